@@ -4,6 +4,12 @@
 
 #include "ios/chrome/browser/crash_report/breadcrumbs/breadcrumb_manager_keyed_service.h"
 
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/strings/string_piece.h"
+#include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/time/time.h"
 #include "ios/chrome/browser/crash_report/breadcrumbs/breadcrumb_manager_observer.h"
@@ -12,10 +18,10 @@
 namespace {
 
 // The minimum number of event buckets to keep, even if they are expired.
-const int kMinEventsBuckets = 2;
+const size_t kMinEventsBuckets = 2;
 
 // Returns a Time used to bucket events for easier discarding of expired events.
-base::Time EventBucket(const base::Time& time) {
+base::Time GetBucketTime(const base::Time& time) {
   base::Time::Exploded exploded;
   time.LocalExplode(&exploded);
   exploded.millisecond = 0;
@@ -29,46 +35,65 @@ base::Time EventBucket(const base::Time& time) {
 
 }  // namespace
 
+const size_t BreadcrumbManagerKeyedService::kMaxEventCount;
+const size_t BreadcrumbManagerKeyedService::kMaxEventLength;
+
 std::list<std::string> BreadcrumbManagerKeyedService::GetEvents(
     size_t event_count_limit) {
   DropOldEvents();
 
+  uint64_t first_sequence = first_event_sequence_;
+  if (event_count_limit > 0 &&
+      next_event_sequence_ - first_sequence > event_count_limit) {
+    first_sequence = next_event_sequence_ - event_count_limit;
+  }
+
   std::list<std::string> events;
-  for (auto it = event_buckets_.rbegin(); it != event_buckets_.rend(); ++it) {
-    std::list<std::string> bucket_events = it->second;
-    for (auto event_it = bucket_events.rbegin();
-         event_it != bucket_events.rend(); ++event_it) {
-      std::string event = *event_it;
-      events.push_front(event);
-      if (event_count_limit > 0 && events.size() >= event_count_limit) {
-        return events;
-      }
-    }
+  for (uint64_t sequence = first_sequence; sequence < next_event_sequence_;
+       ++sequence) {
+    events.push_back(FormatEvent(sequence));
   }
   return events;
 }
 
 void BreadcrumbManagerKeyedService::AddEvent(const std::string& event) {
   base::Time time = base::Time::Now();
-  base::Time bucket_time = EventBucket(time);
+  base::Time bucket_time = GetBucketTime(time);
 
   // If bucket exists, it will be at the end of the list.
-  if (event_buckets_.empty() || event_buckets_.back().first != bucket_time) {
-    std::pair<base::Time, std::list<std::string>> bucket(
-        bucket_time, std::list<std::string>());
-    event_buckets_.push_back(bucket);
+  if (event_buckets_.empty() || event_buckets_.back().time != bucket_time) {
+    event_buckets_.push_back({bucket_time, next_event_sequence_});
   }
 
-  base::Time::Exploded exploded;
-  time.UTCExplode(&exploded);
-  std::string timestamp = base::StringPrintf(
-      "%02d:%02d.%03d", exploded.minute, exploded.second, exploded.millisecond);
-  std::string event_log = base::StringPrintf(
-      "%s %s %s", timestamp.c_str(), browsing_mode_.c_str(), event.c_str());
-  event_buckets_.back().second.push_back(event_log);
+  base::StringPiece text(event);
+  std::string truncated_event;
+  if (event.size() > kMaxEventLength) {
+    // Truncate on a character boundary so that the event stays valid UTF-8.
+    base::TruncateUTF8ToByteSize(event, kMaxEventLength, &truncated_event);
+    text = truncated_event;
+  }
+  EventRecord& record = events_[next_event_sequence_ % kMaxEventCount];
+  record.time = time;
+  record.length = text.size();
+  memcpy(record.text, text.data(), record.length);
+  next_event_sequence_++;
+
+  if (next_event_sequence_ - first_event_sequence_ > kMaxEventCount) {
+    // The oldest event was overwritten. Drop its bucket if it was the last
+    // event in it.
+    first_event_sequence_++;
+    if (event_buckets_.size() > 1 &&
+        event_buckets_[1].first_event_sequence <= first_event_sequence_) {
+      event_buckets_.pop_front();
+    }
+  }
 
   DropOldEvents();
 
+  if (!observers_.might_have_observers()) {
+    return;
+  }
+  std::string event_log = FormatEvent(next_event_sequence_ - 1);
   for (auto& observer : observers_) {
     observer.EventAdded(this, event_log);
   }
@@ -80,19 +105,36 @@ void BreadcrumbManagerKeyedService::DropOldEvents() {
 
   base::Time now = base::Time::Now();
   while (event_buckets_.size() > kMinEventsBuckets) {
-    base::Time oldest_bucket_time = event_buckets_.front().first;
+    base::Time oldest_bucket_time = event_buckets_.front().time;
     if (now - oldest_bucket_time < kMessageExpirationTime) {
       break;
     }
     event_buckets_.pop_front();
+    first_event_sequence_ = std::max(
+        first_event_sequence_, event_buckets_.front().first_event_sequence);
   }
 }
 
+std::string BreadcrumbManagerKeyedService::FormatEvent(
+    uint64_t sequence) const {
+  DCHECK_GE(sequence, first_event_sequence_);
+  DCHECK_LT(sequence, next_event_sequence_);
+  const EventRecord& record = events_[sequence % kMaxEventCount];
+
+  base::Time::Exploded exploded;
+  record.time.UTCExplode(&exploded);
+  return base::StringPrintf("%02d:%02d.%03d %s %.*s", exploded.minute,
+                            exploded.second, exploded.millisecond,
+                            browsing_mode_.c_str(),
+                            static_cast<int>(record.length), record.text);
+}
+
 BreadcrumbManagerKeyedService::BreadcrumbManagerKeyedService(
     web::BrowserState* browser_state)
     // Set "I" for Incognito (Chrome branded OffTheRecord implementation) and
     // "N" for Normal browsing mode.
-    : browsing_mode_(browser_state->IsOffTheRecord() ? "I" : "N") {}
+    : browsing_mode_(browser_state->IsOffTheRecord() ? "I" : "N"),
+      events_(kMaxEventCount) {}
 
 BreadcrumbManagerKeyedService::~BreadcrumbManagerKeyedService() = default;
 
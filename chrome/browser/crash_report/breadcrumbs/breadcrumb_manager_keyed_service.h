@@ -5,10 +5,14 @@
 #ifndef IOS_CHROME_BROWSER_CRASH_REPORT_BREADCRUMBS_BREADCRUMB_MANAGER_KEYED_SERVICE_H_
 #define IOS_CHROME_BROWSER_CRASH_REPORT_BREADCRUMBS_BREADCRUMB_MANAGER_KEYED_SERVICE_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <list>
-#include <map>
 #include <string>
+#include <vector>
 
+#include "base/containers/circular_deque.h"
 #include "base/observer_list.h"
 #import "base/time/time.h"
 #include "components/keyed_service/core/keyed_service.h"
@@ -24,8 +28,17 @@ class BrowserState;
 // time has passed unless no more recent events are available. The internal
 // management of events aims to keep relevant events available while clearing
 // stale data.
+//
+// Events are stored in a preallocated ring of fixed-size records, so logging an
+// event does not allocate. Once the ring is full, the oldest events are
+// overwritten. Events longer than |kMaxEventLength| are truncated.
 class BreadcrumbManagerKeyedService : public KeyedService {
  public:
+  // Maximum number of events kept in memory.
+  static const size_t kMaxEventCount = 1024;
+  // Maximum length of an event, excluding the timestamp and browsing mode.
+  static const size_t kMaxEventLength = 116;
+
   // Returns a list of the collected breadcrumb events which are still relevant
   // up to |event_count_limit|. Passing zero for |event_count_limit| signifies
   // no limit. Events returned will have a timestamp prepended to the original
@@ -45,20 +58,47 @@ class BreadcrumbManagerKeyedService : public KeyedService {
   ~BreadcrumbManagerKeyedService() override;
 
  private:
+  // An event logged with |AddEvent|.
+  struct EventRecord {
+    base::Time time;
+    uint32_t length = 0;
+    char text[kMaxEventLength];
+  };
+
+  // Events logged within the same minute.
+  struct EventBucket {
+    // Time of the bucket, to minute resolution.
+    base::Time time;
+    // Sequence number of the first event of the bucket.
+    uint64_t first_event_sequence;
+  };
+
   // Drops events which are considered stale. Note that stale events are not
   // guaranteed to be removed. Explicitly, stale events will be retained while
   // newer events are limited.
   void DropOldEvents();
 
+  // Returns the event with sequence number |sequence| formatted with its
+  // timestamp and |browsing_mode_|.
+  std::string FormatEvent(uint64_t sequence) const;
+
   // A short string identifying the browser state used to initialize the
   // receiver. For example, "N" for "N"ormal browsing mode. This value is
   // prepended to events sent to |AddEvent| in order to differentiate the
   // BrowserState associated with each event.
   std::string browsing_mode_;
 
-  // List of events, paired with the time which they were logged to minute
-  // resolution. Newer events are at the end of the list.
-  std::list<std::pair<base::Time, std::list<std::string>>> event_buckets_;
+  // Ring of |kMaxEventCount| events. The event with sequence number |sequence|
+  // is stored at index |sequence % kMaxEventCount|.
+  std::vector<EventRecord> events_;
+  // Sequence number of the oldest event still available.
+  uint64_t first_event_sequence_ = 0;
+  // Sequence number of the next event to be logged.
+  uint64_t next_event_sequence_ = 0;
+
+  // Buckets of the available events, ordered by time. Newer buckets are at the
+  // end. Dropping a bucket only moves |first_event_sequence_|.
+  base::circular_deque<EventBucket> event_buckets_;
 
   base::ObserverList<BreadcrumbManagerObserver, /*check_empty=*/true>
       observers_;
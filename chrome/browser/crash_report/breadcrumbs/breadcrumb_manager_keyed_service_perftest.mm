@@ -0,0 +1,66 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/chrome/browser/crash_report/breadcrumbs/breadcrumb_manager_keyed_service.h"
+
+#include <algorithm>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/timer/elapsed_timer.h"
+#include "ios/chrome/test/base/perf_test_ios.h"
+#include "ios/web/public/test/fakes/test_browser_state.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Number of navigations of the replayed trace.
+const int kNavigationCount = 2500;
+
+// Events logged for each navigation.
+const char* const kNavigationEvents[] = {"DidStartNavigation",
+                                         "DidFinishNavigation", "PageLoaded",
+                                         "DidChangeVisibleSecurity"};
+
+class BreadcrumbManagerKeyedServicePerfTest : public PerfTest {
+ protected:
+  BreadcrumbManagerKeyedServicePerfTest()
+      : PerfTest("Breadcrumb manager"), breadcrumb_manager_(&browser_state_) {}
+
+  web::TestBrowserState browser_state_;
+  BreadcrumbManagerKeyedService breadcrumb_manager_;
+};
+
+// Tests logging the events of a navigation trace across 20 tabs.
+TEST_F(BreadcrumbManagerKeyedServicePerfTest, AddEvent) {
+  std::vector<std::string> trace;
+  for (int i = 0; i < kNavigationCount; i++) {
+    for (const char* navigation_event : kNavigationEvents) {
+      trace.push_back("Tab" + base::NumberToString(i % 20) + " " +
+                      navigation_event);
+    }
+  }
+
+  base::ElapsedTimer timer;
+  for (const std::string& event : trace) {
+    breadcrumb_manager_.AddEvent(event);
+  }
+  const base::TimeDelta elapsed = timer.Elapsed();
+
+  LogPerfTiming("Log 10000 events", elapsed);
+  LogPerfValue("Logged events per second",
+               trace.size() / std::max(elapsed.InSecondsF(), 0.000001),
+               "events/s");
+
+  std::list<std::string> events = breadcrumb_manager_.GetEvents(0);
+  ASSERT_FALSE(events.empty());
+  EXPECT_NE(std::string::npos, events.back().find(trace.back()));
+}
+
+}  // namespace
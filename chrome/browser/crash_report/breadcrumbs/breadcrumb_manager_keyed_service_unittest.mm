@@ -4,6 +4,10 @@
 
 #include "ios/chrome/browser/crash_report/breadcrumbs/breadcrumb_manager_keyed_service.h"
 
+#include <string>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
 #include "base/time/time.h"
 #include "ios/chrome/browser/browser_state/test_chrome_browser_state.h"
 #include "ios/chrome/browser/browser_state/test_chrome_browser_state_manager.h"
@@ -141,3 +145,48 @@ TEST_F(BreadcrumbManagerKeyedServiceTest, EventsLabeledWithBrowserState) {
 
   EXPECT_STRNE(event.c_str(), off_the_record_event.c_str());
 }
+
+// Tests that the oldest events are overwritten once |kMaxEventCount| events
+// are stored.
+TEST_F(BreadcrumbManagerKeyedServiceTest, OldestEventsOverwritten) {
+  const size_t kEventCount = BreadcrumbManagerKeyedService::kMaxEventCount + 10;
+  for (size_t i = 0; i < kEventCount; i++) {
+    breadcrumb_manager_->AddEvent("event" + base::NumberToString(i));
+  }
+
+  std::list<std::string> events = breadcrumb_manager_->GetEvents(0);
+  ASSERT_EQ(BreadcrumbManagerKeyedService::kMaxEventCount, events.size());
+  EXPECT_NE(std::string::npos, events.front().find(" event10"));
+  EXPECT_NE(std::string::npos,
+            events.back().find(" event" +
+                               base::NumberToString(kEventCount - 1)));
+}
+
+// Tests that long events are truncated to |kMaxEventLength|.
+TEST_F(BreadcrumbManagerKeyedServiceTest, LongEventTruncated) {
+  std::string long_event(BreadcrumbManagerKeyedService::kMaxEventLength + 10,
+                         'a');
+  breadcrumb_manager_->AddEvent(long_event);
+
+  std::string event = breadcrumb_manager_->GetEvents(0).front();
+  EXPECT_EQ(std::string::npos, event.find(long_event));
+  EXPECT_NE(std::string::npos,
+            event.find(long_event.substr(
+                0, BreadcrumbManagerKeyedService::kMaxEventLength)));
+}
+
+// Tests that long events are truncated on a character boundary.
+TEST_F(BreadcrumbManagerKeyedServiceTest, LongEventTruncatedToValidUTF8) {
+  // The two bytes of the last character straddle |kMaxEventLength|.
+  std::string long_event(BreadcrumbManagerKeyedService::kMaxEventLength - 1,
+                         'a');
+  long_event += "\xC3\xA9";
+  breadcrumb_manager_->AddEvent(long_event);
+
+  std::string event = breadcrumb_manager_->GetEvents(0).front();
+  EXPECT_TRUE(base::IsStringUTF8(event));
+  EXPECT_TRUE(base::EndsWith(
+      event,
+      long_event.substr(0, BreadcrumbManagerKeyedService::kMaxEventLength - 1),
+      base::CompareCase::SENSITIVE));
+}
@@ -4,10 +4,14 @@
 
 #include "ios/chrome/browser/crash_report/breadcrumbs/breadcrumb_persistent_storage_keyed_service.h"
 
+#include "base/bind.h"
+#include "base/files/file_util.h"
 #include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
+#include "base/task/post_task.h"
 #include "ios/chrome/browser/crash_report/breadcrumbs/breadcrumb_manager_keyed_service.h"
 #include "ios/chrome/browser/crash_report/breadcrumbs/breadcrumb_persistent_storage_util.h"
+#include "ios/chrome/browser/crash_report/breadcrumbs/breadcrumb_ring_buffer.h"
 
 namespace {
 
@@ -15,6 +19,14 @@ namespace {
 // BreadcrumbManager.
 const int kPersistedExistingEventsCount = 10;
 
+// Size of the breadcrumbs file. Once full, the oldest events are overwritten.
+const size_t kPersistedFileSize = 100 * 1024;
+
+// Delay between an event being added and the breadcrumbs file being synced to
+// disk. Events are in the file as soon as they are added, so they survive a
+// crash of the app; syncing only protects them from a crash of the system.
+const base::TimeDelta kSyncDelay = base::TimeDelta::FromSeconds(1);
+
 }  // namespace
 
 using breadcrumb_persistent_storage_util::
@@ -23,33 +35,43 @@ using breadcrumb_persistent_storage_util::
 BreadcrumbPersistentStorageKeyedService::
     BreadcrumbPersistentStorageKeyedService(web::BrowserState* browser_state)
     : breadcrumbs_file_path_(
-          GetBreadcrumbPersistentStorageFilePath(browser_state)) {}
+          GetBreadcrumbPersistentStorageFilePath(browser_state)),
+      sync_task_runner_(base::CreateSequencedTaskRunner(
+          {base::ThreadPool(), base::MayBlock(),
+           base::TaskPriority::BEST_EFFORT,
+           base::TaskShutdownBehavior::BLOCK_SHUTDOWN})) {}
+
 BreadcrumbPersistentStorageKeyedService::
-    ~BreadcrumbPersistentStorageKeyedService() = default;
+    ~BreadcrumbPersistentStorageKeyedService() {
+  if (sync_timer_.IsRunning()) {
+    sync_timer_.Stop();
+    SyncRingBuffer();
+  }
+}
 
 std::vector<std::string>
 BreadcrumbPersistentStorageKeyedService::GetStoredEvents() {
-  base::File events_file(breadcrumbs_file_path_,
-                         base::File::FLAG_OPEN | base::File::FLAG_READ);
-  if (!events_file.IsValid()) {
+  std::string file_contents;
+  if (!base::ReadFileToString(breadcrumbs_file_path_, &file_contents)) {
     // File may not yet exist.
     return std::vector<std::string>();
   }
 
-  int64_t file_size = events_file.GetLength();
-  if (file_size <= 0) {
-    return std::vector<std::string>();
+  std::vector<std::string> events;
+  if (BreadcrumbRingBuffer::ReadEvents(file_contents, &events)) {
+    return events;
   }
 
-  std::vector<uint8_t> data;
-  // Subtract one to account for '\0' at end of file.
-  data.resize(file_size - 1);
-  if (!events_file.ReadAndCheck(/*offset=*/0, data)) {
+  // A ring buffer file whose headers are both corrupt is binary, and must not
+  // be read as text. Start with no events instead.
+  if (file_contents.size() == kPersistedFileSize ||
+      file_contents.find('\0') != std::string::npos) {
     return std::vector<std::string>();
   }
-  std::string persistent_events_string(data.begin(), data.end());
-  return base::SplitString(persistent_events_string, "\n",
-                           base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+
+  // The file was written by a version which appended events to a text file.
+  return base::SplitString(file_contents, "\n", base::TRIM_WHITESPACE,
+                           base::SPLIT_WANT_NONEMPTY);
 }
 
 void BreadcrumbPersistentStorageKeyedService::ObserveBreadcrumbManager(
@@ -61,45 +83,58 @@ void BreadcrumbPersistentStorageKeyedService::ObserveBreadcrumbManager(
   observered_manager_ = manager;
   WriteExistingBreadcrumbEvents();
 
-  if (observered_manager_) {
+  // Events can't be persisted without a ring buffer.
+  if (observered_manager_ && ring_buffer_) {
     observered_manager_->AddObserver(this);
   }
 }
 
 void BreadcrumbPersistentStorageKeyedService::WriteExistingBreadcrumbEvents() {
-  if (persisted_events_file_) {
-    // File already exists, truncate to remove old events.
-    persisted_events_file_->SetLength(0);
+  if (ring_buffer_) {
+    // Start a new generation to remove old events.
+    ring_buffer_->Clear();
   } else if (observered_manager_) {
-    persisted_events_file_ = std::make_unique<base::File>(
-        breadcrumbs_file_path_,
-        base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE);
+    ring_buffer_ =
+        BreadcrumbRingBuffer::Create(breadcrumbs_file_path_, kPersistedFileSize);
   }
 
-  if (!observered_manager_) {
+  if (!ring_buffer_) {
     return;
   }
 
-  for (auto& event :
-       observered_manager_->GetEvents(kPersistedExistingEventsCount)) {
-    WriteBreadcrumbEvent(event);
+  if (observered_manager_) {
+    for (auto& event :
+         observered_manager_->GetEvents(kPersistedExistingEventsCount)) {
+      ring_buffer_->Append(event);
+    }
   }
-  persisted_events_file_->Flush();
+  ScheduleSync();
 }
 
-void BreadcrumbPersistentStorageKeyedService::WriteBreadcrumbEvent(
-    const std::string& event) {
-  DCHECK(persisted_events_file_);
+void BreadcrumbPersistentStorageKeyedService::ScheduleSync() {
+  if (sync_timer_.IsRunning()) {
+    return;
+  }
+  sync_timer_.Start(
+      FROM_HERE, kSyncDelay,
+      base::BindOnce(&BreadcrumbPersistentStorageKeyedService::SyncRingBuffer,
+                     base::Unretained(this)));
+}
 
-  persisted_events_file_->WriteAtCurrentPosAndCheck(
-      base::as_bytes(base::make_span(event)));
-  persisted_events_file_->WriteAtCurrentPosAndCheck(
-      base::as_bytes(base::make_span("\n")));
+void BreadcrumbPersistentStorageKeyedService::SyncRingBuffer() {
+  if (!ring_buffer_) {
+    return;
+  }
+  sync_task_runner_->PostTask(
+      FROM_HERE, base::BindOnce(&BreadcrumbRingBuffer::Sync, ring_buffer_));
 }
 
 void BreadcrumbPersistentStorageKeyedService::EventAdded(
     BreadcrumbManagerKeyedService* manager,
     const std::string& event) {
-  WriteBreadcrumbEvent(event);
-  persisted_events_file_->Flush();
+  if (!ring_buffer_) {
+    return;
+  }
+  ring_buffer_->Append(event);
+  ScheduleSync();
 }
@@ -9,19 +9,27 @@
 #include <string>
 #include <vector>
 
-#include "base/files/file.h"
 #include "base/files/file_path.h"
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/timer/timer.h"
 #include "components/keyed_service/core/keyed_service.h"
 #include "ios/chrome/browser/crash_report/breadcrumbs/breadcrumb_manager_observer.h"
 
 class BreadcrumbManagerKeyedService;
+class BreadcrumbRingBuffer;
+
+namespace base {
+class SequencedTaskRunner;
+}  // namespace base
 
 namespace web {
 class BrowserState;
 }
 
-// Saves and retrieves breadcrumb events to and from disk.
+// Saves and retrieves breadcrumb events to and from disk. Events are appended
+// to a fixed-size memory-mapped ring buffer file, which is periodically synced
+// to disk on a background sequence.
 class BreadcrumbPersistentStorageKeyedService
     : public BreadcrumbManagerObserver,
       public KeyedService {
@@ -34,7 +42,7 @@ class BreadcrumbPersistentStorageKeyedService
       web::BrowserState* browser_state);
   ~BreadcrumbPersistentStorageKeyedService() override;
 
-  // Returns the stored breadcrumb events from disk.
+  // Returns the stored breadcrumb events from disk, oldest first.
   std::vector<std::string> GetStoredEvents();
 
   // Sets the |manager| to observe. Old stored breadcrumbs will be removed, even
@@ -49,9 +57,11 @@ class BreadcrumbPersistentStorageKeyedService
   // is null.
   void WriteExistingBreadcrumbEvents();
 
-  // Appends |event| to |persisted_events_file_|. |persisted_events_file_| must
-  // already exist.
-  void WriteBreadcrumbEvent(const std::string& event);
+  // Schedules a sync of |ring_buffer_| to disk, unless one is already pending.
+  void ScheduleSync();
+
+  // Posts a task syncing |ring_buffer_| to disk on |sync_task_runner_|.
+  void SyncRingBuffer();
 
   // BreadcrumbManagerObserver
   void EventAdded(BreadcrumbManagerKeyedService* manager,
@@ -63,10 +73,15 @@ class BreadcrumbPersistentStorageKeyedService
   // The path to the breadcrumbs file.
   base::FilePath breadcrumbs_file_path_;
 
-  // File handle for writing persisted breadcrumbs to |breadcrumbs_file_path_|.
-  // Lazily created after |ObserveBreadcrumbManager| is called with a non-null
-  // manager.
-  std::unique_ptr<base::File> persisted_events_file_;
+  // Ring buffer mapping |breadcrumbs_file_path_|. Lazily created after
+  // |ObserveBreadcrumbManager| is called with a non-null manager.
+  scoped_refptr<BreadcrumbRingBuffer> ring_buffer_;
+
+  // Sequence on which |ring_buffer_| is synced to disk.
+  scoped_refptr<base::SequencedTaskRunner> sync_task_runner_;
+
+  // Delays syncs so that bursts of events are synced at once.
+  base::OneShotTimer sync_timer_;
 
   DISALLOW_COPY_AND_ASSIGN(BreadcrumbPersistentStorageKeyedService);
 };
@@ -6,12 +6,14 @@
 
 #include "base/files/file_util.h"
 #include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_number_conversions.h"
 #include "ios/chrome/browser/browser_state/test_chrome_browser_state.h"
 #include "ios/chrome/browser/browser_state/test_chrome_browser_state_manager.h"
 #include "ios/chrome/browser/crash_report/breadcrumbs/breadcrumb_manager_keyed_service.h"
 #include "ios/chrome/browser/crash_report/breadcrumbs/breadcrumb_manager_keyed_service_factory.h"
 #include "ios/chrome/browser/crash_report/breadcrumbs/breadcrumb_persistent_storage_keyed_service_factory.h"
 #include "ios/chrome/browser/crash_report/breadcrumbs/breadcrumb_persistent_storage_util.h"
+#include "ios/chrome/browser/crash_report/breadcrumbs/breadcrumb_ring_buffer.h"
 #include "ios/chrome/test/ios_chrome_scoped_testing_chrome_browser_state_manager.h"
 #include "ios/web/public/test/web_task_environment.h"
 #include "testing/platform_test.h"
@@ -102,15 +104,60 @@ TEST_F(BreadcrumbPersistentStorageKeyedServiceTest, PersistExistingMessages) {
 }
 
 // Tests that calling |ObserveBreadcrumbManager| with a null manager removes the
-// contents of the persistent storage file.
+// events from the persistent storage file.
 TEST_F(BreadcrumbPersistentStorageKeyedServiceTest, DeletePersistentStorage) {
   breadcrumb_manager_->AddEvent("event");
   persistent_storage_->ObserveBreadcrumbManager(breadcrumb_manager_);
   persistent_storage_->ObserveBreadcrumbManager(/*manager=*/nullptr);
 
-  int64_t file_size = -1;
-  ASSERT_TRUE(base::GetFileSize(
-      GetBreadcrumbPersistentStorageFilePath(chrome_browser_state_.get()),
-      &file_size));
-  EXPECT_EQ(0, file_size);
+  EXPECT_TRUE(persistent_storage_->GetStoredEvents().empty());
+}
+
+// Tests that events stored in the ring buffer are returned in order once the
+// oldest ones have been overwritten.
+TEST_F(BreadcrumbPersistentStorageKeyedServiceTest, PersistManyMessages) {
+  persistent_storage_->ObserveBreadcrumbManager(breadcrumb_manager_);
+  const int kEventCount = 10000;
+  for (int i = 0; i < kEventCount; i++) {
+    breadcrumb_manager_->AddEvent("event" + base::NumberToString(i));
+  }
+
+  auto events = persistent_storage_->GetStoredEvents();
+  ASSERT_FALSE(events.empty());
+  EXPECT_LT(events.size(), static_cast<size_t>(kEventCount));
+  EXPECT_NE(std::string::npos,
+            events.back().find("event" + base::NumberToString(kEventCount - 1)));
+}
+
+// Tests that breadcrumbs files written by previous versions, which were plain
+// text files, can still be read.
+TEST_F(BreadcrumbPersistentStorageKeyedServiceTest, ReadLegacyFile) {
+  const std::string legacy_events = "event1\nevent2\n";
+  ASSERT_EQ(static_cast<int>(legacy_events.size()),
+            base::WriteFile(GetBreadcrumbPersistentStorageFilePath(
+                                chrome_browser_state_.get()),
+                            legacy_events.data(), legacy_events.size()));
+
+  std::vector<std::string> expected_events = {"event1", "event2"};
+  EXPECT_EQ(expected_events, persistent_storage_->GetStoredEvents());
+}
+
+// Tests that a ring buffer file whose headers are both corrupt is not read as
+// a text file.
+TEST_F(BreadcrumbPersistentStorageKeyedServiceTest, ReadCorruptFile) {
+  persistent_storage_->ObserveBreadcrumbManager(breadcrumb_manager_);
+  breadcrumb_manager_->AddEvent("event");
+
+  const base::FilePath file_path =
+      GetBreadcrumbPersistentStorageFilePath(chrome_browser_state_.get());
+  std::string file_contents;
+  ASSERT_TRUE(base::ReadFileToString(file_path, &file_contents));
+  ASSERT_GT(file_contents.size(), BreadcrumbRingBuffer::kHeaderRegionSize);
+  file_contents.replace(0, BreadcrumbRingBuffer::kHeaderRegionSize,
+                        BreadcrumbRingBuffer::kHeaderRegionSize, '\xff');
+  ASSERT_EQ(static_cast<int>(file_contents.size()),
+            base::WriteFile(file_path, file_contents.data(),
+                            file_contents.size()));
+
+  EXPECT_TRUE(persistent_storage_->GetStoredEvents().empty());
 }
@@ -0,0 +1,269 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/chrome/browser/crash_report/breadcrumbs/breadcrumb_ring_buffer.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/hash/hash.h"
+#include "base/logging.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "base/threading/scoped_blocking_call.h"
+
+namespace {
+
+// Identifies a breadcrumbs ring buffer file ("BCRB").
+const uint32_t kMagic = 0x42524342;
+const uint32_t kVersion = 2;
+
+// Header stored in each of the |kHeaderSlotCount| slots at the start of the
+// file.
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+  // Incremented on each commit. The slot with the highest value is current.
+  uint64_t sequence;
+  uint32_t generation;
+  // Offset in the data region where the next event will be written.
+  uint32_t write_offset;
+  // Non-zero once events have been written past the end of the data region.
+  uint32_t wrapped;
+  // Once wrapped, hash of the bytes at |write_offset| up to the next
+  // separator, which hold the oldest event unless an append overwrote them
+  // without committing.
+  uint32_t oldest_event_hash;
+  uint32_t unused;
+  // Hash of the preceding fields.
+  uint32_t checksum;
+};
+static_assert(sizeof(Header) == 40, "Header must not contain padding");
+
+const size_t kHeaderSlotCount = 2;
+
+const char kEventSeparator = '\n';
+
+uint32_t ComputeChecksum(const Header& header) {
+  return base::PersistentHash(&header, offsetof(Header, checksum));
+}
+
+// Finds the most recent valid header in |header_region| for a data region of
+// |capacity| bytes. Returns false if no slot holds a valid header.
+bool ReadLatestHeader(const uint8_t* header_region,
+                      size_t capacity,
+                      Header* latest_header) {
+  bool found = false;
+  for (size_t i = 0; i < kHeaderSlotCount; ++i) {
+    Header header;
+    memcpy(&header, header_region + i * sizeof(Header), sizeof(Header));
+    if (header.magic != kMagic || header.version != kVersion ||
+        header.checksum != ComputeChecksum(header) ||
+        header.write_offset >= capacity) {
+      continue;
+    }
+    if (!found || header.sequence > latest_header->sequence) {
+      *latest_header = header;
+      found = true;
+    }
+  }
+  return found;
+}
+
+}  // namespace
+
+const size_t BreadcrumbRingBuffer::kHeaderRegionSize =
+    kHeaderSlotCount * sizeof(Header);
+
+// static
+scoped_refptr<BreadcrumbRingBuffer> BreadcrumbRingBuffer::Create(
+    const base::FilePath& file_path,
+    size_t file_size) {
+  DCHECK_GT(file_size, kHeaderRegionSize);
+  base::File file(file_path, base::File::FLAG_OPEN_ALWAYS |
+                                 base::File::FLAG_READ |
+                                 base::File::FLAG_WRITE);
+  if (!file.IsValid()) {
+    return nullptr;
+  }
+  if (file.GetLength() != static_cast<int64_t>(file_size) &&
+      !file.SetLength(file_size)) {
+    return nullptr;
+  }
+
+  auto mapped_file = std::make_unique<base::MemoryMappedFile>();
+  if (!mapped_file->Initialize(std::move(file),
+                               base::MemoryMappedFile::READ_WRITE)) {
+    return nullptr;
+  }
+
+  scoped_refptr<BreadcrumbRingBuffer> ring_buffer =
+      base::WrapRefCounted(new BreadcrumbRingBuffer(std::move(mapped_file)));
+  ring_buffer->Clear();
+  return ring_buffer;
+}
+
+// static
+bool BreadcrumbRingBuffer::ReadEvents(base::StringPiece file_contents,
+                                      std::vector<std::string>* events) {
+  if (file_contents.size() <= kHeaderRegionSize) {
+    return false;
+  }
+  const size_t capacity = file_contents.size() - kHeaderRegionSize;
+  Header header;
+  if (!ReadLatestHeader(
+          reinterpret_cast<const uint8_t*>(file_contents.data()), capacity,
+          &header)) {
+    return false;
+  }
+
+  base::StringPiece data = file_contents.substr(kHeaderRegionSize);
+  std::string ordered_events;
+  if (header.wrapped) {
+    // The oldest events start at the write offset. The first of them may have
+    // been partially overwritten, so skip past the first separator.
+    ordered_events.reserve(capacity);
+    data.substr(header.write_offset).AppendToString(&ordered_events);
+    data.substr(0, header.write_offset).AppendToString(&ordered_events);
+    // The first of them is dropped if an append which did not commit
+    // overwrote it.
+    size_t first_separator = ordered_events.find(kEventSeparator);
+    const size_t oldest_event_size = first_separator == std::string::npos
+                                         ? ordered_events.size()
+                                         : first_separator;
+    if (base::PersistentHash(ordered_events.data(), oldest_event_size) !=
+        header.oldest_event_hash) {
+      ordered_events.erase(0, first_separator == std::string::npos
+                                  ? ordered_events.size()
+                                  : first_separator + 1);
+    }
+  } else {
+    data.substr(0, header.write_offset).AppendToString(&ordered_events);
+  }
+  // Bytes of a cleared ring which were never written are zero.
+  base::RemoveChars(ordered_events, base::StringPiece("\0", 1),
+                    &ordered_events);
+
+  *events = base::SplitString(ordered_events, std::string(1, kEventSeparator),
+                              base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+  return true;
+}
+
+BreadcrumbRingBuffer::BreadcrumbRingBuffer(
+    std::unique_ptr<base::MemoryMappedFile> file)
+    : file_(std::move(file)),
+      data_(file_->data() + kHeaderRegionSize),
+      capacity_(file_->length() - kHeaderRegionSize) {
+  Header header;
+  if (ReadLatestHeader(file_->data(), capacity_, &header)) {
+    sequence_ = header.sequence;
+    generation_ = header.generation;
+  }
+}
+
+BreadcrumbRingBuffer::~BreadcrumbRingBuffer() = default;
+
+void BreadcrumbRingBuffer::Clear() {
+  memset(data_, 0, capacity_);
+  generation_++;
+  write_offset_ = 0;
+  wrapped_ = false;
+  CommitHeader();
+}
+
+void BreadcrumbRingBuffer::Append(base::StringPiece event) {
+  std::string sanitized_event;
+  if (event.find(kEventSeparator) != base::StringPiece::npos) {
+    sanitized_event = event.as_string();
+    std::replace(sanitized_event.begin(), sanitized_event.end(),
+                 kEventSeparator, ' ');
+    event = sanitized_event;
+  }
+  const size_t event_size = std::min(event.size(), capacity_ - 1);
+
+  if (!wrapped_ && write_offset_ + event_size + 1 > capacity_) {
+    // Mark the ring as wrapped before overwriting the start of the data
+    // region, so that an event torn by a crash is dropped as the oldest one.
+    wrapped_ = true;
+    CommitHeader();
+  }
+
+  WriteData(event.data(), event_size);
+  if (wrapped_) {
+    ClearOverwrittenEventRemainder(capacity_ - event_size);
+  }
+  WriteData(&kEventSeparator, 1);
+  CommitHeader();
+}
+
+void BreadcrumbRingBuffer::Sync() {
+  base::ScopedBlockingCall scoped_blocking_call(FROM_HERE,
+                                                base::BlockingType::MAY_BLOCK);
+  if (msync(file_->data(), file_->length(), MS_SYNC) != 0) {
+    DPLOG(ERROR) << "Failed to sync breadcrumbs";
+  }
+}
+
+void BreadcrumbRingBuffer::WriteData(const char* bytes, size_t size) {
+  while (size > 0) {
+    const size_t chunk_size = std::min(size, capacity_ - write_offset_);
+    memcpy(data_ + write_offset_, bytes, chunk_size);
+    bytes += chunk_size;
+    size -= chunk_size;
+    write_offset_ += static_cast<uint32_t>(chunk_size);
+    if (write_offset_ == capacity_) {
+      write_offset_ = 0;
+      wrapped_ = true;
+    }
+  }
+}
+
+void BreadcrumbRingBuffer::ClearOverwrittenEventRemainder(size_t max_size) {
+  size_t offset = write_offset_;
+  for (size_t i = 0; i < max_size && data_[offset] != kEventSeparator; ++i) {
+    data_[offset] = 0;
+    offset = (offset + 1) % capacity_;
+  }
+}
+
+uint32_t BreadcrumbRingBuffer::HashOldestEvent() const {
+  size_t size = 0;
+  while (size < capacity_ &&
+         data_[(write_offset_ + size) % capacity_] != kEventSeparator) {
+    ++size;
+  }
+  if (write_offset_ + size <= capacity_) {
+    return base::PersistentHash(data_ + write_offset_, size);
+  }
+  // The oldest event wraps around the end of the data region.
+  std::string oldest_event;
+  oldest_event.reserve(size);
+  oldest_event.append(reinterpret_cast<const char*>(data_ + write_offset_),
+                      capacity_ - write_offset_);
+  oldest_event.append(reinterpret_cast<const char*>(data_),
+                      size - (capacity_ - write_offset_));
+  return base::PersistentHash(oldest_event.data(), oldest_event.size());
+}
+
+void BreadcrumbRingBuffer::CommitHeader() {
+  Header header = {};
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.sequence = ++sequence_;
+  header.generation = generation_;
+  header.write_offset = write_offset_;
+  header.wrapped = wrapped_ ? 1 : 0;
+  if (wrapped_) {
+    header.oldest_event_hash = HashOldestEvent();
+  }
+  header.checksum = ComputeChecksum(header);
+  memcpy(file_->data() + (sequence_ % kHeaderSlotCount) * sizeof(Header),
+         &header, sizeof(Header));
+}
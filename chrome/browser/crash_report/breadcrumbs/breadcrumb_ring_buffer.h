@@ -0,0 +1,114 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_CHROME_BROWSER_CRASH_REPORT_BREADCRUMBS_BREADCRUMB_RING_BUFFER_H_
+#define IOS_CHROME_BROWSER_CRASH_REPORT_BREADCRUMBS_BREADCRUMB_RING_BUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/files/memory_mapped_file.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+class FilePath;
+}  // namespace base
+
+// Fixed-size, memory-mapped ring buffer file storing breadcrumb events as
+// newline separated strings. Once the data region is full, new events
+// overwrite the oldest ones.
+//
+// The file starts with two header slots, which are written alternately so that
+// a crash while committing a header leaves the previous one intact. Each header
+// holds the write offset of the next event, whether the ring wrapped around,
+// the generation of the buffer (incremented on each |Clear|), the hash of the
+// oldest event once wrapped and a checksum.
+// Event bytes are always written before the header is committed. When an
+// event overwrites older ones, the remainder of the last overwritten event is
+// zeroed before the new event's separator is written, and the oldest event is
+// only read back if it matches the hash of the header, so that neither a torn
+// event nor a truncated old one is read back after a crash.
+//
+// |Append| and |Clear| must be called on the same sequence. |Sync| may be
+// called on any sequence.
+class BreadcrumbRingBuffer
+    : public base::RefCountedThreadSafe<BreadcrumbRingBuffer> {
+ public:
+  // Size of the header region at the start of the file.
+  static const size_t kHeaderRegionSize;
+
+  // Maps the file at |file_path|, creating or resizing it to |file_size| bytes
+  // as needed, and clears any events it contained. Returns null on failure.
+  static scoped_refptr<BreadcrumbRingBuffer> Create(
+      const base::FilePath& file_path,
+      size_t file_size);
+
+  // Reconstructs the events stored in the ring buffer file |file_contents|,
+  // oldest first, into |events|. When the ring wrapped around, the oldest
+  // event is dropped if it was partially overwritten. Returns false if
+  // |file_contents| does not hold a valid ring buffer.
+  static bool ReadEvents(base::StringPiece file_contents,
+                         std::vector<std::string>* events);
+
+  // Removes all events and starts a new generation.
+  void Clear();
+
+  // Appends |event|. Newlines in |event| are replaced by spaces.
+  void Append(base::StringPiece event);
+
+  // Flushes the mapped memory to disk. This blocks and must not be called on
+  // the UI thread.
+  void Sync();
+
+  // Returns the generation of the buffer.
+  uint32_t generation() const { return generation_; }
+
+  // Returns the offset in the data region where the next event will be
+  // written.
+  uint32_t write_offset() const { return write_offset_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<BreadcrumbRingBuffer>;
+
+  explicit BreadcrumbRingBuffer(std::unique_ptr<base::MemoryMappedFile> file);
+  ~BreadcrumbRingBuffer();
+
+  // Copies |size| bytes of |bytes| at |write_offset_|, wrapping around the end
+  // of the data region.
+  void WriteData(const char* bytes, size_t size);
+
+  // Zeroes the bytes at |write_offset_| up to the next separator, visiting at
+  // most |max_size| bytes. Called after an event overwrote the beginning of an
+  // older one.
+  void ClearOverwrittenEventRemainder(size_t max_size);
+
+  // Returns the hash of the bytes at |write_offset_| up to the next separator,
+  // which hold the oldest event once the ring wrapped around.
+  uint32_t HashOldestEvent() const;
+
+  // Writes the current state to the header slot following the last committed
+  // one.
+  void CommitHeader();
+
+  std::unique_ptr<base::MemoryMappedFile> file_;
+  // Start and size of the data region of |file_|.
+  uint8_t* data_ = nullptr;
+  size_t capacity_ = 0;
+
+  // State written to the header on each commit.
+  uint64_t sequence_ = 0;
+  uint32_t generation_ = 0;
+  uint32_t write_offset_ = 0;
+  bool wrapped_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(BreadcrumbRingBuffer);
+};
+
+#endif  // IOS_CHROME_BROWSER_CRASH_REPORT_BREADCRUMBS_BREADCRUMB_RING_BUFFER_H_
@@ -0,0 +1,67 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/chrome/browser/crash_report/breadcrumbs/breadcrumb_ring_buffer.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/timer/elapsed_timer.h"
+#include "ios/chrome/test/base/perf_test_ios.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Number of events appended in each run.
+const int kEventCount = 100000;
+
+// Size of the ring buffer file, as used by the persistent storage.
+const size_t kFileSize = 100 * 1024;
+
+class BreadcrumbRingBufferPerfTest : public PerfTest {
+ protected:
+  BreadcrumbRingBufferPerfTest() : PerfTest("Breadcrumb ring buffer") {
+    EXPECT_TRUE(scoped_temp_directory_.CreateUniqueTempDir());
+    file_path_ = scoped_temp_directory_.GetPath().Append("breadcrumbs");
+  }
+
+  base::ScopedTempDir scoped_temp_directory_;
+  base::FilePath file_path_;
+};
+
+// Tests appending events to the memory-mapped ring buffer.
+TEST_F(BreadcrumbRingBufferPerfTest, Append) {
+  scoped_refptr<BreadcrumbRingBuffer> ring =
+      BreadcrumbRingBuffer::Create(file_path_, kFileSize);
+  ASSERT_TRUE(ring);
+
+  const std::string event = "Tab1 PageLoaded https://www.example.com/";
+  base::ElapsedTimer timer;
+  for (int i = 0; i < kEventCount; i++) {
+    ring->Append(event);
+  }
+  const base::TimeDelta elapsed = timer.Elapsed();
+  ring->Sync();
+
+  LogPerfTiming("Append 100000 events", elapsed);
+  LogPerfValue("Appended events per second",
+               kEventCount / std::max(elapsed.InSecondsF(), 0.000001),
+               "events/s");
+
+  std::string file_contents;
+  ASSERT_TRUE(base::ReadFileToString(file_path_, &file_contents));
+  std::vector<std::string> events;
+  ASSERT_TRUE(BreadcrumbRingBuffer::ReadEvents(file_contents, &events));
+  ASSERT_FALSE(events.empty());
+  EXPECT_EQ(event, events.back());
+}
+
+}  // namespace
@@ -0,0 +1,220 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/chrome/browser/crash_report/breadcrumbs/breadcrumb_ring_buffer.h"
+
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_number_conversions.h"
+#include "testing/platform_test.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Size of the ring buffer files used by the tests. Small enough for the ring
+// to wrap around after a few events.
+const size_t kDataSize = 64;
+const size_t kFileSize = BreadcrumbRingBuffer::kHeaderRegionSize + kDataSize;
+
+}  // namespace
+
+class BreadcrumbRingBufferTest : public PlatformTest {
+ protected:
+  BreadcrumbRingBufferTest() {
+    EXPECT_TRUE(scoped_temp_directory_.CreateUniqueTempDir());
+    file_path_ = scoped_temp_directory_.GetPath().Append("breadcrumbs");
+  }
+
+  // Returns the current contents of the ring buffer file.
+  std::string ReadFile() {
+    std::string contents;
+    EXPECT_TRUE(base::ReadFileToString(file_path_, &contents));
+    return contents;
+  }
+
+  // Returns the events stored in |contents|.
+  std::vector<std::string> ReadEvents(const std::string& contents) {
+    std::vector<std::string> events;
+    EXPECT_TRUE(BreadcrumbRingBuffer::ReadEvents(contents, &events));
+    return events;
+  }
+
+  base::ScopedTempDir scoped_temp_directory_;
+  base::FilePath file_path_;
+};
+
+// Tests that appended events are read back in order.
+TEST_F(BreadcrumbRingBufferTest, AppendAndRead) {
+  scoped_refptr<BreadcrumbRingBuffer> ring =
+      BreadcrumbRingBuffer::Create(file_path_, kFileSize);
+  ASSERT_TRUE(ring);
+  EXPECT_TRUE(ReadEvents(ReadFile()).empty());
+
+  ring->Append("event1");
+  ring->Append("event\n2");
+  ring->Append("event3");
+
+  std::vector<std::string> expected_events = {"event1", "event 2", "event3"};
+  EXPECT_EQ(expected_events, ReadEvents(ReadFile()));
+}
+
+// Tests that the oldest events are dropped once the ring wraps around.
+TEST_F(BreadcrumbRingBufferTest, WrapAround) {
+  scoped_refptr<BreadcrumbRingBuffer> ring =
+      BreadcrumbRingBuffer::Create(file_path_, kFileSize);
+  ASSERT_TRUE(ring);
+
+  for (int i = 0; i < 100; i++) {
+    ring->Append("event" + base::NumberToString(i));
+  }
+
+  std::vector<std::string> events = ReadEvents(ReadFile());
+  ASSERT_FALSE(events.empty());
+  // Events are 8 bytes long with their separator, so at most 8 fit.
+  EXPECT_LE(events.size(), 8U);
+  EXPECT_GE(events.size(), 6U);
+  for (size_t i = 0; i < events.size(); i++) {
+    EXPECT_EQ("event" + base::NumberToString(100 - events.size() + i),
+              events[i]);
+  }
+}
+
+// Tests that no event is dropped when events end exactly at the end of the
+// data region or where an older event ended.
+TEST_F(BreadcrumbRingBufferTest, WrapAroundOnEventBoundaries) {
+  scoped_refptr<BreadcrumbRingBuffer> ring =
+      BreadcrumbRingBuffer::Create(file_path_, kFileSize);
+  ASSERT_TRUE(ring);
+
+  // Events are 8 bytes long with their separator, so exactly 8 fit.
+  std::vector<std::string> expected_events;
+  for (int i = 10; i < 18; i++) {
+    expected_events.push_back("event" + base::NumberToString(i));
+    ring->Append(expected_events.back());
+  }
+  EXPECT_EQ(expected_events, ReadEvents(ReadFile()));
+
+  ring->Append("event18");
+  expected_events.erase(expected_events.begin());
+  expected_events.push_back("event18");
+  EXPECT_EQ(expected_events, ReadEvents(ReadFile()));
+}
+
+// Tests that re-creating the ring buffer removes the stored events and starts
+// a new generation.
+TEST_F(BreadcrumbRingBufferTest, CreateClearsEvents) {
+  scoped_refptr<BreadcrumbRingBuffer> ring =
+      BreadcrumbRingBuffer::Create(file_path_, kFileSize);
+  ASSERT_TRUE(ring);
+  ring->Append("event");
+  const uint32_t generation = ring->generation();
+  ring.reset();
+
+  ring = BreadcrumbRingBuffer::Create(file_path_, kFileSize);
+  ASSERT_TRUE(ring);
+  EXPECT_EQ(generation + 1, ring->generation());
+  EXPECT_TRUE(ReadEvents(ReadFile()).empty());
+}
+
+// Tests that files which are not ring buffers are rejected.
+TEST_F(BreadcrumbRingBufferTest, InvalidFile) {
+  std::vector<std::string> events;
+  EXPECT_FALSE(BreadcrumbRingBuffer::ReadEvents("event1\nevent2\n", &events));
+  EXPECT_FALSE(BreadcrumbRingBuffer::ReadEvents(
+      std::string(kFileSize, 'a'), &events));
+}
+
+// Simulates a crash at every point of an append, in the order the bytes are
+// written, and checks that only complete events are read back.
+TEST_F(BreadcrumbRingBufferTest, CrashConsistency) {
+  scoped_refptr<BreadcrumbRingBuffer> ring =
+      BreadcrumbRingBuffer::Create(file_path_, kFileSize);
+  ASSERT_TRUE(ring);
+
+  bool wrapped = false;
+  for (int i = 0; i < 40; i++) {
+    const std::string before = ReadFile();
+    const std::vector<std::string> committed_events = ReadEvents(before);
+    const size_t write_offset = ring->write_offset();
+    const std::string event =
+        "event" + base::NumberToString(i) + std::string(i % 7, 'x');
+    ring->Append(event);
+    const std::string after = ReadFile();
+
+    if (!wrapped && ring->write_offset() <= write_offset) {
+      // The append which first wraps around commits a wrapped header before
+      // writing any byte, which is not modeled here.
+      wrapped = true;
+      continue;
+    }
+
+    // Event bytes are written first, then the remainder of the overwritten
+    // event is cleared and the separator is written last.
+    std::vector<size_t> write_order;
+    const size_t separator_position = (write_offset + event.size()) % kDataSize;
+    for (size_t j = 0; j < event.size(); j++) {
+      write_order.push_back((write_offset + j) % kDataSize);
+    }
+    for (size_t j = 1; j < kDataSize - event.size(); j++) {
+      const size_t position = (separator_position + j) % kDataSize;
+      const size_t file_position =
+          BreadcrumbRingBuffer::kHeaderRegionSize + position;
+      if (before[file_position] != after[file_position]) {
+        write_order.push_back(position);
+      }
+    }
+    write_order.push_back(separator_position);
+
+    // Crash after |crash_point| bytes were written but before the header was
+    // committed.
+    for (size_t crash_point = 0; crash_point <= write_order.size();
+         crash_point++) {
+      std::string torn = before;
+      for (size_t j = 0; j < crash_point; j++) {
+        const size_t file_position =
+            BreadcrumbRingBuffer::kHeaderRegionSize + write_order[j];
+        torn[file_position] = after[file_position];
+      }
+      std::vector<std::string> events = ReadEvents(torn);
+      // The events read must be the most recent committed events, in order.
+      // Only the oldest ones, which the new event overwrote, may be missing.
+      ASSERT_LE(events.size(), committed_events.size());
+      ASSERT_EQ(committed_events.empty(), events.empty())
+          << "Crash at " << crash_point << " of event " << i;
+      const size_t skipped = committed_events.size() - events.size();
+      for (size_t j = 0; j < events.size(); j++) {
+        EXPECT_EQ(committed_events[skipped + j], events[j])
+            << "Crash at " << crash_point << " of event " << i;
+      }
+    }
+  }
+}
+
+// Tests that a torn header falls back to the previously committed one.
+TEST_F(BreadcrumbRingBufferTest, TornHeader) {
+  scoped_refptr<BreadcrumbRingBuffer> ring =
+      BreadcrumbRingBuffer::Create(file_path_, kFileSize);
+  ASSERT_TRUE(ring);
+  ring->Append("event1");
+  const std::string before = ReadFile();
+  ring->Append("event2");
+  const std::string after = ReadFile();
+
+  // Only one header slot changed. Corrupt it.
+  std::string torn = after;
+  for (size_t i = 0; i < BreadcrumbRingBuffer::kHeaderRegionSize; i++) {
+    if (before[i] != after[i]) {
+      torn[i] = ~after[i];
+    }
+  }
+  std::vector<std::string> expected_events = {"event1"};
+  EXPECT_EQ(expected_events, ReadEvents(torn));
+}
@@ -26,6 +26,7 @@
 #include "ios/chrome/browser/infobars/infobar_utils.h"
 #include "ios/chrome/browser/sessions/ios_chrome_tab_restore_service_factory.h"
 #import "ios/chrome/browser/sessions/session_ios.h"
+#import "ios/chrome/browser/sessions/session_journal.h"
 #import "ios/chrome/browser/sessions/session_service_ios.h"
 #import "ios/chrome/browser/sessions/session_window_ios.h"
 #import "ios/chrome/browser/sessions/session_window_restoring.h"
@@ -247,6 +248,8 @@ int SessionCrashedInfoBarDelegate::GetIconId() const {
   NSString* stashPath =
       base::SysUTF8ToNSString(browserState->GetStatePath().value());
   NSString* sessionPath = [SessionServiceIOS sessionPathForDirectory:stashPath];
+  NSString* journalPath =
+      [SessionJournal journalPathForSessionPath:sessionPath];
   NSFileManager* fileManager = [NSFileManager defaultManager];
   if (![fileManager fileExistsAtPath:sessionPath])
     return NO;
@@ -268,6 +271,11 @@ int SessionCrashedInfoBarDelegate::GetIconId() const {
     if (!fileOperationSuccess) {
       return NO;
     }
+    // The journal holds the changes saved since the session file was written.
+    NSString* backupJournalPath =
+        [SessionJournal journalPathForSessionPath:file];
+    [fileManager removeItemAtPath:backupJournalPath error:nil];
+    [fileManager moveItemAtPath:journalPath toPath:backupJournalPath error:nil];
   } else {
     NSError* error;
     BOOL fileOperationSuccess =
@@ -278,6 +286,7 @@ int SessionCrashedInfoBarDelegate::GetIconId() const {
     if (!fileOperationSuccess) {
       return NO;
     }
+    [fileManager removeItemAtPath:journalPath error:nil];
   }
   return YES;
 }
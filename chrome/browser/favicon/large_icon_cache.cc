@@ -4,24 +4,56 @@
 
 #include "ios/chrome/browser/favicon/large_icon_cache.h"
 
+#include <utility>
+
+#include "base/logging.h"
+#include "base/metrics/histogram_macros.h"
 #include "components/favicon_base/fallback_icon_style.h"
 #include "components/favicon_base/favicon_types.h"
 #include "url/gurl.h"
 
+struct LargeIconCacheEntry {
+  LargeIconCacheEntry() {}
+  ~LargeIconCacheEntry() {}
+
+  scoped_refptr<const LargeIconCache::Result> result;
+  size_t byte_count = 0;
+};
+
 namespace {
 
-const int kMaxCacheSize = 12;
+// Budget of the cached results, enough for the favicons of the NTP tiles and
+// of a few screens of history or bookmarks.
+const size_t kMaxCacheByteCount = 2 * 1024 * 1024;
+
+// Returns the estimated memory used by the cached |result| of |url|.
+size_t EstimateByteCount(const GURL& url,
+                         const favicon_base::LargeIconResult& result) {
+  size_t byte_count = sizeof(LargeIconCacheEntry) +
+                      sizeof(favicon_base::LargeIconResult) +
+                      url.spec().size() + result.bitmap.icon_url.spec().size();
+  if (result.bitmap.bitmap_data)
+    byte_count += result.bitmap.bitmap_data->size();
+  if (result.fallback_icon_style)
+    byte_count += sizeof(favicon_base::FallbackIconStyle);
+  return byte_count;
+}
 
 }  // namespace
 
-struct LargeIconCacheEntry {
-  LargeIconCacheEntry() {}
-  ~LargeIconCacheEntry() {}
+LargeIconCache::Result::Result(
+    std::unique_ptr<favicon_base::LargeIconResult> result)
+    : result_(std::move(result)) {
+  DCHECK(result_);
+}
 
-  std::unique_ptr<favicon_base::LargeIconResult> result;
-};
+LargeIconCache::Result::~Result() {}
+
+LargeIconCache::LargeIconCache() : LargeIconCache(kMaxCacheByteCount) {}
 
-LargeIconCache::LargeIconCache() : cache_(kMaxCacheSize) {}
+LargeIconCache::LargeIconCache(size_t max_byte_count)
+    : max_byte_count_(max_byte_count),
+      cache_(decltype(cache_)::NO_AUTO_EVICT) {}
 
 LargeIconCache::~LargeIconCache() {}
 
@@ -29,19 +61,47 @@ void LargeIconCache::SetCachedResult(
     const GURL& url,
     const favicon_base::LargeIconResult& result) {
   std::unique_ptr<LargeIconCacheEntry> entry(new LargeIconCacheEntry);
-  entry->result = CloneLargeIconResult(result);
+  entry->result = base::MakeRefCounted<Result>(CloneLargeIconResult(result));
+  entry->byte_count = EstimateByteCount(url, result);
+
+  auto iter = cache_.Peek(url);
+  if (iter != cache_.end()) {
+    stats_.byte_count -= iter->second->byte_count;
+    cache_.Erase(iter);
+  }
+  stats_.byte_count += entry->byte_count;
   cache_.Put(url, std::move(entry));
+  EvictToByteBudget();
 }
 
-std::unique_ptr<favicon_base::LargeIconResult> LargeIconCache::GetCachedResult(
+scoped_refptr<const LargeIconCache::Result> LargeIconCache::GetCachedResult(
     const GURL& url) {
   auto iter = cache_.Get(url);
   if (iter != cache_.end()) {
     DCHECK(iter->second->result);
-    return CloneLargeIconResult(*iter->second->result.get());
+    ++stats_.hit_count;
+    return iter->second->result;
   }
 
-  return std::unique_ptr<favicon_base::LargeIconResult>();
+  ++stats_.miss_count;
+  return nullptr;
+}
+
+LargeIconCache::Stats LargeIconCache::GetStats() const {
+  Stats stats = stats_;
+  stats.entry_count = cache_.size();
+  return stats;
+}
+
+void LargeIconCache::Shutdown() {
+  int64_t lookup_count = stats_.hit_count + stats_.miss_count;
+  if (lookup_count > 0) {
+    UMA_HISTOGRAM_PERCENTAGE(
+        "IOS.LargeIconCache.HitRate",
+        static_cast<int>(stats_.hit_count * 100 / lookup_count));
+  }
+  UMA_HISTOGRAM_COUNTS_1000("IOS.LargeIconCache.EntryCount", cache_.size());
+  UMA_HISTOGRAM_MEMORY_KB("IOS.LargeIconCache.Size", stats_.byte_count / 1024);
 }
 
 std::unique_ptr<favicon_base::LargeIconResult>
@@ -57,3 +117,11 @@ LargeIconCache::CloneLargeIconResult(
   }
   return clone;
 }
+
+void LargeIconCache::EvictToByteBudget() {
+  while (stats_.byte_count > max_byte_count_ && !cache_.empty()) {
+    auto oldest = cache_.rbegin();
+    stats_.byte_count -= oldest->second->byte_count;
+    cache_.Erase(oldest);
+  }
+}
@@ -5,10 +5,14 @@
 #ifndef IOS_CHROME_BROWSER_FAVICON_LARGE_ICON_CACHE_H_
 #define IOS_CHROME_BROWSER_FAVICON_LARGE_ICON_CACHE_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <memory>
 
 #include "base/containers/mru_cache.h"
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
 #include "components/keyed_service/core/keyed_service.h"
 
 class GURL;
@@ -18,34 +22,77 @@ namespace favicon_base {
 struct LargeIconResult;
 }
 
-// Provides a cache of most recently used LargeIconResult.
+// Provides a cache of most recently used LargeIconResult, up to a budget of
+// bytes.
 //
 // Example usage:
 //   LargeIconCache* large_icon_cache =
 //       IOSChromeLargeIconServiceFactory::GetForBrowserState(browser_state);
-//   std::unique_ptr<favicon_base::LargeIconResult> icon =
+//   scoped_refptr<const LargeIconCache::Result> icon =
 //       large_icon_cache->GetCachedResult(...);
 //
 class LargeIconCache : public KeyedService {
  public:
+  // A cached LargeIconResult. It is immutable, so that the cache hands it out
+  // without copying it.
+  class Result : public base::RefCounted<Result> {
+   public:
+    explicit Result(std::unique_ptr<favicon_base::LargeIconResult> result);
+
+    const favicon_base::LargeIconResult& result() const { return *result_; }
+
+   private:
+    friend class base::RefCounted<Result>;
+    ~Result();
+
+    const std::unique_ptr<const favicon_base::LargeIconResult> result_;
+
+    DISALLOW_COPY_AND_ASSIGN(Result);
+  };
+
+  // Usage counters of the cache.
+  struct Stats {
+    // Number of calls to GetCachedResult() which found, or did not find, a
+    // result.
+    int64_t hit_count = 0;
+    int64_t miss_count = 0;
+    // Estimated size and number of the cached results.
+    size_t byte_count = 0;
+    size_t entry_count = 0;
+  };
+
   LargeIconCache();
+  // Creates a cache evicting the least recently used results once they take
+  // more than |max_byte_count| bytes.
+  explicit LargeIconCache(size_t max_byte_count);
   ~LargeIconCache() override;
 
   // |LargeIconService| does everything on callbacks, and iOS needs to load the
   // icons immediately on page load. This caches the LargeIconResult so we can
-  // immediately load.
+  // immediately load.
   void SetCachedResult(const GURL& url, const favicon_base::LargeIconResult&);
 
-  // Returns a cached LargeIconResult.
-  std::unique_ptr<favicon_base::LargeIconResult> GetCachedResult(
-      const GURL& url);
+  // Returns a cached LargeIconResult, or null if there is none for |url|.
+  scoped_refptr<const Result> GetCachedResult(const GURL& url);
+
+  // Returns the usage counters of the cache.
+  Stats GetStats() const;
+
+  // KeyedService implementation.
+  void Shutdown() override;
 
  private:
   // Clones a LargeIconResult.
   std::unique_ptr<favicon_base::LargeIconResult> CloneLargeIconResult(
       const favicon_base::LargeIconResult& large_icon_result);
 
+  // Removes the least recently used results until the cached results fit in
+  // |max_byte_count_|.
+  void EvictToByteBudget();
+
+  const size_t max_byte_count_;
   base::MRUCache<GURL, std::unique_ptr<LargeIconCacheEntry>> cache_;
+  Stats stats_;
 
   DISALLOW_COPY_AND_ASSIGN(LargeIconCache);
 };
@@ -78,26 +78,81 @@ TEST_F(LargeIconCacheTest, RetreiveItem) {
   large_icon_cache_->SetCachedResult(GURL(kDummyUrl), *expected_result1);
   large_icon_cache_->SetCachedResult(GURL(kDummyUrl2), *expected_result2);
 
-  std::unique_ptr<favicon_base::LargeIconResult> result1 =
+  scoped_refptr<const LargeIconCache::Result> result1 =
       large_icon_cache_->GetCachedResult(GURL(kDummyUrl));
-  EXPECT_EQ(true, result1->bitmap.is_valid());
-  EXPECT_EQ(expected_result1->bitmap.pixel_size, result1->bitmap.pixel_size);
+  EXPECT_EQ(true, result1->result().bitmap.is_valid());
+  EXPECT_EQ(expected_result1->bitmap.pixel_size,
+            result1->result().bitmap.pixel_size);
 
-  std::unique_ptr<favicon_base::LargeIconResult> result2 =
+  scoped_refptr<const LargeIconCache::Result> result2 =
       large_icon_cache_->GetCachedResult(GURL(kDummyUrl2));
-  EXPECT_EQ(false, result2->bitmap.is_valid());
+  EXPECT_EQ(false, result2->result().bitmap.is_valid());
   EXPECT_EQ(expected_result2->fallback_icon_style->background_color,
-            result2->fallback_icon_style->background_color);
-  EXPECT_FALSE(result2->fallback_icon_style->is_default_background_color);
+            result2->result().fallback_icon_style->background_color);
+  EXPECT_FALSE(
+      result2->result().fallback_icon_style->is_default_background_color);
 
   // Test overwriting kDummyUrl.
   large_icon_cache_->SetCachedResult(GURL(kDummyUrl), *expected_result2);
-  std::unique_ptr<favicon_base::LargeIconResult> result3 =
+  scoped_refptr<const LargeIconCache::Result> result3 =
       large_icon_cache_->GetCachedResult(GURL(kDummyUrl2));
-  EXPECT_EQ(false, result3->bitmap.is_valid());
+  EXPECT_EQ(false, result3->result().bitmap.is_valid());
   EXPECT_EQ(expected_result2->fallback_icon_style->background_color,
-            result3->fallback_icon_style->background_color);
-  EXPECT_FALSE(result2->fallback_icon_style->is_default_background_color);
+            result3->result().fallback_icon_style->background_color);
+  EXPECT_FALSE(
+      result2->result().fallback_icon_style->is_default_background_color);
+}
+
+// Tests that the cached results are shared rather than copied on each lookup,
+// and that the lookups are counted.
+TEST_F(LargeIconCacheTest, SharedResults) {
+  large_icon_cache_->SetCachedResult(
+      GURL(kDummyUrl), favicon_base::LargeIconResult(expected_bitmap_));
+
+  scoped_refptr<const LargeIconCache::Result> result1 =
+      large_icon_cache_->GetCachedResult(GURL(kDummyUrl));
+  scoped_refptr<const LargeIconCache::Result> result2 =
+      large_icon_cache_->GetCachedResult(GURL(kDummyUrl));
+  EXPECT_EQ(result1, result2);
+  EXPECT_EQ(nullptr, large_icon_cache_->GetCachedResult(GURL(kDummyUrl2)));
+
+  LargeIconCache::Stats stats = large_icon_cache_->GetStats();
+  EXPECT_EQ(2, stats.hit_count);
+  EXPECT_EQ(1, stats.miss_count);
+  EXPECT_EQ(1u, stats.entry_count);
+  EXPECT_LT(expected_bitmap_.bitmap_data->size(), stats.byte_count);
+
+  // The result handed out stays valid after it is replaced.
+  large_icon_cache_->SetCachedResult(
+      GURL(kDummyUrl), favicon_base::LargeIconResult(expected_bitmap_));
+  EXPECT_TRUE(result1->result().bitmap.is_valid());
+}
+
+// Tests that the least recently used results are evicted once the cached
+// results exceed the byte budget.
+TEST_F(LargeIconCacheTest, ByteBudget) {
+  const char kDummyUrl3[] = "http://www.example3.com";
+  LargeIconCache probe_cache;
+  probe_cache.SetCachedResult(GURL(kDummyUrl),
+                              favicon_base::LargeIconResult(expected_bitmap_));
+  size_t entry_byte_count = probe_cache.GetStats().byte_count;
+
+  // Room for two results.
+  LargeIconCache large_icon_cache(entry_byte_count * 2 + entry_byte_count / 2);
+  large_icon_cache.SetCachedResult(
+      GURL(kDummyUrl), favicon_base::LargeIconResult(expected_bitmap_));
+  large_icon_cache.SetCachedResult(
+      GURL(kDummyUrl2), favicon_base::LargeIconResult(expected_bitmap_));
+  EXPECT_TRUE(large_icon_cache.GetCachedResult(GURL(kDummyUrl)));
+  large_icon_cache.SetCachedResult(
+      GURL(kDummyUrl3), favicon_base::LargeIconResult(expected_bitmap_));
+
+  EXPECT_TRUE(large_icon_cache.GetCachedResult(GURL(kDummyUrl)));
+  EXPECT_FALSE(large_icon_cache.GetCachedResult(GURL(kDummyUrl2)));
+  EXPECT_TRUE(large_icon_cache.GetCachedResult(GURL(kDummyUrl3)));
+  EXPECT_EQ(2u, large_icon_cache.GetStats().entry_count);
+  EXPECT_GE(entry_byte_count * 2 + entry_byte_count / 2,
+            large_icon_cache.GetStats().byte_count);
 }
 
 }  // namespace
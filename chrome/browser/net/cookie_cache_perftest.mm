@@ -0,0 +1,125 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/net/cookies/cookie_cache.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "base/timer/elapsed_timer.h"
+#include "ios/chrome/test/base/perf_test_ios.h"
+#include "net/cookies/canonical_cookie.h"
+#include "net/cookies/cookie_constants.h"
+#include "url/gurl.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Number of cookies of each (url, name) pair.
+const int kCookiesPerKey = 10;
+
+// The cookies of a (url, name) pair of the cache.
+struct KeyCookies {
+  GURL url;
+  std::string name;
+  std::vector<net::CanonicalCookie> cookies;
+};
+
+net::CanonicalCookie MakeCookie(const GURL& url,
+                                const std::string& name,
+                                const std::string& value) {
+  return net::CanonicalCookie(name, value, url.host(), url.path(),
+                              base::Time(), base::Time(), base::Time(), false,
+                              false, net::CookieSameSite::NO_RESTRICTION,
+                              net::COOKIE_PRIORITY_DEFAULT);
+}
+
+// Returns a jar of |cookie_count| cookies, grouped by (url, name) pair.
+std::vector<KeyCookies> MakeJar(int cookie_count) {
+  std::vector<KeyCookies> jar;
+  for (int key = 0; key < cookie_count / kCookiesPerKey; ++key) {
+    KeyCookies key_cookies;
+    key_cookies.url = GURL(base::StringPrintf(
+        "https://www.example%d.com/path", key % (cookie_count / 100 + 1)));
+    key_cookies.name = "name" + base::NumberToString(key);
+    for (int i = 0; i < kCookiesPerKey; ++i) {
+      const GURL cookie_url(key_cookies.url.spec() + "/" +
+                            base::NumberToString(i));
+      key_cookies.cookies.push_back(
+          MakeCookie(cookie_url, key_cookies.name, base::NumberToString(i)));
+    }
+    jar.push_back(std::move(key_cookies));
+  }
+  return jar;
+}
+
+class CookieCachePerfTest : public PerfTest {
+ protected:
+  CookieCachePerfTest() : PerfTest("Cookie cache") {}
+
+  // Times filling a cache with a jar of |cookie_count| cookies, looking all of
+  // them up with unchanged updates, then changing one cookie of each (url,
+  // name) pair.
+  void TimeJar(int cookie_count) {
+    std::vector<KeyCookies> jar = MakeJar(cookie_count);
+    net::CookieCache cache;
+
+    base::ElapsedTimer fill_timer;
+    for (const KeyCookies& key_cookies : jar) {
+      EXPECT_TRUE(cache.Update(key_cookies.url, key_cookies.name,
+                               key_cookies.cookies, nullptr, nullptr));
+    }
+    LogPerfTiming(base::StringPrintf("Fill %d cookies", cookie_count),
+                  fill_timer.Elapsed());
+
+    base::ElapsedTimer lookup_timer;
+    for (const KeyCookies& key_cookies : jar) {
+      EXPECT_FALSE(cache.Update(key_cookies.url, key_cookies.name,
+                                key_cookies.cookies, nullptr, nullptr));
+    }
+    LogPerfTiming(base::StringPrintf("Look up %d cookies", cookie_count),
+                  lookup_timer.Elapsed());
+
+    for (KeyCookies& key_cookies : jar) {
+      key_cookies.cookies[0] =
+          MakeCookie(key_cookies.url, key_cookies.name, "changed");
+    }
+    base::ElapsedTimer change_timer;
+    std::vector<net::CanonicalCookie> removed;
+    std::vector<net::CanonicalCookie> added;
+    for (const KeyCookies& key_cookies : jar) {
+      removed.clear();
+      added.clear();
+      EXPECT_TRUE(cache.Update(key_cookies.url, key_cookies.name,
+                               key_cookies.cookies, &removed, &added));
+    }
+    LogPerfTiming(
+        base::StringPrintf("Change 1 cookie per name, %d cookies",
+                           cookie_count),
+        change_timer.Elapsed());
+  }
+};
+
+// Tests a jar of 1000 cookies.
+TEST_F(CookieCachePerfTest, Jar1000) {
+  TimeJar(1000);
+}
+
+// Tests a jar of 10000 cookies.
+TEST_F(CookieCachePerfTest, Jar10000) {
+  TimeJar(10000);
+}
+
+// Tests a jar of 50000 cookies.
+TEST_F(CookieCachePerfTest, Jar50000) {
+  TimeJar(50000);
+}
+
+}  // namespace
@@ -0,0 +1,106 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/net/read_buffer_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+
+#include "base/debug/alias.h"
+#include "base/stl_util.h"
+#include "base/timer/elapsed_timer.h"
+#include "ios/chrome/test/base/perf_test_ios.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Size classes and high-water mark of the pool, as for the shared pool used by
+// HttpProtocolHandlerCore.
+const int kMinSize = 64 * 1024;
+const int kMaxSize = 16 * kMinSize;
+const size_t kMaxRetainedBytes = 4 * kMaxSize;
+
+// Sizes of the successive reads of a response body, as the buffer of
+// HttpProtocolHandlerCore grows from its minimum to its maximum size.
+const int kReadSizes[] = {kMinSize,     2 * kMinSize, 4 * kMinSize,
+                          8 * kMinSize, kMaxSize,     kMaxSize,
+                          kMaxSize,     kMaxSize};
+
+// Number of responses read by each run.
+const int kResponseCount = 100;
+
+// Number of reads of each run.
+const int kReadCount = kResponseCount * base::size(kReadSizes);
+
+class ReadBufferPoolPerfTest : public PerfTest {
+ protected:
+  ReadBufferPoolPerfTest() : PerfTest("Read buffer pool") {}
+
+  // Times reading |kResponseCount| responses, with buffers from the pool if
+  // |pooled| is true, or with one malloc per read otherwise. Each read fills
+  // its buffer, as the network does.
+  void TimeReads(bool pooled) {
+    net::ReadBufferPool pool(kMinSize, kMaxSize, kMaxRetainedBytes);
+    net::ReadBufferPool* pool_pointer = &pool;
+    __block base::TimeDelta total_elapsed;
+    __block int run_count = 0;
+    const std::string allocation = pooled ? "pooled buffers" : "malloc";
+    RepeatTimedRuns(
+        "Read 100 responses, " + allocation,
+        ^base::TimeDelta(int) {
+          base::ElapsedTimer timer;
+          for (int response = 0; response < kResponseCount; ++response) {
+            for (int size : kReadSizes) {
+              if (pooled) {
+                net::ReadBufferPool::Buffer buffer =
+                    pool_pointer->Acquire(size);
+                memset(buffer.get(), response, size);
+                // Keeps the writes from being optimized out.
+                base::debug::Alias(buffer.get());
+              } else {
+                char* buffer = static_cast<char*>(malloc(size));
+                memset(buffer, response, size);
+                base::debug::Alias(buffer);
+                free(buffer);
+              }
+            }
+          }
+          base::TimeDelta elapsed = timer.Elapsed();
+          total_elapsed += elapsed;
+          run_count++;
+          return elapsed;
+        },
+        nil);
+
+    LogPerfValue("Reads per second, " + allocation,
+                 run_count * kReadCount /
+                     std::max(total_elapsed.InSecondsF(), 0.000001),
+                 "reads/s");
+    if (pooled) {
+      net::ReadBufferPool::Stats stats = pool.GetStats();
+      LogPerfValue("Pool hit rate",
+                   100.0 * stats.hits / std::max<size_t>(
+                                            stats.hits + stats.misses, 1),
+                   "%");
+    }
+  }
+};
+
+// Tests reading responses with one malloc per read, as the baseline.
+TEST_F(ReadBufferPoolPerfTest, MallocPerRead) {
+  TimeReads(/*pooled=*/false);
+}
+
+// Tests reading responses with buffers recycled through the pool.
+TEST_F(ReadBufferPoolPerfTest, PooledReads) {
+  TimeReads(/*pooled=*/true);
+}
+
+}  // namespace
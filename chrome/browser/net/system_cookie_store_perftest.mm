@@ -0,0 +1,107 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/net/cookies/ns_http_system_cookie_store.h"
+
+#import <Foundation/Foundation.h>
+
+#include "base/macros.h"
+#include "base/strings/stringprintf.h"
+#include "base/timer/elapsed_timer.h"
+#include "ios/chrome/test/base/perf_test_ios.h"
+#import "ios/net/cookies/cookie_creation_time_manager.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Number of distinct path lengths of the cookies, so that the creation times
+// break most of the ties.
+const int kPathCount = 4;
+
+// Exposes the comparator and the creation time manager used to sort cookies.
+class SortingSystemCookieStore : public net::NSHTTPSystemCookieStore {
+ public:
+  SortingSystemCookieStore() = default;
+
+  // Sorts |cookies| the way the system cookie stores do, as per RFC6265.
+  NSArray* SortCookies(NSArray* cookies) {
+    return [cookies sortedArrayUsingFunction:CompareCookies
+                                     context:creation_time_manager_.get()];
+  }
+
+  // Forgets all the creation times, as on a new session.
+  void ClearCreationTimes() { creation_time_manager_->Clear(); }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SortingSystemCookieStore);
+};
+
+// Returns |count| cookies created by the system within the same second, as for
+// a jar restored on startup.
+NSArray* CreateCookies(int count) {
+  NSMutableArray* cookies = [NSMutableArray arrayWithCapacity:count];
+  NSURL* url = [NSURL URLWithString:@"http://www.example.com"];
+  for (int i = 0; i < count; ++i) {
+    NSString* path = [@"/" stringByPaddingToLength:1 + i % kPathCount
+                                        withString:@"a"
+                                   startingAtIndex:0];
+    NSString* cookie_line =
+        [NSString stringWithFormat:@"name%d=value; path=%@", i, path];
+    NSDictionary* headers = @{@"Set-Cookie" : cookie_line};
+    [cookies addObjectsFromArray:[NSHTTPCookie
+                                     cookiesWithResponseHeaderFields:headers
+                                                              forURL:url]];
+  }
+  return cookies;
+}
+
+class SystemCookieStorePerfTest : public PerfTest {
+ protected:
+  SystemCookieStorePerfTest() : PerfTest("System cookie store") {}
+
+  // Times sorting a jar of |cookie_count| cookies. If |cold| is true, the
+  // creation times are cleared before each run, so that the sort also loads
+  // them from the cookies.
+  void TimeSort(int cookie_count, bool cold) {
+    NSArray* cookies = CreateCookies(cookie_count);
+    ASSERT_EQ(static_cast<NSUInteger>(cookie_count), cookies.count);
+
+    SortingSystemCookieStore* store = &store_;
+    std::string test_name = base::StringPrintf(
+        "Sort %d cookies, %s creation times", cookie_count,
+        cold ? "cold" : "warm");
+    RepeatTimedRuns(
+        test_name,
+        ^base::TimeDelta(int) {
+          base::ElapsedTimer timer;
+          NSArray* sorted = store->SortCookies(cookies);
+          base::TimeDelta elapsed = timer.Elapsed();
+          EXPECT_EQ(cookies.count, sorted.count);
+          return elapsed;
+        },
+        ^{
+          if (cold)
+            store->ClearCreationTimes();
+        });
+  }
+
+  SortingSystemCookieStore store_;
+};
+
+// Tests sorting a typical jar.
+TEST_F(SystemCookieStorePerfTest, CompareCookies) {
+  TimeSort(1000, /*cold=*/true);
+  TimeSort(1000, /*cold=*/false);
+}
+
+// Tests sorting a jar of a heavy user.
+TEST_F(SystemCookieStorePerfTest, CompareCookiesLargeJar) {
+  TimeSort(10000, /*cold=*/true);
+  TimeSort(10000, /*cold=*/false);
+}
+
+}  // namespace
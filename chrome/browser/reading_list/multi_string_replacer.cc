@@ -0,0 +1,148 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/chrome/browser/reading_list/multi_string_replacer.h"
+
+#include <limits>
+#include <queue>
+
+#include "base/logging.h"
+#include "base/stl_util.h"
+
+namespace reading_list {
+
+namespace {
+// The state of the empty prefix.
+const size_t kRoot = 0;
+// Value of Node::pattern for the prefixes which are not patterns.
+const size_t kNoPattern = std::numeric_limits<size_t>::max();
+}  // namespace
+
+MultiStringReplacer::Node::Node()
+    : failure(kRoot), output(kRoot), pattern(kNoPattern), depth(0) {}
+
+MultiStringReplacer::Node::Node(Node&& other) = default;
+
+MultiStringReplacer::Node::~Node() = default;
+
+MultiStringReplacer::Node& MultiStringReplacer::Node::operator=(
+    Node&& other) = default;
+
+MultiStringReplacer::MultiStringReplacer(
+    const std::vector<std::pair<std::string, std::string>>& replacements)
+    : nodes_(1) {
+  // Builds the trie of the patterns.
+  for (const auto& replacement : replacements) {
+    const std::string& pattern = replacement.first;
+    if (pattern.empty())
+      continue;
+    size_t node = kRoot;
+    for (char c : pattern) {
+      auto it = nodes_[node].children.find(c);
+      if (it != nodes_[node].children.end()) {
+        node = it->second;
+        continue;
+      }
+      size_t child = nodes_.size();
+      nodes_[node].children.emplace(c, child);
+      nodes_.emplace_back();
+      nodes_[child].depth = nodes_[node].depth + 1;
+      node = child;
+    }
+    if (nodes_[node].pattern != kNoPattern)
+      continue;
+    nodes_[node].pattern = replacements_.size();
+    replacements_.push_back(replacement.second);
+  }
+
+  // Computes the failure and output links in breadth-first order, so that the
+  // links of the shorter prefixes are known.
+  std::queue<size_t> queue;
+  queue.push(kRoot);
+  while (!queue.empty()) {
+    size_t node = queue.front();
+    queue.pop();
+    for (const auto& child : nodes_[node].children) {
+      size_t failure =
+          node == kRoot ? kRoot : Next(nodes_[node].failure, child.first);
+      Node& child_node = nodes_[child.second];
+      child_node.failure = failure;
+      child_node.output = nodes_[failure].pattern != kNoPattern
+                              ? failure
+                              : nodes_[failure].output;
+      queue.push(child.second);
+    }
+  }
+}
+
+MultiStringReplacer::~MultiStringReplacer() = default;
+
+bool MultiStringReplacer::Replace(base::StringPiece text,
+                                  std::string* output) const {
+  DCHECK(output);
+  // An occurrence of a pattern, not replaced yet.
+  struct Match {
+    size_t start;
+    size_t node;
+  };
+  std::vector<Match> pending_matches;
+  // The characters of |text| before |copied| are already in |output|.
+  size_t copied = 0;
+  bool replaced = false;
+
+  // Replaces the leftmost longest pending matches, as long as they start
+  // before |earliest_start|, the earliest position at which an occurrence not
+  // found yet may start.
+  auto replace_pending_matches = [&](size_t earliest_start) {
+    while (!pending_matches.empty()) {
+      base::EraseIf(pending_matches, [copied](const Match& match) {
+        return match.start < copied;
+      });
+      const Match* best = nullptr;
+      for (const Match& match : pending_matches) {
+        if (!best || match.start < best->start ||
+            (match.start == best->start &&
+             nodes_[match.node].depth > nodes_[best->node].depth)) {
+          best = &match;
+        }
+      }
+      if (!best || best->start >= earliest_start)
+        return;
+      const Node& node = nodes_[best->node];
+      output->append(text.data() + copied, best->start - copied);
+      output->append(replacements_[node.pattern]);
+      copied = best->start + node.depth;
+      replaced = true;
+    }
+  };
+
+  size_t state = kRoot;
+  for (size_t i = 0; i < text.size(); ++i) {
+    state = Next(state, text[i]);
+    for (size_t node = state; node != kRoot; node = nodes_[node].output) {
+      if (nodes_[node].pattern != kNoPattern)
+        pending_matches.push_back({i + 1 - nodes_[node].depth, node});
+    }
+    // The occurrences ending after |i| extend a suffix of the current prefix.
+    if (!pending_matches.empty())
+      replace_pending_matches(i + 1 - nodes_[state].depth);
+  }
+  replace_pending_matches(text.size());
+  output->append(text.data() + copied, text.size() - copied);
+  return replaced;
+}
+
+size_t MultiStringReplacer::Next(size_t state, char c) const {
+  while (true) {
+    const base::flat_map<char, size_t>& children = nodes_[state].children;
+    auto it = children.find(c);
+    if (it != children.end())
+      return it->second;
+    if (state == kRoot)
+      return kRoot;
+    state = nodes_[state].failure;
+  }
+}
+
+}  // namespace reading_list
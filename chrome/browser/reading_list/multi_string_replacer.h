@@ -0,0 +1,72 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_CHROME_BROWSER_READING_LIST_MULTI_STRING_REPLACER_H_
+#define IOS_CHROME_BROWSER_READING_LIST_MULTI_STRING_REPLACER_H_
+
+#include <stddef.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+
+namespace reading_list {
+
+// Replaces the occurrences of a set of patterns in a text in a single pass over
+// the text, using an Aho-Corasick automaton built from all the patterns. Used
+// to replace the URLs of the images of a distilled page by the names of their
+// local copies.
+class MultiStringReplacer {
+ public:
+  // Builds the automaton matching the first string of each pair of
+  // |replacements|, to be replaced by the second one. Empty patterns are
+  // ignored. A pattern present several times keeps its first replacement.
+  explicit MultiStringReplacer(
+      const std::vector<std::pair<std::string, std::string>>& replacements);
+  ~MultiStringReplacer();
+
+  // Appends |text| to |output|, replacing the occurrences of the patterns.
+  // When occurrences overlap, the leftmost one is replaced, and the longest
+  // one among those starting at the same position. The replacements are not
+  // scanned for patterns. Returns whether any occurrence was replaced.
+  bool Replace(base::StringPiece text, std::string* output) const;
+
+ private:
+  // A state of the automaton, i.e. a prefix of some patterns.
+  struct Node {
+    Node();
+    Node(Node&& other);
+    ~Node();
+    Node& operator=(Node&& other);
+
+    // The states reached by appending a character to this prefix.
+    base::flat_map<char, size_t> children;
+    // The state of the longest proper suffix of this prefix.
+    size_t failure;
+    // The state of the longest proper suffix of this prefix which is a
+    // pattern, or the root if there is none.
+    size_t output;
+    // The index in |replacements_| of the pattern equal to this prefix, or
+    // kNoPattern.
+    size_t pattern;
+    // The length of this prefix.
+    size_t depth;
+  };
+
+  // Returns the state reached from |state| by reading |c|.
+  size_t Next(size_t state, char c) const;
+
+  std::vector<Node> nodes_;
+  std::vector<std::string> replacements_;
+
+  DISALLOW_COPY_AND_ASSIGN(MultiStringReplacer);
+};
+
+}  // namespace reading_list
+
+#endif  // IOS_CHROME_BROWSER_READING_LIST_MULTI_STRING_REPLACER_H_
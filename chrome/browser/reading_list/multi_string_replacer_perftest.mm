@@ -0,0 +1,103 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/chrome/browser/reading_list/multi_string_replacer.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/hash/md5.h"
+#include "base/strings/stringprintf.h"
+#include "base/timer/elapsed_timer.h"
+#include "ios/chrome/test/base/perf_test_ios.h"
+#include "net/base/escape.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Number of images in the synthetic article.
+const int kImageCount = 500;
+
+// Size of the synthetic article, as for a large distilled page.
+const size_t kArticleSize = 5 * 1024 * 1024;
+
+const char kParagraph[] =
+    "<p>Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do "
+    "eiusmod tempor incididunt ut labore et dolore magna aliqua. Ut enim ad "
+    "minim veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip "
+    "ex ea commodo consequat. See https://www.example.com/about.</p>";
+
+class MultiStringReplacerPerfTest : public PerfTest {
+ protected:
+  MultiStringReplacerPerfTest() : PerfTest("Reading list image rewriting") {
+    // Builds an article with |kImageCount| images spread among paragraphs,
+    // and the replacements of the escaped image URLs by their local names as
+    // done by URLDownloader.
+    size_t text_size_per_image = kArticleSize / kImageCount;
+    for (int i = 0; i < kImageCount; ++i) {
+      std::string image_url = net::EscapeForHTML(base::StringPrintf(
+          "https://www.example.com/images/%d/photo.jpg?w=800&h=600", i));
+      replacements_.emplace_back(image_url, base::MD5String(image_url));
+      size_t image_start = html_.size();
+      html_ += base::StringPrintf("<figure><img src=\"%s\"></figure>",
+                                  image_url.c_str());
+      while (html_.size() - image_start < text_size_per_image)
+        html_ += kParagraph;
+    }
+  }
+
+  std::string html_;
+  std::vector<std::pair<std::string, std::string>> replacements_;
+};
+
+// Tests rewriting the image URLs of the article in a single pass.
+TEST_F(MultiStringReplacerPerfTest, SinglePass) {
+  const std::string& html = html_;
+  const std::vector<std::pair<std::string, std::string>>& replacements =
+      replacements_;
+  __block std::string output;
+  RepeatTimedRuns("Single pass, 5 MB, 500 images",
+                  ^base::TimeDelta(int) {
+                    base::ElapsedTimer timer;
+                    reading_list::MultiStringReplacer replacer(replacements);
+                    output.clear();
+                    output.reserve(html.size());
+                    replacer.Replace(html, &output);
+                    return timer.Elapsed();
+                  },
+                  nil);
+  EXPECT_EQ(std::string::npos, output.find("photo.jpg"));
+}
+
+// Tests rewriting the image URLs of the article with a find and replace pass
+// per image, as a baseline.
+TEST_F(MultiStringReplacerPerfTest, PassPerImage) {
+  const std::string& html = html_;
+  const std::vector<std::pair<std::string, std::string>>& replacements =
+      replacements_;
+  __block std::string output;
+  RepeatTimedRuns("Pass per image, 5 MB, 500 images",
+                  ^base::TimeDelta(int) {
+                    base::ElapsedTimer timer;
+                    output = html;
+                    for (const auto& replacement : replacements) {
+                      size_t pos = output.find(replacement.first);
+                      while (pos != std::string::npos) {
+                        output.replace(pos, replacement.first.size(),
+                                       replacement.second);
+                        pos = output.find(replacement.first,
+                                          pos + replacement.second.size());
+                      }
+                    }
+                    return timer.Elapsed();
+                  },
+                  nil);
+  EXPECT_EQ(std::string::npos, output.find("photo.jpg"));
+}
+
+}  // namespace
@@ -0,0 +1,73 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/chrome/browser/reading_list/multi_string_replacer.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/platform_test.h"
+
+namespace reading_list {
+
+namespace {
+// Returns |text| with the patterns of |replacements| replaced, and sets
+// |replaced| to whether any was replaced.
+std::string Replace(
+    const std::vector<std::pair<std::string, std::string>>& replacements,
+    const std::string& text,
+    bool* replaced) {
+  MultiStringReplacer replacer(replacements);
+  std::string output;
+  *replaced = replacer.Replace(text, &output);
+  return output;
+}
+}  // namespace
+
+using MultiStringReplacerTest = PlatformTest;
+
+// Tests that all the occurrences of all the patterns are replaced.
+TEST_F(MultiStringReplacerTest, ReplacesAllOccurrences) {
+  bool replaced = false;
+  EXPECT_EQ("<img src=\"A\"><img src=\"B\"><img src=\"A\">",
+            Replace({{"http://a.png", "A"}, {"http://b.png", "B"}},
+                    "<img src=\"http://a.png\"><img src=\"http://b.png\">"
+                    "<img src=\"http://a.png\">",
+                    &replaced));
+  EXPECT_TRUE(replaced);
+}
+
+// Tests that the text is unchanged if no pattern is found.
+TEST_F(MultiStringReplacerTest, NoOccurrence) {
+  bool replaced = true;
+  EXPECT_EQ("<img src=\"http://c.png\">",
+            Replace({{"http://a.png", "A"}, {"", "B"}},
+                    "<img src=\"http://c.png\">", &replaced));
+  EXPECT_FALSE(replaced);
+  EXPECT_EQ("text", Replace({}, "text", &replaced));
+  EXPECT_FALSE(replaced);
+}
+
+// Tests that overlapping occurrences are replaced leftmost first, then
+// longest first, and that the replacements are not scanned for patterns.
+TEST_F(MultiStringReplacerTest, OverlappingOccurrences) {
+  bool replaced = false;
+  EXPECT_EQ("XZe Y",
+            Replace({{"ab", "X"}, {"abcd", "Y"}, {"c", "Z"}}, "abce abcd",
+                    &replaced));
+  EXPECT_EQ("Ba", Replace({{"bc", "a"}, {"abc", "B"}}, "abca", &replaced));
+  EXPECT_EQ("ab", Replace({{"a", "ab"}, {"b", "c"}}, "a", &replaced));
+  EXPECT_TRUE(replaced);
+}
+
+// Tests that a pattern present several times keeps its first replacement.
+TEST_F(MultiStringReplacerTest, DuplicatePattern) {
+  bool replaced = false;
+  EXPECT_EQ("A.A", Replace({{"a", "A"}, {"a", "B"}}, "a.a", &replaced));
+  EXPECT_TRUE(replaced);
+}
+
+}  // namespace reading_list
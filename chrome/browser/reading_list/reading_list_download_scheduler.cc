@@ -0,0 +1,223 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/chrome/browser/reading_list/reading_list_download_scheduler.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/metrics/histogram_macros.h"
+#include "base/stl_util.h"
+#include "net/base/backoff_entry.h"
+
+namespace reading_list {
+
+namespace {
+// Maximum number of downloads from the same host running at the same time.
+const size_t kMaxDownloadsPerHost = 2;
+
+// Backoff of the hosts whose downloads fail.
+const net::BackoffEntry::Policy kHostBackoffPolicy = {
+    0,               // num_errors_to_ignore
+    2 * 1000,        // initial_delay_ms
+    2.0,             // multiply_factor
+    0.1,             // jitter_factor
+    10 * 60 * 1000,  // maximum_backoff_ms
+    -1,              // entry_lifetime_ms
+    false            // always_use_initial_delay
+};
+}  // namespace
+
+ReadingListDownloadScheduler::Queue::Queue() = default;
+
+ReadingListDownloadScheduler::Queue::~Queue() = default;
+
+ReadingListDownloadScheduler::ReadingListDownloadScheduler(
+    size_t concurrency_limit,
+    const StartDownloadCallback& start_download)
+    : concurrency_limit_(concurrency_limit), start_download_(start_download) {
+  DCHECK_GT(concurrency_limit_, 0u);
+}
+
+ReadingListDownloadScheduler::~ReadingListDownloadScheduler() = default;
+
+void ReadingListDownloadScheduler::SetConcurrencyLimit(
+    size_t concurrency_limit) {
+  DCHECK_GT(concurrency_limit, 0u);
+  concurrency_limit_ = concurrency_limit;
+  StartDownloads();
+}
+
+void ReadingListDownloadScheduler::ScheduleDownload(const GURL& url,
+                                                    Priority priority) {
+  if (IsDownloadRunning(url))
+    return;
+  auto it = queued_downloads_.find(url);
+  if (it != queued_downloads_.end()) {
+    if (it->second.priority >= priority)
+      return;
+    RemoveFromQueue(GetQueue(it->second.priority), url);
+    it->second.priority = priority;
+  } else {
+    queued_downloads_.emplace(
+        url, QueuedDownload{priority, base::TimeTicks::Now()});
+  }
+
+  Queue* queue = GetQueue(priority);
+  base::circular_deque<GURL>& host_urls = queue->urls_by_host[url.host()];
+  if (host_urls.empty())
+    queue->hosts.push_back(url.host());
+  host_urls.push_back(url);
+
+  UMA_HISTOGRAM_COUNTS_1000("ReadingList.Download.QueueDepth",
+                            queued_downloads_.size());
+  StartDownloads();
+}
+
+void ReadingListDownloadScheduler::CancelDownload(const GURL& url) {
+  auto it = queued_downloads_.find(url);
+  if (it == queued_downloads_.end())
+    return;
+  RemoveFromQueue(GetQueue(it->second.priority), url);
+  queued_downloads_.erase(it);
+}
+
+void ReadingListDownloadScheduler::DownloadDidEnd(const GURL& url,
+                                                  bool success,
+                                                  int64_t size) {
+  RunningDownload download = RemoveRunningDownload(url);
+  base::TimeDelta duration = base::TimeTicks::Now() - download.start_time;
+  if (success) {
+    host_backoffs_.erase(download.host);
+    UMA_HISTOGRAM_MEDIUM_TIMES("ReadingList.Download.Duration", duration);
+    if (size > 0 && duration > base::TimeDelta()) {
+      UMA_HISTOGRAM_COUNTS_100000(
+          "ReadingList.Download.Throughput",
+          static_cast<int>(size / 1024 / duration.InSecondsF()));
+    }
+  } else {
+    std::unique_ptr<net::BackoffEntry>& backoff =
+        host_backoffs_[download.host];
+    if (!backoff)
+      backoff = std::make_unique<net::BackoffEntry>(&kHostBackoffPolicy);
+    backoff->InformOfRequest(false);
+  }
+  StartDownloads();
+}
+
+void ReadingListDownloadScheduler::DownloadWasCancelled(const GURL& url) {
+  RemoveRunningDownload(url);
+  StartDownloads();
+}
+
+bool ReadingListDownloadScheduler::IsDownloadQueued(const GURL& url) const {
+  return base::Contains(queued_downloads_, url);
+}
+
+bool ReadingListDownloadScheduler::IsDownloadRunning(const GURL& url) const {
+  return base::Contains(running_downloads_, url);
+}
+
+ReadingListDownloadScheduler::RunningDownload
+ReadingListDownloadScheduler::RemoveRunningDownload(const GURL& url) {
+  auto it = running_downloads_.find(url);
+  DCHECK(it != running_downloads_.end());
+  RunningDownload download = it->second;
+  running_downloads_.erase(it);
+  auto running_count = running_counts_by_host_.find(download.host);
+  if (--running_count->second == 0)
+    running_counts_by_host_.erase(running_count);
+  return download;
+}
+
+void ReadingListDownloadScheduler::StartDownloads() {
+  base::TimeTicks next_release_time = base::TimeTicks::Max();
+  while (running_downloads_.size() < concurrency_limit_) {
+    GURL url = TakeNextURL(&high_priority_queue_, &next_release_time);
+    if (url.is_empty())
+      url = TakeNextURL(&normal_priority_queue_, &next_release_time);
+    if (url.is_empty())
+      break;
+
+    base::TimeTicks now = base::TimeTicks::Now();
+    auto queued = queued_downloads_.find(url);
+    DCHECK(queued != queued_downloads_.end());
+    UMA_HISTOGRAM_MEDIUM_TIMES("ReadingList.Download.QueueTime",
+                               now - queued->second.queue_time);
+    queued_downloads_.erase(queued);
+    running_downloads_.emplace(url, RunningDownload{url.host(), now});
+    ++running_counts_by_host_[url.host()];
+    start_download_.Run(url);
+  }
+
+  // If only backed off hosts have queued downloads, try again when the first
+  // one is released.
+  if (running_downloads_.size() < concurrency_limit_ &&
+      next_release_time != base::TimeTicks::Max()) {
+    backoff_timer_.Start(FROM_HERE,
+                         next_release_time - base::TimeTicks::Now(), this,
+                         &ReadingListDownloadScheduler::StartDownloads);
+  } else {
+    backoff_timer_.Stop();
+  }
+}
+
+GURL ReadingListDownloadScheduler::TakeNextURL(
+    Queue* queue,
+    base::TimeTicks* next_release_time) {
+  for (auto host_it = queue->hosts.begin(); host_it != queue->hosts.end();
+       ++host_it) {
+    auto running = running_counts_by_host_.find(*host_it);
+    if (running != running_counts_by_host_.end() &&
+        running->second >= kMaxDownloadsPerHost) {
+      continue;
+    }
+    auto backoff = host_backoffs_.find(*host_it);
+    if (backoff != host_backoffs_.end() &&
+        backoff->second->ShouldRejectRequest()) {
+      *next_release_time =
+          std::min(*next_release_time, backoff->second->GetReleaseTime());
+      continue;
+    }
+
+    // Take the first URL of the host, and move the host at the end of the
+    // queue so that the other hosts go first next time.
+    std::string host = *host_it;
+    queue->hosts.erase(host_it);
+    auto host_urls = queue->urls_by_host.find(host);
+    GURL url = host_urls->second.front();
+    host_urls->second.pop_front();
+    if (host_urls->second.empty()) {
+      queue->urls_by_host.erase(host_urls);
+    } else {
+      queue->hosts.push_back(host);
+    }
+    return url;
+  }
+  return GURL();
+}
+
+// static
+void ReadingListDownloadScheduler::RemoveFromQueue(Queue* queue,
+                                                   const GURL& url) {
+  auto host_urls = queue->urls_by_host.find(url.host());
+  if (host_urls == queue->urls_by_host.end())
+    return;
+  host_urls->second.erase(
+      std::remove(host_urls->second.begin(), host_urls->second.end(), url),
+      host_urls->second.end());
+  if (host_urls->second.empty()) {
+    queue->urls_by_host.erase(host_urls);
+    queue->hosts.erase(
+        std::find(queue->hosts.begin(), queue->hosts.end(), url.host()));
+  }
+}
+
+ReadingListDownloadScheduler::Queue* ReadingListDownloadScheduler::GetQueue(
+    Priority priority) {
+  return priority == PRIORITY_HIGH ? &high_priority_queue_
+                                   : &normal_priority_queue_;
+}
+
+}  // namespace reading_list
@@ -0,0 +1,143 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_CHROME_BROWSER_READING_LIST_READING_LIST_DOWNLOAD_SCHEDULER_H_
+#define IOS_CHROME_BROWSER_READING_LIST_READING_LIST_DOWNLOAD_SCHEDULER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "base/callback.h"
+#include "base/containers/circular_deque.h"
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+#include "url/gurl.h"
+
+namespace net {
+class BackoffEntry;
+}
+
+namespace reading_list {
+
+// Decides when the offline versions of the reading list entries are
+// downloaded. Runs up to |concurrency_limit()| downloads at a time, takes the
+// high priority downloads first, and alternates between the hosts of the
+// downloads of the same priority so that a host with many entries does not
+// delay the others. Once a download from a host fails, the next downloads
+// from this host are delayed with an exponential backoff until one succeeds.
+class ReadingListDownloadScheduler {
+ public:
+  // The priorities of the downloads.
+  enum Priority {
+    // Entries synced from other devices or retried after a failure.
+    PRIORITY_NORMAL,
+    // Entries recently added or marked unread by the user.
+    PRIORITY_HIGH,
+  };
+
+  // Callback starting the download of a URL. The scheduler must be told when
+  // the download ends with DownloadDidEnd().
+  using StartDownloadCallback = base::RepeatingCallback<void(const GURL&)>;
+
+  ReadingListDownloadScheduler(size_t concurrency_limit,
+                               const StartDownloadCallback& start_download);
+  ~ReadingListDownloadScheduler();
+
+  // Sets the maximum number of downloads running at the same time. Running
+  // downloads are not interrupted when the limit shrinks.
+  void SetConcurrencyLimit(size_t concurrency_limit);
+  size_t concurrency_limit() const { return concurrency_limit_; }
+
+  // Queues the download of |url| with |priority|. If |url| is already queued,
+  // it is moved to the queue of |priority| if that is higher. Does nothing if
+  // the download of |url| is running.
+  void ScheduleDownload(const GURL& url, Priority priority);
+
+  // Removes |url| from the queue. Does not interrupt a running download.
+  void CancelDownload(const GURL& url);
+
+  // Tells that the download of |url| started by the scheduler ended, with
+  // |size| bytes saved if |success|.
+  void DownloadDidEnd(const GURL& url, bool success, int64_t size);
+
+  // Tells that the download of |url| started by the scheduler was cancelled
+  // before it ended.
+  void DownloadWasCancelled(const GURL& url);
+
+  // Returns whether the download of |url| is queued or running.
+  bool IsDownloadQueued(const GURL& url) const;
+  bool IsDownloadRunning(const GURL& url) const;
+
+  // Returns the number of queued and running downloads.
+  size_t queued_count() const { return queued_downloads_.size(); }
+  size_t running_count() const { return running_downloads_.size(); }
+
+ private:
+  // The URLs of a priority, in per host queues visited in turn.
+  struct Queue {
+    Queue();
+    ~Queue();
+
+    std::map<std::string, base::circular_deque<GURL>> urls_by_host;
+    // The hosts of |urls_by_host|, the next one to visit first.
+    base::circular_deque<std::string> hosts;
+  };
+
+  // A queued download.
+  struct QueuedDownload {
+    Priority priority;
+    base::TimeTicks queue_time;
+  };
+
+  // A running download.
+  struct RunningDownload {
+    std::string host;
+    base::TimeTicks start_time;
+  };
+
+  // Removes |url| from the running downloads and returns it.
+  RunningDownload RemoveRunningDownload(const GURL& url);
+
+  // Starts queued downloads until the concurrency limit is reached or all the
+  // hosts with queued downloads are busy or backed off.
+  void StartDownloads();
+
+  // Removes from |queue| and returns the next URL whose host can start a
+  // download, or an empty URL if there is none. Sets |next_release_time| to
+  // the earliest time a backed off host of |queue| can start a download, if it
+  // is before it.
+  GURL TakeNextURL(Queue* queue, base::TimeTicks* next_release_time);
+
+  // Removes |url| from |queue|.
+  static void RemoveFromQueue(Queue* queue, const GURL& url);
+
+  // Returns the queue of |priority|.
+  Queue* GetQueue(Priority priority);
+
+  size_t concurrency_limit_;
+  const StartDownloadCallback start_download_;
+
+  Queue normal_priority_queue_;
+  Queue high_priority_queue_;
+  std::map<GURL, QueuedDownload> queued_downloads_;
+
+  std::map<GURL, RunningDownload> running_downloads_;
+  // The number of running downloads of each host.
+  std::map<std::string, size_t> running_counts_by_host_;
+  // The backoff of the hosts whose last download failed.
+  std::map<std::string, std::unique_ptr<net::BackoffEntry>> host_backoffs_;
+  // Restarts the downloads when the first backed off host is released.
+  base::OneShotTimer backoff_timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadingListDownloadScheduler);
+};
+
+}  // namespace reading_list
+
+#endif  // IOS_CHROME_BROWSER_READING_LIST_READING_LIST_DOWNLOAD_SCHEDULER_H_
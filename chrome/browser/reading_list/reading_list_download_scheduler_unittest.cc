@@ -0,0 +1,145 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/chrome/browser/reading_list/reading_list_download_scheduler.h"
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/test/task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/platform_test.h"
+#include "url/gurl.h"
+
+namespace reading_list {
+
+class ReadingListDownloadSchedulerTest : public PlatformTest {
+ protected:
+  ReadingListDownloadSchedulerTest()
+      : scheduler_(2,
+                   base::BindRepeating(
+                       &ReadingListDownloadSchedulerTest::StartDownload,
+                       base::Unretained(this))) {}
+
+  void StartDownload(const GURL& url) { started_urls_.push_back(url); }
+
+  base::test::TaskEnvironment task_environment_{
+      base::test::TaskEnvironment::TimeSource::MOCK_TIME};
+  std::vector<GURL> started_urls_;
+  ReadingListDownloadScheduler scheduler_;
+};
+
+// Tests that no more downloads than the concurrency limit run at a time.
+TEST_F(ReadingListDownloadSchedulerTest, ConcurrencyLimit) {
+  GURL url_a("http://a.com/");
+  GURL url_b("http://b.com/");
+  GURL url_c("http://c.com/");
+  scheduler_.ScheduleDownload(url_a,
+                              ReadingListDownloadScheduler::PRIORITY_NORMAL);
+  scheduler_.ScheduleDownload(url_b,
+                              ReadingListDownloadScheduler::PRIORITY_NORMAL);
+  scheduler_.ScheduleDownload(url_c,
+                              ReadingListDownloadScheduler::PRIORITY_NORMAL);
+  EXPECT_EQ(std::vector<GURL>({url_a, url_b}), started_urls_);
+  EXPECT_EQ(2u, scheduler_.running_count());
+  EXPECT_EQ(1u, scheduler_.queued_count());
+
+  // Shrinking the limit does not interrupt the running downloads, but delays
+  // the next one.
+  scheduler_.SetConcurrencyLimit(1);
+  scheduler_.DownloadDidEnd(url_a, true, 1024);
+  EXPECT_EQ(2u, started_urls_.size());
+  scheduler_.DownloadDidEnd(url_b, true, 1024);
+  EXPECT_EQ(std::vector<GURL>({url_a, url_b, url_c}), started_urls_);
+  EXPECT_TRUE(scheduler_.IsDownloadRunning(url_c));
+  EXPECT_EQ(0u, scheduler_.queued_count());
+}
+
+// Tests that the high priority downloads start first, and that a queued
+// download can be raised to high priority.
+TEST_F(ReadingListDownloadSchedulerTest, Priorities) {
+  scheduler_.SetConcurrencyLimit(1);
+  GURL url_a("http://a.com/");
+  GURL url_b("http://b.com/");
+  GURL url_c("http://c.com/");
+  GURL url_d("http://d.com/");
+  scheduler_.ScheduleDownload(url_a,
+                              ReadingListDownloadScheduler::PRIORITY_NORMAL);
+  scheduler_.ScheduleDownload(url_b,
+                              ReadingListDownloadScheduler::PRIORITY_NORMAL);
+  scheduler_.ScheduleDownload(url_c,
+                              ReadingListDownloadScheduler::PRIORITY_NORMAL);
+  scheduler_.ScheduleDownload(url_d,
+                              ReadingListDownloadScheduler::PRIORITY_HIGH);
+  scheduler_.ScheduleDownload(url_c,
+                              ReadingListDownloadScheduler::PRIORITY_HIGH);
+  scheduler_.DownloadDidEnd(url_a, true, 0);
+  scheduler_.DownloadDidEnd(url_d, true, 0);
+  scheduler_.DownloadDidEnd(url_c, true, 0);
+  EXPECT_EQ(std::vector<GURL>({url_a, url_d, url_c, url_b}), started_urls_);
+}
+
+// Tests that the downloads alternate between hosts.
+TEST_F(ReadingListDownloadSchedulerTest, HostFairness) {
+  scheduler_.SetConcurrencyLimit(1);
+  GURL url_a1("http://a.com/1");
+  GURL url_a2("http://a.com/2");
+  GURL url_a3("http://a.com/3");
+  GURL url_b("http://b.com/");
+  scheduler_.ScheduleDownload(url_a1,
+                              ReadingListDownloadScheduler::PRIORITY_NORMAL);
+  scheduler_.ScheduleDownload(url_a2,
+                              ReadingListDownloadScheduler::PRIORITY_NORMAL);
+  scheduler_.ScheduleDownload(url_a3,
+                              ReadingListDownloadScheduler::PRIORITY_NORMAL);
+  scheduler_.ScheduleDownload(url_b,
+                              ReadingListDownloadScheduler::PRIORITY_NORMAL);
+  scheduler_.DownloadDidEnd(url_a1, true, 0);
+  scheduler_.DownloadDidEnd(url_a2, true, 0);
+  scheduler_.DownloadDidEnd(url_b, true, 0);
+  EXPECT_EQ(std::vector<GURL>({url_a1, url_a2, url_b, url_a3}), started_urls_);
+}
+
+// Tests that the downloads from a host are delayed after a failure, without
+// delaying the other hosts.
+TEST_F(ReadingListDownloadSchedulerTest, HostBackoff) {
+  scheduler_.SetConcurrencyLimit(1);
+  GURL url_a1("http://a.com/1");
+  GURL url_a2("http://a.com/2");
+  GURL url_b("http://b.com/");
+  scheduler_.ScheduleDownload(url_a1,
+                              ReadingListDownloadScheduler::PRIORITY_NORMAL);
+  scheduler_.ScheduleDownload(url_a2,
+                              ReadingListDownloadScheduler::PRIORITY_NORMAL);
+  scheduler_.DownloadDidEnd(url_a1, false, 0);
+  EXPECT_EQ(std::vector<GURL>({url_a1}), started_urls_);
+
+  scheduler_.ScheduleDownload(url_b,
+                              ReadingListDownloadScheduler::PRIORITY_NORMAL);
+  EXPECT_EQ(std::vector<GURL>({url_a1, url_b}), started_urls_);
+  scheduler_.DownloadDidEnd(url_b, true, 0);
+  EXPECT_EQ(2u, started_urls_.size());
+
+  task_environment_.FastForwardBy(base::TimeDelta::FromSeconds(2));
+  EXPECT_EQ(std::vector<GURL>({url_a1, url_b, url_a2}), started_urls_);
+}
+
+// Tests that cancelled downloads do not start.
+TEST_F(ReadingListDownloadSchedulerTest, CancelDownload) {
+  scheduler_.SetConcurrencyLimit(1);
+  GURL url_a("http://a.com/");
+  GURL url_b("http://b.com/");
+  scheduler_.ScheduleDownload(url_a,
+                              ReadingListDownloadScheduler::PRIORITY_NORMAL);
+  scheduler_.ScheduleDownload(url_b,
+                              ReadingListDownloadScheduler::PRIORITY_NORMAL);
+  EXPECT_TRUE(scheduler_.IsDownloadQueued(url_b));
+  scheduler_.CancelDownload(url_b);
+  EXPECT_FALSE(scheduler_.IsDownloadQueued(url_b));
+  scheduler_.DownloadWasCancelled(url_a);
+  EXPECT_EQ(std::vector<GURL>({url_a}), started_urls_);
+  EXPECT_EQ(0u, scheduler_.running_count());
+}
+
+}  // namespace reading_list
@@ -4,6 +4,7 @@
 
 #include "ios/chrome/browser/reading_list/reading_list_download_service.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 
@@ -12,6 +13,7 @@
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/stl_util.h"
 #include "base/strings/string_util.h"
 #include "base/task/post_task.h"
 #include "components/reading_list/core/offline_url_utils.h"
@@ -43,6 +45,12 @@ const int kNumberOfFailsBeforeWifiOnly = 5;
 // it.
 const int kNumberOfFailsBeforeStop = 7;
 
+// Maximum number of downloads running at the same time on wifi or ethernet.
+const size_t kMaxConcurrentDownloads = 4;
+// Maximum number of downloads running at the same time on other connections,
+// e.g. cellular.
+const size_t kMaxConcurrentDownloadsCellular = 1;
+
 // Scans |root| directory and deletes all subdirectories not listed
 // in |directories_to_keep|.
 // Must be called on File thread.
@@ -71,23 +79,30 @@ ReadingListDownloadService::ReadingListDownloadService(
         distiller_page_factory)
     : reading_list_model_(reading_list_model),
       chrome_profile_path_(chrome_profile_path),
+      prefs_(prefs),
+      url_loader_factory_(std::move(url_loader_factory)),
+      download_scheduler_(
+          kMaxConcurrentDownloadsCellular,
+          base::BindRepeating(&ReadingListDownloadService::StartDownload,
+                              base::Unretained(this))),
       had_connection_(!net::NetworkChangeNotifier::IsOffline()),
       distiller_page_factory_(std::move(distiller_page_factory)),
       distiller_factory_(std::move(distiller_factory)),
       weak_ptr_factory_(this) {
   DCHECK(reading_list_model);
 
-  url_downloader_ = std::make_unique<URLDownloader>(
-      distiller_factory_.get(), distiller_page_factory_.get(), prefs,
-      chrome_profile_path, url_loader_factory,
-      base::Bind(&ReadingListDownloadService::OnDownloadEnd,
-                 base::Unretained(this)),
-      base::Bind(&ReadingListDownloadService::OnDeleteEnd,
-                 base::Unretained(this)));
-
-  GetApplicationContext()
-      ->GetNetworkConnectionTracker()
-      ->AddNetworkConnectionObserver(this);
+  network::NetworkConnectionTracker* network_connection_tracker =
+      GetApplicationContext()->GetNetworkConnectionTracker();
+  network_connection_tracker->AddNetworkConnectionObserver(this);
+  // Sets the concurrency limit from the connection type, now if it is known,
+  // else when it is.
+  auto connection_type = network::mojom::ConnectionType::CONNECTION_UNKNOWN;
+  if (network_connection_tracker->GetConnectionType(
+          &connection_type,
+          base::BindOnce(&ReadingListDownloadService::OnConnectionChanged,
+                         weak_ptr_factory_.GetWeakPtr()))) {
+    OnConnectionChanged(connection_type);
+  }
 }
 
 ReadingListDownloadService::~ReadingListDownloadService() {
@@ -127,26 +142,30 @@ void ReadingListDownloadService::ReadingListDidAddEntry(
     const GURL& url,
     reading_list::EntrySource source) {
   DCHECK_EQ(reading_list_model_, model);
-  ProcessNewEntry(url);
+  ProcessNewEntry(url,
+                  reading_list::ReadingListDownloadScheduler::PRIORITY_HIGH);
 }
 
 void ReadingListDownloadService::ReadingListDidMoveEntry(
     const ReadingListModel* model,
     const GURL& url) {
   DCHECK_EQ(reading_list_model_, model);
-  ProcessNewEntry(url);
+  ProcessNewEntry(url,
+                  reading_list::ReadingListDownloadScheduler::PRIORITY_HIGH);
 }
 
 void ReadingListDownloadService::Clear() {
   distiller_page_factory_->ReleaseAllRetainedWebState();
 }
 
-void ReadingListDownloadService::ProcessNewEntry(const GURL& url) {
+void ReadingListDownloadService::ProcessNewEntry(
+    const GURL& url,
+    reading_list::ReadingListDownloadScheduler::Priority priority) {
   const ReadingListEntry* entry = reading_list_model_->GetEntryByURL(url);
   if (!entry || entry->IsRead()) {
-    url_downloader_->CancelDownloadOfflineURL(url);
+    download_scheduler_.CancelDownload(url);
   } else {
-    ScheduleDownloadEntry(url);
+    ScheduleDownloadEntry(url, priority);
   }
 }
 
@@ -181,11 +200,14 @@ void ReadingListDownloadService::SyncWithModel() {
 void ReadingListDownloadService::DownloadUnprocessedEntries(
     const std::set<GURL>& unprocessed_entries) {
   for (const GURL& url : unprocessed_entries) {
-    this->ScheduleDownloadEntry(url);
+    this->ScheduleDownloadEntry(
+        url, reading_list::ReadingListDownloadScheduler::PRIORITY_NORMAL);
   }
 }
 
-void ReadingListDownloadService::ScheduleDownloadEntry(const GURL& url) {
+void ReadingListDownloadService::ScheduleDownloadEntry(
+    const GURL& url,
+    reading_list::ReadingListDownloadScheduler::Priority priority) {
   DCHECK(reading_list_model_->loaded());
   const ReadingListEntry* entry = reading_list_model_->GetEntryByURL(url);
   if (!entry ||
@@ -196,11 +218,13 @@ void ReadingListDownloadService::ScheduleDownloadEntry(const GURL& url) {
   base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
       FROM_HERE,
       base::BindOnce(&ReadingListDownloadService::DownloadEntry,
-                     weak_ptr_factory_.GetWeakPtr(), local_url),
+                     weak_ptr_factory_.GetWeakPtr(), local_url, priority),
       entry->TimeUntilNextTry());
 }
 
-void ReadingListDownloadService::DownloadEntry(const GURL& url) {
+void ReadingListDownloadService::DownloadEntry(
+    const GURL& url,
+    reading_list::ReadingListDownloadScheduler::Priority priority) {
   DCHECK(reading_list_model_->loaded());
   const ReadingListEntry* entry = reading_list_model_->GetEntryByURL(url);
   if (!entry ||
@@ -223,7 +247,7 @@ void ReadingListDownloadService::DownloadEntry(const GURL& url) {
     // Try to download the page, whatever the connection.
     reading_list_model_->SetEntryDistilledState(entry->URL(),
                                                 ReadingListEntry::PROCESSING);
-    url_downloader_->DownloadOfflineURL(entry->URL());
+    download_scheduler_.ScheduleDownload(entry->URL(), priority);
 
   } else if (entry->FailedDownloadCounter() < kNumberOfFailsBeforeStop) {
     // Try to download the page only if the connection is wifi.
@@ -239,7 +263,7 @@ void ReadingListDownloadService::DownloadEntry(const GURL& url) {
       // The connection is wifi, download the page.
       reading_list_model_->SetEntryDistilledState(entry->URL(),
                                                   ReadingListEntry::PROCESSING);
-      url_downloader_->DownloadOfflineURL(entry->URL());
+      download_scheduler_.ScheduleDownload(entry->URL(), priority);
 
     } else {
       // The connection is not wifi, save it for download when the connection
@@ -251,7 +275,59 @@ void ReadingListDownloadService::DownloadEntry(const GURL& url) {
 
 void ReadingListDownloadService::RemoveDownloadedEntry(const GURL& url) {
   DCHECK(reading_list_model_->loaded());
-  url_downloader_->RemoveOfflineURL(url);
+  download_scheduler_.CancelDownload(url);
+  if (downloads_waiting_for_deletion_.erase(url))
+    download_scheduler_.DownloadWasCancelled(url);
+
+  if (base::Contains(running_downloaders_, url)) {
+    // The download cannot be interrupted, delete its result once it ends.
+    deletions_waiting_for_download_.insert(url);
+    return;
+  }
+  DeleteOfflineURL(url);
+}
+
+void ReadingListDownloadService::DeleteOfflineURL(const GURL& url) {
+  if (!url_deleter_)
+    url_deleter_ = CreateURLDownloader();
+  ++pending_deletions_[url];
+  url_deleter_->RemoveOfflineURL(url);
+}
+
+void ReadingListDownloadService::StartDownload(const GURL& url) {
+  if (base::Contains(pending_deletions_, url)) {
+    // Download once the previous offline version is deleted.
+    downloads_waiting_for_deletion_.insert(url);
+    return;
+  }
+  URLDownloader* url_downloader = GetIdleURLDownloader();
+  running_downloaders_[url] = url_downloader;
+  url_downloader->DownloadOfflineURL(url);
+}
+
+std::unique_ptr<URLDownloader>
+ReadingListDownloadService::CreateURLDownloader() {
+  return std::make_unique<URLDownloader>(
+      distiller_factory_.get(), distiller_page_factory_.get(), prefs_,
+      chrome_profile_path_, url_loader_factory_,
+      base::Bind(&ReadingListDownloadService::OnDownloadEnd,
+                 base::Unretained(this)),
+      base::Bind(&ReadingListDownloadService::OnDeleteEnd,
+                 base::Unretained(this)));
+}
+
+URLDownloader* ReadingListDownloadService::GetIdleURLDownloader() {
+  for (const auto& url_downloader : url_downloaders_) {
+    bool running = std::any_of(
+        running_downloaders_.begin(), running_downloaders_.end(),
+        [&url_downloader](const std::pair<const GURL, URLDownloader*>& pair) {
+          return pair.second == url_downloader.get();
+        });
+    if (!running)
+      return url_downloader.get();
+  }
+  url_downloaders_.push_back(CreateURLDownloader());
+  return url_downloaders_.back().get();
 }
 
 void ReadingListDownloadService::OnDownloadEnd(
@@ -262,6 +338,7 @@ void ReadingListDownloadService::OnDownloadEnd(
     int64_t size,
     const std::string& title) {
   DCHECK(reading_list_model_->loaded());
+  running_downloaders_.erase(url);
   URLDownloader::SuccessState real_success_value = success;
   if (distilled_path.empty()) {
     real_success_value = URLDownloader::ERROR;
@@ -291,7 +368,8 @@ void ReadingListDownloadService::OnDownloadEnd(
           entry->FailedDownloadCounter() + 1 < kNumberOfFailsBeforeStop) {
         reading_list_model_->SetEntryDistilledState(
             url, ReadingListEntry::WILL_RETRY);
-        ScheduleDownloadEntry(url);
+        ScheduleDownloadEntry(
+            url, reading_list::ReadingListDownloadScheduler::PRIORITY_NORMAL);
         UMA_HISTOGRAM_ENUMERATION("ReadingList.Download.Status", RETRY,
                                   STATUS_MAX);
       } else {
@@ -303,10 +381,22 @@ void ReadingListDownloadService::OnDownloadEnd(
       break;
     }
   }
+  download_scheduler_.DownloadDidEnd(
+      url, real_success_value != URLDownloader::ERROR, size);
+  if (deletions_waiting_for_download_.erase(url))
+    DeleteOfflineURL(url);
 }
 
 void ReadingListDownloadService::OnDeleteEnd(const GURL& url, bool success) {
-  // Nothing to update as this is only called when deleting reading list entries
+  // Nothing to update as this is only called when deleting reading list
+  // entries, but a download of |url| may wait for the deletion.
+  auto pending_deletion = pending_deletions_.find(url);
+  DCHECK(pending_deletion != pending_deletions_.end());
+  if (--pending_deletion->second > 0)
+    return;
+  pending_deletions_.erase(pending_deletion);
+  if (downloads_waiting_for_deletion_.erase(url))
+    StartDownload(url);
 }
 
 void ReadingListDownloadService::OnConnectionChanged(
@@ -316,15 +406,24 @@ void ReadingListDownloadService::OnConnectionChanged(
     return;
   }
 
+  // Runs fewer downloads at the same time on cellular connections.
+  bool is_unmetered =
+      type == network::mojom::ConnectionType::CONNECTION_WIFI ||
+      type == network::mojom::ConnectionType::CONNECTION_ETHERNET;
+  download_scheduler_.SetConcurrencyLimit(
+      is_unmetered ? kMaxConcurrentDownloads : kMaxConcurrentDownloadsCellular);
+
   if (!had_connection_) {
     had_connection_ = true;
     for (auto& url : url_to_download_cellular_) {
-      ScheduleDownloadEntry(url);
+      ScheduleDownloadEntry(
+          url, reading_list::ReadingListDownloadScheduler::PRIORITY_NORMAL);
     }
   }
   if (type == network::mojom::ConnectionType::CONNECTION_WIFI) {
     for (auto& url : url_to_download_wifi_) {
-      ScheduleDownloadEntry(url);
+      ScheduleDownloadEntry(
+          url, reading_list::ReadingListDownloadScheduler::PRIORITY_NORMAL);
     }
   }
 }
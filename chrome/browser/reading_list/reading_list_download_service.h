@@ -5,9 +5,15 @@
 #ifndef IOS_CHROME_BROWSER_READING_LIST_READING_LIST_DOWNLOAD_SERVICE_H_
 #define IOS_CHROME_BROWSER_READING_LIST_READING_LIST_DOWNLOAD_SERVICE_H_
 
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
 #include "base/macros.h"
 #include "components/keyed_service/core/keyed_service.h"
 #include "components/reading_list/core/reading_list_model_observer.h"
+#include "ios/chrome/browser/reading_list/reading_list_download_scheduler.h"
 #include "ios/chrome/browser/reading_list/url_downloader.h"
 #include "services/network/public/cpp/network_connection_tracker.h"
 
@@ -26,6 +32,10 @@ class ReadingListDistillerPageFactory;
 // Any calls made to DownloadEntry before the model is loaded will be ignored.
 // When the model is loaded, offline directory is automatically synced with the
 // entries in the model.
+// The downloads are scheduled by a ReadingListDownloadScheduler and run by a
+// pool of URLDownloaders, one per concurrent download. The deletions run on
+// another URLDownloader, and never at the same time as a download of the same
+// URL.
 class ReadingListDownloadService
     : public KeyedService,
       public ReadingListModelObserver,
@@ -72,15 +82,24 @@ class ReadingListDownloadService
   void SyncWithModel();
   // Schedules all entries in |unprocessed_entries| for distillation.
   void DownloadUnprocessedEntries(const std::set<GURL>& unprocessed_entries);
-  // Processes a new entry and schedules a download if needed.
-  void ProcessNewEntry(const GURL& url);
+  // Processes a new entry and schedules a download with |priority| if needed.
+  void ProcessNewEntry(const GURL& url,
+                       reading_list::ReadingListDownloadScheduler::Priority
+                           priority);
   // Schedules a download of an offline version of the reading list entry,
   // according to the delay of the entry. Must only be called after reading list
   // model is loaded.
-  void ScheduleDownloadEntry(const GURL& url);
+  void ScheduleDownloadEntry(
+      const GURL& url,
+      reading_list::ReadingListDownloadScheduler::Priority priority);
   // Tries to save an offline version of the reading list entry if it is not yet
   // saved. Must only be called after reading list model is loaded.
-  void DownloadEntry(const GURL& url);
+  void DownloadEntry(
+      const GURL& url,
+      reading_list::ReadingListDownloadScheduler::Priority priority);
+  // Starts the download of |url| on an idle URLDownloader. Called by
+  // |download_scheduler_|.
+  void StartDownload(const GURL& url);
   // Removes the offline version of the reading list entry if it exists. Must
   // only be called after reading list model is loaded.
   void RemoveDownloadedEntry(const GURL& url);
@@ -95,12 +114,33 @@ class ReadingListDownloadService
   // Callback for entry deletion.
   void OnDeleteEnd(const GURL& url, bool success);
 
+  // Creates a URLDownloader reporting to this service.
+  std::unique_ptr<URLDownloader> CreateURLDownloader();
+  // Returns a URLDownloader with no download running, creating one if needed.
+  URLDownloader* GetIdleURLDownloader();
+  // Deletes the offline version of |url| on |url_deleter_|.
+  void DeleteOfflineURL(const GURL& url);
+
   // network::NetworkConnectionTracker::NetworkConnectionObserver:
   void OnConnectionChanged(network::mojom::ConnectionType type) override;
 
   ReadingListModel* reading_list_model_;
   base::FilePath chrome_profile_path_;
-  std::unique_ptr<URLDownloader> url_downloader_;
+  PrefService* prefs_;
+  scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory_;
+  reading_list::ReadingListDownloadScheduler download_scheduler_;
+  // The URLDownloaders running the downloads, one download each.
+  std::vector<std::unique_ptr<URLDownloader>> url_downloaders_;
+  // The URLDownloader running the download of each URL.
+  std::map<GURL, URLDownloader*> running_downloaders_;
+  // The URLDownloader deleting the offline versions, one at a time.
+  std::unique_ptr<URLDownloader> url_deleter_;
+  // The number of pending deletions of each URL.
+  std::map<GURL, int> pending_deletions_;
+  // The URLs whose download waits for the end of their deletion.
+  std::set<GURL> downloads_waiting_for_deletion_;
+  // The URLs whose deletion waits for the end of their download.
+  std::set<GURL> deletions_waiting_for_download_;
   std::vector<GURL> url_to_download_cellular_;
   std::vector<GURL> url_to_download_wifi_;
   bool had_connection_;
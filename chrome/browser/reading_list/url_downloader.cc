@@ -5,6 +5,7 @@
 #include "ios/chrome/browser/reading_list/url_downloader.h"
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/bind.h"
@@ -17,6 +18,7 @@
 #include "components/reading_list/core/offline_url_utils.h"
 #include "ios/chrome/browser/chrome_paths.h"
 #include "ios/chrome/browser/dom_distiller/distiller_viewer.h"
+#include "ios/chrome/browser/reading_list/multi_string_replacer.h"
 #include "ios/chrome/browser/reading_list/reading_list_distiller_page.h"
 #include "ios/chrome/browser/reading_list/reading_list_distiller_page_factory.h"
 #include "net/base/escape.h"
@@ -340,8 +342,8 @@ std::string URLDownloader::SaveAndReplaceImagesInHTML(
     const std::string& html,
     const std::vector<dom_distiller::DistillerViewerInterface::ImageInfo>&
         images) {
-  std::string mutable_html = html;
-  bool local_images_found = false;
+  std::vector<std::pair<std::string, std::string>> replacements;
+  replacements.reserve(images.size());
   for (size_t i = 0; i < images.size(); i++) {
     if (images[i].url.SchemeIs(url::kDataScheme)) {
       // Data URI, the data part of the image is empty, no need to store it.
@@ -358,16 +360,16 @@ std::string URLDownloader::SaveAndReplaceImagesInHTML(
         return std::string();
       }
     }
-    std::string image_url = net::EscapeForHTML(images[i].url.spec());
-    size_t image_url_size = image_url.size();
-    size_t pos = mutable_html.find(image_url, 0);
-    while (pos != std::string::npos) {
-      local_images_found = true;
-      mutable_html.replace(pos, image_url_size, local_image_name);
-      pos = mutable_html.find(image_url, pos + local_image_name.size());
-    }
+    replacements.emplace_back(net::EscapeForHTML(images[i].url.spec()),
+                              std::move(local_image_name));
   }
-  if (local_images_found) {
+
+  // Replace all the image URLs in a single pass over |html|.
+  reading_list::MultiStringReplacer replacer(replacements);
+  std::string mutable_html;
+  mutable_html.reserve(html.size() +
+                       base::size(kDisableImageContextMenuScript));
+  if (replacer.Replace(html, &mutable_html)) {
     mutable_html += kDisableImageContextMenuScript;
   }
 
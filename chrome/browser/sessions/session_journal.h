@@ -0,0 +1,75 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_CHROME_BROWSER_SESSIONS_SESSION_JOURNAL_H_
+#define IOS_CHROME_BROWSER_SESSIONS_SESSION_JOURNAL_H_
+
+#import <Foundation/Foundation.h>
+
+#include <stdint.h>
+
+@class SessionIOS;
+@class SessionWindowIOS;
+
+// The session file is a full snapshot of the session. Saving a session only
+// appends the sessions which changed since the previous save to a journal file
+// next to the snapshot. Once the journal grows larger than the snapshot, the
+// snapshot is rebuilt from the journal and the journal is removed.
+//
+// Each journal entry is stamped with the generation of the snapshot it
+// applies to, so that entries left behind by an interrupted compaction are
+// ignored when the session is loaded.
+
+// Key of the generation of the snapshot in the session file.
+extern NSString* const kSessionJournalGenerationKey;
+
+// Builds the records describing the changes made to a session window since
+// the last call. Must be used on the main thread.
+@interface SessionJournalRecorder : NSObject
+
+// Returns the record describing the changes from the previous session window
+// passed to this method to |sessionWindow|, or nil if nothing changed or if
+// |sessionWindow| cannot be serialized. The first record returned is full.
+// Records are immutable and may be passed to other threads.
+- (NSDictionary*)recordForSessionWindow:(SessionWindowIOS*)sessionWindow;
+
+@end
+
+// Applies the records built by a SessionJournalRecorder to the state of a
+// session and produces the data to write to disk. Must be used on the
+// sequence performing the file IO.
+@interface SessionJournal : NSObject
+
+// Returns the path of the journal of the session file at |sessionPath|.
++ (NSString*)journalPathForSessionPath:(NSString*)sessionPath;
+
+// Returns the data of the snapshot of |session| for |generation|.
++ (NSData*)snapshotDataForSession:(SessionIOS*)session
+                       generation:(uint64_t)generation;
+
+// Returns |sessionWindow| with the entries of |journalData| stamped with
+// |generation| applied. Entries after a torn or corrupted one are ignored.
++ (SessionWindowIOS*)sessionWindowByReplayingJournalData:(NSData*)journalData
+                                               onWindow:
+                                                   (SessionWindowIOS*)
+                                                       sessionWindow
+                                             generation:(uint64_t)generation;
+
+// Applies |record| to the session state. Returns the entry to append to the
+// journal, or nil if a new snapshot must be written with |-snapshotData|
+// instead.
+- (NSData*)journalEntryForRecord:(NSDictionary*)record;
+
+// Returns the data of a snapshot of the session state, with a new generation.
+// Returns nil if the state cannot be serialized. The journal must be removed
+// once the snapshot has been written.
+- (NSData*)snapshotData;
+
+// Forces the next record to be written as a snapshot, after a failure to
+// write to disk.
+- (void)invalidate;
+
+@end
+
+#endif  // IOS_CHROME_BROWSER_SESSIONS_SESSION_JOURNAL_H_
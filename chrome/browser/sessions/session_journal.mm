@@ -0,0 +1,309 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/sessions/session_journal.h"
+
+#include <string.h>
+
+#include "base/hash/hash.h"
+#include "base/logging.h"
+#import "base/mac/foundation_util.h"
+#include "base/rand_util.h"
+#include "base/strings/sys_string_conversions.h"
+#import "ios/chrome/browser/sessions/session_ios.h"
+#import "ios/chrome/browser/sessions/session_window_ios.h"
+#import "ios/web/public/session/crw_session_storage.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+NSString* const kSessionJournalGenerationKey = @"journalGeneration";
+
+namespace {
+
+// Record keys.
+NSString* const kFullKey = @"full";
+NSString* const kCountKey = @"count";
+NSString* const kSelectedIndexKey = @"selectedIndex";
+NSString* const kSessionsKey = @"sessions";
+
+// The snapshot is rebuilt once the journal is larger than the snapshot times
+// this ratio.
+const double kCompactionRatio = 1.0;
+
+// Header preceding each record in the journal.
+struct EntryHeader {
+  // Generation of the snapshot the record applies to.
+  uint64_t generation;
+  // Size of the archived record following the header.
+  uint32_t size;
+  // Hash of the archived record.
+  uint32_t checksum;
+};
+static_assert(sizeof(EntryHeader) == 16, "EntryHeader must not be padded");
+
+// Returns |object| archived, or nil on failure.
+NSData* ArchiveObject(id<NSCoding> object) {
+  NSError* error = nil;
+  NSData* data = [NSKeyedArchiver archivedDataWithRootObject:object
+                                       requiringSecureCoding:NO
+                                                       error:&error];
+  if (!data || error) {
+    DLOG(WARNING) << "Error serializing session: "
+                  << base::SysNSStringToUTF8([error description]);
+    return nil;
+  }
+  return data;
+}
+
+// Returns the object archived in |data|, or nil on failure.
+id UnarchiveObject(NSData* data) {
+  NSError* error = nil;
+  NSKeyedUnarchiver* unarchiver =
+      [[NSKeyedUnarchiver alloc] initForReadingFromData:data error:&error];
+  if (!unarchiver || error)
+    return nil;
+  unarchiver.requiresSecureCoding = NO;
+  return [unarchiver decodeObjectForKey:NSKeyedArchiveRootObjectKey];
+}
+
+// Applies |record| to |sessions| and |selectedIndex|. The sessions of |record|
+// are stored archived. Returns NO if |record| is invalid.
+BOOL ApplyRecord(NSDictionary* record,
+                 NSMutableArray* sessions,
+                 NSInteger* selectedIndex) {
+  NSNumber* count = base::mac::ObjCCast<NSNumber>(record[kCountKey]);
+  NSNumber* index = base::mac::ObjCCast<NSNumber>(record[kSelectedIndexKey]);
+  NSDictionary* changedSessions =
+      base::mac::ObjCCast<NSDictionary>(record[kSessionsKey]);
+  if (!count || !index || !changedSessions)
+    return NO;
+
+  const NSUInteger newCount = count.unsignedIntegerValue;
+  if (sessions.count > newCount) {
+    [sessions
+        removeObjectsInRange:NSMakeRange(newCount, sessions.count - newCount)];
+  }
+  for (NSNumber* key in changedSessions) {
+    NSData* data = base::mac::ObjCCast<NSData>(changedSessions[key]);
+    const NSUInteger sessionIndex = key.unsignedIntegerValue;
+    if (!data || sessionIndex >= newCount || sessionIndex > sessions.count)
+      return NO;
+    if (sessionIndex == sessions.count) {
+      [sessions addObject:data];
+    } else {
+      sessions[sessionIndex] = data;
+    }
+  }
+  *selectedIndex = index.integerValue;
+  return sessions.count == newCount;
+}
+
+// Returns a session window built from |sessions|, which are either archived
+// or CRWSessionStorage, or nil on failure.
+SessionWindowIOS* SessionWindowFromSessions(NSArray* sessions,
+                                            NSInteger selectedIndex) {
+  NSMutableArray<CRWSessionStorage*>* storages =
+      [NSMutableArray arrayWithCapacity:sessions.count];
+  for (id session in sessions) {
+    CRWSessionStorage* storage = base::mac::ObjCCast<CRWSessionStorage>(
+        [session isKindOfClass:[NSData class]] ? UnarchiveObject(session)
+                                               : session);
+    if (!storage)
+      return nil;
+    [storages addObject:storage];
+  }
+  if (storages.count == 0) {
+    selectedIndex = NSNotFound;
+  } else if (selectedIndex < 0 ||
+             static_cast<NSUInteger>(selectedIndex) >= storages.count) {
+    selectedIndex = 0;
+  }
+  return [[SessionWindowIOS alloc] initWithSessions:storages
+                                      selectedIndex:selectedIndex];
+}
+
+}  // namespace
+
+@implementation SessionJournalRecorder {
+  // The archived sessions passed to the last call to
+  // |recordForSessionWindow:|, or nil before the first call.
+  NSArray<NSData*>* _lastSessions;
+  NSUInteger _lastSelectedIndex;
+}
+
+- (NSDictionary*)recordForSessionWindow:(SessionWindowIOS*)sessionWindow {
+  NSMutableArray<NSData*>* sessions =
+      [NSMutableArray arrayWithCapacity:sessionWindow.sessions.count];
+  NSMutableDictionary<NSNumber*, NSData*>* changedSessions =
+      [NSMutableDictionary dictionary];
+  for (CRWSessionStorage* storage in sessionWindow.sessions) {
+    NSData* data = ArchiveObject(storage);
+    if (!data)
+      return nil;
+    const NSUInteger index = sessions.count;
+    if (index >= _lastSessions.count ||
+        ![_lastSessions[index] isEqualToData:data]) {
+      changedSessions[@(index)] = data;
+    }
+    [sessions addObject:data];
+  }
+
+  const BOOL full = _lastSessions == nil;
+  if (!full && changedSessions.count == 0 &&
+      sessions.count == _lastSessions.count &&
+      sessionWindow.selectedIndex == _lastSelectedIndex) {
+    return nil;
+  }
+
+  _lastSessions = [sessions copy];
+  _lastSelectedIndex = sessionWindow.selectedIndex;
+  return @{
+    kFullKey : @(full),
+    kCountKey : @(sessions.count),
+    kSelectedIndexKey : @(static_cast<NSInteger>(sessionWindow.selectedIndex)),
+    kSessionsKey : [changedSessions copy],
+  };
+}
+
+@end
+
+@implementation SessionJournal {
+  // The archived sessions and selected index of the session, with all the
+  // records applied.
+  NSMutableArray<NSData*>* _sessions;
+  NSInteger _selectedIndex;
+
+  // Generation of the last snapshot, or zero if the next record must be
+  // written as a snapshot.
+  uint64_t _generation;
+
+  // Size of the last snapshot and of the journal following it.
+  NSUInteger _snapshotSize;
+  NSUInteger _journalSize;
+}
+
++ (NSString*)journalPathForSessionPath:(NSString*)sessionPath {
+  return [sessionPath stringByAppendingPathExtension:@"journal"];
+}
+
++ (NSData*)snapshotDataForSession:(SessionIOS*)session
+                       generation:(uint64_t)generation {
+  NSKeyedArchiver* archiver =
+      [[NSKeyedArchiver alloc] initRequiringSecureCoding:NO];
+  [archiver encodeObject:session forKey:NSKeyedArchiveRootObjectKey];
+  [archiver encodeInt64:generation forKey:kSessionJournalGenerationKey];
+  [archiver finishEncoding];
+  return archiver.encodedData;
+}
+
++ (SessionWindowIOS*)sessionWindowByReplayingJournalData:(NSData*)journalData
+                                               onWindow:
+                                                   (SessionWindowIOS*)
+                                                       sessionWindow
+                                             generation:(uint64_t)generation {
+  if (!generation || !journalData.length)
+    return sessionWindow;
+
+  NSMutableArray* sessions = [sessionWindow.sessions mutableCopy];
+  NSInteger selectedIndex = sessionWindow.selectedIndex;
+  BOOL replayed = NO;
+  const uint8_t* bytes = static_cast<const uint8_t*>(journalData.bytes);
+  NSUInteger offset = 0;
+  while (journalData.length - offset >= sizeof(EntryHeader)) {
+    EntryHeader header;
+    memcpy(&header, bytes + offset, sizeof(EntryHeader));
+    offset += sizeof(EntryHeader);
+    if (header.size > journalData.length - offset ||
+        header.checksum != base::PersistentHash(bytes + offset, header.size)) {
+      // The entry was torn by a crash while it was appended.
+      break;
+    }
+    NSData* recordData =
+        [journalData subdataWithRange:NSMakeRange(offset, header.size)];
+    offset += header.size;
+    if (header.generation != generation)
+      continue;
+
+    NSDictionary* record =
+        base::mac::ObjCCast<NSDictionary>(UnarchiveObject(recordData));
+    if (!record || !ApplyRecord(record, sessions, &selectedIndex))
+      break;
+    replayed = YES;
+  }
+
+  if (!replayed)
+    return sessionWindow;
+  SessionWindowIOS* replayedWindow =
+      SessionWindowFromSessions(sessions, selectedIndex);
+  return replayedWindow ? replayedWindow : sessionWindow;
+}
+
+- (instancetype)init {
+  if ((self = [super init])) {
+    _sessions = [NSMutableArray array];
+    _selectedIndex = NSNotFound;
+  }
+  return self;
+}
+
+- (NSData*)journalEntryForRecord:(NSDictionary*)record {
+  DCHECK(record);
+  if ([record[kFullKey] boolValue]) {
+    [_sessions removeAllObjects];
+    _generation = 0;
+  }
+  if (!ApplyRecord(record, _sessions, &_selectedIndex)) {
+    NOTREACHED() << "Invalid session journal record";
+    _generation = 0;
+  }
+  if (!_generation)
+    return nil;
+
+  NSMutableDictionary* journalRecord = [record mutableCopy];
+  [journalRecord removeObjectForKey:kFullKey];
+  NSData* recordData = ArchiveObject(journalRecord);
+  if (!recordData)
+    return nil;
+
+  const NSUInteger entrySize = sizeof(EntryHeader) + recordData.length;
+  if (_journalSize + entrySize > _snapshotSize * kCompactionRatio)
+    return nil;
+
+  EntryHeader header = {};
+  header.generation = _generation;
+  header.size = static_cast<uint32_t>(recordData.length);
+  header.checksum = base::PersistentHash(recordData.bytes, recordData.length);
+  NSMutableData* entry = [NSMutableData dataWithCapacity:entrySize];
+  [entry appendBytes:&header length:sizeof(EntryHeader)];
+  [entry appendData:recordData];
+  _journalSize += entrySize;
+  return entry;
+}
+
+- (NSData*)snapshotData {
+  SessionWindowIOS* sessionWindow =
+      SessionWindowFromSessions(_sessions, _selectedIndex);
+  if (!sessionWindow)
+    return nil;
+
+  uint64_t generation = 0;
+  while (!generation || generation == _generation)
+    generation = base::RandUint64();
+  NSData* data = [[self class]
+      snapshotDataForSession:[[SessionIOS alloc]
+                                 initWithWindows:@[ sessionWindow ]]
+                  generation:generation];
+  _generation = generation;
+  _snapshotSize = data.length;
+  _journalSize = 0;
+  return data;
+}
+
+- (void)invalidate {
+  _generation = 0;
+}
+
+@end
@@ -0,0 +1,168 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/sessions/session_journal.h"
+
+#import <Foundation/Foundation.h>
+
+#import "ios/chrome/browser/sessions/session_ios.h"
+#import "ios/chrome/browser/sessions/session_window_ios.h"
+#import "ios/web/public/session/crw_session_storage.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/platform_test.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Number of unchanging sessions added to the session windows, so that the
+// snapshot is much larger than the changes.
+const NSUInteger kPaddingSessionCount = 20;
+
+// Returns a session window with one session per element of |indices|, each
+// with its |lastCommittedItemIndex| set to the element, followed by
+// |kPaddingSessionCount| sessions.
+SessionWindowIOS* CreateSessionWindow(NSArray<NSNumber*>* indices,
+                                      NSUInteger selected_index) {
+  NSMutableArray<CRWSessionStorage*>* sessions = [NSMutableArray array];
+  for (NSNumber* index in indices) {
+    CRWSessionStorage* session = [[CRWSessionStorage alloc] init];
+    session.lastCommittedItemIndex = index.integerValue;
+    session.itemStorages = @[];
+    [sessions addObject:session];
+  }
+  for (NSUInteger i = 0; i < kPaddingSessionCount; ++i) {
+    CRWSessionStorage* session = [[CRWSessionStorage alloc] init];
+    session.lastCommittedItemIndex = -1;
+    session.itemStorages = @[];
+    [sessions addObject:session];
+  }
+  return [[SessionWindowIOS alloc] initWithSessions:sessions
+                                      selectedIndex:selected_index];
+}
+
+// Returns the |lastCommittedItemIndex| of the sessions of |session_window|,
+// excluding the padding sessions.
+NSArray<NSNumber*>* GetIndices(SessionWindowIOS* session_window) {
+  EXPECT_LE(kPaddingSessionCount, session_window.sessions.count);
+  NSMutableArray<NSNumber*>* indices = [NSMutableArray array];
+  for (CRWSessionStorage* session in session_window.sessions) {
+    if (session.lastCommittedItemIndex != -1)
+      [indices addObject:@(session.lastCommittedItemIndex)];
+  }
+  return indices;
+}
+
+}  // namespace
+
+class SessionJournalTest : public PlatformTest {
+ protected:
+  SessionJournalTest()
+      : recorder_([[SessionJournalRecorder alloc] init]),
+        journal_([[SessionJournal alloc] init]) {}
+
+  // Records |session_window| and writes it to |snapshot_| or |journal_data_|.
+  void Save(SessionWindowIOS* session_window) {
+    NSDictionary* record = [recorder_ recordForSessionWindow:session_window];
+    ASSERT_TRUE(record);
+    NSData* entry = [journal_ journalEntryForRecord:record];
+    if (entry) {
+      [journal_data_ appendData:entry];
+      return;
+    }
+    snapshot_ = [journal_ snapshotData];
+    ASSERT_TRUE(snapshot_);
+    journal_data_ = [NSMutableData data];
+  }
+
+  // Returns the session window saved by |Save|.
+  SessionWindowIOS* Load() {
+    NSKeyedUnarchiver* unarchiver =
+        [[NSKeyedUnarchiver alloc] initForReadingFromData:snapshot_ error:nil];
+    unarchiver.requiresSecureCoding = NO;
+    SessionIOS* session =
+        [unarchiver decodeObjectForKey:NSKeyedArchiveRootObjectKey];
+    const uint64_t generation =
+        [unarchiver decodeInt64ForKey:kSessionJournalGenerationKey];
+    return [SessionJournal
+        sessionWindowByReplayingJournalData:journal_data_
+                                   onWindow:session.sessionWindows[0]
+                                 generation:generation];
+  }
+
+  SessionJournalRecorder* recorder_;
+  SessionJournal* journal_;
+  NSData* snapshot_;
+  NSMutableData* journal_data_;
+};
+
+// Tests that the first save writes a snapshot and that unchanged session
+// windows are not saved.
+TEST_F(SessionJournalTest, FirstSaveWritesSnapshot) {
+  SessionWindowIOS* session_window = CreateSessionWindow(@[ @1, @2 ], 0);
+  Save(session_window);
+  EXPECT_TRUE(snapshot_);
+  EXPECT_EQ(0u, journal_data_.length);
+  EXPECT_FALSE([recorder_ recordForSessionWindow:session_window]);
+
+  SessionWindowIOS* loaded_window = Load();
+  EXPECT_NSEQ((@[ @1, @2 ]), GetIndices(loaded_window));
+  EXPECT_EQ(0u, loaded_window.selectedIndex);
+}
+
+// Tests that changes are appended to the journal and replayed on load.
+TEST_F(SessionJournalTest, ChangesReplayed) {
+  Save(CreateSessionWindow(@[ @1, @2, @3 ], 0));
+  NSData* snapshot = snapshot_;
+
+  Save(CreateSessionWindow(@[ @1, @5, @3 ], 1));
+  Save(CreateSessionWindow(@[ @1, @5, @3, @7 ], 3));
+  Save(CreateSessionWindow(@[ @1, @5 ], 1));
+  EXPECT_NSEQ(snapshot, snapshot_);
+  EXPECT_LT(0u, journal_data_.length);
+
+  SessionWindowIOS* loaded_window = Load();
+  EXPECT_NSEQ((@[ @1, @5 ]), GetIndices(loaded_window));
+  EXPECT_EQ(1u, loaded_window.selectedIndex);
+}
+
+// Tests that a torn entry and the entries following it are ignored.
+TEST_F(SessionJournalTest, TornEntryIgnored) {
+  Save(CreateSessionWindow(@[ @1, @2 ], 0));
+  Save(CreateSessionWindow(@[ @1, @3 ], 0));
+  const NSUInteger first_entry_length = journal_data_.length;
+  Save(CreateSessionWindow(@[ @1, @4 ], 1));
+
+  journal_data_.length = journal_data_.length - 1;
+  SessionWindowIOS* loaded_window = Load();
+  EXPECT_NSEQ((@[ @1, @3 ]), GetIndices(loaded_window));
+  EXPECT_EQ(0u, loaded_window.selectedIndex);
+
+  journal_data_.length = first_entry_length / 2;
+  EXPECT_NSEQ((@[ @1, @2 ]), GetIndices(Load()));
+}
+
+// Tests that the journal is compacted into a new snapshot once it grows larger
+// than the snapshot, and that entries of older snapshots are ignored.
+TEST_F(SessionJournalTest, JournalCompacted) {
+  Save(CreateSessionWindow(@[ @1, @2 ], 0));
+  NSData* first_snapshot = snapshot_;
+
+  NSInteger index = 2;
+  NSData* stale_journal_data = nil;
+  while ([snapshot_ isEqualToData:first_snapshot]) {
+    ASSERT_LT(index, 1000);
+    stale_journal_data = [journal_data_ copy];
+    Save(CreateSessionWindow(@[ @1, @(++index) ], 0));
+  }
+  EXPECT_EQ(0u, journal_data_.length);
+  EXPECT_NSEQ((@[ @1, @(index) ]), GetIndices(Load()));
+
+  // Entries written for the first snapshot are not applied to the new one.
+  journal_data_ = [stale_journal_data mutableCopy];
+  EXPECT_LT(0u, journal_data_.length);
+  EXPECT_NSEQ((@[ @1, @(index) ]), GetIndices(Load()));
+}
@@ -15,6 +15,10 @@
 
 // A singleton service for saving the current session. Can either save on a
 // delay or immediately. Saving is always performed on a separate thread.
+//
+// Sessions with a single window are saved incrementally: only the WebStates
+// which changed since the previous save are appended to a journal, which is
+// periodically compacted into the session file on the separate thread.
 @interface SessionServiceIOS : NSObject
 
 // Lazily creates a singleton instance with a default task runner.
@@ -58,7 +62,8 @@
 // immediately so we can read it back in to verify various attributes. This
 // is not a situation we normally expect to be in because we never
 // want the session being saved on the main thread in the production app.
-- (void)performSaveSessionData:(NSData*)sessionData
+// Returns NO if the session could not be written.
+- (BOOL)performSaveSessionData:(NSData*)sessionData
                    sessionPath:(NSString*)sessionPath;
 
 @end
@@ -7,6 +7,7 @@
 #import <UIKit/UIKit.h>
 
 #include "base/bind.h"
+#include "base/files/file.h"
 #include "base/files/file_path.h"
 #include "base/format_macros.h"
 #include "base/location.h"
@@ -22,6 +23,7 @@
 #include "base/time/time.h"
 #import "ios/chrome/browser/sessions/session_ios.h"
 #import "ios/chrome/browser/sessions/session_ios_factory.h"
+#import "ios/chrome/browser/sessions/session_journal.h"
 #import "ios/chrome/browser/sessions/session_window_ios.h"
 #import "ios/web/public/session/crw_navigation_item_storage.h"
 #import "ios/web/public/session/crw_session_certificate_policy_cache_storage.h"
@@ -80,6 +82,14 @@ NSString* const kRootObjectKey = @"root";  // Key for the root object.
   // Maps session path to the pending session factories for the delayed save
   // behaviour. SessionIOSFactory pointers are weak.
   NSMapTable<NSString*, SessionIOSFactory*>* _pendingSessions;
+
+  // Maps session path to the recorder of the changes to the session saved
+  // there. Only accessed on the main thread.
+  NSMutableDictionary<NSString*, SessionJournalRecorder*>* _journalRecorders;
+
+  // Maps session path to the journal of the session saved there. Only
+  // accessed on |_taskRunner|.
+  NSMutableDictionary<NSString*, SessionJournal*>* _journals;
 }
 
 #pragma mark - NSObject overrides
@@ -109,6 +119,8 @@ NSString* const kRootObjectKey = @"root";  // Key for the root object.
   self = [super init];
   if (self) {
     _pendingSessions = [NSMapTable strongToWeakObjectsMapTable];
+    _journalRecorders = [NSMutableDictionary dictionary];
+    _journals = [NSMutableDictionary dictionary];
     _taskRunner = taskRunner;
   }
   return self;
@@ -163,6 +175,21 @@ NSString* const kRootObjectKey = @"root";  // Key for the root object.
     // Register compatibility aliases to support legacy saved sessions.
     [unarchiver cr_registerCompatibilityAliases];
     rootObject = [unarchiver decodeObjectForKey:kRootObjectKey];
+
+    // Replay the changes saved since the snapshot was written.
+    const uint64_t generation =
+        [unarchiver decodeInt64ForKey:kSessionJournalGenerationKey];
+    SessionIOS* session = base::mac::ObjCCast<SessionIOS>(rootObject);
+    if (generation && session.sessionWindows.count == 1) {
+      NSData* journalData = [NSData
+          dataWithContentsOfFile:[SessionJournal
+                                     journalPathForSessionPath:sessionPath]];
+      SessionWindowIOS* sessionWindow = [SessionJournal
+          sessionWindowByReplayingJournalData:journalData
+                                     onWindow:session.sessionWindows[0]
+                                   generation:generation];
+      rootObject = [[SessionIOS alloc] initWithWindows:@[ sessionWindow ]];
+    }
   } @catch (NSException* exception) {
     NOTREACHED() << "Error loading session file: "
                  << base::SysNSStringToUTF8(sessionPath) << ": "
@@ -186,11 +213,17 @@ NSString* const kRootObjectKey = @"root";  // Key for the root object.
 - (void)deleteLastSessionFileInDirectory:(NSString*)directory
                               completion:(base::OnceClosure)callback {
   NSString* sessionPath = [[self class] sessionPathForDirectory:directory];
+  [_journalRecorders removeObjectForKey:sessionPath];
   _taskRunner->PostTaskAndReply(
       FROM_HERE, base::BindOnce(^{
         base::ScopedBlockingCall scoped_blocking_call(
             FROM_HERE, base::BlockingType::MAY_BLOCK);
+        [self->_journals removeObjectForKey:sessionPath];
         NSFileManager* fileManager = [NSFileManager defaultManager];
+        [fileManager
+            removeItemAtPath:[SessionJournal
+                                 journalPathForSessionPath:sessionPath]
+                       error:nil];
         if (![fileManager fileExistsAtPath:sessionPath])
           return;
 
@@ -224,6 +257,11 @@ NSString* const kRootObjectKey = @"root";  // Key for the root object.
   if (!session)
     return;
 
+  if (session.sessionWindows.count == 1) {
+    [self saveSessionWindow:session.sessionWindows[0] sessionPath:sessionPath];
+    return;
+  }
+
   @try {
     NSError* error = nil;
     NSData* sessionData = [NSKeyedArchiver archivedDataWithRootObject:session
@@ -251,11 +289,107 @@ NSString* const kRootObjectKey = @"root";  // Key for the root object.
   }
 }
 
+// Records the changes made to |sessionWindow| since the previous save to
+// |sessionPath| and writes them on a background thread.
+- (void)saveSessionWindow:(SessionWindowIOS*)sessionWindow
+              sessionPath:(NSString*)sessionPath {
+  SessionJournalRecorder* recorder = _journalRecorders[sessionPath];
+  if (!recorder) {
+    recorder = [[SessionJournalRecorder alloc] init];
+    _journalRecorders[sessionPath] = recorder;
+  }
+
+  NSDictionary* record = nil;
+  @try {
+    record = [recorder recordForSessionWindow:sessionWindow];
+  } @catch (NSException* exception) {
+    NOTREACHED() << "Error serializing session for path: "
+                 << base::SysNSStringToUTF8(sessionPath) << ": "
+                 << base::SysNSStringToUTF8([exception description]);
+    return;
+  }
+  if (!record)
+    return;
+
+  _taskRunner->PostTask(FROM_HERE, base::BindOnce(^{
+                          [self performSaveJournalRecord:record
+                                             sessionPath:sessionPath];
+                        }));
+}
+
+// Appends |record| to the journal of |sessionPath|, or writes a new snapshot
+// of the session if the journal grew too large.
+- (void)performSaveJournalRecord:(NSDictionary*)record
+                     sessionPath:(NSString*)sessionPath {
+  SessionJournal* journal = _journals[sessionPath];
+  if (!journal) {
+    journal = [[SessionJournal alloc] init];
+    _journals[sessionPath] = journal;
+  }
+
+  NSData* entry = [journal journalEntryForRecord:record];
+  if (entry) {
+    if (![self performAppendJournalEntry:entry sessionPath:sessionPath])
+      [journal invalidate];
+    return;
+  }
+
+  NSData* sessionData = nil;
+  @try {
+    sessionData = [journal snapshotData];
+  } @catch (NSException* exception) {
+    NOTREACHED() << "Error serializing session for path: "
+                 << base::SysNSStringToUTF8(sessionPath) << ": "
+                 << base::SysNSStringToUTF8([exception description]);
+  }
+  if (!sessionData) {
+    [journal invalidate];
+    return;
+  }
+
+  UMA_HISTOGRAM_COUNTS_100000("Session.WebStates.SerializedSize",
+                              sessionData.length / 1024);
+  if (![self performSaveSessionData:sessionData sessionPath:sessionPath])
+    [journal invalidate];
+}
+
+// Appends |entry| to the journal of |sessionPath|. Returns NO on failure.
+- (BOOL)performAppendJournalEntry:(NSData*)entry
+                      sessionPath:(NSString*)sessionPath {
+  base::ScopedBlockingCall scoped_blocking_call(FROM_HERE,
+                                                base::BlockingType::MAY_BLOCK);
+
+  NSString* journalPath =
+      [SessionJournal journalPathForSessionPath:sessionPath];
+  base::File file(base::mac::NSStringToFilePath(journalPath),
+                  base::File::FLAG_OPEN_ALWAYS | base::File::FLAG_APPEND);
+  if (!file.IsValid()) {
+    DLOG(WARNING) << "Error opening session journal: "
+                  << base::SysNSStringToUTF8(journalPath);
+    return NO;
+  }
+  if (file.created()) {
+    [[NSFileManager defaultManager]
+        setAttributes:@{NSFileProtectionKey : NSFileProtectionComplete}
+         ofItemAtPath:journalPath
+                error:nil];
+  }
+
+  const int entrySize = static_cast<int>(entry.length);
+  if (file.WriteAtCurrentPos(static_cast<const char*>(entry.bytes),
+                             entrySize) != entrySize) {
+    DLOG(WARNING) << "Error writing session journal: "
+                  << base::SysNSStringToUTF8(journalPath);
+    return NO;
+  }
+  return YES;
+}
+
 @end
 
 @implementation SessionServiceIOS (SubClassing)
 
-- (void)performSaveSessionData:(NSData*)sessionData
+- (BOOL)performSaveSessionData:(NSData*)sessionData
                    sessionPath:(NSString*)sessionPath {
   base::ScopedBlockingCall scoped_blocking_call(
             FROM_HERE, base::BlockingType::MAY_BLOCK);
@@ -274,7 +408,7 @@ NSString* const kRootObjectKey = @"root";  // Key for the root object.
       NOTREACHED() << "Error creating destination directory: "
                    << base::SysNSStringToUTF8(directory) << ": "
                    << base::SysNSStringToUTF8([error description]);
-      return;
+      return NO;
     }
   }
 
@@ -282,7 +416,7 @@ NSString* const kRootObjectKey = @"root";  // Key for the root object.
     NOTREACHED() << "Error creating destination directory: "
                  << base::SysNSStringToUTF8(directory) << ": "
                  << "file exists and is not a directory.";
-    return;
+    return NO;
   }
 
   NSDataWritingOptions options =
@@ -293,10 +427,16 @@ NSString* const kRootObjectKey = @"root";  // Key for the root object.
     NOTREACHED() << "Error writing session file: "
                  << base::SysNSStringToUTF8(sessionPath) << ": "
                  << base::SysNSStringToUTF8([error description]);
-    return;
+    return NO;
   }
   UmaHistogramTimes("Session.WebStates.WriteToFileTime",
                     base::TimeTicks::Now() - start_time);
+
+  // The snapshot includes all the changes of the journal.
+  [fileManager
+      removeItemAtPath:[SessionJournal journalPathForSessionPath:sessionPath]
+                 error:nil];
+  return YES;
 }
 
 @end
@@ -0,0 +1,121 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import <Foundation/Foundation.h>
+
+#include <memory>
+
+#include "base/bind_helpers.h"
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/strings/sys_string_conversions.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/timer/elapsed_timer.h"
+#import "ios/chrome/browser/sessions/session_ios.h"
+#import "ios/chrome/browser/sessions/session_ios_factory.h"
+#import "ios/chrome/browser/sessions/session_service_ios.h"
+#import "ios/chrome/browser/sessions/session_window_ios.h"
+#import "ios/chrome/browser/web_state_list/fake_web_state_list_delegate.h"
+#import "ios/chrome/browser/web_state_list/web_state_list.h"
+#import "ios/chrome/browser/web_state_list/web_state_opener.h"
+#include "ios/chrome/test/base/perf_test_ios.h"
+#import "ios/web/public/session/serializable_user_data_manager.h"
+#import "ios/web/public/test/fakes/test_web_state.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Number of changes to one tab saved for each session size.
+const int kSaveCount = 10;
+
+class SessionServiceIOSPerfTest : public PerfTest {
+ protected:
+  SessionServiceIOSPerfTest() : PerfTest("Session service") {
+    EXPECT_TRUE(scoped_temp_directory_.CreateUniqueTempDir());
+    directory_ = base::SysUTF8ToNSString(
+        scoped_temp_directory_.GetPath().Append("sessions").AsUTF8Unsafe());
+    session_service_ = [[SessionServiceIOS alloc]
+        initWithTaskRunner:base::ThreadTaskRunnerHandle::Get()];
+  }
+
+  // Returns a WebStateList with |tabs_count| WebStates and activates the first
+  // WebState.
+  std::unique_ptr<WebStateList> CreateWebStateList(int tabs_count) {
+    auto web_state_list =
+        std::make_unique<WebStateList>(&web_state_list_delegate_);
+    for (int i = 0; i < tabs_count; ++i) {
+      web_state_list->InsertWebState(i, std::make_unique<web::TestWebState>(),
+                                     WebStateList::INSERT_FORCE_INDEX,
+                                     WebStateOpener());
+    }
+    if (tabs_count > 0)
+      web_state_list->ActivateWebStateAt(0);
+    return web_state_list;
+  }
+
+  base::ScopedTempDir scoped_temp_directory_;
+  NSString* directory_;
+  SessionServiceIOS* session_service_;
+  FakeWebStateListDelegate web_state_list_delegate_;
+};
+
+// Tests the cost of saving a change to one tab and of loading the session,
+// against the cost of archiving and writing the whole session, for sessions of
+// increasing sizes.
+TEST_F(SessionServiceIOSPerfTest, SaveAndLoad) {
+  for (int tabs_count : {10, 100, 300}) {
+    std::unique_ptr<WebStateList> web_state_list =
+        CreateWebStateList(tabs_count);
+    SessionIOSFactory* factory =
+        [[SessionIOSFactory alloc] initWithWebStateList:web_state_list.get()];
+    [session_service_ saveSession:factory directory:directory_ immediately:YES];
+    base::RunLoop().RunUntilIdle();
+
+    // Baseline: archiving and writing the whole session.
+    base::ElapsedTimer full_save_timer;
+    NSData* session_data =
+        [NSKeyedArchiver archivedDataWithRootObject:[factory sessionForSaving]
+                              requiringSecureCoding:NO
+                                              error:nil];
+    [session_data
+        writeToFile:[directory_ stringByAppendingPathComponent:@"full.plist"]
+         atomically:YES];
+    LogPerfTiming(base::StringPrintf("Full save of %d tabs", tabs_count),
+                  full_save_timer.Elapsed());
+
+    base::ElapsedTimer save_timer;
+    for (int i = 0; i < kSaveCount; ++i) {
+      web::SerializableUserDataManager::FromWebState(
+          web_state_list->GetWebStateAt(i))
+          ->AddSerializableData(@(i), @"SaveAndLoad");
+      [session_service_ saveSession:factory
+                          directory:directory_
+                        immediately:YES];
+      base::RunLoop().RunUntilIdle();
+    }
+    LogPerfTiming(
+        base::StringPrintf("Incremental save of %d tabs", tabs_count),
+        save_timer.Elapsed() / kSaveCount);
+
+    base::ElapsedTimer load_timer;
+    SessionIOS* session =
+        [session_service_ loadSessionFromDirectory:directory_];
+    LogPerfTiming(base::StringPrintf("Load of %d tabs", tabs_count),
+                  load_timer.Elapsed());
+    ASSERT_EQ(static_cast<NSUInteger>(tabs_count),
+              session.sessionWindows[0].sessions.count);
+
+    [factory disconnect];
+    [session_service_ deleteLastSessionFileInDirectory:directory_
+                                            completion:base::DoNothing()];
+    base::RunLoop().RunUntilIdle();
+  }
+}
+
+}  // namespace
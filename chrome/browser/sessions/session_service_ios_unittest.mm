@@ -6,6 +6,7 @@
 
 #include <memory>
 
+#include "base/bind_helpers.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
 #include "base/files/scoped_temp_dir.h"
@@ -19,6 +20,7 @@
 #include "ios/chrome/browser/chrome_paths.h"
 #import "ios/chrome/browser/sessions/session_ios.h"
 #import "ios/chrome/browser/sessions/session_ios_factory.h"
+#import "ios/chrome/browser/sessions/session_journal.h"
 #import "ios/chrome/browser/sessions/session_service_ios.h"
 #import "ios/chrome/browser/sessions/session_window_ios.h"
 #import "ios/chrome/browser/web_state_list/fake_web_state_list_delegate.h"
@@ -218,6 +220,47 @@ TEST_F(SessionServiceTest, LoadSessionFromPath) {
   EXPECT_EQ(0u, session.sessionWindows[0].selectedIndex);
 }
 
+// Tests that saving changes to a session only writes them to the journal, and
+// that they are replayed when the session is loaded.
+TEST_F(SessionServiceTest, SaveSessionIncrementally) {
+  std::unique_ptr<WebStateList> web_state_list = CreateWebStateList(2);
+  SessionIOSFactory* factory =
+      [[SessionIOSFactory alloc] initWithWebStateList:web_state_list.get()];
+  [session_service() saveSession:factory directory:directory() immediately:YES];
+  base::RunLoop().RunUntilIdle();
+
+  NSString* session_path =
+      [SessionServiceIOS sessionPathForDirectory:directory()];
+  NSString* journal_path =
+      [SessionJournal journalPathForSessionPath:session_path];
+  NSData* snapshot = [NSData dataWithContentsOfFile:session_path];
+  ASSERT_TRUE(snapshot);
+  EXPECT_FALSE([[NSFileManager defaultManager] fileExistsAtPath:journal_path]);
+
+  web_state_list->InsertWebState(2, std::make_unique<web::TestWebState>(),
+                                 WebStateList::INSERT_FORCE_INDEX,
+                                 WebStateOpener());
+  web_state_list->ActivateWebStateAt(2);
+  [session_service() saveSession:factory directory:directory() immediately:YES];
+  base::RunLoop().RunUntilIdle();
+
+  EXPECT_NSEQ(snapshot, [NSData dataWithContentsOfFile:session_path]);
+  EXPECT_TRUE([[NSFileManager defaultManager] fileExistsAtPath:journal_path]);
+
+  SessionIOS* session =
+      [session_service() loadSessionFromDirectory:directory()];
+  ASSERT_EQ(1u, session.sessionWindows.count);
+  EXPECT_EQ(3u, session.sessionWindows[0].sessions.count);
+  EXPECT_EQ(2u, session.sessionWindows[0].selectedIndex);
+
+  // Deleting the session also deletes the journal.
+  [session_service() deleteLastSessionFileInDirectory:directory()
+                                           completion:base::DoNothing()];
+  base::RunLoop().RunUntilIdle();
+  EXPECT_FALSE([[NSFileManager defaultManager] fileExistsAtPath:session_path]);
+  EXPECT_FALSE([[NSFileManager defaultManager] fileExistsAtPath:journal_path]);
+}
+
 TEST_F(SessionServiceTest, LoadCorruptedSession) {
   NSString* session_path =
       SessionPathForTestData(FILE_PATH_LITERAL("corrupted.plist"));
@@ -0,0 +1,16 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_CHROME_BROWSER_SNAPSHOTS_GREY_IMAGE_BATCH_CONVERTER_H_
+#define IOS_CHROME_BROWSER_SNAPSHOTS_GREY_IMAGE_BATCH_CONVERTER_H_
+
+#import <UIKit/UIKit.h>
+
+// Converts the images of |images| with GreyImage(), in parallel on the thread
+// pool. |callback| is called on the calling sequence with the key and the grey
+// image of each image, as soon as it has been converted.
+void ConvertImagesToGrey(NSDictionary<NSString*, UIImage*>* images,
+                         void (^callback)(NSString* key, UIImage* grey_image));
+
+#endif  // IOS_CHROME_BROWSER_SNAPSHOTS_GREY_IMAGE_BATCH_CONVERTER_H_
@@ -0,0 +1,34 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/snapshots/grey_image_batch_converter.h"
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/mac/scoped_nsobject.h"
+#include "base/task/post_task.h"
+#import "ios/chrome/browser/ui/util/uikit_ui_util.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+void ConvertImagesToGrey(NSDictionary<NSString*, UIImage*>* images,
+                         void (^callback)(NSString* key, UIImage* grey_image)) {
+  DCHECK(callback);
+  // Each image is converted by its own task, so that the thread pool can run
+  // them in parallel, and so that the first grey images are available before
+  // the whole batch is converted.
+  for (NSString* key in images) {
+    UIImage* image = images[key];
+    base::PostTaskAndReplyWithResult(
+        FROM_HERE, {base::ThreadPool(), base::TaskPriority::USER_VISIBLE},
+        base::BindOnce(^base::scoped_nsobject<UIImage>() {
+          return base::scoped_nsobject<UIImage>(GreyImage(image));
+        }),
+        base::BindOnce(^(base::scoped_nsobject<UIImage> grey_image) {
+          callback(key, grey_image);
+        }));
+  }
+}
@@ -0,0 +1,111 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/snapshots/grey_image_batch_converter.h"
+
+#import <UIKit/UIKit.h>
+
+#include <vector>
+
+#include "base/run_loop.h"
+#include "base/timer/elapsed_timer.h"
+#include "ios/chrome/browser/ui/util/luma_conversion.h"
+#import "ios/chrome/browser/ui/util/uikit_ui_util.h"
+#include "ios/chrome/test/base/perf_test_ios.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Number of snapshots converted by each run, as when the grey cache is created
+// for a window with many tabs.
+const NSUInteger kSnapshotCount = 50;
+
+class GreyImageBatchConverterPerfTest : public PerfTest {
+ protected:
+  GreyImageBatchConverterPerfTest() : PerfTest("Grey snapshot conversion") {
+    // Use snapshots of the size of the screen, each with a different color.
+    const CGSize size = UIScreen.mainScreen.bounds.size;
+    images_ = [NSMutableDictionary dictionaryWithCapacity:kSnapshotCount];
+    for (NSUInteger i = 0; i < kSnapshotCount; ++i) {
+      UIGraphicsBeginImageContextWithOptions(size, /*opaque=*/YES,
+                                             UIScreen.mainScreen.scale);
+      CGFloat component = static_cast<CGFloat>(i) / kSnapshotCount;
+      [[UIColor colorWithRed:component green:1 - component blue:0.5 alpha:1]
+          setFill];
+      UIRectFill(CGRectMake(0, 0, size.width, size.height));
+      images_[[NSString stringWithFormat:@"%@", @(i)]] =
+          UIGraphicsGetImageFromCurrentImageContext();
+      UIGraphicsEndImageContext();
+    }
+    pixel_count_ = size.width * size.height;
+  }
+
+  NSMutableDictionary<NSString*, UIImage*>* images_;
+  // Number of pixels of the grey snapshots.
+  size_t pixel_count_;
+};
+
+// Tests converting the snapshots one after the other.
+TEST_F(GreyImageBatchConverterPerfTest, SequentialConversion) {
+  RepeatTimedRuns("Sequential conversion",
+                  ^base::TimeDelta(int) {
+                    base::ElapsedTimer timer;
+                    for (NSString* key in images_)
+                      EXPECT_TRUE(GreyImage(images_[key]));
+                    return timer.Elapsed();
+                  },
+                  nil);
+}
+
+// Tests converting the snapshots in parallel on the thread pool.
+TEST_F(GreyImageBatchConverterPerfTest, BatchConversion) {
+  RepeatTimedRuns("Batch conversion",
+                  ^base::TimeDelta(int) {
+                    base::ElapsedTimer timer;
+                    base::RunLoop run_loop;
+                    __block NSUInteger converted_count = 0;
+                    base::RepeatingClosure quit_closure =
+                        run_loop.QuitClosure();
+                    ConvertImagesToGrey(images_, ^(NSString*, UIImage* grey) {
+                      EXPECT_TRUE(grey);
+                      if (++converted_count == kSnapshotCount)
+                        quit_closure.Run();
+                    });
+                    run_loop.Run();
+                    return timer.Elapsed();
+                  },
+                  nil);
+}
+
+// Tests the luma kernels alone, on buffers of the size of the snapshots.
+TEST_F(GreyImageBatchConverterPerfTest, LumaKernels) {
+  std::vector<uint8_t> rgbx(pixel_count_ * 4, 0x80);
+  std::vector<uint8_t> luma(pixel_count_);
+  const uint8_t* rgbx_data = rgbx.data();
+  uint8_t* luma_data = luma.data();
+  RepeatTimedRuns("Reference luma kernel",
+                  ^base::TimeDelta(int) {
+                    base::ElapsedTimer timer;
+                    for (NSUInteger i = 0; i < kSnapshotCount; ++i) {
+                      ConvertRGBXToLumaReference(rgbx_data, luma_data,
+                                                 pixel_count_);
+                    }
+                    return timer.Elapsed();
+                  },
+                  nil);
+  RepeatTimedRuns("Vectorized luma kernel",
+                  ^base::TimeDelta(int) {
+                    base::ElapsedTimer timer;
+                    for (NSUInteger i = 0; i < kSnapshotCount; ++i) {
+                      ConvertRGBXToLuma(rgbx_data, luma_data, pixel_count_);
+                    }
+                    return timer.Elapsed();
+                  },
+                  nil);
+}
+
+}  // namespace
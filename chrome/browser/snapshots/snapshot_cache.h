@@ -22,6 +22,11 @@
 // |UIApplicationDidBecomeActiveNotification|.
 @property(nonatomic, strong) NSSet* pinnedIDs;
 
+// JPEG qualities, between 0.0 and 1.0, used to write the snapshots and their
+// thumbnails to disk.
+@property(nonatomic, assign) CGFloat JPEGImageQuality;
+@property(nonatomic, assign) CGFloat thumbnailJPEGImageQuality;
+
 // The scale that should be used for snapshots.
 - (CGFloat)snapshotScaleForDevice;
 
@@ -32,6 +37,15 @@
 - (void)retrieveImageForSessionID:(NSString*)sessionID
                          callback:(void (^)(UIImage*))callback;
 
+// Retrieve a thumbnail of the snapshot for the |sessionID|, suitable for the
+// tab grid, and return it via the callback. Thumbnails have the size of the
+// snapshots in points with a lower resolution, and are kept in memory in a
+// separate cache. The callback is guaranteed to be called synchronously if the
+// thumbnail is in memory. It will be called asynchronously if the thumbnail or
+// the snapshot is on disk, or with nil if the snapshot is not present at all.
+- (void)retrieveThumbnailForSessionID:(NSString*)sessionID
+                             callback:(void (^)(UIImage*))callback;
+
 // Request the session's grey snapshot. If the image is already loaded in
 // memory, this will immediately call back on |callback|.
 - (void)retrieveGreyImageForSessionID:(NSString*)sessionID
@@ -95,6 +109,7 @@
 // Additionnal methods that should only be used for tests.
 @interface SnapshotCache (TestingAdditions)
 - (BOOL)hasImageInMemory:(NSString*)sessionID;
+- (BOOL)hasThumbnailInMemory:(NSString*)sessionID;
 - (BOOL)hasGreyImageInMemory:(NSString*)sessionID;
 - (NSUInteger)lruCacheMaxSize;
 @end
@@ -15,6 +15,7 @@
 #import "base/ios/crb_protocol_observers.h"
 #include "base/logging.h"
 #include "base/mac/scoped_nsobject.h"
+#include "base/metrics/histogram_macros.h"
 #include "base/path_service.h"
 #include "base/sequence_checker.h"
 #include "base/sequenced_task_runner.h"
@@ -23,6 +24,7 @@
 #include "base/task/post_task.h"
 #include "base/task_runner_util.h"
 #include "base/threading/scoped_blocking_call.h"
+#import "ios/chrome/browser/snapshots/grey_image_batch_converter.h"
 #import "ios/chrome/browser/snapshots/snapshot_cache_observer.h"
 #import "ios/chrome/browser/snapshots/snapshot_lru_cache.h"
 #include "ios/chrome/browser/ui/util/ui_util.h"
@@ -50,16 +52,21 @@
 // Marked set of identifiers for which images should not be immediately deleted.
 @property(nonatomic, strong) NSMutableSet* markedIDs;
 
-// Remove all UIImages from |lruCache_|.
+// Remove all UIImages from |lruCache_| and |thumbnailCache_|.
 - (void)handleEnterBackground;
-// Remove all but adjacent UIImages from |lruCache_|.
+// Remove all but adjacent UIImages from |lruCache_| and shrink
+// |thumbnailCache_|.
 - (void)handleLowMemory;
 // Restore adjacent UIImages to |lruCache_|.
 - (void)handleBecomeActive;
+// Read the snapshot for |sessionID| from disk into |lruCache_| and return it
+// via the callback, or nil if it is not on disk.
+- (void)readImageForSessionID:(NSString*)sessionID
+                     callback:(void (^)(UIImage*))callback;
 // Clear most recent caller information.
 - (void)clearGreySessionInfo;
-// Load uncached snapshot image and convert image to grey.
-- (void)loadGreyImageAsync:(NSString*)sessionID;
+// Load uncached snapshot images and convert them to grey in parallel.
+- (void)loadGreyImagesAsync:(NSArray*)sessionIDs;
 // Save grey image to |greyImageDictionary_| and call into most recent
 // |mostRecentGreyBlock_| if |mostRecentGreySessionId_| matches |sessionID|.
 - (void)saveGreyImage:(UIImage*)greyImage forKey:(NSString*)sessionID;
@@ -69,6 +76,7 @@ namespace {
 enum ImageType {
   IMAGE_TYPE_COLOR,
   IMAGE_TYPE_GREYSCALE,
+  IMAGE_TYPE_THUMBNAIL,
 };
 
 enum ImageScale {
@@ -78,15 +86,39 @@ enum ImageScale {
 };
 
 const ImageType kImageTypes[] = {
-    IMAGE_TYPE_COLOR, IMAGE_TYPE_GREYSCALE,
+    IMAGE_TYPE_COLOR, IMAGE_TYPE_GREYSCALE, IMAGE_TYPE_THUMBNAIL,
+};
+
+// Result of a lookup in a tier of the cache. These values are persisted to
+// logs. Entries should not be renumbered and numeric values should never be
+// reused.
+enum class SnapshotCacheLookupResult {
+  kMemoryHit = 0,
+  kDiskHit = 1,
+  kMiss = 2,
+  kMaxValue = kMiss,
 };
 
 const NSUInteger kGreyInitialCapacity = 8;
-const CGFloat kJPEGImageQuality = 1.0;  // Highest quality. No compression.
+
+// Default JPEG qualities of the snapshots and thumbnails written to disk.
+const CGFloat kDefaultJPEGImageQuality = 0.9;
+const CGFloat kDefaultThumbnailJPEGImageQuality = 0.7;
 
 // Maximum size in number of elements that the LRU cache can hold before
 // starting to evict elements.
 const NSUInteger kLRUCacheMaxCapacity = 6;
+// Maximum size in bytes of the images that the LRU cache can hold before
+// starting to evict elements.
+const NSUInteger kLRUCacheMaxCost = 32 * 1024 * 1024;
+
+// Maximum size in bytes of the thumbnails kept in memory.
+const NSUInteger kThumbnailCacheMaxCost = 16 * 1024 * 1024;
+
+// Thumbnails have the point size of the snapshots, with their resolution
+// divided by this factor in each dimension. This is enough for the tab grid
+// cells.
+const CGFloat kThumbnailDownscaleFactor = 3.0;
 
 // Returns the path of the directory containing the snapshots.
 bool GetSnapshotsCacheDirectory(base::FilePath* snapshots_cache_directory) {
@@ -114,6 +146,9 @@ base::FilePath ImagePath(NSString* session_id,
     case IMAGE_TYPE_GREYSCALE:
       filename = [filename stringByAppendingString:@"Grey"];
       break;
+    case IMAGE_TYPE_THUMBNAIL:
+      filename = [filename stringByAppendingString:@"Thumbnail"];
+      break;
   }
   switch (image_scale) {
     case IMAGE_SCALE_1X:
@@ -153,6 +188,37 @@ CGFloat ScaleFromImageScale(ImageScale image_scale) {
   }
 }
 
+// Returns the scale of images of |image_type| for snapshots of |image_scale|.
+CGFloat ScaleForImageType(ImageType image_type, ImageScale image_scale) {
+  switch (image_type) {
+    case IMAGE_TYPE_COLOR:
+      return ScaleFromImageScale(image_scale);
+    case IMAGE_TYPE_GREYSCALE:
+      return 1.0;
+    case IMAGE_TYPE_THUMBNAIL:
+      return ScaleFromImageScale(image_scale) / kThumbnailDownscaleFactor;
+  }
+}
+
+// Returns the number of bytes used by the bitmap of |image|.
+NSUInteger ImageCost(UIImage* image) {
+  CGImageRef cg_image = image.CGImage;
+  if (!cg_image)
+    return 0;
+  return CGImageGetBytesPerRow(cg_image) * CGImageGetHeight(cg_image);
+}
+
+// Returns a copy of |image| with the same size in points, and its resolution
+// reduced by |kThumbnailDownscaleFactor|.
+UIImage* ThumbnailImage(UIImage* image) {
+  UIGraphicsBeginImageContextWithOptions(
+      image.size, /*opaque=*/YES, image.scale / kThumbnailDownscaleFactor);
+  [image drawInRect:CGRectMake(0, 0, image.size.width, image.size.height)];
+  UIImage* thumbnail = UIGraphicsGetImageFromCurrentImageContext();
+  UIGraphicsEndImageContext();
+  return thumbnail;
+}
+
 UIImage* ReadImageForSessionFromDisk(NSString* session_id,
                                      ImageType image_type,
                                      ImageScale image_scale,
@@ -167,12 +233,12 @@ UIImage* ReadImageForSessionFromDisk(NSString* session_id,
   base::ScopedBlockingCall scoped_blocking_call(FROM_HERE,
                                                 base::BlockingType::WILL_BLOCK);
   return [UIImage imageWithData:[NSData dataWithContentsOfFile:path]
-                          scale:(image_type == IMAGE_TYPE_GREYSCALE
-                                     ? 1.0
-                                     : ScaleFromImageScale(image_scale))];
+                          scale:ScaleForImageType(image_type, image_scale)];
 }
 
-void WriteImageToDisk(UIImage* image, const base::FilePath& file_path) {
+void WriteImageToDisk(UIImage* image,
+                      const base::FilePath& file_path,
+                      CGFloat jpeg_quality) {
   if (!image)
     return;
 
@@ -189,8 +255,8 @@ void WriteImageToDisk(UIImage* image, const base::FilePath& file_path) {
   NSString* path = base::SysUTF8ToNSString(file_path.AsUTF8Unsafe());
   base::ScopedBlockingCall scoped_blocking_call(FROM_HERE,
                                                 base::BlockingType::WILL_BLOCK);
-  [UIImageJPEGRepresentation(image, kJPEGImageQuality) writeToFile:path
-                                                        atomically:YES];
+  [UIImageJPEGRepresentation(image, jpeg_quality) writeToFile:path
+                                                   atomically:YES];
 
   // Encrypt the snapshot file (mostly for Incognito, but can't hurt to
   // always do it).
@@ -207,10 +273,30 @@ void WriteImageToDisk(UIImage* image, const base::FilePath& file_path) {
   }
 }
 
+// Writes |image| and its thumbnail to disk. Returns the thumbnail.
+UIImage* WriteImageAndThumbnailToDisk(UIImage* image,
+                                      NSString* session_id,
+                                      ImageScale image_scale,
+                                      const base::FilePath& cache_directory,
+                                      CGFloat jpeg_quality,
+                                      CGFloat thumbnail_jpeg_quality) {
+  WriteImageToDisk(image,
+                   ImagePath(session_id, IMAGE_TYPE_COLOR, image_scale,
+                             cache_directory),
+                   jpeg_quality);
+  UIImage* thumbnail = ThumbnailImage(image);
+  WriteImageToDisk(thumbnail,
+                   ImagePath(session_id, IMAGE_TYPE_THUMBNAIL, image_scale,
+                             cache_directory),
+                   thumbnail_jpeg_quality);
+  return thumbnail;
+}
+
 void ConvertAndSaveGreyImage(NSString* session_id,
                              ImageScale image_scale,
                              UIImage* color_image,
-                             const base::FilePath& cache_directory) {
+                             const base::FilePath& cache_directory,
+                             CGFloat jpeg_quality) {
   base::ScopedBlockingCall scoped_blocking_call(FROM_HERE,
                                                 base::BlockingType::WILL_BLOCK);
   if (!color_image) {
@@ -220,17 +306,23 @@ void ConvertAndSaveGreyImage(NSString* session_id,
       return;
   }
   UIImage* grey_image = GreyImage(color_image);
-  WriteImageToDisk(grey_image, ImagePath(session_id, IMAGE_TYPE_GREYSCALE,
-                                         image_scale, cache_directory));
+  WriteImageToDisk(grey_image,
+                   ImagePath(session_id, IMAGE_TYPE_GREYSCALE, image_scale,
+                             cache_directory),
+                   jpeg_quality);
 }
 
 }  // anonymous namespace
 
 @implementation SnapshotCache {
-  // Cache to hold color snapshots in memory. n.b. Color snapshots are not
-  // kept in memory on tablets.
+  // Cache to hold color snapshots in memory, for the most recently used tabs.
+  // n.b. Color snapshots are not kept in memory on tablets.
   SnapshotLRUCache* _lruCache;
 
+  // Cache to hold the thumbnails of the color snapshots in memory, for the
+  // tab grid.
+  SnapshotLRUCache* _thumbnailCache;
+
   // Temporary dictionary to hold grey snapshots for tablet side swipe. This
   // will be nil before -createGreyCache is called and after -removeGreyCache
   // is called.
@@ -263,6 +355,8 @@ void ConvertAndSaveGreyImage(NSString* session_id,
 }
 
 @synthesize pinnedIDs = _pinnedIDs;
+@synthesize JPEGImageQuality = _JPEGImageQuality;
+@synthesize thumbnailJPEGImageQuality = _thumbnailJPEGImageQuality;
 @synthesize observers = _observers;
 @synthesize markedIDs = _markedIDs;
 
@@ -280,7 +374,13 @@ void ConvertAndSaveGreyImage(NSString* session_id,
   DCHECK_CALLED_ON_VALID_SEQUENCE(_sequenceChecker);
   if ((self = [super init])) {
     _lruCache =
-        [[SnapshotLRUCache alloc] initWithCacheSize:kLRUCacheMaxCapacity];
+        [[SnapshotLRUCache alloc] initWithCacheSize:kLRUCacheMaxCapacity
+                                            maxCost:kLRUCacheMaxCost];
+    _thumbnailCache =
+        [[SnapshotLRUCache alloc] initWithCacheSize:0
+                                            maxCost:kThumbnailCacheMaxCost];
+    _JPEGImageQuality = kDefaultJPEGImageQuality;
+    _thumbnailJPEGImageQuality = kDefaultThumbnailJPEGImageQuality;
     _cacheDirectory = cacheDirectory;
     _snapshotsScale = snapshotsScale;
 
@@ -338,10 +438,25 @@ void ConvertAndSaveGreyImage(NSString* session_id,
   DCHECK(callback);
 
   if (UIImage* image = [_lruCache objectForKey:sessionID]) {
+    UMA_HISTOGRAM_ENUMERATION("IOS.SnapshotCache.FullResolutionLookup",
+                              SnapshotCacheLookupResult::kMemoryHit);
     callback(image);
     return;
   }
 
+  [self readImageForSessionID:sessionID
+                     callback:^(UIImage* image) {
+                       UMA_HISTOGRAM_ENUMERATION(
+                           "IOS.SnapshotCache.FullResolutionLookup",
+                           image ? SnapshotCacheLookupResult::kDiskHit
+                                 : SnapshotCacheLookupResult::kMiss);
+                       callback(image);
+                     }];
+}
+
+- (void)readImageForSessionID:(NSString*)sessionID
+                     callback:(void (^)(UIImage*))callback {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(_sequenceChecker);
   if (!_taskRunner) {
     callback(nil);
     return;
@@ -360,30 +475,106 @@ void ConvertAndSaveGreyImage(NSString* session_id,
             sessionID, IMAGE_TYPE_COLOR, snapshotsScale, cacheDirectory));
       }),
       base::BindOnce(^(base::scoped_nsobject<UIImage> image) {
-        if (image)
-          [weakLRUCache setObject:image forKey:sessionID];
+        if (image) {
+          [weakLRUCache setObject:image
+                           forKey:sessionID
+                             cost:ImageCost(image)];
+        }
         callback(image);
       }));
 }
 
+- (void)retrieveThumbnailForSessionID:(NSString*)sessionID
+                             callback:(void (^)(UIImage*))callback {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(_sequenceChecker);
+  DCHECK(sessionID);
+  DCHECK(callback);
+
+  if (UIImage* thumbnail = [_thumbnailCache objectForKey:sessionID]) {
+    UMA_HISTOGRAM_ENUMERATION("IOS.SnapshotCache.ThumbnailLookup",
+                              SnapshotCacheLookupResult::kMemoryHit);
+    callback(thumbnail);
+    return;
+  }
+
+  if (!_taskRunner) {
+    callback(nil);
+    return;
+  }
+
+  // Copy ivars used by the block so that it does not reference |self|.
+  const base::FilePath cacheDirectory = _cacheDirectory;
+  const ImageScale snapshotsScale = _snapshotsScale;
+  const CGFloat thumbnailJPEGImageQuality = _thumbnailJPEGImageQuality;
+
+  __weak SnapshotLRUCache* weakThumbnailCache = _thumbnailCache;
+  base::PostTaskAndReplyWithResult(
+      _taskRunner.get(), FROM_HERE,
+      base::BindOnce(^base::scoped_nsobject<UIImage>() {
+        UIImage* thumbnail = ReadImageForSessionFromDisk(
+            sessionID, IMAGE_TYPE_THUMBNAIL, snapshotsScale, cacheDirectory);
+        if (thumbnail)
+          return base::scoped_nsobject<UIImage>(thumbnail);
+
+        // Snapshots saved before thumbnails existed only have the full
+        // resolution image on disk.
+        UIImage* image = ReadImageForSessionFromDisk(
+            sessionID, IMAGE_TYPE_COLOR, snapshotsScale, cacheDirectory);
+        if (!image)
+          return base::scoped_nsobject<UIImage>();
+        thumbnail = ThumbnailImage(image);
+        WriteImageToDisk(thumbnail,
+                         ImagePath(sessionID, IMAGE_TYPE_THUMBNAIL,
+                                   snapshotsScale, cacheDirectory),
+                         thumbnailJPEGImageQuality);
+        return base::scoped_nsobject<UIImage>(thumbnail);
+      }),
+      base::BindOnce(^(base::scoped_nsobject<UIImage> thumbnail) {
+        UMA_HISTOGRAM_ENUMERATION("IOS.SnapshotCache.ThumbnailLookup",
+                                  thumbnail
+                                      ? SnapshotCacheLookupResult::kDiskHit
+                                      : SnapshotCacheLookupResult::kMiss);
+        if (thumbnail) {
+          [weakThumbnailCache setObject:thumbnail
+                                 forKey:sessionID
+                                   cost:ImageCost(thumbnail)];
+        }
+        callback(thumbnail);
+      }));
+}
+
 - (void)setImage:(UIImage*)image withSessionID:(NSString*)sessionID {
   DCHECK_CALLED_ON_VALID_SEQUENCE(_sequenceChecker);
   if (!image || !sessionID || !_taskRunner)
     return;
 
-  [_lruCache setObject:image forKey:sessionID];
+  [_lruCache setObject:image forKey:sessionID cost:ImageCost(image)];
+  // The thumbnail is outdated until it has been rebuilt from |image|.
+  [_thumbnailCache removeObjectForKey:sessionID];
 
   [self.observers snapshotCache:self didUpdateSnapshotForIdentifier:sessionID];
 
   // Copy ivars used by the block so that it does not reference |self|.
   const base::FilePath cacheDirectory = _cacheDirectory;
   const ImageScale snapshotsScale = _snapshotsScale;
+  const CGFloat JPEGImageQuality = _JPEGImageQuality;
+  const CGFloat thumbnailJPEGImageQuality = _thumbnailJPEGImageQuality;
 
-  // Save the image to disk.
-  _taskRunner->PostTask(
-      FROM_HERE, base::BindOnce(^{
-        WriteImageToDisk(image, ImagePath(sessionID, IMAGE_TYPE_COLOR,
-                                          snapshotsScale, cacheDirectory));
+  // Save the image and its thumbnail to disk.
+  __weak SnapshotLRUCache* weakThumbnailCache = _thumbnailCache;
+  base::PostTaskAndReplyWithResult(
+      _taskRunner.get(), FROM_HERE,
+      base::BindOnce(^base::scoped_nsobject<UIImage>() {
+        return base::scoped_nsobject<UIImage>(WriteImageAndThumbnailToDisk(
+            image, sessionID, snapshotsScale, cacheDirectory, JPEGImageQuality,
+            thumbnailJPEGImageQuality));
+      }),
+      base::BindOnce(^(base::scoped_nsobject<UIImage> thumbnail) {
+        if (thumbnail) {
+          [weakThumbnailCache setObject:thumbnail
+                                 forKey:sessionID
+                                   cost:ImageCost(thumbnail)];
+        }
       }));
 }
 
@@ -394,6 +585,7 @@ void ConvertAndSaveGreyImage(NSString* session_id,
     return;
 
   [_lruCache removeObjectForKey:sessionID];
+  [_thumbnailCache removeObjectForKey:sessionID];
 
   [self.observers snapshotCache:self didUpdateSnapshotForIdentifier:sessionID];
 
@@ -500,21 +692,33 @@ void ConvertAndSaveGreyImage(NSString* session_id,
       [dictionary setObject:image forKey:sessionID];
   }
   [_lruCache removeAllObjects];
-  for (NSString* sessionID in self.pinnedIDs)
-    [_lruCache setObject:[dictionary objectForKey:sessionID] forKey:sessionID];
+  for (NSString* sessionID in dictionary) {
+    UIImage* image = [dictionary objectForKey:sessionID];
+    [_lruCache setObject:image forKey:sessionID cost:ImageCost(image)];
+  }
+
+  // Thumbnails are cheap to reload, but keep the most recently used ones so
+  // that the tab grid does not have to reload all of them.
+  [_thumbnailCache evictObjectsToCost:kThumbnailCacheMaxCost / 2];
 }
 
 - (void)handleEnterBackground {
   DCHECK_CALLED_ON_VALID_SEQUENCE(_sequenceChecker);
   [_lruCache removeAllObjects];
+  [_thumbnailCache removeAllObjects];
 }
 
 - (void)handleBecomeActive {
   DCHECK_CALLED_ON_VALID_SEQUENCE(_sequenceChecker);
-  for (NSString* sessionID in self.pinnedIDs)
-    [self retrieveImageForSessionID:sessionID
-                           callback:^(UIImage*){
-                           }];
+  // Reloading the pinned snapshots is not a lookup, so it is not recorded in
+  // the hit rate histograms.
+  for (NSString* sessionID in self.pinnedIDs) {
+    if (![_lruCache objectForKey:sessionID]) {
+      [self readImageForSessionID:sessionID
+                         callback:^(UIImage*){
+                         }];
+    }
+  }
 }
 
 - (void)saveGreyImage:(UIImage*)greyImage forKey:(NSString*)sessionID {
@@ -527,36 +731,64 @@ void ConvertAndSaveGreyImage(NSString* session_id,
   }
 }
 
-- (void)loadGreyImageAsync:(NSString*)sessionID {
+- (void)loadGreyImagesAsync:(NSArray*)sessionIDs {
   DCHECK_CALLED_ON_VALID_SEQUENCE(_sequenceChecker);
   // Don't call -retrieveImageForSessionID here because it caches the colored
-  // image, which we don't need for the grey image cache. But if the image is
-  // already in the cache, use it.
-  UIImage* image = [_lruCache objectForKey:sessionID];
+  // images, which we don't need for the grey image cache. But if the images
+  // are already in the cache, use them.
+  NSMutableDictionary<NSString*, UIImage*>* images =
+      [NSMutableDictionary dictionaryWithCapacity:sessionIDs.count];
+  NSMutableArray<NSString*>* uncachedSessionIDs = [NSMutableArray array];
+  for (NSString* sessionID in sessionIDs) {
+    if (UIImage* image = [_lruCache objectForKey:sessionID]) {
+      images[sessionID] = image;
+    } else {
+      [uncachedSessionIDs addObject:sessionID];
+    }
+  }
 
-  if (!_taskRunner)
+  __weak SnapshotCache* weakSelf = self;
+  void (^saveGreyImage)(NSString*, UIImage*) =
+      ^(NSString* sessionID, UIImage* greyImage) {
+        [weakSelf saveGreyImage:greyImage forKey:sessionID];
+      };
+  ConvertImagesToGrey(images, saveGreyImage);
+
+  if (uncachedSessionIDs.count == 0)
     return;
+  if (!_taskRunner) {
+    for (NSString* sessionID in uncachedSessionIDs)
+      saveGreyImage(sessionID, nil);
+    return;
+  }
 
   // Copy ivars used by the block so that it does not reference |self|.
   const base::FilePath cacheDirectory = _cacheDirectory;
   const ImageScale snapshotsScale = _snapshotsScale;
 
-  __weak SnapshotCache* weakSelf = self;
+  // The images are read on |_taskRunner| so that pending writes complete
+  // first, and converted in parallel on the thread pool.
   base::PostTaskAndReplyWithResult(
       _taskRunner.get(), FROM_HERE,
-      base::BindOnce(^base::scoped_nsobject<UIImage>() {
-        // If the image is not in the cache, load it from disk.
-        UIImage* localImage = image;
-        if (!localImage) {
-          localImage = ReadImageForSessionFromDisk(
+      base::BindOnce(^base::scoped_nsobject<NSDictionary>() {
+        NSMutableDictionary<NSString*, UIImage*>* diskImages =
+            [NSMutableDictionary dictionary];
+        for (NSString* sessionID in uncachedSessionIDs) {
+          UIImage* image = ReadImageForSessionFromDisk(
               sessionID, IMAGE_TYPE_COLOR, snapshotsScale, cacheDirectory);
+          if (image)
+            diskImages[sessionID] = image;
         }
-        if (localImage)
-          localImage = GreyImage(localImage);
-        return base::scoped_nsobject<UIImage>(localImage);
+        return base::scoped_nsobject<NSDictionary>([diskImages copy]);
       }),
-      base::BindOnce(^(base::scoped_nsobject<UIImage> greyImage) {
-        [weakSelf saveGreyImage:greyImage forKey:sessionID];
+      base::BindOnce(^(base::scoped_nsobject<NSDictionary> diskImages) {
+        ConvertImagesToGrey(diskImages, saveGreyImage);
+        // Sessions without a snapshot on disk get no grey image, which still
+        // runs the callback waiting for it.
+        for (NSString* sessionID in uncachedSessionIDs) {
+          if (![diskImages objectForKey:sessionID])
+            saveGreyImage(sessionID, nil);
+        }
       }));
 }
 
@@ -564,8 +796,7 @@ void ConvertAndSaveGreyImage(NSString* session_id,
   DCHECK_CALLED_ON_VALID_SEQUENCE(_sequenceChecker);
   _greyImageDictionary =
       [NSMutableDictionary dictionaryWithCapacity:kGreyInitialCapacity];
-  for (NSString* sessionID in sessionIDs)
-    [self loadGreyImageAsync:sessionID];
+  [self loadGreyImagesAsync:sessionIDs];
 }
 
 - (void)removeGreyCache {
@@ -660,11 +891,13 @@ void ConvertAndSaveGreyImage(NSString* session_id,
   UIImage* backgroundingColorImage = _backgroundingColorImage;
   const base::FilePath cacheDirectory = _cacheDirectory;
   const ImageScale snapshotsScale = _snapshotsScale;
+  const CGFloat JPEGImageQuality = _JPEGImageQuality;
 
   _taskRunner->PostTask(
       FROM_HERE, base::BindOnce(^{
         ConvertAndSaveGreyImage(sessionID, snapshotsScale,
-                                backgroundingColorImage, cacheDirectory);
+                                backgroundingColorImage, cacheDirectory,
+                                JPEGImageQuality);
       }));
 }
 
@@ -688,6 +921,10 @@ void ConvertAndSaveGreyImage(NSString* session_id,
   return [_lruCache objectForKey:sessionID] != nil;
 }
 
+- (BOOL)hasThumbnailInMemory:(NSString*)sessionID {
+  return [_thumbnailCache objectForKey:sessionID] != nil;
+}
+
 - (BOOL)hasGreyImageInMemory:(NSString*)sessionID {
   return [_greyImageDictionary objectForKey:sessionID] != nil;
 }
@@ -14,6 +14,7 @@
 #include "base/run_loop.h"
 #include "base/strings/sys_string_conversions.h"
 #include "base/task/thread_pool/thread_pool_instance.h"
+#include "base/test/metrics/histogram_tester.h"
 #include "base/time/time.h"
 #import "ios/chrome/browser/snapshots/snapshot_cache_internal.h"
 #import "ios/chrome/browser/snapshots/snapshot_cache_observer.h"
@@ -267,6 +268,8 @@ TEST_F(SnapshotCacheTest, Cache) {
 // The snapshots are then reloaded from the disk, and the colors are compared.
 TEST_F(SnapshotCacheTest, SaveToDisk) {
   SnapshotCache* cache = GetSnapshotCache();
+  // Do not compress the images, so that their colors can be compared.
+  cache.JPEGImageQuality = 1.0;
 
   // Put all images in the cache.
   for (NSUInteger i = 0; i < kSessionCount; ++i) {
@@ -393,6 +396,67 @@ TEST_F(SnapshotCacheTest, HandleMemoryWarning) {
   FlushRunLoops();
 }
 
+// Loads the color images into the cache, and checks that their thumbnails are
+// kept in memory, shrunk on memory warnings, and rebuilt from disk.
+TEST_F(SnapshotCacheTest, Thumbnails) {
+  base::HistogramTester histogram_tester;
+  LoadAllColorImagesIntoCache(true);
+
+  SnapshotCache* cache = GetSnapshotCache();
+  NSString* sessionID = [testSessions_ objectAtIndex:0];
+  UIImage* image = [testImages_ objectAtIndex:0];
+  EXPECT_TRUE([cache hasThumbnailInMemory:sessionID]);
+
+  __block UIImage* thumbnail = nil;
+  [cache retrieveThumbnailForSessionID:sessionID
+                              callback:^(UIImage* retrievedThumbnail) {
+                                thumbnail = retrievedThumbnail;
+                              }];
+  ASSERT_TRUE(thumbnail);
+  EXPECT_TRUE(CGSizeEqualToSize(image.size, thumbnail.size));
+  EXPECT_LT(CGImageGetWidth(thumbnail.CGImage),
+            CGImageGetWidth(image.CGImage));
+  histogram_tester.ExpectUniqueSample("IOS.SnapshotCache.ThumbnailLookup",
+                                      /*kMemoryHit=*/0, 1);
+
+  // The thumbnails are small enough to survive a memory warning.
+  TriggerMemoryWarning();
+  EXPECT_TRUE([cache hasThumbnailInMemory:sessionID]);
+
+  // Thumbnails are reloaded from disk once the application is backgrounded.
+  [[NSNotificationCenter defaultCenter]
+      postNotificationName:UIApplicationDidEnterBackgroundNotification
+                    object:nil];
+  EXPECT_FALSE([cache hasThumbnailInMemory:sessionID]);
+  EXPECT_FALSE([cache hasImageInMemory:sessionID]);
+
+  thumbnail = nil;
+  [cache retrieveThumbnailForSessionID:sessionID
+                              callback:^(UIImage* retrievedThumbnail) {
+                                thumbnail = retrievedThumbnail;
+                              }];
+  EXPECT_FALSE(thumbnail);
+  FlushRunLoops();
+  ASSERT_TRUE(thumbnail);
+  EXPECT_TRUE(CGSizeEqualToSize(image.size, thumbnail.size));
+  EXPECT_TRUE([cache hasThumbnailInMemory:sessionID]);
+  // Retrieving the thumbnail does not load the full resolution snapshot.
+  EXPECT_FALSE([cache hasImageInMemory:sessionID]);
+  histogram_tester.ExpectBucketCount("IOS.SnapshotCache.ThumbnailLookup",
+                                     /*kDiskHit=*/1, 1);
+
+  [cache removeImageWithSessionID:sessionID];
+  FlushRunLoops();
+  [cache retrieveThumbnailForSessionID:sessionID
+                              callback:^(UIImage* retrievedThumbnail) {
+                                thumbnail = retrievedThumbnail;
+                              }];
+  FlushRunLoops();
+  EXPECT_FALSE(thumbnail);
+  histogram_tester.ExpectBucketCount("IOS.SnapshotCache.ThumbnailLookup",
+                                     /*kMiss=*/2, 1);
+}
+
 // Tests that createGreyCache creates the grey snapshots in the background,
 // from color images in the in-memory cache.  When the grey images are all
 // loaded into memory, tests that the request to retrieve the grey snapshot
@@ -502,6 +566,25 @@ TEST_F(SnapshotCacheTest, MostRecentGreyBlock) {
   EXPECT_TRUE(thirdCallbackCalled);
 }
 
+// Tests that the callback waiting for the grey image of a session without a
+// snapshot on disk is called with nil.
+TEST_F(SnapshotCacheTest, MostRecentGreyBlockWithoutSnapshot) {
+  SnapshotCache* cache = GetSnapshotCache();
+  NSString* sessionID = @"SessionWithoutSnapshot";
+  [cache createGreyCache:@[ sessionID ]];
+
+  __block BOOL callbackCalled = NO;
+  [cache greyImageForSessionID:sessionID
+                      callback:^(UIImage* image) {
+                        EXPECT_FALSE(image);
+                        callbackCalled = YES;
+                      }];
+  FlushRunLoops();
+
+  EXPECT_TRUE(callbackCalled);
+  EXPECT_FALSE([cache hasGreyImageInMemory:sessionID]);
+}
+
 // Test the function used to save a grey copy of a color snapshot fully on a
 // background thread when the application is backgrounded.
 TEST_F(SnapshotCacheTest, GreyImageAllInBackground) {
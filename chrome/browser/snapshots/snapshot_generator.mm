@@ -104,6 +104,16 @@ BOOL ViewHierarchyContainsWKWebView(UIView* view) {
   }
 }
 
+- (void)retrieveThumbnail:(void (^)(UIImage*))callback {
+  DCHECK(callback);
+  if (self.snapshotCache) {
+    [self.snapshotCache retrieveThumbnailForSessionID:self.sessionID
+                                             callback:callback];
+  } else {
+    callback(nil);
+  }
+}
+
 - (void)retrieveGreySnapshot:(void (^)(UIImage*))callback {
   DCHECK(callback);
 
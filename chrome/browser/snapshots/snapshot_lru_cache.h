@@ -10,6 +10,8 @@
 // This class implements a cache with a limited size. Once the cache reach its
 // size limit, it will start to evict items in a Least Recently Used order
 // (where the term "used" is determined in terms of query to the cache).
+// The size can be limited by the number of items, by the total cost of the
+// items (e.g. their size in bytes), or both.
 @interface SnapshotLRUCache : NSObject
 
 // The maximum amount of items that the cache can hold before starting to
@@ -17,13 +19,27 @@
 // amount of elements (i.e. never evicts).
 @property(nonatomic, readonly) NSUInteger maxCacheSize;
 
+// The maximum total cost of the items that the cache can hold before starting
+// to evict. The value 0 is used to signify that the cost is not limited. The
+// most recently added item is never evicted for its cost.
+@property(nonatomic, readonly) NSUInteger maxCost;
+
+// The total cost of the items that the cache currently holds.
+@property(nonatomic, readonly) NSUInteger totalCost;
+
 // Use the initWithCacheSize: designated initializer. The is no good general
 // default value for the cache size.
 - (instancetype)init NS_UNAVAILABLE;
 
 // |maxCacheSize| value is used to specify the maximum amount of items that the
 // cache can hold before starting to evict items.
+- (instancetype)initWithCacheSize:(NSUInteger)maxCacheSize;
+
+// |maxCacheSize| and |maxCost| values are used to specify the maximum amount
+// of items and the maximum total cost of the items that the cache can hold
+// before starting to evict items.
 - (instancetype)initWithCacheSize:(NSUInteger)maxCacheSize
+                          maxCost:(NSUInteger)maxCost
     NS_DESIGNATED_INITIALIZER;
 
 // Query the cache for an item corresponding to the |key|. Returns nil if there
@@ -36,12 +52,22 @@
 // that key is replaced by |object|.
 - (void)setObject:(id<NSObject>)object forKey:(NSObject*)key;
 
+// Adds the pair |key|, |obj| to the cache with the given |cost|. Items are
+// evicted until both the maxCacheSize and maxCost limits are respected.
+- (void)setObject:(id<NSObject>)object
+           forKey:(NSObject*)key
+             cost:(NSUInteger)cost;
+
 // Remove the key, value pair corresponding to the given |key|.
 - (void)removeObjectForKey:(id<NSObject>)key;
 
 // Remove all objects from the cache.
 - (void)removeAllObjects;
 
+// Evicts the least recently used items until the total cost of the items is
+// at most |cost|.
+- (void)evictObjectsToCost:(NSUInteger)cost;
+
 // Returns the amount of items that the cache currently hold.
 - (NSUInteger)count;
 
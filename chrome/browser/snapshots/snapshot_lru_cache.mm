@@ -10,6 +10,7 @@
 #include <unordered_map>
 
 #include "base/containers/mru_cache.h"
+#include "base/logging.h"
 #include "base/macros.h"
 
 #if !defined(__has_feature) || !__has_feature(objc_arc)
@@ -34,47 +35,87 @@ struct MRUCacheNSObjectHashMap {
       std::unordered_map<KeyType, ValueType, HashType, NSObjectEqualTo>;
 };
 
+// An item of the cache, with its cost.
+struct CacheEntry {
+  id<NSObject> object;
+  NSUInteger cost;
+};
+
 using NSObjectMRUCache = base::MRUCacheBase<id<NSObject>,
-                                            id<NSObject>,
+                                            CacheEntry,
                                             NSObjectHash,
                                             MRUCacheNSObjectHashMap>;
 
 }  // namespace
 
 @implementation SnapshotLRUCache {
+  // Items are evicted explicitly so that |_totalCost| is kept up to date.
   std::unique_ptr<NSObjectMRUCache> _cache;
 }
 
+@synthesize maxCacheSize = _maxCacheSize;
+@synthesize maxCost = _maxCost;
+@synthesize totalCost = _totalCost;
+
 - (instancetype)initWithCacheSize:(NSUInteger)maxCacheSize {
+  return [self initWithCacheSize:maxCacheSize maxCost:0];
+}
+
+- (instancetype)initWithCacheSize:(NSUInteger)maxCacheSize
+                          maxCost:(NSUInteger)maxCost {
   if ((self = [super init])) {
-    _cache = std::make_unique<NSObjectMRUCache>(maxCacheSize);
+    _cache =
+        std::make_unique<NSObjectMRUCache>(NSObjectMRUCache::NO_AUTO_EVICT);
+    _maxCacheSize = maxCacheSize;
+    _maxCost = maxCost;
   }
   return self;
 }
 
-- (NSUInteger)maxCacheSize {
-  return _cache->max_size();
-}
-
 - (id)objectForKey:(id<NSObject>)key {
   auto it = _cache->Get(key);
   if (it == _cache->end())
     return nil;
-  return it->second;
+  return it->second.object;
 }
 
 - (void)setObject:(id<NSObject>)value forKey:(NSObject*)key {
-  _cache->Put([key copy], value);
+  [self setObject:value forKey:key cost:0];
+}
+
+- (void)setObject:(id<NSObject>)value
+           forKey:(NSObject*)key
+             cost:(NSUInteger)cost {
+  [self removeObjectForKey:key];
+  if (_maxCacheSize) {
+    while (_cache->size() >= _maxCacheSize)
+      [self evictLeastRecentlyUsedObject];
+  }
+  _cache->Put([key copy], CacheEntry{value, cost});
+  _totalCost += cost;
+
+  if (_maxCost) {
+    while (_totalCost > _maxCost && _cache->size() > 1)
+      [self evictLeastRecentlyUsedObject];
+  }
 }
 
 - (void)removeObjectForKey:(id<NSObject>)key {
   auto it = _cache->Peek(key);
-  if (it != _cache->end())
+  if (it != _cache->end()) {
+    _totalCost -= it->second.cost;
     _cache->Erase(it);
+  }
 }
 
 - (void)removeAllObjects {
   _cache->Clear();
+  _totalCost = 0;
+}
+
+- (void)evictObjectsToCost:(NSUInteger)cost {
+  while (_totalCost > cost && !_cache->empty())
+    [self evictLeastRecentlyUsedObject];
 }
 
 - (NSUInteger)count {
@@ -85,4 +126,14 @@ using NSObjectMRUCache = base::MRUCacheBase<id<NSObject>,
   return _cache->empty();
 }
 
+#pragma mark - Private
+
+// Removes the least recently used item from the cache.
+- (void)evictLeastRecentlyUsedObject {
+  auto it = _cache->rbegin();
+  DCHECK(it != _cache->rend());
+  _totalCost -= it->second.cost;
+  _cache->Erase(it);
+}
+
 @end
@@ -48,4 +48,40 @@ TEST_F(SnapshotLRUCacheTest, Basic) {
   EXPECT_TRUE([cache isEmpty]);
 }
 
+// Tests that items are evicted once their total cost exceeds the maximum cost.
+TEST_F(SnapshotLRUCacheTest, Cost) {
+  SnapshotLRUCache* cache = [[SnapshotLRUCache alloc] initWithCacheSize:0
+                                                                maxCost:10];
+
+  [cache setObject:@"Value 1" forKey:@"VALUE 1" cost:4];
+  [cache setObject:@"Value 2" forKey:@"VALUE 2" cost:4];
+  EXPECT_EQ(8u, [cache totalCost]);
+
+  // Replacing an item replaces its cost.
+  [cache setObject:@"Value 2" forKey:@"VALUE 2" cost:2];
+  EXPECT_EQ(6u, [cache totalCost]);
+
+  // Use the first item, so that the second one is evicted.
+  EXPECT_TRUE([cache objectForKey:@"VALUE 1"]);
+  [cache setObject:@"Value 3" forKey:@"VALUE 3" cost:5];
+  EXPECT_EQ(2u, [cache count]);
+  EXPECT_EQ(9u, [cache totalCost]);
+  EXPECT_FALSE([cache objectForKey:@"VALUE 2"]);
+
+  // An item more costly than the maximum cost is kept alone.
+  [cache setObject:@"Value 4" forKey:@"VALUE 4" cost:20];
+  EXPECT_EQ(1u, [cache count]);
+  EXPECT_TRUE([cache objectForKey:@"VALUE 4"]);
+
+  [cache setObject:@"Value 5" forKey:@"VALUE 5" cost:1];
+  EXPECT_EQ(1u, [cache count]);
+  [cache setObject:@"Value 6" forKey:@"VALUE 6" cost:1];
+  [cache evictObjectsToCost:1];
+  EXPECT_EQ(1u, [cache count]);
+  EXPECT_TRUE([cache objectForKey:@"VALUE 6"]);
+
+  [cache removeObjectForKey:@"VALUE 6"];
+  EXPECT_EQ(0u, [cache totalCost]);
+}
+
 }  // namespace
@@ -44,6 +44,14 @@ class SnapshotTabHelper : public infobars::InfoBarManager::Observer,
   // snapshot does not exist.
   void RetrieveColorSnapshot(void (^callback)(UIImage*));
 
+  // Retrieves a low resolution thumbnail of the color snapshot for the current
+  // page, suitable for the tab grid, invoking |callback| with the image. The
+  // callback may be called synchronously is there is a cached thumbnail
+  // available in memory, otherwise it will be invoked asynchronously after
+  // retrieved from disk. Invokes |callback| with nil if a snapshot does not
+  // exist.
+  void RetrieveThumbnail(void (^callback)(UIImage*));
+
   // Retrieves a grey snapshot for the current page, invoking |callback|
   // with the image. The callback may be called synchronously is there is
   // a cached snapshot available in memory, otherwise it will be invoked
@@ -61,6 +61,10 @@ void SnapshotTabHelper::RetrieveColorSnapshot(void (^callback)(UIImage*)) {
   [snapshot_generator_ retrieveSnapshot:callback];
 }
 
+void SnapshotTabHelper::RetrieveThumbnail(void (^callback)(UIImage*)) {
+  [snapshot_generator_ retrieveThumbnail:callback];
+}
+
 void SnapshotTabHelper::RetrieveGreySnapshot(void (^callback)(UIImage*)) {
   [snapshot_generator_ retrieveGreySnapshot:callback];
 }
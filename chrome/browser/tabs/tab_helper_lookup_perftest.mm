@@ -0,0 +1,120 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+
+#include <utility>
+
+#include "base/macros.h"
+#include "base/timer/elapsed_timer.h"
+#include "ios/chrome/test/base/perf_test_ios.h"
+#import "ios/web/public/test/fakes/test_web_state.h"
+#import "ios/web/public/web_state_user_data.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Number of tab helper types attached to the WebState, about as many as
+// AttachTabHelpers() attaches.
+const size_t kTabHelperCount = 40;
+
+// Number of times each tab helper is looked up by each run.
+const int kLookupCount = 100000;
+
+// A tab helper type, distinct for each |N|.
+template <size_t N>
+class FakeTabHelper : public web::WebStateUserData<FakeTabHelper<N>> {
+ public:
+  ~FakeTabHelper() override = default;
+
+ private:
+  explicit FakeTabHelper(web::WebState* web_state) {}
+  friend class web::WebStateUserData<FakeTabHelper<N>>;
+  WEB_STATE_USER_DATA_KEY_DECL();
+};
+
+template <size_t N>
+constexpr int FakeTabHelper<N>::kUserDataKey;
+
+template <size_t... N>
+void CreateTabHelpers(web::WebState* web_state, std::index_sequence<N...>) {
+  int unused[] = {(FakeTabHelper<N>::CreateForWebState(web_state), 0)...};
+  ALLOW_UNUSED_LOCAL(unused);
+}
+
+// Looks up the tab helpers with FromWebState(), and returns how many were
+// found.
+template <size_t... N>
+size_t FromWebState(web::WebState* web_state, std::index_sequence<N...>) {
+  size_t found = 0;
+  int unused[] = {
+      (found += !!FakeTabHelper<N>::FromWebState(web_state), 0)...};
+  ALLOW_UNUSED_LOCAL(unused);
+  return found;
+}
+
+// Looks up the tab helpers in the user data map, and returns how many were
+// found.
+template <size_t... N>
+size_t GetUserData(web::WebState* web_state, std::index_sequence<N...>) {
+  size_t found = 0;
+  int unused[] = {
+      (found += !!web_state->GetUserData(FakeTabHelper<N>::UserDataKey()),
+       0)...};
+  ALLOW_UNUSED_LOCAL(unused);
+  return found;
+}
+
+class TabHelperLookupPerfTest : public PerfTest {
+ protected:
+  TabHelperLookupPerfTest() : PerfTest("Tab helper lookup") {
+    CreateTabHelpers(&web_state_, std::make_index_sequence<kTabHelperCount>());
+  }
+
+  web::TestWebState web_state_;
+};
+
+// Tests looking up 40 tab helpers with FromWebState(), which uses the slots of
+// the tab helpers.
+TEST_F(TabHelperLookupPerfTest, FromWebState) {
+  web::WebState* web_state = &web_state_;
+  RepeatTimedRuns("FromWebState for 40 tab helpers",
+                  ^base::TimeDelta(int) {
+                    base::ElapsedTimer timer;
+                    size_t found = 0;
+                    for (int i = 0; i < kLookupCount; ++i) {
+                      found += FromWebState(
+                          web_state,
+                          std::make_index_sequence<kTabHelperCount>());
+                    }
+                    base::TimeDelta elapsed = timer.Elapsed();
+                    EXPECT_EQ(kTabHelperCount * kLookupCount, found);
+                    return elapsed;
+                  },
+                  nil);
+}
+
+// Tests looking up 40 tab helpers in the user data map, as a baseline.
+TEST_F(TabHelperLookupPerfTest, GetUserData) {
+  web::WebState* web_state = &web_state_;
+  RepeatTimedRuns("GetUserData for 40 tab helpers",
+                  ^base::TimeDelta(int) {
+                    base::ElapsedTimer timer;
+                    size_t found = 0;
+                    for (int i = 0; i < kLookupCount; ++i) {
+                      found += GetUserData(
+                          web_state,
+                          std::make_index_sequence<kTabHelperCount>());
+                    }
+                    base::TimeDelta elapsed = timer.Elapsed();
+                    EXPECT_EQ(kTabHelperCount * kLookupCount, found);
+                    return elapsed;
+                  },
+                  nil);
+}
+
+}  // namespace
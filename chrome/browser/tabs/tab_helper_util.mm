@@ -8,6 +8,7 @@
 #error "This file requires ARC support."
 #endif
 
+#include "base/bind.h"
 #include "base/feature_list.h"
 #import "components/favicon/ios/web_favicon_driver.h"
 #include "components/history/core/browser/top_sites.h"
@@ -84,14 +85,11 @@ void AttachTabHelpers(web::WebState* web_state, bool for_prerender) {
   IOSChromeSyncedTabDelegate::CreateForWebState(web_state);
   InfoBarManagerImpl::CreateForWebState(web_state);
   BlockedPopupTabHelper::CreateForWebState(web_state);
-  FindTabHelper::CreateForWebState(web_state);
   U2FTabHelper::CreateForWebState(web_state);
-  StoreKitTabHelper::CreateForWebState(web_state);
   JavaScriptConsoleTabHelper::CreateForWebState(web_state);
   ITunesUrlsHandlerTabHelper::CreateForWebState(web_state);
   HistoryTabHelper::CreateForWebState(web_state);
   LoadTimingTabHelper::CreateForWebState(web_state);
-  OverscrollActionsTabHelper::CreateForWebState(web_state);
   IOSTaskTabHelper::CreateForWebState(web_state);
 
   if (base::FeatureList::IsEnabled(kInfobarOverlayUI)) {
@@ -103,17 +101,10 @@ void AttachTabHelpers(web::WebState* web_state, bool for_prerender) {
     CaptivePortalMetricsTabHelper::CreateForWebState(web_state);
   }
 
-  if (base::FeatureList::IsEnabled(web::kWebPageTextAccessibility)) {
-    FontSizeTabHelper::CreateForWebState(web_state);
-  }
-
   if (base::FeatureList::IsEnabled(kLogBreadcrumbs)) {
     BreadcrumbManagerTabHelper::CreateForWebState(web_state);
   }
 
-  ImageFetchTabHelper::CreateForWebState(web_state);
-
-  OpenInTabHelper::CreateForWebState(web_state);
   ios::ChromeBrowserState* original_browser_state =
       browser_state->GetOriginalChromeBrowserState();
   favicon::WebFaviconDriver::CreateForWebState(
@@ -142,7 +133,23 @@ void AttachTabHelpers(web::WebState* web_state, bool for_prerender) {
 
   ukm::InitializeSourceUrlRecorderForWebState(web_state);
 
-  ARQuickLookTabHelper::CreateForWebState(web_state);
+  // The following tab helpers are only used once the user interacts with the
+  // page, so their creation is deferred until they are first used, or until
+  // the WebState is first shown or starts its first navigation. Restored tabs
+  // which are never shown do not pay for them. Tab helpers which must observe
+  // the WebState before it is realized, such as policy deciders, must not be
+  // created lazily.
+  FindTabHelper::CreateLazilyForWebState(web_state);
+  StoreKitTabHelper::CreateLazilyForWebState(web_state);
+  OverscrollActionsTabHelper::CreateLazilyForWebState(web_state);
+  ImageFetchTabHelper::CreateLazilyForWebState(web_state);
+  OpenInTabHelper::CreateLazilyForWebState(
+      web_state, base::BindOnce(&OpenInTabHelper::CreateForWebState));
+  ARQuickLookTabHelper::CreateLazilyForWebState(
+      web_state, base::BindOnce(&ARQuickLookTabHelper::CreateForWebState));
+  if (base::FeatureList::IsEnabled(web::kWebPageTextAccessibility)) {
+    FontSizeTabHelper::CreateLazilyForWebState(web_state);
+  }
 
   // TODO(crbug.com/794115): pre-rendered WebState have lots of unnecessary
   // tab helpers for historical reasons. For the moment, AttachTabHelpers
@@ -153,7 +160,7 @@ void AttachTabHelpers(web::WebState* web_state, bool for_prerender) {
     SadTabTabHelper::CreateForWebState(web_state);
     SnapshotTabHelper::CreateForWebState(web_state, tab_id);
     PagePlaceholderTabHelper::CreateForWebState(web_state);
-    PrintTabHelper::CreateForWebState(web_state);
+    PrintTabHelper::CreateLazilyForWebState(web_state);
     InfobarBadgeTabHelper::CreateForWebState(web_state);
   }
 
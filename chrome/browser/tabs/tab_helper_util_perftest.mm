@@ -0,0 +1,153 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/tabs/tab_helper_util.h"
+
+#import <UIKit/UIKit.h>
+#include <mach/mach.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/timer/elapsed_timer.h"
+#include "ios/chrome/browser/browser_state/test_chrome_browser_state.h"
+#import "ios/chrome/browser/download/ar_quick_look_tab_helper.h"
+#include "ios/chrome/browser/favicon/favicon_service_factory.h"
+#include "ios/chrome/browser/favicon/ios_chrome_favicon_loader_factory.h"
+#include "ios/chrome/browser/favicon/ios_chrome_large_icon_service_factory.h"
+#import "ios/chrome/browser/main/test_browser.h"
+#import "ios/chrome/browser/open_in/open_in_tab_helper.h"
+#include "ios/chrome/browser/search_engines/template_url_service_factory.h"
+#import "ios/chrome/browser/ui/download/ar_quick_look_coordinator.h"
+#import "ios/chrome/browser/ui/open_in/open_in_mediator.h"
+#import "ios/chrome/browser/web_state_list/fake_web_state_list_delegate.h"
+#import "ios/chrome/browser/web_state_list/web_state_list.h"
+#import "ios/chrome/browser/web_state_list/web_state_opener.h"
+#include "ios/chrome/test/base/perf_test_ios.h"
+#include "ios/chrome/test/ios_chrome_scoped_testing_local_state.h"
+#import "ios/web/public/web_state.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Number of WebStates restored, as for a large session.
+const int kWebStateCount = 500;
+
+// Returns the physical memory footprint of the process, in bytes.
+double GetPhysicalFootprint() {
+  task_vm_info_data_t info;
+  mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+  if (task_info(mach_task_self(), TASK_VM_INFO,
+                reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+    return 0;
+  }
+  return info.phys_footprint;
+}
+
+class TabHelperUtilPerfTest : public PerfTest {
+ protected:
+  TabHelperUtilPerfTest() : PerfTest("Tab helpers") {
+    TestChromeBrowserState::Builder builder;
+    builder.AddTestingFactory(
+        ios::TemplateURLServiceFactory::GetInstance(),
+        ios::TemplateURLServiceFactory::GetDefaultFactory());
+    builder.AddTestingFactory(
+        IOSChromeLargeIconServiceFactory::GetInstance(),
+        IOSChromeLargeIconServiceFactory::GetDefaultFactory());
+    builder.AddTestingFactory(
+        IOSChromeFaviconLoaderFactory::GetInstance(),
+        IOSChromeFaviconLoaderFactory::GetDefaultFactory());
+    builder.AddTestingFactory(ios::FaviconServiceFactory::GetInstance(),
+                              ios::FaviconServiceFactory::GetDefaultFactory());
+    chrome_browser_state_ = builder.Build();
+    EXPECT_TRUE(chrome_browser_state_->CreateHistoryService(true));
+  }
+
+  IOSChromeScopedTestingLocalState local_state_;
+  std::unique_ptr<TestChromeBrowserState> chrome_browser_state_;
+};
+
+// Tests attaching the tab helpers to the WebStates of a large session, which
+// are not shown.
+TEST_F(TabHelperUtilPerfTest, AttachTabHelpersToRestoredWebStates) {
+  const double footprint_before = GetPhysicalFootprint();
+  __block std::vector<std::unique_ptr<web::WebState>> web_states;
+  RepeatTimedRuns(
+      "Attach tab helpers to 500 WebStates",
+      ^base::TimeDelta(int) {
+        web::WebState::CreateParams params(chrome_browser_state_.get());
+        base::ElapsedTimer timer;
+        for (int i = 0; i < kWebStateCount; ++i) {
+          web_states.push_back(web::WebState::Create(params));
+          AttachTabHelpers(web_states.back().get(), /*for_prerender=*/false);
+        }
+        return timer.Elapsed();
+      },
+      ^{
+        LogPerfValue("Footprint of 500 WebStates",
+                     (GetPhysicalFootprint() - footprint_before) / 1024,
+                     "KB");
+        web_states.clear();
+      });
+}
+
+// Tests inserting the WebStates of a large session, which are not shown, into
+// a WebStateList observed by the objects installing delegates on their tab
+// helpers. Installing the delegates must not create the lazy tab helpers.
+TEST_F(TabHelperUtilPerfTest, InsertRestoredWebStatesIntoObservedList) {
+  FakeWebStateListDelegate web_state_list_delegate;
+  WebStateList web_state_list_storage(&web_state_list_delegate);
+  TestBrowser browser(chrome_browser_state_.get(), &web_state_list_storage);
+  // The blocks below cannot copy the WebStateList, so they capture a pointer.
+  WebStateList* web_state_list = browser.GetWebStateList();
+  OpenInMediator* open_in_mediator =
+      [[OpenInMediator alloc] initWithWebStateList:web_state_list];
+  ARQuickLookCoordinator* ar_quick_look_coordinator =
+      [[ARQuickLookCoordinator alloc]
+          initWithBaseViewController:[[UIViewController alloc] init]
+                             browser:&browser];
+  [ar_quick_look_coordinator start];
+
+  const double footprint_before = GetPhysicalFootprint();
+  RepeatTimedRuns(
+      "Insert 500 WebStates",
+      ^base::TimeDelta(int) {
+        web::WebState::CreateParams params(chrome_browser_state_.get());
+        base::ElapsedTimer timer;
+        for (int i = 0; i < kWebStateCount; ++i) {
+          std::unique_ptr<web::WebState> web_state =
+              web::WebState::Create(params);
+          AttachTabHelpers(web_state.get(), /*for_prerender=*/false);
+          web_state_list->InsertWebState(
+              web_state_list->count(), std::move(web_state),
+              WebStateList::INSERT_NO_FLAGS, WebStateOpener());
+        }
+        return timer.Elapsed();
+      },
+      ^{
+        LogPerfValue("Footprint of 500 inserted WebStates",
+                     (GetPhysicalFootprint() - footprint_before) / 1024,
+                     "KB");
+        int created_tab_helpers = 0;
+        for (int i = 0; i < web_state_list->count(); ++i) {
+          const web::WebState* web_state = web_state_list->GetWebStateAt(i);
+          if (OpenInTabHelper::FromWebState(web_state))
+            ++created_tab_helpers;
+          if (ARQuickLookTabHelper::FromWebState(web_state))
+            ++created_tab_helpers;
+        }
+        LogPerfValue("Lazy tab helpers created", created_tab_helpers,
+                     "helpers");
+        EXPECT_EQ(0, created_tab_helpers);
+        web_state_list->CloseAllWebStates(WebStateList::CLOSE_NO_FLAGS);
+      });
+
+  [ar_quick_look_coordinator stop];
+  open_in_mediator = nil;
+}
+
+}  // namespace
@@ -6,6 +6,7 @@
 
 #include <memory>
 
+#include "base/bind.h"
 #include "base/scoped_observer.h"
 #include "base/strings/sys_string_conversions.h"
 #import "ios/chrome/browser/app_launcher/app_launcher_abuse_detector.h"
@@ -641,27 +642,34 @@
 
   PassKitTabHelper::CreateForWebState(webState, self.passKitCoordinator);
 
-  if (PrintTabHelper::FromWebState(webState)) {
-    PrintTabHelper::FromWebState(webState)->set_printer(self.printController);
-  }
+  // The print and StoreKit tab helpers are created lazily, so their delegates
+  // are only set once they are created.
+  __weak PrintController* printController = self.printController;
+  PrintTabHelper::RunWhenCreatedForWebState(
+      webState, base::BindOnce(^(PrintTabHelper* printTabHelper) {
+        printTabHelper->set_printer(printController);
+      }));
 
   RepostFormTabHelper::CreateForWebState(webState, self);
 
-  if (StoreKitTabHelper::FromWebState(webState)) {
-    StoreKitTabHelper::FromWebState(webState)->SetLauncher(
-        self.storeKitCoordinator);
-  }
+  __weak StoreKitCoordinator* storeKitCoordinator = self.storeKitCoordinator;
+  StoreKitTabHelper::RunWhenCreatedForWebState(
+      webState, base::BindOnce(^(StoreKitTabHelper* storeKitTabHelper) {
+        storeKitTabHelper->SetLauncher(storeKitCoordinator);
+      }));
 }
 
 // Uninstalls delegates for |webState|.
 - (void)uninstallDelegatesForWebState:(web::WebState*)webState {
-  if (PrintTabHelper::FromWebState(webState)) {
-    PrintTabHelper::FromWebState(webState)->set_printer(nil);
-  }
-
-  if (StoreKitTabHelper::FromWebState(webState)) {
-    StoreKitTabHelper::FromWebState(webState)->SetLauncher(nil);
-  }
+  PrintTabHelper::RunWhenCreatedForWebState(
+      webState, base::BindOnce(^(PrintTabHelper* printTabHelper) {
+        printTabHelper->set_printer(nil);
+      }));
+
+  StoreKitTabHelper::RunWhenCreatedForWebState(
+      webState, base::BindOnce(^(StoreKitTabHelper* storeKitTabHelper) {
+        storeKitTabHelper->SetLauncher(nil);
+      }));
 }
 
 @end
@@ -8,6 +8,7 @@
 #import <MessageUI/MessageUI.h>
 
 #include "base/base64.h"
+#include "base/bind.h"
 #include "base/ios/ios_util.h"
 #include "base/mac/bundle_locations.h"
 #include "base/mac/foundation_util.h"
@@ -2687,7 +2688,12 @@ NSString* const kBrowserViewControllerSnackbarCategory =
   }
 
   if (!IsIPadIdiom()) {
-    OverscrollActionsTabHelper::FromWebState(webState)->SetDelegate(self);
+    // The tab helper is created lazily, so its delegate is set once it is.
+    __weak BrowserViewController* weakSelf = self;
+    OverscrollActionsTabHelper::RunWhenCreatedForWebState(
+        webState, base::BindOnce(^(OverscrollActionsTabHelper* tabHelper) {
+          tabHelper->SetDelegate(weakSelf);
+        }));
   }
 
   // Install the proper CRWWebController delegates.
@@ -2741,7 +2747,10 @@ NSString* const kBrowserViewControllerSnackbarCategory =
   }
 
   if (!IsIPadIdiom()) {
-    OverscrollActionsTabHelper::FromWebState(webState)->SetDelegate(nil);
+    OverscrollActionsTabHelper::RunWhenCreatedForWebState(
+        webState, base::BindOnce(^(OverscrollActionsTabHelper* tabHelper) {
+          tabHelper->SetDelegate(nil);
+        }));
   }
 
   web_deprecated::SetSwipeRecognizerProvider(webState, nil);
@@ -8,6 +8,7 @@
 
 #include <memory>
 
+#include "base/bind.h"
 #include "base/logging.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/scoped_observer.h"
@@ -131,16 +132,20 @@ PresentQLPreviewController GetHistogramEnum(
 
 // Installs delegates for |webState|.
 - (void)installDelegatesForWebState:(web::WebState*)webState {
-  if (ARQuickLookTabHelper::FromWebState(webState)) {
-    ARQuickLookTabHelper::FromWebState(webState)->set_delegate(self);
-  }
+  // The tab helper is created lazily, so its delegate is set once it is.
+  __weak ARQuickLookCoordinator* weakSelf = self;
+  ARQuickLookTabHelper::RunWhenCreatedForWebState(
+      webState, base::BindOnce(^(ARQuickLookTabHelper* tabHelper) {
+        tabHelper->set_delegate(weakSelf);
+      }));
 }
 
 // Uninstalls delegates for |webState|.
 - (void)uninstallDelegatesForWebState:(web::WebState*)webState {
-  if (ARQuickLookTabHelper::FromWebState(webState)) {
-    ARQuickLookTabHelper::FromWebState(webState)->set_delegate(nil);
-  }
+  ARQuickLookTabHelper::RunWhenCreatedForWebState(
+      webState, base::BindOnce(^(ARQuickLookTabHelper* tabHelper) {
+        tabHelper->set_delegate(nil);
+      }));
 }
 
 #pragma mark - WebStateListObserving
@@ -9,6 +9,7 @@
 #import <memory>
 
 #include "base/base_paths.h"
+#include "base/bind.h"
 #include "base/files/file_path.h"
 #include "base/path_service.h"
 #include "base/strings/sys_string_conversions.h"
@@ -108,6 +109,25 @@ TEST_F(ARQuickLookCoordinatorTest, InstallDelegates) {
   EXPECT_TRUE(ARQuickLookTabHelper::FromWebState(web_state_ptr3)->delegate());
 }
 
+// Tests that the coordinator installs itself as delegate of the
+// ARQuickLookTabHelper instances created lazily once they are created, without
+// creating them.
+TEST_F(ARQuickLookCoordinatorTest, InstallDelegatesOfLazyTabHelpers) {
+  auto web_state2 = std::make_unique<web::TestWebState>();
+  auto* web_state_ptr2 = web_state2.get();
+  ARQuickLookTabHelper::CreateLazilyForWebState(
+      web_state_ptr2, base::BindOnce(&ARQuickLookTabHelper::CreateForWebState));
+  browser_->GetWebStateList()->InsertWebState(0, std::move(web_state2),
+                                              WebStateList::INSERT_NO_FLAGS,
+                                              WebStateOpener());
+  const web::WebState* const_web_state_ptr2 = web_state_ptr2;
+  EXPECT_FALSE(ARQuickLookTabHelper::FromWebState(const_web_state_ptr2));
+
+  web_state_ptr2->WasShown();
+  ASSERT_TRUE(ARQuickLookTabHelper::FromWebState(const_web_state_ptr2));
+  EXPECT_TRUE(ARQuickLookTabHelper::FromWebState(web_state_ptr2)->delegate());
+}
+
 // Tests presenting a valid USDZ file.
 TEST_F(ARQuickLookCoordinatorTest, ValidUSDZFile) {
   base::FilePath path = GetTestFilePath();
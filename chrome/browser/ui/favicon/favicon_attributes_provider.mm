@@ -96,10 +96,10 @@
       };
 
   if (self.cache) {
-    std::unique_ptr<favicon_base::LargeIconResult> cached_result =
+    scoped_refptr<const LargeIconCache::Result> cached_result =
         self.cache->GetCachedResult(URL);
     if (cached_result) {
-      faviconBlock(*cached_result);
+      faviconBlock(cached_result->result());
     }
   }
 
@@ -6,6 +6,7 @@
 
 #import <UIKit/UIKit.h>
 
+#include "base/bind.h"
 #import "ios/chrome/browser/open_in/open_in_tab_helper.h"
 #import "ios/chrome/browser/ui/open_in/open_in_controller.h"
 #include "ios/chrome/browser/web_state_list/web_state_list.h"
@@ -40,7 +41,7 @@
     // Set the delegates for all existing webstates in the |_webStateList|.
     for (int i = 0; i < _webStateList->count(); i++) {
       web::WebState* webState = _webStateList->GetWebStateAt(i);
-      OpenInTabHelper::FromWebState(webState)->SetDelegate(self);
+      [self installDelegateForWebState:webState];
     }
     _webStateListObserver = std::make_unique<WebStateListObserverBridge>(self);
     _webStateList->AddObserver(_webStateListObserver.get());
@@ -74,7 +75,19 @@
               atIndex:(int)index
            activating:(BOOL)activating {
   DCHECK_EQ(_webStateList, webStateList);
-  OpenInTabHelper::FromWebState(webState)->SetDelegate(self);
+  [self installDelegateForWebState:webState];
+}
+
+#pragma mark - Private
+
+// Sets the delegate of the OpenInTabHelper of |webState|, once it is created
+// as it is created lazily.
+- (void)installDelegateForWebState:(web::WebState*)webState {
+  __weak OpenInMediator* weakSelf = self;
+  OpenInTabHelper::RunWhenCreatedForWebState(
+      webState, base::BindOnce(^(OpenInTabHelper* tabHelper) {
+        tabHelper->SetDelegate(weakSelf);
+      }));
 }
 
 #pragma mark - OpenInTabHelperDelegate
@@ -358,7 +358,7 @@ web::WebState* GetWebStateWithId(WebStateList* web_state_list,
   }
   web::WebState* webState = GetWebStateWithId(self.webStateList, identifier);
   if (webState) {
-    SnapshotTabHelper::FromWebState(webState)->RetrieveColorSnapshot(
+    SnapshotTabHelper::FromWebState(webState)->RetrieveThumbnail(
         ^(UIImage* image) {
             completion(image);
         });
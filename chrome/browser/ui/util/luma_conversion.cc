@@ -0,0 +1,91 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/chrome/browser/ui/util/luma_conversion.h"
+
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_ARM64)
+#include <arm_neon.h>
+#elif defined(ARCH_CPU_X86_FAMILY)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// BT.601 luma weights in 8.8 fixed point. They sum to 256, so the weighted sum
+// of a pixel fits in 16 bits.
+const uint8_t kRedWeight = 77;
+const uint8_t kGreenWeight = 150;
+const uint8_t kBlueWeight = 29;
+const uint16_t kRounding = 128;
+
+}  // namespace
+
+void ConvertRGBXToLumaReference(const uint8_t* rgbx,
+                                uint8_t* luma,
+                                size_t pixel_count) {
+  for (size_t i = 0; i < pixel_count; ++i, rgbx += 4) {
+    const uint32_t sum = kRedWeight * rgbx[0] + kGreenWeight * rgbx[1] +
+                         kBlueWeight * rgbx[2] + kRounding;
+    luma[i] = static_cast<uint8_t>(sum >> 8);
+  }
+}
+
+void ConvertRGBXToLuma(const uint8_t* rgbx, uint8_t* luma, size_t pixel_count) {
+  size_t i = 0;
+
+#if defined(ARCH_CPU_ARM64)
+  const uint8x8_t red_weight = vdup_n_u8(kRedWeight);
+  const uint8x8_t green_weight = vdup_n_u8(kGreenWeight);
+  const uint8x8_t blue_weight = vdup_n_u8(kBlueWeight);
+  for (; i + 16 <= pixel_count; i += 16) {
+    // Deinterleave 16 pixels into one register per channel.
+    const uint8x16x4_t pixels = vld4q_u8(rgbx + 4 * i);
+    uint16x8_t low = vmull_u8(vget_low_u8(pixels.val[0]), red_weight);
+    low = vmlal_u8(low, vget_low_u8(pixels.val[1]), green_weight);
+    low = vmlal_u8(low, vget_low_u8(pixels.val[2]), blue_weight);
+    uint16x8_t high = vmull_u8(vget_high_u8(pixels.val[0]), red_weight);
+    high = vmlal_u8(high, vget_high_u8(pixels.val[1]), green_weight);
+    high = vmlal_u8(high, vget_high_u8(pixels.val[2]), blue_weight);
+    // The rounding shift adds |kRounding| before shifting.
+    vst1q_u8(luma + i,
+             vcombine_u8(vrshrn_n_u16(low, 8), vrshrn_n_u16(high, 8)));
+  }
+#elif defined(ARCH_CPU_X86_FAMILY)
+  const __m128i byte_mask = _mm_set1_epi32(0xFF);
+  const __m128i red_weight = _mm_set1_epi16(kRedWeight);
+  const __m128i green_weight = _mm_set1_epi16(kGreenWeight);
+  const __m128i blue_weight = _mm_set1_epi16(kBlueWeight);
+  const __m128i rounding = _mm_set1_epi16(kRounding);
+  // Returns the luma of the 8 pixels of |first| and |second| as 16-bit
+  // integers. The weighted sums fit in unsigned 16-bit integers, so the
+  // wrapping 16-bit arithmetic is exact.
+  auto luma_of_8_pixels = [&](__m128i first, __m128i second) {
+    const __m128i red = _mm_packs_epi32(_mm_and_si128(first, byte_mask),
+                                        _mm_and_si128(second, byte_mask));
+    const __m128i green =
+        _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(first, 8), byte_mask),
+                        _mm_and_si128(_mm_srli_epi32(second, 8), byte_mask));
+    const __m128i blue =
+        _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(first, 16), byte_mask),
+                        _mm_and_si128(_mm_srli_epi32(second, 16), byte_mask));
+    __m128i sum = _mm_mullo_epi16(red, red_weight);
+    sum = _mm_add_epi16(sum, _mm_mullo_epi16(green, green_weight));
+    sum = _mm_add_epi16(sum, _mm_mullo_epi16(blue, blue_weight));
+    return _mm_srli_epi16(_mm_add_epi16(sum, rounding), 8);
+  };
+  for (; i + 16 <= pixel_count; i += 16) {
+    const __m128i* pixels = reinterpret_cast<const __m128i*>(rgbx + 4 * i);
+    const __m128i low = luma_of_8_pixels(_mm_loadu_si128(pixels),
+                                         _mm_loadu_si128(pixels + 1));
+    const __m128i high = luma_of_8_pixels(_mm_loadu_si128(pixels + 2),
+                                          _mm_loadu_si128(pixels + 3));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(luma + i),
+                     _mm_packus_epi16(low, high));
+  }
+#endif
+
+  ConvertRGBXToLumaReference(rgbx + 4 * i, luma + i, pixel_count - i);
+}
@@ -0,0 +1,23 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_CHROME_BROWSER_UI_UTIL_LUMA_CONVERSION_H_
+#define IOS_CHROME_BROWSER_UI_UTIL_LUMA_CONVERSION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Converts |pixel_count| pixels of |rgbx|, stored as 4 bytes per pixel in the
+// R, G, B, X order, to their luma stored as 1 byte per pixel in |luma|. Luma
+// is computed with the BT.601 weights in 8.8 fixed point, rounded to nearest.
+// Uses SIMD instructions when they are available, and returns the same result
+// as |ConvertRGBXToLumaReference|.
+void ConvertRGBXToLuma(const uint8_t* rgbx, uint8_t* luma, size_t pixel_count);
+
+// Scalar implementation of |ConvertRGBXToLuma|.
+void ConvertRGBXToLumaReference(const uint8_t* rgbx,
+                                uint8_t* luma,
+                                size_t pixel_count);
+
+#endif  // IOS_CHROME_BROWSER_UI_UTIL_LUMA_CONVERSION_H_
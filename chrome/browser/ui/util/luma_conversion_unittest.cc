@@ -0,0 +1,70 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/chrome/browser/ui/util/luma_conversion.h"
+
+#include <vector>
+
+#include "base/rand_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/platform_test.h"
+
+using LumaConversionTest = PlatformTest;
+
+// Tests the luma of the primary colors.
+TEST_F(LumaConversionTest, PrimaryColors) {
+  const uint8_t rgbx[] = {
+      0,   0,   0,   255,  // Black.
+      255, 255, 255, 255,  // White.
+      255, 0,   0,   255,  // Red.
+      0,   255, 0,   255,  // Green.
+      0,   0,   255, 255,  // Blue.
+  };
+  uint8_t luma[5] = {};
+  ConvertRGBXToLuma(rgbx, luma, 5);
+  EXPECT_EQ(0, luma[0]);
+  EXPECT_EQ(255, luma[1]);
+  EXPECT_EQ(77, luma[2]);
+  EXPECT_EQ(149, luma[3]);
+  EXPECT_EQ(29, luma[4]);
+}
+
+// Tests that the vectorized conversion is bit-exact with the reference one,
+// for all the lengths of the remainder and all the alignments of the buffers.
+TEST_F(LumaConversionTest, MatchesReference) {
+  for (size_t pixel_count = 0; pixel_count < 100; ++pixel_count) {
+    for (size_t offset = 0; offset < 4; ++offset) {
+      std::vector<uint8_t> rgbx(4 * pixel_count + offset);
+      base::RandBytes(rgbx.data(), rgbx.size());
+      std::vector<uint8_t> luma(pixel_count + offset);
+      std::vector<uint8_t> reference_luma(pixel_count + offset);
+      ConvertRGBXToLuma(rgbx.data() + offset, luma.data() + offset,
+                        pixel_count);
+      ConvertRGBXToLumaReference(rgbx.data() + offset,
+                                 reference_luma.data() + offset, pixel_count);
+      EXPECT_EQ(reference_luma, luma)
+          << "pixel_count: " << pixel_count << " offset: " << offset;
+    }
+  }
+}
+
+// Tests that the vectorized conversion is bit-exact with the reference one
+// for all the values of each channel.
+TEST_F(LumaConversionTest, MatchesReferenceForAllValues) {
+  const size_t kPixelCount = 256 * 3;
+  std::vector<uint8_t> rgbx(4 * kPixelCount);
+  for (size_t channel = 0; channel < 3; ++channel) {
+    for (size_t value = 0; value < 256; ++value) {
+      uint8_t* pixel = &rgbx[4 * (256 * channel + value)];
+      pixel[channel] = value;
+      pixel[(channel + 1) % 3] = 255 - value;
+      pixel[(channel + 2) % 3] = value / 2;
+    }
+  }
+  std::vector<uint8_t> luma(kPixelCount);
+  std::vector<uint8_t> reference_luma(kPixelCount);
+  ConvertRGBXToLuma(rgbx.data(), luma.data(), kPixelCount);
+  ConvertRGBXToLumaReference(rgbx.data(), reference_luma.data(), kPixelCount);
+  EXPECT_EQ(reference_luma, luma);
+}
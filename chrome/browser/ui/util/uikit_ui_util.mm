@@ -11,14 +11,17 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <cmath>
+#include <vector>
 
 #include "base/ios/ios_util.h"
 #include "base/logging.h"
 #include "base/mac/foundation_util.h"
+#include "base/mac/scoped_cftyperef.h"
 #include "base/numerics/math_constants.h"
 #include "ios/chrome/browser/system_flags.h"
 #include "ios/chrome/browser/ui/ui_feature_flags.h"
 #include "ios/chrome/browser/ui/util/dynamic_type_util.h"
+#include "ios/chrome/browser/ui/util/luma_conversion.h"
 #include "ios/chrome/browser/ui/util/rtl_geometry.h"
 #include "ios/chrome/browser/ui/util/ui_util.h"
 #include "ios/web/public/thread/web_thread.h"
@@ -214,13 +217,55 @@ UIImage* CaptureView(UIView* view, CGFloat scale) {
 
 UIImage* GreyImage(UIImage* image) {
   DCHECK(image);
-  // Grey images are always non-retina to improve memory performance.
-  UIGraphicsBeginImageContextWithOptions(image.size, YES, 1.0);
-  CGRect greyImageRect = CGRectMake(0, 0, image.size.width, image.size.height);
-  [image drawInRect:greyImageRect blendMode:kCGBlendModeLuminosity alpha:1.0];
-  UIImage* greyImage = UIGraphicsGetImageFromCurrentImageContext();
-  UIGraphicsEndImageContext();
-  return greyImage;
+  // Grey images are always non-retina to improve memory performance. The
+  // bitmaps are in the orientation of |image.CGImage|, and the grey image gets
+  // the orientation of |image|.
+  CGSize size = image.size;
+  switch (image.imageOrientation) {
+    case UIImageOrientationLeft:
+    case UIImageOrientationLeftMirrored:
+    case UIImageOrientationRight:
+    case UIImageOrientationRightMirrored:
+      size = CGSizeMake(size.height, size.width);
+      break;
+    default:
+      break;
+  }
+  const size_t width = std::ceil(size.width);
+  const size_t height = std::ceil(size.height);
+  if (!width || !height || !image.CGImage)
+    return nil;
+
+  // Draw |image| at the resolution of the grey image in an RGBX bitmap, then
+  // convert each row to luma in an 8-bit grey bitmap.
+  std::vector<uint8_t> rgbx(width * height * 4);
+  base::ScopedCFTypeRef<CGColorSpaceRef> rgb_color_space(
+      CGColorSpaceCreateDeviceRGB());
+  base::ScopedCFTypeRef<CGContextRef> rgbx_context(CGBitmapContextCreate(
+      rgbx.data(), width, height, 8, width * 4, rgb_color_space,
+      kCGImageAlphaNoneSkipLast | kCGBitmapByteOrder32Big));
+  base::ScopedCFTypeRef<CGColorSpaceRef> grey_color_space(
+      CGColorSpaceCreateDeviceGray());
+  base::ScopedCFTypeRef<CGContextRef> grey_context(CGBitmapContextCreate(
+      nullptr, width, height, 8, 0, grey_color_space, kCGImageAlphaNone));
+  if (!rgbx_context || !grey_context)
+    return nil;
+  CGContextSetInterpolationQuality(rgbx_context, kCGInterpolationMedium);
+  CGContextDrawImage(rgbx_context, CGRectMake(0, 0, width, height),
+                     image.CGImage);
+
+  uint8_t* grey = static_cast<uint8_t*>(CGBitmapContextGetData(grey_context));
+  const size_t grey_bytes_per_row = CGBitmapContextGetBytesPerRow(grey_context);
+  for (size_t row = 0; row < height; ++row) {
+    ConvertRGBXToLuma(&rgbx[row * width * 4], grey + row * grey_bytes_per_row,
+                      width);
+  }
+
+  base::ScopedCFTypeRef<CGImageRef> grey_image(
+      CGBitmapContextCreateImage(grey_context));
+  return [UIImage imageWithCGImage:grey_image
+                             scale:1.0
+                       orientation:image.imageOrientation];
 }
 
 UIColor* GetPrimaryActionButtonColor() {
@@ -83,6 +83,24 @@ TEST_F(UIKitUIUtilTest, TestGreyImage) {
   EXPECT_EQ(1.0, greyImage.scale);
 }
 
+// Verifies that greyImage keeps the orientation and the size of the image.
+TEST_F(UIKitUIUtilTest, TestGreyImageOrientation) {
+  const CGSize kSize = CGSizeMake(100, 50);
+  UIGraphicsBeginImageContextWithOptions(kSize, NO, 1.0);
+  UIImage* image = UIGraphicsGetImageFromCurrentImageContext();
+  UIGraphicsEndImageContext();
+  UIImage* rotatedImage =
+      [UIImage imageWithCGImage:image.CGImage
+                          scale:1.0
+                    orientation:UIImageOrientationRight];
+  ASSERT_EQ(kSize.height, rotatedImage.size.width);
+
+  UIImage* greyImage = GreyImage(rotatedImage);
+  EXPECT_EQ(UIImageOrientationRight, greyImage.imageOrientation);
+  EXPECT_EQ(kSize.height, greyImage.size.width);
+  EXPECT_EQ(kSize.width, greyImage.size.height);
+}
+
 // Returns an image of random color in the same scale as the device main
 // screen.
 UIImage* testImage(CGSize imageSize) {
@@ -26,6 +26,7 @@
 #include "ios/chrome/common/channel_info.h"
 #include "ios/web/public/thread/web_thread.h"
 #include "ios/web/public/webui/web_ui_ios.h"
+#include "ios/web/public/webui/web_ui_ios_javascript_batcher.h"
 
 namespace {
 
@@ -61,6 +62,8 @@ SyncInternalsMessageHandler::~SyncInternalsMessageHandler() {
 void SyncInternalsMessageHandler::RegisterMessages() {
   DCHECK_CURRENTLY_ON(web::WebThread::UI);
 
+  event_batcher_ = std::make_unique<web::WebUIIOSJavascriptBatcher>(web_ui());
+
   web_ui()->RegisterMessageCallback(
       syncer::sync_ui_util::kRegisterForEvents,
       base::BindRepeating(&SyncInternalsMessageHandler::HandleRegisterForEvents,
@@ -270,6 +273,8 @@ void SyncInternalsMessageHandler::OnReceivedAllNodes(
   base::Value nodes_clone = nodes->Clone();
 
   std::vector<const base::Value*> args{&id, &nodes_clone};
+  // Send the events dispatched before the nodes first.
+  event_batcher_->Flush();
   web_ui()->CallJavascriptFunction(syncer::sync_ui_util::kGetAllNodesCallback,
                                    args);
 }
@@ -345,5 +350,6 @@ void SyncInternalsMessageHandler::DispatchEvent(
 
   std::vector<const base::Value*> args{&event_name, &details_value};
 
-  web_ui()->CallJavascriptFunction(syncer::sync_ui_util::kDispatchEvent, args);
+  event_batcher_->CallJavascriptFunction(syncer::sync_ui_util::kDispatchEvent,
+                                         args);
 }
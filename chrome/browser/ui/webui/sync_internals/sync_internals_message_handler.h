@@ -22,6 +22,10 @@ namespace syncer {
 class SyncService;
 }  // namespace syncer
 
+namespace web {
+class WebUIIOSJavascriptBatcher;
+}  // namespace web
+
 // The implementation for the chrome://sync-internals page.
 class SyncInternalsMessageHandler : public web::WebUIIOSMessageHandler,
                                     public syncer::JsEventHandler,
@@ -121,6 +125,10 @@ class SyncInternalsMessageHandler : public web::WebUIIOSMessageHandler,
   // human readable format.
   bool include_specifics_ = false;
 
+  // Batches the events sent to the page, which can be hundreds per second
+  // during a full sync.
+  std::unique_ptr<web::WebUIIOSJavascriptBatcher> event_batcher_;
+
   base::WeakPtrFactory<SyncInternalsMessageHandler> weak_ptr_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(SyncInternalsMessageHandler);
@@ -0,0 +1,139 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/web/public/security/certificate_policy_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/strings/stringprintf.h"
+#include "base/synchronization/atomic_flag.h"
+#include "base/threading/simple_thread.h"
+#include "base/timer/elapsed_timer.h"
+#include "ios/chrome/test/base/perf_test_ios.h"
+#include "net/cert/x509_certificate.h"
+#include "net/test/test_certificate_data.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Number of hosts with an allowed cert, as for a heavy user.
+const int kHostCount = 10000;
+
+// Number of queries timed by each run.
+const int kQueryCount = 100000;
+
+// Returns the |index|-th host.
+std::string GetHost(int index) {
+  return base::StringPrintf("host%d.example.com", index);
+}
+
+// Queries the policies of the allowed hosts in a loop until stopped.
+class QueryDelegate : public base::DelegateSimpleThread::Delegate {
+ public:
+  QueryDelegate(web::CertificatePolicyCache* cache,
+                net::X509Certificate* cert,
+                const std::vector<std::string>* hosts,
+                const base::AtomicFlag* stop)
+      : cache_(cache), cert_(cert), hosts_(hosts), stop_(stop) {}
+
+  void Run() override {
+    while (!stop_->IsSet()) {
+      for (const std::string& host : *hosts_) {
+        cache_->QueryPolicy(cert_, host, net::CERT_STATUS_DATE_INVALID);
+      }
+    }
+  }
+
+ private:
+  web::CertificatePolicyCache* cache_;
+  net::X509Certificate* cert_;
+  const std::vector<std::string>* hosts_;
+  const base::AtomicFlag* stop_;
+
+  DISALLOW_COPY_AND_ASSIGN(QueryDelegate);
+};
+
+class CertificatePolicyCachePerfTest : public PerfTest {
+ protected:
+  CertificatePolicyCachePerfTest()
+      : PerfTest("Certificate policy cache"),
+        cache_(base::MakeRefCounted<web::CertificatePolicyCache>()),
+        cert_(net::X509Certificate::CreateFromBytes(
+            reinterpret_cast<const char*>(google_der),
+            sizeof(google_der))),
+        unknown_host_("unknown.example.com") {
+    std::vector<web::CertificatePolicyCache::AllowedCert> allowed_certs;
+    for (int index = 0; index < kHostCount; ++index) {
+      hosts_.push_back(GetHost(index));
+      allowed_certs.emplace_back(cert_, hosts_.back(),
+                                 net::CERT_STATUS_DATE_INVALID);
+    }
+    cache_->AllowCertsForHosts(allowed_certs);
+  }
+
+  // Times |kQueryCount| queries for allowed and unknown hosts, while
+  // |reader_count| other threads query the policies.
+  void TimeQueries(const std::string& test_name, int reader_count) {
+    base::AtomicFlag stop;
+    QueryDelegate delegate(cache_.get(), cert_.get(), &hosts_, &stop);
+    base::DelegateSimpleThreadPool pool("CertificatePolicyCachePerfTest",
+                                        reader_count);
+    if (reader_count) {
+      pool.AddWork(&delegate, reader_count);
+      pool.Start();
+    }
+
+    web::CertificatePolicyCache* cache = cache_.get();
+    net::X509Certificate* cert = cert_.get();
+    const std::vector<std::string>* hosts = &hosts_;
+    const std::string* unknown_host = &unknown_host_;
+    RepeatTimedRuns(
+        test_name,
+        ^base::TimeDelta(int) {
+          base::ElapsedTimer timer;
+          int allowed_count = 0;
+          for (int i = 0; i < kQueryCount; ++i) {
+            // Alternate between allowed and unknown hosts.
+            const std::string& host =
+                i % 2 ? *unknown_host : (*hosts)[i % kHostCount];
+            allowed_count +=
+                cache->QueryPolicy(cert, host, net::CERT_STATUS_DATE_INVALID) ==
+                web::CertPolicy::ALLOWED;
+          }
+          base::TimeDelta elapsed = timer.Elapsed();
+          EXPECT_EQ(kQueryCount / 2, allowed_count);
+          return elapsed;
+        },
+        nil);
+
+    stop.Set();
+    if (reader_count)
+      pool.JoinAll();
+  }
+
+  scoped_refptr<web::CertificatePolicyCache> cache_;
+  scoped_refptr<net::X509Certificate> cert_;
+  std::vector<std::string> hosts_;
+  const std::string unknown_host_;
+};
+
+// Tests querying the policies of 10000 hosts from a single thread.
+TEST_F(CertificatePolicyCachePerfTest, Queries) {
+  ASSERT_TRUE(cert_);
+  TimeQueries("100000 queries, 10000 hosts", 0);
+}
+
+// Tests querying the policies of 10000 hosts while other threads query them.
+TEST_F(CertificatePolicyCachePerfTest, ConcurrentQueries) {
+  ASSERT_TRUE(cert_);
+  TimeQueries("100000 queries, 10000 hosts, 3 concurrent readers", 3);
+}
+
+}  // namespace
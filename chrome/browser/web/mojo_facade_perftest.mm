@@ -0,0 +1,156 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/web/webui/mojo_facade.h"
+
+#import <Foundation/Foundation.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "base/base64.h"
+#include "base/strings/sys_string_conversions.h"
+#include "base/timer/elapsed_timer.h"
+#include "ios/chrome/test/base/perf_test_ios.h"
+#import "ios/web/public/test/fakes/test_web_state.h"
+#include "mojo/public/c/system/types.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Size of the payload written to the message pipe.
+const size_t kPayloadSize = 100 * 1024;
+
+// Number of messages written and read by each run.
+const int kMessageCount = 5;
+
+// Serializes the given |object| to JSON string.
+std::string GetJson(id object) {
+  NSData* json_as_data =
+      [NSJSONSerialization dataWithJSONObject:object options:0 error:nil];
+  NSString* json_as_string =
+      [[NSString alloc] initWithData:json_as_data
+                            encoding:NSUTF8StringEncoding];
+  return base::SysNSStringToUTF8(json_as_string);
+}
+
+// Deserializes the given |json| to an object.
+id GetObject(const std::string& json) {
+  NSData* json_as_data =
+      [base::SysUTF8ToNSString(json) dataUsingEncoding:NSUTF8StringEncoding];
+  return [NSJSONSerialization JSONObjectWithData:json_as_data
+                                         options:0
+                                           error:nil];
+}
+
+class MojoFacadePerfTest : public PerfTest {
+ protected:
+  MojoFacadePerfTest()
+      : PerfTest("Mojo facade"),
+        facade_(std::make_unique<web::MojoFacade>(&web_state_)) {
+    NSDictionary* create = @{
+      @"name" : @"Mojo.createMessagePipe",
+      @"args" : @{},
+    };
+    NSDictionary* response =
+        GetObject(facade_->HandleMojoMessage(GetJson(create)));
+    EXPECT_EQ(MOJO_RESULT_OK, [response[@"result"] unsignedIntValue]);
+    handle0_ = [response[@"handle0"] unsignedIntValue];
+    handle1_ = [response[@"handle1"] unsignedIntValue];
+  }
+
+  ~MojoFacadePerfTest() override {
+    for (uint32_t handle : {handle0_, handle1_}) {
+      NSDictionary* close = @{
+        @"name" : @"MojoHandle.close",
+        @"args" : @{
+          @"handle" : @(handle),
+        },
+      };
+      facade_->HandleMojoMessage(GetJson(close));
+    }
+  }
+
+  // Times writing and reading |kMessageCount| messages of |kPayloadSize|
+  // bytes with the binary or the JSON transport.
+  void TimeRoundTrips(bool binary) {
+    std::string payload(kPayloadSize, '\0');
+    NSMutableDictionary* json_payload =
+        [NSMutableDictionary dictionaryWithCapacity:kPayloadSize];
+    for (size_t i = 0; i < kPayloadSize; i++) {
+      payload[i] = static_cast<char>(i * 31);
+      json_payload[@(i).stringValue] = @(static_cast<uint8_t>(payload[i]));
+    }
+    std::string base64_payload;
+    base::Base64Encode(payload, &base64_payload);
+
+    NSDictionary* write = @{
+      @"name" : @"MojoHandle.writeMessage",
+      @"args" : @{
+        @"handle" : @(handle1_),
+        @"handles" : @[],
+        @"buffer" : binary ? base::SysUTF8ToNSString(base64_payload)
+                           : json_payload,
+      },
+    };
+    NSDictionary* read = @{
+      @"name" : @"MojoHandle.readMessage",
+      @"args" : @{
+        @"handle" : @(handle0_),
+        @"binary" : @(binary),
+      },
+    };
+    const std::string write_json = GetJson(write);
+    const std::string read_json = GetJson(read);
+
+    web::MojoFacade* facade = facade_.get();
+    __block base::TimeDelta total_elapsed;
+    __block int run_count = 0;
+    const std::string transport = binary ? "binary" : "JSON";
+    RepeatTimedRuns(
+        "Round trip 5 100KB messages, " + transport + " transport",
+        ^base::TimeDelta(int) {
+          base::ElapsedTimer timer;
+          std::string last_read;
+          for (int i = 0; i < kMessageCount; i++) {
+            facade->HandleMojoMessage(write_json);
+            last_read = facade->HandleMojoMessage(read_json);
+          }
+          base::TimeDelta elapsed = timer.Elapsed();
+          NSDictionary* message = GetObject(last_read);
+          EXPECT_EQ(MOJO_RESULT_OK, [message[@"result"] unsignedIntValue]);
+          total_elapsed += elapsed;
+          run_count++;
+          return elapsed;
+        },
+        nil);
+
+    LogPerfValue(
+        "Throughput, " + transport + " transport",
+        run_count * kMessageCount * kPayloadSize / 1024 /
+            std::max(total_elapsed.InSecondsF(), 0.000001),
+        "KB/s");
+  }
+
+  web::TestWebState web_state_;
+  std::unique_ptr<web::MojoFacade> facade_;
+  uint32_t handle0_ = 0;
+  uint32_t handle1_ = 0;
+};
+
+// Tests round tripping payloads through the JSON transport.
+TEST_F(MojoFacadePerfTest, JSONTransport) {
+  TimeRoundTrips(/*binary=*/false);
+}
+
+// Tests round tripping payloads through the binary transport.
+TEST_F(MojoFacadePerfTest, BinaryTransport) {
+  TimeRoundTrips(/*binary=*/true);
+}
+
+}  // namespace
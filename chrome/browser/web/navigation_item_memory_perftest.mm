@@ -0,0 +1,103 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <malloc/malloc.h>
+
+#include <vector>
+
+#include "base/strings/stringprintf.h"
+#include "ios/chrome/test/base/perf_test_ios.h"
+#include "ios/web/navigation/interned_url.h"
+#include "url/gurl.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Number of tabs of the synthetic session.
+const int kTabCount = 500;
+
+// Number of items of the back/forward list of each tab.
+const int kItemCountPerTab = 25;
+
+// Number of distinct back/forward lists, so that tabs share some URLs as tabs
+// opened on the same sites do.
+const int kDistinctTabCount = 50;
+
+// Returns the URL of the |item_index|-th item of the |tab_index|-th tab.
+GURL GetItemURL(int tab_index, int item_index) {
+  return GURL(base::StringPrintf(
+      "https://www.example.com/section/%d/article/%d?source=navigation",
+      tab_index % kDistinctTabCount, item_index));
+}
+
+// Returns the number of bytes allocated in the heap.
+size_t GetHeapSizeInUse() {
+  malloc_statistics_t statistics;
+  malloc_zone_statistics(nullptr, &statistics);
+  return statistics.size_in_use;
+}
+
+// The URLs of a NavigationItem, stored as plain GURLs as they were before
+// NavigationItemImpl interned them.
+struct ItemURLs {
+  GURL original_request_url;
+  GURL url;
+  GURL virtual_url;
+};
+
+// The URLs of a NavigationItem, stored as NavigationItemImpl stores them.
+struct InternedItemURLs {
+  web::InternedURL original_request_url;
+  web::InternedURL url;
+  web::InternedURL virtual_url;
+};
+
+class NavigationItemMemoryPerfTest : public PerfTest {
+ protected:
+  NavigationItemMemoryPerfTest() : PerfTest("NavigationItem memory") {}
+};
+
+// Tests the heap used by the three URLs of each NavigationItem of a 500 tab
+// session when they are interned, against the heap the same URLs use when each
+// item holds copies of them.
+TEST_F(NavigationItemMemoryPerfTest, SyntheticSession) {
+  size_t heap_size = GetHeapSizeInUse();
+  std::vector<ItemURLs> item_urls;
+  item_urls.reserve(kTabCount * kItemCountPerTab);
+  for (int tab_index = 0; tab_index < kTabCount; ++tab_index) {
+    for (int item_index = 0; item_index < kItemCountPerTab; ++item_index) {
+      const GURL url = GetItemURL(tab_index, item_index);
+      // The virtual URL is empty when it is the URL.
+      item_urls.push_back(ItemURLs{url, url, GURL()});
+    }
+  }
+  const size_t copied_heap_size = GetHeapSizeInUse() - heap_size;
+  LogPerfValue("Heap of the copied URLs of 500 tabs", copied_heap_size,
+               "bytes");
+
+  heap_size = GetHeapSizeInUse();
+  std::vector<InternedItemURLs> interned_item_urls;
+  interned_item_urls.reserve(kTabCount * kItemCountPerTab);
+  for (int tab_index = 0; tab_index < kTabCount; ++tab_index) {
+    for (int item_index = 0; item_index < kItemCountPerTab; ++item_index) {
+      const GURL url = GetItemURL(tab_index, item_index);
+      interned_item_urls.push_back(InternedItemURLs{
+          web::InternedURL(url), web::InternedURL(url), web::InternedURL()});
+    }
+  }
+  const size_t interned_heap_size = GetHeapSizeInUse() - heap_size;
+  LogPerfValue("Heap of the interned URLs of 500 tabs", interned_heap_size,
+               "bytes");
+
+  LogPerfValue("Heap saved by interning the URLs of 500 tabs",
+               static_cast<double>(copied_heap_size) - interned_heap_size,
+               "bytes");
+  EXPECT_EQ(item_urls.size(), interned_item_urls.size());
+  EXPECT_LT(interned_heap_size, copied_heap_size);
+}
+
+}  // namespace
@@ -0,0 +1,106 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import <Foundation/Foundation.h>
+
+#include <memory>
+
+#include "base/strings/stringprintf.h"
+#include "base/strings/utf_string_conversions.h"
+#import "base/test/ios/wait_util.h"
+#include "base/test/scoped_feature_list.h"
+#include "base/timer/elapsed_timer.h"
+#include "ios/chrome/browser/browser_state/test_chrome_browser_state.h"
+#include "ios/chrome/test/base/perf_test_ios.h"
+#include "ios/web/common/features.h"
+#import "ios/web/public/navigation/navigation_manager.h"
+#import "ios/web/public/session/crw_navigation_item_storage.h"
+#import "ios/web/public/session/crw_session_storage.h"
+#import "ios/web/public/web_state.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+using base::test::ios::kWaitForPageLoadTimeout;
+using base::test::ios::WaitUntilConditionOrTimeout;
+
+namespace {
+
+// Class for testing the restoration of the session history of a WebState.
+class SessionRestorationPerfTest : public PerfTest {
+ protected:
+  SessionRestorationPerfTest()
+      : PerfTest("Session restoration"),
+        browser_state_(TestChromeBrowserState::Builder().Build()) {}
+
+  // Returns a session history of |item_count| items, whose last committed
+  // item is the last one.
+  CRWSessionStorage* CreateSessionStorage(int item_count) {
+    NSMutableArray<CRWNavigationItemStorage*>* item_storages =
+        [NSMutableArray arrayWithCapacity:item_count];
+    for (int i = 0; i < item_count; i++) {
+      CRWNavigationItemStorage* item = [[CRWNavigationItemStorage alloc] init];
+      item.virtualURL =
+          GURL(base::StringPrintf("https://www.example.com/article/%d", i));
+      item.title = base::ASCIIToUTF16(
+          base::StringPrintf("A long title for the article number %d", i));
+      [item_storages addObject:item];
+    }
+    CRWSessionStorage* session_storage = [[CRWSessionStorage alloc] init];
+    session_storage.itemStorages = item_storages;
+    session_storage.lastCommittedItemIndex = item_count - 1;
+    return session_storage;
+  }
+
+  // Times the restoration of sessions of |item_count| items, until the web
+  // view has all their entries.
+  void TimeRestoration(const std::string& test_name, int item_count) {
+    CRWSessionStorage* session_storage = CreateSessionStorage(item_count);
+    web::BrowserState* browser_state = browser_state_.get();
+    RepeatTimedRuns(
+        test_name,
+        ^base::TimeDelta(int) {
+          base::ElapsedTimer timer;
+          web::WebState::CreateParams params(browser_state);
+          std::unique_ptr<web::WebState> web_state =
+              web::WebState::CreateWithStorageSession(params, session_storage);
+          web_state->SetKeepRenderProcessAlive(true);
+          web::NavigationManager* navigation_manager =
+              web_state->GetNavigationManager();
+          navigation_manager->LoadIfNecessary();
+          EXPECT_TRUE(WaitUntilConditionOrTimeout(kWaitForPageLoadTimeout, ^{
+            return !navigation_manager->IsRestoreSessionInProgress();
+          }));
+          return timer.Elapsed();
+        },
+        nil);
+  }
+
+  std::unique_ptr<TestChromeBrowserState> browser_state_;
+};
+
+// Tests restoring sessions with the compact encoding, restoring sessions longer
+// than wk_navigation_util::kMaxSessionSize in chunks.
+TEST_F(SessionRestorationPerfTest, CompactEncoding) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeature(
+      web::features::kRestoreSessionCompactEncoding);
+  TimeRestoration("Compact encoding, 10 items", 10);
+  TimeRestoration("Compact encoding, 75 items", 75);
+  TimeRestoration("Compact encoding, 300 items", 300);
+}
+
+// Tests restoring sessions with the JSON encoding, as a baseline. Sessions
+// longer than wk_navigation_util::kMaxSessionSize are truncated.
+TEST_F(SessionRestorationPerfTest, JSONEncoding) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndDisableFeature(
+      web::features::kRestoreSessionCompactEncoding);
+  TimeRestoration("JSON encoding, 10 items", 10);
+  TimeRestoration("JSON encoding, 75 items", 75);
+  TimeRestoration("JSON encoding, 300 items (truncated)", 300);
+}
+
+}  // namespace
@@ -0,0 +1,104 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/web/public/thread/web_thread.h"
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/macros.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/task/post_task.h"
+#include "base/threading/simple_thread.h"
+#include "base/timer/elapsed_timer.h"
+#include "ios/chrome/test/base/perf_test_ios.h"
+#include "ios/web/public/thread/web_task_traits.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Number of tasks posted by each run.
+const int kTaskCount = 100000;
+
+// Counts the tasks that ran, and quits |run_loop| once all ran.
+void CountTask(int* run_count, base::RunLoop* run_loop) {
+  if (++*run_count == kTaskCount)
+    run_loop->Quit();
+}
+
+// Posts |task_count| tasks to the IO thread.
+class PostTaskDelegate : public base::DelegateSimpleThread::Delegate {
+ public:
+  PostTaskDelegate(int task_count, const base::RepeatingClosure& task)
+      : task_count_(task_count), task_(task) {}
+
+  void Run() override {
+    for (int i = 0; i < task_count_; ++i)
+      base::PostTask(FROM_HERE, {web::WebThread::IO}, task_);
+  }
+
+ private:
+  const int task_count_;
+  const base::RepeatingClosure task_;
+
+  DISALLOW_COPY_AND_ASSIGN(PostTaskDelegate);
+};
+
+class WebThreadPerfTest : public PerfTest {
+ protected:
+  WebThreadPerfTest() : PerfTest("WebThread") {}
+
+  // Times posting |kTaskCount| tasks to the IO thread from |thread_count|
+  // threads that are not WebThreads, or from the UI thread if |thread_count|
+  // is 0, until they all ran.
+  void TimePosting(int thread_count) {
+    std::string test_name =
+        thread_count ? base::StringPrintf("Post %d tasks from %d threads",
+                                          kTaskCount, thread_count)
+                     : base::StringPrintf("Post %d tasks from UI thread",
+                                          kTaskCount);
+    RepeatTimedRuns(
+        test_name,
+        ^base::TimeDelta(int) {
+          int run_count = 0;
+          base::RunLoop run_loop;
+          base::RepeatingClosure task = base::BindRepeating(
+              &CountTask, base::Unretained(&run_count),
+              base::Unretained(&run_loop));
+          base::ElapsedTimer timer;
+          if (thread_count) {
+            PostTaskDelegate delegate(kTaskCount / thread_count, task);
+            base::DelegateSimpleThreadPool pool("WebThreadPerfTest",
+                                                thread_count);
+            pool.AddWork(&delegate, thread_count);
+            pool.Start();
+            run_loop.Run();
+            pool.JoinAll();
+          } else {
+            PostTaskDelegate(kTaskCount, task).Run();
+            run_loop.Run();
+          }
+          base::TimeDelta elapsed = timer.Elapsed();
+          EXPECT_EQ(kTaskCount, run_count);
+          return elapsed;
+        },
+        nil);
+  }
+};
+
+// Tests posting tasks from the UI thread to the IO thread.
+TEST_F(WebThreadPerfTest, PostFromUIThread) {
+  TimePosting(0);
+}
+
+// Tests posting tasks to the IO thread from 4 threads at once.
+TEST_F(WebThreadPerfTest, PostFromOtherThreads) {
+  TimePosting(4);
+}
+
+}  // namespace
@@ -6,9 +6,12 @@
 #define IOS_CHROME_BROWSER_WEB_STATE_LIST_WEB_STATE_LIST_H_
 
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "base/compiler_specific.h"
+#include "base/containers/flat_set.h"
 #include "base/macros.h"
 #include "base/observer_list.h"
 #include "url/gurl.h"
@@ -175,6 +178,33 @@ class WebStateList {
   // specified index to null.
   void ClearOpenersReferencing(int index);
 
+  // Adds |web_state_wrapper| to, or removes it from, the indexes of the
+  // WebStates by pointer, by URL and by opener.
+  void AddToIndexes(WebStateWrapper* web_state_wrapper);
+  void RemoveFromIndexes(WebStateWrapper* web_state_wrapper);
+
+  // Sets the opener of |web_state_wrapper|, keeping the index of the WebStates
+  // by opener up to date.
+  void SetOpenerOfWrapper(WebStateWrapper* web_state_wrapper,
+                          WebStateOpener opener);
+
+  // Updates the index of the WebStates by URL after the visible URL of the
+  // WebState of |web_state_wrapper| may have changed.
+  void UpdateURLIndex(WebStateWrapper* web_state_wrapper);
+
+  // Marks the positions stored in the wrappers from |index| onwards as stale,
+  // after WebStates were inserted, moved or removed.
+  void InvalidatePositionsFrom(int index);
+
+  // Updates the positions stored in the wrappers that are stale. The positions
+  // are updated in bulk, when they are next needed, so that batch operations
+  // update each of them once.
+  void UpdatePositions() const;
+
+  // Returns the index of the first WebState whose visible URL is |url|,
+  // ignoring the WebState at |ignored_index|.
+  int GetIndexOfFirstWebStateWithURL(const GURL& url, int ignored_index) const;
+
   // Notify the observers if the active WebState change. |reason| is the value
   // passed to the WebStateListObservers.
   void NotifyIfActiveWebStateChanged(web::WebState* old_web_state, int reason);
@@ -195,6 +225,19 @@ class WebStateList {
   // Wrappers to the WebStates hosted by the WebStateList.
   std::vector<std::unique_ptr<WebStateWrapper>> web_state_wrappers_;
 
+  // Indexes of the wrappers, avoiding linear scans of |web_state_wrappers_|:
+  // by WebState, by spec of the visible URL of the WebState, and by opener.
+  std::unordered_map<const web::WebState*, WebStateWrapper*>
+      wrappers_by_web_state_;
+  std::unordered_map<std::string, base::flat_set<WebStateWrapper*>>
+      wrappers_by_url_;
+  std::unordered_map<const web::WebState*, base::flat_set<WebStateWrapper*>>
+      wrappers_by_opener_;
+
+  // Index of the first wrapper of |web_state_wrappers_| whose stored position
+  // is stale.
+  mutable int first_stale_position_ = 0;
+
   // An object that determines where new WebState should be inserted and where
   // selection should move when a WebState is detached.
   std::unique_ptr<WebStateListOrderController> order_controller_;
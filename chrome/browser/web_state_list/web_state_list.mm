@@ -9,12 +9,14 @@
 
 #include "base/auto_reset.h"
 #include "base/logging.h"
+#include "base/stl_util.h"
 #import "ios/chrome/browser/web_state_list/web_state_list_delegate.h"
 #import "ios/chrome/browser/web_state_list/web_state_list_observer.h"
 #import "ios/chrome/browser/web_state_list/web_state_list_order_controller.h"
 #import "ios/chrome/browser/web_state_list/web_state_opener.h"
 #import "ios/web/public/navigation/navigation_manager.h"
 #import "ios/web/public/web_state.h"
+#import "ios/web/public/web_state_observer.h"
 
 #if !defined(__has_feature) || !__has_feature(objc_arc)
 #error "This file requires ARC support."
@@ -34,14 +36,27 @@ bool IsClosingFlagSet(int flagset, WebStateList::ClosingFlags flag) {
 
 }  // namespace
 
-// Wrapper around a WebState stored in a WebStateList.
-class WebStateList::WebStateWrapper {
+// Wrapper around a WebState stored in a WebStateList. Observes the WebState to
+// keep the index of the WebStates by URL of the WebStateList up to date.
+class WebStateList::WebStateWrapper : public web::WebStateObserver {
  public:
-  explicit WebStateWrapper(std::unique_ptr<web::WebState> web_state);
-  ~WebStateWrapper();
+  WebStateWrapper(WebStateList* web_state_list,
+                  std::unique_ptr<web::WebState> web_state);
+  ~WebStateWrapper() override;
 
   web::WebState* web_state() const { return web_state_.get(); }
 
+  // Gets and sets the position of the wrapper in the WebStateList. The position
+  // is only valid if it is not stale, see WebStateList::UpdatePositions().
+  int position() const { return position_; }
+  void set_position(int position) { position_ = position; }
+
+  // Gets and sets the spec of the URL under which the wrapper is indexed.
+  const std::string& indexed_url_spec() const { return indexed_url_spec_; }
+  void set_indexed_url_spec(const std::string& spec) {
+    indexed_url_spec_ = spec;
+  }
+
   // Replaces the wrapped WebState (and clear associated state) and returns the
   // old WebState after forfeiting ownership.
   std::unique_ptr<web::WebState> ReplaceWebState(
@@ -59,25 +74,48 @@ class WebStateList::WebStateWrapper {
                    int opener_navigation_index,
                    bool use_group) const;
 
+  // web::WebStateObserver implementation. The visible URL of the WebState may
+  // change on each of these events.
+  void DidStartNavigation(web::WebState* web_state,
+                          web::NavigationContext* navigation_context) override;
+  void DidFinishNavigation(web::WebState* web_state,
+                           web::NavigationContext* navigation_context) override;
+  void DidStopLoading(web::WebState* web_state) override;
+
  private:
+  WebStateList* web_state_list_;
   std::unique_ptr<web::WebState> web_state_;
   WebStateOpener opener_;
+  int position_ = kInvalidIndex;
+  std::string indexed_url_spec_;
 
   DISALLOW_COPY_AND_ASSIGN(WebStateWrapper);
 };
 
 WebStateList::WebStateWrapper::WebStateWrapper(
+    WebStateList* web_state_list,
     std::unique_ptr<web::WebState> web_state)
-    : web_state_(std::move(web_state)), opener_(nullptr) {
+    : web_state_list_(web_state_list),
+      web_state_(std::move(web_state)),
+      opener_(nullptr) {
+  DCHECK(web_state_list_);
   DCHECK(web_state_);
+  web_state_->AddObserver(this);
 }
 
-WebStateList::WebStateWrapper::~WebStateWrapper() = default;
+WebStateList::WebStateWrapper::~WebStateWrapper() {
+  if (web_state_)
+    web_state_->RemoveObserver(this);
+}
 
 std::unique_ptr<web::WebState> WebStateList::WebStateWrapper::ReplaceWebState(
     std::unique_ptr<web::WebState> web_state) {
   DCHECK_NE(web_state.get(), web_state_.get());
+  if (web_state_)
+    web_state_->RemoveObserver(this);
   std::swap(web_state, web_state_);
+  if (web_state_)
+    web_state_->AddObserver(this);
   opener_ = WebStateOpener();
   return web_state;
 }
@@ -95,6 +133,22 @@ bool WebStateList::WebStateWrapper::WasOpenedBy(const web::WebState* opener,
   return opener_.navigation_index == opener_navigation_index;
 }
 
+void WebStateList::WebStateWrapper::DidStartNavigation(
+    web::WebState* web_state,
+    web::NavigationContext* navigation_context) {
+  web_state_list_->UpdateURLIndex(this);
+}
+
+void WebStateList::WebStateWrapper::DidFinishNavigation(
+    web::WebState* web_state,
+    web::NavigationContext* navigation_context) {
+  web_state_list_->UpdateURLIndex(this);
+}
+
+void WebStateList::WebStateWrapper::DidStopLoading(web::WebState* web_state) {
+  web_state_list_->UpdateURLIndex(this);
+}
+
 WebStateList::WebStateList(WebStateListDelegate* delegate)
     : delegate_(delegate),
       order_controller_(std::make_unique<WebStateListOrderController>(this)) {
@@ -126,29 +180,19 @@ web::WebState* WebStateList::GetWebStateAt(int index) const {
 }
 
 int WebStateList::GetIndexOfWebState(const web::WebState* web_state) const {
-  for (int index = 0; index < count(); ++index) {
-    if (web_state_wrappers_[index]->web_state() == web_state)
-      return index;
-  }
-  return kInvalidIndex;
+  auto it = wrappers_by_web_state_.find(web_state);
+  if (it == wrappers_by_web_state_.end())
+    return kInvalidIndex;
+  UpdatePositions();
+  return it->second->position();
 }
 
 int WebStateList::GetIndexOfWebStateWithURL(const GURL& url) const {
-  for (int index = 0; index < count(); ++index) {
-    if (web_state_wrappers_[index]->web_state()->GetVisibleURL() == url)
-      return index;
-  }
-  return kInvalidIndex;
+  return GetIndexOfFirstWebStateWithURL(url, kInvalidIndex);
 }
 
 int WebStateList::GetIndexOfInactiveWebStateWithURL(const GURL& url) const {
-  for (int index = 0; index < count(); ++index) {
-    if (index == active_index_)
-      continue;
-    if (web_state_wrappers_[index]->web_state()->GetVisibleURL() == url)
-      return index;
-  }
-  return kInvalidIndex;
+  return GetIndexOfFirstWebStateWithURL(url, active_index_);
 }
 
 WebStateOpener WebStateList::GetOpenerOfWebStateAt(int index) const {
@@ -159,7 +203,7 @@ WebStateOpener WebStateList::GetOpenerOfWebStateAt(int index) const {
 void WebStateList::SetOpenerOfWebStateAt(int index, WebStateOpener opener) {
   DCHECK(ContainsIndex(index));
   DCHECK(ContainsIndex(GetIndexOfWebState(opener.opener)));
-  web_state_wrappers_[index]->set_opener(opener);
+  SetOpenerOfWrapper(web_state_wrappers_[index].get(), opener);
 }
 
 int WebStateList::GetIndexOfNextWebStateOpenedBy(const web::WebState* opener,
@@ -199,9 +243,12 @@ int WebStateList::InsertWebState(int index,
     delegate_->WillAddWebState(web_state.get());
 
     web::WebState* web_state_ptr = web_state.get();
-    web_state_wrappers_.insert(
-        web_state_wrappers_.begin() + index,
-        std::make_unique<WebStateWrapper>(std::move(web_state)));
+    auto web_state_wrapper =
+        std::make_unique<WebStateWrapper>(this, std::move(web_state));
+    AddToIndexes(web_state_wrapper.get());
+    web_state_wrappers_.insert(web_state_wrappers_.begin() + index,
+                               std::move(web_state_wrapper));
+    InvalidatePositionsFrom(index);
 
     if (active_index_ >= index)
       ++active_index_;
@@ -233,6 +280,7 @@ void WebStateList::MoveWebStateAt(int from_index, int to_index) {
   web_state_wrappers_.erase(web_state_wrappers_.begin() + from_index);
   web_state_wrappers_.insert(web_state_wrappers_.begin() + to_index,
                              std::move(web_state_wrapper));
+  InvalidatePositionsFrom(std::min(from_index, to_index));
 
   if (active_index_ == from_index) {
     active_index_ = to_index;
@@ -257,8 +305,11 @@ std::unique_ptr<web::WebState> WebStateList::ReplaceWebStateAt(
   ClearOpenersReferencing(index);
 
   web::WebState* web_state_ptr = web_state.get();
+  WebStateWrapper* web_state_wrapper = web_state_wrappers_[index].get();
+  RemoveFromIndexes(web_state_wrapper);
   std::unique_ptr<web::WebState> old_web_state =
-      web_state_wrappers_[index]->ReplaceWebState(std::move(web_state));
+      web_state_wrapper->ReplaceWebState(std::move(web_state));
+  AddToIndexes(web_state_wrapper);
 
   for (auto& observer : observers_) {
     observer.WebStateReplacedAt(this, old_web_state.get(), web_state_ptr,
@@ -285,9 +336,11 @@ std::unique_ptr<web::WebState> WebStateList::DetachWebStateAt(int index) {
     observer.WillDetachWebStateAt(this, web_state, index);
 
   ClearOpenersReferencing(index);
+  RemoveFromIndexes(web_state_wrappers_[index].get());
   std::unique_ptr<web::WebState> detached_web_state =
       web_state_wrappers_[index]->ReplaceWebState(nullptr);
   web_state_wrappers_.erase(web_state_wrappers_.begin() + index);
+  InvalidatePositionsFrom(index);
 
   // Update the active index to prevent observer from seeing an invalid WebState
   // as the active one but only send the WebStateActivatedAt notification after
@@ -364,18 +417,113 @@ void WebStateList::PerformBatchOperation(
     observer.WillBeginBatchOperation(this);
   if (!operation.is_null())
     std::move(operation).Run(this);
+  UpdatePositions();
   for (auto& observer : observers_)
     observer.BatchOperationEnded(this);
 }
 
 void WebStateList::ClearOpenersReferencing(int index) {
   web::WebState* old_web_state = web_state_wrappers_[index]->web_state();
-  for (auto& web_state_wrapper : web_state_wrappers_) {
-    if (web_state_wrapper->opener().opener == old_web_state)
-      web_state_wrapper->set_opener(WebStateOpener());
+  auto it = wrappers_by_opener_.find(old_web_state);
+  if (it == wrappers_by_opener_.end())
+    return;
+  // Clearing the openers empties the set of wrappers opened by
+  // |old_web_state|, so iterate over a copy.
+  const base::flat_set<WebStateWrapper*> opened_wrappers = it->second;
+  for (WebStateWrapper* web_state_wrapper : opened_wrappers)
+    SetOpenerOfWrapper(web_state_wrapper, WebStateOpener());
+}
+
+void WebStateList::AddToIndexes(WebStateWrapper* web_state_wrapper) {
+  web::WebState* web_state = web_state_wrapper->web_state();
+  DCHECK(web_state);
+  DCHECK(!base::Contains(wrappers_by_web_state_, web_state));
+  wrappers_by_web_state_[web_state] = web_state_wrapper;
+
+  const std::string& spec = web_state->GetVisibleURL().possibly_invalid_spec();
+  web_state_wrapper->set_indexed_url_spec(spec);
+  wrappers_by_url_[spec].insert(web_state_wrapper);
+
+  if (const web::WebState* opener = web_state_wrapper->opener().opener)
+    wrappers_by_opener_[opener].insert(web_state_wrapper);
+}
+
+void WebStateList::RemoveFromIndexes(WebStateWrapper* web_state_wrapper) {
+  wrappers_by_web_state_.erase(web_state_wrapper->web_state());
+
+  auto url_it = wrappers_by_url_.find(web_state_wrapper->indexed_url_spec());
+  DCHECK(url_it != wrappers_by_url_.end());
+  url_it->second.erase(web_state_wrapper);
+  if (url_it->second.empty())
+    wrappers_by_url_.erase(url_it);
+
+  if (const web::WebState* opener = web_state_wrapper->opener().opener) {
+    auto opener_it = wrappers_by_opener_.find(opener);
+    DCHECK(opener_it != wrappers_by_opener_.end());
+    opener_it->second.erase(web_state_wrapper);
+    if (opener_it->second.empty())
+      wrappers_by_opener_.erase(opener_it);
   }
 }
 
+void WebStateList::SetOpenerOfWrapper(WebStateWrapper* web_state_wrapper,
+                                      WebStateOpener opener) {
+  if (const web::WebState* old_opener = web_state_wrapper->opener().opener) {
+    auto it = wrappers_by_opener_.find(old_opener);
+    DCHECK(it != wrappers_by_opener_.end());
+    it->second.erase(web_state_wrapper);
+    if (it->second.empty())
+      wrappers_by_opener_.erase(it);
+  }
+  web_state_wrapper->set_opener(opener);
+  if (opener.opener)
+    wrappers_by_opener_[opener.opener].insert(web_state_wrapper);
+}
+
+void WebStateList::UpdateURLIndex(WebStateWrapper* web_state_wrapper) {
+  const std::string& spec =
+      web_state_wrapper->web_state()->GetVisibleURL().possibly_invalid_spec();
+  if (spec == web_state_wrapper->indexed_url_spec())
+    return;
+
+  auto it = wrappers_by_url_.find(web_state_wrapper->indexed_url_spec());
+  DCHECK(it != wrappers_by_url_.end());
+  it->second.erase(web_state_wrapper);
+  if (it->second.empty())
+    wrappers_by_url_.erase(it);
+
+  web_state_wrapper->set_indexed_url_spec(spec);
+  wrappers_by_url_[spec].insert(web_state_wrapper);
+}
+
+void WebStateList::InvalidatePositionsFrom(int index) {
+  first_stale_position_ = std::min(first_stale_position_, index);
+}
+
+void WebStateList::UpdatePositions() const {
+  for (int index = first_stale_position_; index < count(); ++index)
+    web_state_wrappers_[index]->set_position(index);
+  first_stale_position_ = count();
+}
+
+int WebStateList::GetIndexOfFirstWebStateWithURL(const GURL& url,
+                                                 int ignored_index) const {
+  auto it = wrappers_by_url_.find(url.possibly_invalid_spec());
+  if (it == wrappers_by_url_.end())
+    return kInvalidIndex;
+
+  UpdatePositions();
+  int first_index = kInvalidIndex;
+  for (const WebStateWrapper* web_state_wrapper : it->second) {
+    const int index = web_state_wrapper->position();
+    if (index == ignored_index)
+      continue;
+    if (first_index == kInvalidIndex || index < first_index)
+      first_index = index;
+  }
+  return first_index;
+}
+
 void WebStateList::NotifyIfActiveWebStateChanged(web::WebState* old_web_state,
                                                  int reason) {
   web::WebState* new_web_state = GetActiveWebState();
@@ -396,20 +544,35 @@ int WebStateList::GetIndexOfNthWebStateOpenedBy(const web::WebState* opener,
   if (!opener || !ContainsIndex(start_index) || start_index == INT_MAX)
     return kInvalidIndex;
 
+  auto it = wrappers_by_opener_.find(opener);
+  if (it == wrappers_by_opener_.end())
+    return kInvalidIndex;
+
   const int opener_navigation_index =
       use_group ? opener->GetNavigationManager()->GetLastCommittedItemIndex()
                 : -1;
 
-  int found_index = kInvalidIndex;
-  for (int index = start_index + 1; index < count() && n; ++index) {
-    if (web_state_wrappers_[index]->WasOpenedBy(opener, opener_navigation_index,
-                                                use_group)) {
-      found_index = index;
-      --n;
-    } else if (found_index != kInvalidIndex) {
-      return found_index;
+  // Collect the indexes of the WebStates opened by |opener| after
+  // |start_index|, and find the |n|-th one of the first contiguous sequence.
+  UpdatePositions();
+  std::vector<int> indexes;
+  for (const WebStateWrapper* web_state_wrapper : it->second) {
+    if (web_state_wrapper->position() > start_index &&
+        web_state_wrapper->WasOpenedBy(opener, opener_navigation_index,
+                                       use_group)) {
+      indexes.push_back(web_state_wrapper->position());
     }
   }
+  std::sort(indexes.begin(), indexes.end());
+
+  int found_index = kInvalidIndex;
+  for (int index : indexes) {
+    if (found_index != kInvalidIndex && index != found_index + 1)
+      break;
+    found_index = index;
+    if (--n == 0)
+      break;
+  }
 
   return found_index;
 }
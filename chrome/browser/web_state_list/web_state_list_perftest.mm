@@ -0,0 +1,94 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/chrome/browser/web_state_list/web_state_list.h"
+
+#include <memory>
+
+#include "base/bind.h"
+#include "base/strings/stringprintf.h"
+#include "base/timer/elapsed_timer.h"
+#import "ios/chrome/browser/web_state_list/fake_web_state_list_delegate.h"
+#import "ios/chrome/browser/web_state_list/web_state_opener.h"
+#include "ios/chrome/test/base/perf_test_ios.h"
+#import "ios/web/public/test/fakes/test_web_state.h"
+#include "url/gurl.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace {
+
+// Number of WebStates in the WebStateList, as for a large session.
+const int kWebStateCount = 1000;
+
+// Returns the URL of the |index|-th WebState.
+GURL GetURL(int index) {
+  return GURL(base::StringPrintf("https://chromium.org/%d", index));
+}
+
+// Inserts |kWebStateCount| WebStates in |web_state_list|, each opened by the
+// previous one.
+void InsertWebStates(WebStateList* web_state_list) {
+  for (int index = 0; index < kWebStateCount; ++index) {
+    auto web_state = std::make_unique<web::TestWebState>();
+    web_state->SetCurrentURL(GetURL(index));
+    web_state_list->InsertWebState(
+        index, std::move(web_state),
+        WebStateList::INSERT_FORCE_INDEX | WebStateList::INSERT_INHERIT_OPENER |
+            WebStateList::INSERT_ACTIVATE,
+        WebStateOpener());
+  }
+}
+
+class WebStateListPerfTest : public PerfTest {
+ protected:
+  WebStateListPerfTest()
+      : PerfTest("WebStateList"), web_state_list_(&web_state_list_delegate_) {}
+
+  FakeWebStateListDelegate web_state_list_delegate_;
+  WebStateList web_state_list_;
+};
+
+// Tests inserting and closing the WebStates of a large session in batch
+// operations, as when restoring a session and closing all the tabs.
+TEST_F(WebStateListPerfTest, InsertAndCloseAll) {
+  WebStateList* web_state_list = &web_state_list_;
+  RepeatTimedRuns("Insert and close 1000 WebStates",
+                  ^base::TimeDelta(int) {
+                    base::ElapsedTimer timer;
+                    web_state_list->PerformBatchOperation(
+                        base::BindOnce(&InsertWebStates));
+                    web_state_list->CloseAllWebStates(
+                        WebStateList::CLOSE_NO_FLAGS);
+                    return timer.Elapsed();
+                  },
+                  nil);
+}
+
+// Tests looking up each WebState of a large session by pointer, by URL and by
+// opener.
+TEST_F(WebStateListPerfTest, Lookups) {
+  web_state_list_.PerformBatchOperation(base::BindOnce(&InsertWebStates));
+  WebStateList* web_state_list = &web_state_list_;
+  RepeatTimedRuns(
+      "Look up 1000 WebStates",
+      ^base::TimeDelta(int) {
+        base::ElapsedTimer timer;
+        for (int index = 0; index < kWebStateCount; ++index) {
+          web::WebState* web_state = web_state_list->GetWebStateAt(index);
+          EXPECT_EQ(index, web_state_list->GetIndexOfWebState(web_state));
+          EXPECT_EQ(index,
+                    web_state_list->GetIndexOfWebStateWithURL(GetURL(index)));
+          web_state_list->GetIndexOfInactiveWebStateWithURL(GetURL(index));
+          web_state_list->GetIndexOfNextWebStateOpenedBy(web_state, index,
+                                                         /*use_group=*/false);
+        }
+        return timer.Elapsed();
+      },
+      nil);
+}
+
+}  // namespace
@@ -9,6 +9,7 @@
 #import "ios/chrome/browser/web_state_list/fake_web_state_list_delegate.h"
 #import "ios/chrome/browser/web_state_list/web_state_list_observer.h"
 #import "ios/chrome/browser/web_state_list/web_state_opener.h"
+#import "ios/web/public/test/fakes/fake_navigation_context.h"
 #import "ios/web/public/test/fakes/test_navigation_manager.h"
 #import "ios/web/public/test/fakes/test_web_state.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -356,6 +357,27 @@ TEST_F(WebStateListTest, GetIndexOfInactiveWebStateWithURL) {
   EXPECT_EQ(2, web_state_list_.GetIndexOfInactiveWebStateWithURL(GURL(kURL0)));
 }
 
+// Test finding a webstate by URL after it navigated to that URL.
+TEST_F(WebStateListTest, GetIndexOfWebStateWithURLAfterNavigation) {
+  AppendNewWebState(kURL0);
+  AppendNewWebState(kURL1);
+  ASSERT_EQ(1, web_state_list_.GetIndexOfWebStateWithURL(GURL(kURL1)));
+
+  web::TestWebState* web_state =
+      static_cast<web::TestWebState*>(web_state_list_.GetWebStateAt(0));
+  web_state->SetCurrentURL(GURL(kURL1));
+  web::FakeNavigationContext context;
+  web_state->OnNavigationFinished(&context);
+  EXPECT_EQ(0, web_state_list_.GetIndexOfWebStateWithURL(GURL(kURL1)));
+  EXPECT_EQ(WebStateList::kInvalidIndex,
+            web_state_list_.GetIndexOfWebStateWithURL(GURL(kURL0)));
+
+  // The index follows the webstate when it is moved.
+  web_state_list_.MoveWebStateAt(0, 1);
+  EXPECT_EQ(0, web_state_list_.GetIndexOfWebStateWithURL(GURL(kURL1)));
+  EXPECT_EQ(1, web_state_list_.GetIndexOfWebState(web_state));
+}
+
 // Test that inserted webstates correctly inherit openers.
 TEST_F(WebStateListTest, InsertInheritOpener) {
   AppendNewWebState(kURL0);
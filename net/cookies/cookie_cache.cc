@@ -5,7 +5,9 @@
 #include "ios/net/cookies/cookie_cache.h"
 
 #include <algorithm>
+#include <functional>
 
+#include "base/hash/hash.h"
 #include "base/logging.h"
 #include "net/cookies/cookie_options.h"
 
@@ -22,50 +24,81 @@ bool CookieCache::Update(const GURL& url,
                          const std::vector<net::CanonicalCookie>& new_cookies,
                          std::vector<net::CanonicalCookie>* out_removed_cookies,
                          std::vector<net::CanonicalCookie>* out_added_cookies) {
-  CookieKey key(url, name);
-  CookieSet old_set = cache_[key];
-  CookieSet new_set(new_cookies.begin(), new_cookies.end());
-
-  // Compute the changes and the removals.
-  CookieSet added_cookies;
-  CookieSet removed_cookies;
-  std::set_difference(new_set.begin(), new_set.end(), old_set.begin(),
-                      old_set.end(),
-                      std::inserter(added_cookies, added_cookies.begin()),
-                      CookieCache::CookieAndValueComparator());
-  std::set_difference(old_set.begin(), old_set.end(), new_set.begin(),
-                      new_set.end(),
-                      std::inserter(removed_cookies, removed_cookies.begin()),
-                      CookieCache::CookieAndValueComparator());
-
-  if (added_cookies.empty() && removed_cookies.empty())
-    return false;
+  CookieVector& old_cookies = cache_[CookieKey(url, name)];
+  const CookieComparator less;
 
-  cache_[key] = new_set;
-  if (out_removed_cookies) {
-    out_removed_cookies->insert(out_removed_cookies->end(),
-                                removed_cookies.begin(), removed_cookies.end());
-  }
-  if (out_added_cookies) {
-    out_added_cookies->insert(out_added_cookies->end(), added_cookies.begin(),
-                              added_cookies.end());
+  // Sort the new cookies without copying them. When several cookies share the
+  // same (domain, path, name), the first one is kept.
+  std::vector<const net::CanonicalCookie*> new_sorted;
+  new_sorted.reserve(new_cookies.size());
+  for (const net::CanonicalCookie& cookie : new_cookies)
+    new_sorted.push_back(&cookie);
+  std::stable_sort(new_sorted.begin(), new_sorted.end(),
+                   [&less](const net::CanonicalCookie* lhs,
+                           const net::CanonicalCookie* rhs) {
+                     return less(*lhs, *rhs);
+                   });
+  new_sorted.erase(std::unique(new_sorted.begin(), new_sorted.end(),
+                               [&less](const net::CanonicalCookie* lhs,
+                                       const net::CanonicalCookie* rhs) {
+                                 return !less(*lhs, *rhs);
+                               }),
+                   new_sorted.end());
+
+  // Compute the changes and the removals in a single merge pass.
+  bool changed = false;
+  auto old_it = old_cookies.begin();
+  auto new_it = new_sorted.begin();
+  while (old_it != old_cookies.end() || new_it != new_sorted.end()) {
+    if (new_it == new_sorted.end() ||
+        (old_it != old_cookies.end() && less(*old_it, **new_it))) {
+      changed = true;
+      if (out_removed_cookies)
+        out_removed_cookies->push_back(*old_it);
+      ++old_it;
+    } else if (old_it == old_cookies.end() || less(**new_it, *old_it)) {
+      changed = true;
+      if (out_added_cookies)
+        out_added_cookies->push_back(**new_it);
+      ++new_it;
+    } else {
+      if (old_it->Value() != (*new_it)->Value()) {
+        changed = true;
+        if (out_removed_cookies)
+          out_removed_cookies->push_back(*old_it);
+        if (out_added_cookies)
+          out_added_cookies->push_back(**new_it);
+      }
+      ++old_it;
+      ++new_it;
+    }
   }
+
+  if (!changed)
+    return false;
+
+  old_cookies.clear();
+  old_cookies.reserve(new_sorted.size());
+  for (const net::CanonicalCookie* cookie : new_sorted)
+    old_cookies.push_back(*cookie);
   return true;
 }
 
-bool CookieCache::CookieComparator::operator()(
-    const net::CanonicalCookie& lhs,
-    const net::CanonicalCookie& rhs) const {
-  if (lhs.Domain() != rhs.Domain())
-    return lhs.Domain() < rhs.Domain();
-  if (lhs.Path() != rhs.Path())
-    return lhs.Path() < rhs.Path();
-  if (lhs.Name() != rhs.Name())
-    return lhs.Name() < rhs.Name();
-  return false;
+CookieCache::CookieKey::CookieKey(const GURL& url, const std::string& name)
+    : url(url),
+      name(name),
+      hash(base::HashInts(std::hash<std::string>()(url.spec()),
+                          std::hash<std::string>()(name))) {}
+
+CookieCache::CookieKey::CookieKey(CookieKey&& other) = default;
+
+CookieCache::CookieKey::~CookieKey() = default;
+
+bool CookieCache::CookieKey::operator==(const CookieKey& other) const {
+  return hash == other.hash && name == other.name && url == other.url;
 }
 
-bool CookieCache::CookieAndValueComparator::operator()(
+bool CookieCache::CookieComparator::operator()(
     const net::CanonicalCookie& lhs,
     const net::CanonicalCookie& rhs) const {
   if (lhs.Domain() != rhs.Domain())
@@ -74,8 +107,6 @@ bool CookieCache::CookieAndValueComparator::operator()(
     return lhs.Path() < rhs.Path();
   if (lhs.Name() != rhs.Name())
     return lhs.Name() < rhs.Name();
-  if (lhs.Value() != rhs.Value())
-    return lhs.Value() < rhs.Value();
   return false;
 }
 
@@ -5,10 +5,11 @@
 #ifndef IOS_NET_COOKIES_COOKIE_CACHE_H_
 #define IOS_NET_COOKIES_COOKIE_CACHE_H_
 
-#include <map>
-#include <set>
+#include <stddef.h>
+
 #include <string>
-#include <utility>
+#include <unordered_map>
+#include <vector>
 
 #include "base/macros.h"
 #include "net/cookies/canonical_cookie.h"
@@ -48,25 +49,35 @@ class CookieCache {
 
  private:
   // Compares two cookies, returning true if |lhs| comes before |rhs| in the
-  // partial ordering defined for CookieSet. This effectively does a
+  // partial ordering defined for CookieVector. This effectively does a
   // lexicographic comparison of (domain, path, name) tuples for two cookies.
   struct CookieComparator {
     bool operator()(const net::CanonicalCookie& lhs,
                     const net::CanonicalCookie& rhs) const;
   };
 
-  // Compares two cookies, returning true if |lhs| comes before |rhs| in the
-  // partial ordering defined for CookieSet. This effectively does a
-  // lexicographic comparison of (domain, path, name, value) tuples for two
-  // cookies.
-  struct CookieAndValueComparator {
-    bool operator()(const net::CanonicalCookie& lhs,
-                    const net::CanonicalCookie& rhs) const;
+  // Key of the cache. The hash of the (url, name) pair is computed once when
+  // the key is built.
+  struct CookieKey {
+    CookieKey(const GURL& url, const std::string& name);
+    CookieKey(CookieKey&& other);
+    ~CookieKey();
+
+    bool operator==(const CookieKey& other) const;
+
+    GURL url;
+    std::string name;
+    size_t hash;
+  };
+
+  struct CookieKeyHash {
+    size_t operator()(const CookieKey& key) const { return key.hash; }
   };
 
-  typedef std::set<net::CanonicalCookie, CookieComparator> CookieSet;
-  typedef std::pair<GURL, std::string> CookieKey;
-  typedef std::map<CookieKey, CookieSet> CookieKeyPathMap;
+  // Cookies sorted by CookieComparator, without duplicates.
+  typedef std::vector<net::CanonicalCookie> CookieVector;
+  typedef std::unordered_map<CookieKey, CookieVector, CookieKeyHash>
+      CookieKeyPathMap;
 
   CookieKeyPathMap cache_;
 
@@ -4,6 +4,9 @@
 
 #include "ios/net/cookies/cookie_cache.h"
 
+#include <algorithm>
+
+#include "base/strings/string_number_conversions.h"
 #include "net/cookies/canonical_cookie.h"
 #include "net/cookies/cookie_constants.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -169,4 +172,51 @@ TEST_F(CookieCacheTest, MultipleNames) {
   EXPECT_FALSE(cache.Update(cookieurl, "abc", cookies, nullptr, nullptr));
 }
 
+TEST_F(CookieCacheTest, DuplicateCookiesKeepFirst) {
+  CookieCache cache;
+  const GURL test_url("http://www.google.com");
+  std::vector<CanonicalCookie> cookies;
+  cookies.push_back(MakeCookie(test_url, "abc", "def"));
+  cookies.push_back(MakeCookie(test_url, "abc", "ghi"));
+  std::vector<net::CanonicalCookie> removed;
+  std::vector<net::CanonicalCookie> changed;
+  EXPECT_TRUE(cache.Update(test_url, "abc", cookies, &removed, &changed));
+  ASSERT_EQ(1U, changed.size());
+  EXPECT_EQ("def", changed[0].Value());
+
+  cookies.erase(cookies.begin());
+  changed.clear();
+  EXPECT_TRUE(cache.Update(test_url, "abc", cookies, &removed, &changed));
+  ASSERT_EQ(1U, removed.size());
+  EXPECT_EQ("def", removed[0].Value());
+  ASSERT_EQ(1U, changed.size());
+  EXPECT_EQ("ghi", changed[0].Value());
+}
+
+// Tests that updating a large jar detects the changes only, whatever the order
+// of the cookies. The timings are measured by the CookieCache perftest.
+TEST_F(CookieCacheTest, LargeJar) {
+  const size_t kCookieCount = 50000;
+  CookieCache cache;
+  const GURL test_url("http://www.google.com");
+  std::vector<CanonicalCookie> cookies;
+  for (size_t i = 0; i < kCookieCount; ++i) {
+    const GURL cookie_url("http://www.google.com/" + base::NumberToString(i));
+    cookies.push_back(MakeCookie(cookie_url, "abc", base::NumberToString(i)));
+  }
+  EXPECT_TRUE(cache.Update(test_url, "abc", cookies, nullptr, nullptr));
+
+  std::reverse(cookies.begin(), cookies.end());
+  EXPECT_FALSE(cache.Update(test_url, "abc", cookies, nullptr, nullptr));
+
+  cookies[0] = MakeCookie(test_url, "abc", "new");
+  cookies.pop_back();
+  std::vector<net::CanonicalCookie> removed;
+  std::vector<net::CanonicalCookie> changed;
+  EXPECT_TRUE(cache.Update(test_url, "abc", cookies, &removed, &changed));
+  EXPECT_EQ(2U, removed.size());
+  ASSERT_EQ(1U, changed.size());
+  EXPECT_EQ("new", changed[0].Value());
+}
+
 }  // namespace net
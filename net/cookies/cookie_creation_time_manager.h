@@ -5,13 +5,16 @@
 #ifndef IOS_NET_COOKIES_COOKIE_CREATION_TIME_MANAGER_H_
 #define IOS_NET_COOKIES_COOKIE_CREATION_TIME_MANAGER_H_
 
-#include <set>
+#include <stdint.h>
+
 #include <unordered_map>
+#include <unordered_set>
 
 #include "base/memory/weak_ptr.h"
 #include "base/threading/thread_checker.h"
 #include "base/time/time.h"
 
+@class NSArray;
 @class NSHTTPCookie;
 
 namespace net {
@@ -32,10 +35,16 @@ class CookieCreationTimeManager {
   // |creation_time| must be unique (not used by another cookie).
   void SetCreationTime(NSHTTPCookie* cookie, const base::Time& creation_time);
   // Creates a unique creation time (to be used in SetCreationTime()) that is
-  // as close as possible to |creation_time|.
+  // |creation_time| if available, or the next time available after the last
+  // unique time made for |creation_time|. This is amortized constant time, even
+  // when many cookies share the same |creation_time|.
   base::Time MakeUniqueCreationTime(const base::Time& creation_time);
   // Gets the creation time for |cookie|.
   base::Time GetCreationTime(NSHTTPCookie* cookie);
+  // Loads the creation times of all the NSHTTPCookies of |cookies| that do not
+  // have one yet. Equivalent to calling GetCreationTime() on each of them, but
+  // sizes the internal tables once for the whole batch.
+  void LoadCreationTimes(NSArray* cookies);
   // Deletes the creation time for |cookie|.
   void DeleteCreationTime(NSHTTPCookie* cookie);
   // Clears all the creation times.
@@ -44,8 +53,19 @@ class CookieCreationTimeManager {
   base::WeakPtr<CookieCreationTimeManager> GetWeakPtr();
 
  private:
-  std::unordered_map<std::string, base::Time> creation_times_;
-  std::set<base::Time> unique_times_;
+  // Removes |time_value| from the used times, along with its search hint in
+  // |next_unique_times_|.
+  void ReleaseTime(int64_t time_value);
+
+  // Creation times, keyed by the hash of the (name, domain, path) identity of
+  // the cookie.
+  std::unordered_map<uint64_t, base::Time> creation_times_;
+  // Internal values of the times of |creation_times_|.
+  std::unordered_set<int64_t> unique_times_;
+  // Maps a time requested to MakeUniqueCreationTime() to the last unique time
+  // made for it, from which the next search starts. Only used times have a
+  // hint, so this is never larger than |unique_times_|.
+  std::unordered_map<int64_t, int64_t> next_unique_times_;
   base::ThreadChecker thread_checker_;
   base::WeakPtrFactory<CookieCreationTimeManager> weak_factory_;
 };
@@ -7,8 +7,9 @@
 #import <Foundation/Foundation.h>
 #include <stddef.h>
 
+#include <algorithm>
+
 #include "base/logging.h"
-#include "base/strings/sys_string_conversions.h"
 #include "base/time/time.h"
 #include "ios/net/ios_net_buildflags.h"
 
@@ -43,11 +44,32 @@ base::Time GetCreationTimeFromObject(NSHTTPCookie* cookie) {
   return base::Time::FromCFAbsoluteTime(absolute_time);
 }
 
-// Gets a string that can be used as a unique identifier for |cookie|.
-std::string GetCookieUniqueID(NSHTTPCookie* cookie) {
-  return base::SysNSStringToUTF8([cookie name]) + ";" +
-         base::SysNSStringToUTF8([cookie domain]) + ";" +
-         base::SysNSStringToUTF8([cookie path]);
+// Parameters of the 64-bit FNV-1a hash.
+const uint64_t kFNVOffsetBasis = 14695981039346656037ULL;
+const uint64_t kFNVPrime = 1099511628211ULL;
+
+// Adds the UTF-16 code units of |string| and a separator to |hash|, without
+// copying |string|.
+uint64_t HashString(uint64_t hash, NSString* string) {
+  CFStringRef cf_string = (__bridge CFStringRef)string;
+  const CFIndex length = string ? CFStringGetLength(cf_string) : 0;
+  CFStringInlineBuffer buffer;
+  CFStringInitInlineBuffer(cf_string, &buffer, CFRangeMake(0, length));
+  for (CFIndex i = 0; i < length; ++i) {
+    const UniChar c = CFStringGetCharacterFromInlineBuffer(&buffer, i);
+    hash = (hash ^ (c & 0xFF)) * kFNVPrime;
+    hash = (hash ^ (c >> 8)) * kFNVPrime;
+  }
+  // Separator, so that ("ab", "c") and ("a", "bc") hash differently.
+  return (hash ^ 0xFFFF) * kFNVPrime;
+}
+
+// Gets a 64-bit hash that can be used as a unique identifier for |cookie|.
+uint64_t GetCookieUniqueID(NSHTTPCookie* cookie) {
+  uint64_t hash = kFNVOffsetBasis;
+  hash = HashString(hash, [cookie name]);
+  hash = HashString(hash, [cookie domain]);
+  return HashString(hash, [cookie path]);
 }
 
 }  // namespace
@@ -65,44 +87,46 @@ void CookieCreationTimeManager::SetCreationTime(
     NSHTTPCookie* cookie,
     const base::Time& creation_time) {
   DCHECK(thread_checker_.CalledOnValidThread());
-  DCHECK(unique_times_.find(creation_time) == unique_times_.end());
+  const int64_t time_value = creation_time.ToInternalValue();
+  DCHECK(unique_times_.find(time_value) == unique_times_.end());
 
   // If the cookie overrides an existing cookie, remove its creation time.
-  auto it = creation_times_.find(GetCookieUniqueID(cookie));
-  if (it != creation_times_.end()) {
-    size_t erased = unique_times_.erase(it->second);
-    DCHECK_EQ(1u, erased);
+  auto result =
+      creation_times_.emplace(GetCookieUniqueID(cookie), creation_time);
+  if (!result.second) {
+    ReleaseTime(result.first->second.ToInternalValue());
+    result.first->second = creation_time;
   }
 
-  unique_times_.insert(creation_time);
-  creation_times_[GetCookieUniqueID(cookie)] = creation_time;
+  unique_times_.insert(time_value);
 }
 
 base::Time CookieCreationTimeManager::MakeUniqueCreationTime(
     const base::Time& creation_time) {
   DCHECK(thread_checker_.CalledOnValidThread());
-  auto it = unique_times_.find(creation_time);
-
-  if (it == unique_times_.end())
+  const int64_t time_value = creation_time.ToInternalValue();
+  if (unique_times_.find(time_value) == unique_times_.end())
     return creation_time;
 
-  // If the time already exist, increment until we find a time available.
-  // |unique_times_| is sorted according to time, so we can traverse it from
-  // |it|.
-  base::Time time = creation_time;
+  // If the time already exist, increment until we find a time available,
+  // starting after the last time made for |creation_time| as all the times
+  // before it were used.
+  int64_t& next_time = next_unique_times_[time_value];
+  int64_t time = std::max(time_value, next_time);
   do {
-    DCHECK(time == *it);
-    ++it;
-    time = base::Time::FromInternalValue(time.ToInternalValue() + 1);
-  } while (it != unique_times_.end() && *it == time);
-
-  return time;
+    ++time;
+  } while (unique_times_.find(time) != unique_times_.end());
+  next_time = time;
+  // Hints are only kept for used times, so there are never more hints than
+  // cookies.
+  DCHECK_LE(next_unique_times_.size(), unique_times_.size());
+
+  return base::Time::FromInternalValue(time);
 }
 
 base::Time CookieCreationTimeManager::GetCreationTime(NSHTTPCookie* cookie) {
   DCHECK(thread_checker_.CalledOnValidThread());
-  std::unordered_map<std::string, base::Time>::iterator it =
-      creation_times_.find(GetCookieUniqueID(cookie));
+  auto it = creation_times_.find(GetCookieUniqueID(cookie));
   if (it != creation_times_.end())
     return it->second;
 
@@ -112,12 +136,20 @@ base::Time CookieCreationTimeManager::GetCreationTime(NSHTTPCookie* cookie) {
   return native_creation_time;
 }
 
+void CookieCreationTimeManager::LoadCreationTimes(NSArray* cookies) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  const size_t count = creation_times_.size() + [cookies count];
+  creation_times_.reserve(count);
+  unique_times_.reserve(count);
+  for (NSHTTPCookie* cookie in cookies)
+    GetCreationTime(cookie);
+}
+
 void CookieCreationTimeManager::DeleteCreationTime(NSHTTPCookie* cookie) {
   DCHECK(thread_checker_.CalledOnValidThread());
   auto it = creation_times_.find(GetCookieUniqueID(cookie));
   if (it != creation_times_.end()) {
-    size_t erased = unique_times_.erase(it->second);
-    DCHECK_EQ(1u, erased);
+    ReleaseTime(it->second.ToInternalValue());
     creation_times_.erase(it);
   }
 }
@@ -126,6 +158,7 @@ void CookieCreationTimeManager::Clear() {
   DCHECK(thread_checker_.CalledOnValidThread());
   creation_times_.clear();
   unique_times_.clear();
+  next_unique_times_.clear();
 }
 
 base::WeakPtr<CookieCreationTimeManager>
@@ -133,4 +166,12 @@ CookieCreationTimeManager::GetWeakPtr() {
   return weak_factory_.GetWeakPtr();
 }
 
+void CookieCreationTimeManager::ReleaseTime(int64_t time_value) {
+  size_t erased = unique_times_.erase(time_value);
+  DCHECK_EQ(1u, erased);
+  // The next MakeUniqueCreationTime() for |time_value| returns it directly, so
+  // its search hint is no longer needed.
+  next_unique_times_.erase(time_value);
+}
+
 }  // namespace net
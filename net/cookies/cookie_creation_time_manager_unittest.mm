@@ -122,4 +122,82 @@ TEST_F(CookieCreationTimeManagerTest, MakeUniqueCreationTimeConflicts) {
   EXPECT_EQ(time_internal_value + 3, time.ToInternalValue());
 }
 
+// Tests that many cookies sharing the same creation time all get unique times
+// in increasing order.
+TEST_F(CookieCreationTimeManagerTest, MakeUniqueCreationTimeBurst) {
+  const int kCookieCount = 10000;
+  base::Time creation_time = base::Time::Now();
+  int64_t time_internal_value = creation_time.ToInternalValue();
+  for (int i = 0; i < kCookieCount; ++i) {
+    base::Time time =
+        creation_time_manager_.MakeUniqueCreationTime(creation_time);
+    EXPECT_EQ(time_internal_value + i, time.ToInternalValue());
+    creation_time_manager_.SetCreationTime(
+        GetCookie([NSString stringWithFormat:@"A%d=B", i]), time);
+  }
+}
+
+// Tests that deleting the cookies of a burst drops the search hint of their
+// creation time, so that a new burst reuses the freed times.
+TEST_F(CookieCreationTimeManagerTest, MakeUniqueCreationTimeAfterDeletion) {
+  const int kCookieCount = 3;
+  base::Time creation_time = base::Time::Now();
+  int64_t time_internal_value = creation_time.ToInternalValue();
+  for (int round = 0; round < 2; ++round) {
+    for (int i = 0; i < kCookieCount; ++i) {
+      base::Time time =
+          creation_time_manager_.MakeUniqueCreationTime(creation_time);
+      EXPECT_EQ(time_internal_value + i, time.ToInternalValue());
+      creation_time_manager_.SetCreationTime(
+          GetCookie([NSString stringWithFormat:@"A%d=B", i]), time);
+    }
+    for (int i = 0; i < kCookieCount; ++i) {
+      creation_time_manager_.DeleteCreationTime(
+          GetCookie([NSString stringWithFormat:@"A%d=B", i]));
+    }
+  }
+}
+
+TEST_F(CookieCreationTimeManagerTest, LoadCreationTimes) {
+  NSHTTPCookie* cookie1 = GetCookie(@"A=B");
+  NSHTTPCookie* cookie2 = GetCookie(@"C=D");
+  ASSERT_TRUE(cookie1);
+  ASSERT_TRUE(cookie2);
+  base::Time creation_time = base::Time::Now();
+  creation_time_manager_.SetCreationTime(cookie1, creation_time);
+
+  creation_time_manager_.LoadCreationTimes(@[ cookie1, cookie2 ]);
+  // The creation time of |cookie1| is kept, and |cookie2| gets the one of the
+  // system.
+  EXPECT_EQ(creation_time, creation_time_manager_.GetCreationTime(cookie1));
+  base::Time time2 = creation_time_manager_.GetCreationTime(cookie2);
+  EXPECT_FALSE(time2.is_null());
+  EXPECT_NE(creation_time, time2);
+}
+
+// Tests that cookies with the same name but different domains or paths have
+// distinct creation times.
+TEST_F(CookieCreationTimeManagerTest, CookieIdentity) {
+  NSHTTPCookie* cookie1 = [NSHTTPCookie cookieWithProperties:@{
+    NSHTTPCookiePath : @"/a",
+    NSHTTPCookieName : @"A",
+    NSHTTPCookieValue : @"B",
+    NSHTTPCookieDomain : @"foo",
+  }];
+  NSHTTPCookie* cookie2 = [NSHTTPCookie cookieWithProperties:@{
+    NSHTTPCookiePath : @"/",
+    NSHTTPCookieName : @"A",
+    NSHTTPCookieValue : @"B",
+    NSHTTPCookieDomain : @"foo/a",
+  }];
+  base::Time creation_time = base::Time::Now();
+  base::Time other_creation_time =
+      creation_time - base::TimeDelta::FromSeconds(1);
+  creation_time_manager_.SetCreationTime(cookie1, creation_time);
+  creation_time_manager_.SetCreationTime(cookie2, other_creation_time);
+  EXPECT_EQ(creation_time, creation_time_manager_.GetCreationTime(cookie1));
+  EXPECT_EQ(other_creation_time,
+            creation_time_manager_.GetCreationTime(cookie2));
+}
+
 }  // namespace net
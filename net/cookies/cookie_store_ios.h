@@ -81,6 +81,15 @@ class CookieStoreIOS : public net::CookieStore,
   // Only one cookie store may enable metrics.
   void SetMetricsEnabled();
 
+  // Sets the window within which system cookie change notifications are
+  // coalesced into a single cache update. Defaults to zero, which coalesces
+  // the notifications received before the current task completes.
+  void SetCookieChangeBatchDelay(base::TimeDelta delay);
+
+  // Returns the number of cookie store queries avoided by coalescing the
+  // system cookie change notifications and grouping subscriptions by URL.
+  size_t cookie_queries_saved() const { return cookie_queries_saved_; }
+
   // Implementation of the net::CookieStore interface.
   void SetCanonicalCookieAsync(std::unique_ptr<CanonicalCookie> cookie,
                                std::string source_scheme,
@@ -182,6 +191,11 @@ class CookieStoreIOS : public net::CookieStore,
   // Inherited CookieNotificationObserver methods.
   void OnSystemCookiesChanged() override;
 
+  // Fetches new values from the system store for all (url, name) pairs that
+  // have hooks registered, with one query per URL, and runs the callbacks if
+  // necessary. Called once per burst of OnSystemCookiesChanged().
+  void UpdateCachesFromSystem();
+
   void DeleteCookiesMatchingInfoAsync(net::CookieDeletionInfo delete_info,
                                       DeleteCallback callback);
 
@@ -225,6 +239,22 @@ class CookieStoreIOS : public net::CookieStore,
                                       const std::string& cookie_name,
                                       bool run_callbacks);
 
+  // Updates the cookie cache with the cookies named after one of |names| from
+  // the current set of |nscookies| that would be sent with a request for
+  // |url|, then runs the callbacks of all the names whose cache changed.
+  void UpdateCacheForURLFromSystemCookies(const GURL& gurl,
+                                          const std::vector<std::string>& names,
+                                          NSArray<NSHTTPCookie*>* nscookies);
+
+  // Updates the cookie cache for all the (gurl, name) pairs of
+  // |cookies_by_name|. The callbacks are run once the cache is updated for all
+  // the names, so that they observe a consistent cache for |gurl|. They are
+  // run name by name, removals before insertions.
+  void UpdateCacheForURLAndRunCallbacks(
+      const GURL& gurl,
+      const std::map<std::string, std::vector<net::CanonicalCookie>>&
+          cookies_by_name);
+
   // Runs all callbacks registered for cookies named |name| that would be sent
   // with a request for |url|.
   // All cookies in |cookies| must have the name equal to |name|.
@@ -234,14 +264,19 @@ class CookieStoreIOS : public net::CookieStore,
                               net::CookieChangeCause cause);
 
   // Called by this CookieStoreIOS' internal CookieMonster instance when
-  // UpdateCachesFromCookieMonster completes. Updates the cookie cache and runs
-  // callbacks if the cache changed.
-  void GotCookieListFor(const std::pair<GURL, std::string> key,
-                        const net::CookieStatusList& cookies,
-                        const net::CookieStatusList& excluded_cookies);
+  // UpdateCachesFromCookieMonster completes. Updates the cookie cache for all
+  // the hooked |names| of |gurl| and runs callbacks if the cache changed.
+  void GotCookieListForURL(const GURL& gurl,
+                           const std::vector<std::string>& names,
+                           const net::CookieStatusList& cookies,
+                           const net::CookieStatusList& excluded_cookies);
+
+  // Returns the hooked (url, name) pairs grouped by URL.
+  std::vector<std::pair<GURL, std::vector<std::string>>> GetHookedNamesByURL()
+      const;
 
   // Fetches new values for all (url, name) pairs that have hooks registered,
-  // asynchronously invoking callbacks if necessary.
+  // with one query per URL, asynchronously invoking callbacks if necessary.
   void UpdateCachesFromCookieMonster();
 
   // Callback-wrapping:
@@ -298,6 +333,14 @@ class CookieStoreIOS : public net::CookieStore,
 
   base::LinkedList<Subscription> all_subscriptions_;
 
+  // Window within which system cookie change notifications are coalesced.
+  base::TimeDelta cookie_change_batch_delay_;
+  // Number of system cookie change notifications received since the last
+  // call to UpdateCachesFromSystem().
+  size_t pending_system_cookie_changes_ = 0;
+  // Number of queries avoided by batching, see cookie_queries_saved().
+  size_t cookie_queries_saved_ = 0;
+
   CookieChangeDispatcherIOS change_dispatcher_;
 
   base::WeakPtrFactory<CookieStoreIOS> weak_factory_;
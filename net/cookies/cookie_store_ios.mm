@@ -505,13 +505,22 @@ void CookieStoreIOS::DeleteCookiesMatchingPredicateAsync(
       }));
 }
 
+void CookieStoreIOS::SetCookieChangeBatchDelay(base::TimeDelta delay) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  cookie_change_batch_delay_ = delay;
+}
+
 void CookieStoreIOS::OnSystemCookiesChanged() {
   DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
 
-  for (const auto& hook_map_entry : hook_map_) {
-    std::pair<GURL, std::string> key = hook_map_entry.first;
-    UpdateCacheForCookieFromSystem(key.first, key.second,
-                                   /*run_callbacks=*/true);
+  // The system store fires notifications in bursts. Only the first
+  // notification of a burst schedules a cache update.
+  if (pending_system_cookie_changes_++ == 0) {
+    base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+        FROM_HERE,
+        base::BindOnce(&CookieStoreIOS::UpdateCachesFromSystem,
+                       weak_factory_.GetWeakPtr()),
+        cookie_change_batch_delay_);
   }
 
   // Do not schedule a flush if one is already scheduled.
@@ -524,6 +533,27 @@ void CookieStoreIOS::OnSystemCookiesChanged() {
       FROM_HERE, flush_closure_.callback(), base::TimeDelta::FromSeconds(10));
 }
 
+void CookieStoreIOS::UpdateCachesFromSystem() {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  const size_t notification_count = pending_system_cookie_changes_;
+  pending_system_cookie_changes_ = 0;
+
+  std::vector<std::pair<GURL, std::vector<std::string>>> names_by_url =
+      GetHookedNamesByURL();
+  for (auto& url_and_names : names_by_url) {
+    const GURL& gurl = url_and_names.first;
+    system_store_->GetCookiesForURLAsync(
+        gurl,
+        base::BindOnce(&CookieStoreIOS::UpdateCacheForURLFromSystemCookies,
+                       weak_factory_.GetWeakPtr(), gurl,
+                       std::move(url_and_names.second)));
+  }
+
+  // Without batching, every notification queried every hooked (url, name).
+  cookie_queries_saved_ +=
+      notification_count * hook_map_.size() - names_by_url.size();
+}
+
 CookieChangeDispatcher& CookieStoreIOS::GetChangeDispatcher() {
   return change_dispatcher_;
 }
@@ -592,6 +622,58 @@ void CookieStoreIOS::UpdateCacheForCookies(const GURL& gurl,
   }
 }
 
+void CookieStoreIOS::UpdateCacheForURLFromSystemCookies(
+    const GURL& gurl,
+    const std::vector<std::string>& names,
+    NSArray<NSHTTPCookie*>* nscookies) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  std::map<std::string, std::vector<net::CanonicalCookie>> cookies_by_name;
+  for (const std::string& name : names)
+    cookies_by_name[name];
+  for (NSHTTPCookie* nscookie in nscookies) {
+    auto it = cookies_by_name.find(base::SysNSStringToUTF8(nscookie.name));
+    if (it == cookies_by_name.end())
+      continue;
+    it->second.push_back(CanonicalCookieFromSystemCookie(
+        nscookie, system_store_->GetCookieCreationTime(nscookie)));
+  }
+  UpdateCacheForURLAndRunCallbacks(gurl, cookies_by_name);
+}
+
+void CookieStoreIOS::UpdateCacheForURLAndRunCallbacks(
+    const GURL& gurl,
+    const std::map<std::string, std::vector<net::CanonicalCookie>>&
+        cookies_by_name) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  // Update the cache for all the names first, so that every callback observes
+  // the final state of the cache for |gurl|.
+  struct CookieChanges {
+    std::string name;
+    std::vector<net::CanonicalCookie> removed_cookies;
+    std::vector<net::CanonicalCookie> added_cookies;
+  };
+  std::vector<CookieChanges> changes;
+  for (const auto& name_and_cookies : cookies_by_name) {
+    CookieChanges name_changes;
+    name_changes.name = name_and_cookies.first;
+    if (cookie_cache_->Update(gurl, name_changes.name, name_and_cookies.second,
+                              &name_changes.removed_cookies,
+                              &name_changes.added_cookies)) {
+      changes.push_back(std::move(name_changes));
+    }
+  }
+
+  // Then dispatch the changes name by name, removals before insertions, as
+  // when each name was updated on its own.
+  for (const CookieChanges& name_changes : changes) {
+    RunCallbacksForCookies(gurl, name_changes.name,
+                           name_changes.removed_cookies,
+                           net::CookieChangeCause::UNKNOWN_DELETION);
+    RunCallbacksForCookies(gurl, name_changes.name, name_changes.added_cookies,
+                           net::CookieChangeCause::INSERTED);
+  }
+}
+
 void CookieStoreIOS::RunCallbacksForCookies(
     const GURL& url,
     const std::string& name,
@@ -612,33 +694,41 @@ void CookieStoreIOS::RunCallbacksForCookies(
   }
 }
 
-void CookieStoreIOS::GotCookieListFor(
-    const std::pair<GURL, std::string> key,
+void CookieStoreIOS::GotCookieListForURL(
+    const GURL& gurl,
+    const std::vector<std::string>& names,
     const net::CookieStatusList& cookies,
     const net::CookieStatusList& excluded_cookies) {
   DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
 
-  net::CookieList filtered;
-  OnlyCookiesWithName(cookies, key.second, &filtered);
-  std::vector<net::CanonicalCookie> removed_cookies;
-  std::vector<net::CanonicalCookie> added_cookies;
-  if (cookie_cache_->Update(key.first, key.second, filtered, &removed_cookies,
-                            &added_cookies)) {
-    RunCallbacksForCookies(key.first, key.second, removed_cookies,
-                           net::CookieChangeCause::UNKNOWN_DELETION);
-    RunCallbacksForCookies(key.first, key.second, added_cookies,
-                           net::CookieChangeCause::INSERTED);
+  std::map<std::string, std::vector<net::CanonicalCookie>> cookies_by_name;
+  for (const std::string& name : names)
+    OnlyCookiesWithName(cookies, name, &cookies_by_name[name]);
+  UpdateCacheForURLAndRunCallbacks(gurl, cookies_by_name);
+}
+
+std::vector<std::pair<GURL, std::vector<std::string>>>
+CookieStoreIOS::GetHookedNamesByURL() const {
+  // |hook_map_| is ordered by URL first, so the names of a URL are adjacent.
+  std::vector<std::pair<GURL, std::vector<std::string>>> names_by_url;
+  for (const auto& hook_map_entry : hook_map_) {
+    const GURL& gurl = hook_map_entry.first.first;
+    if (names_by_url.empty() || names_by_url.back().first != gurl)
+      names_by_url.emplace_back(gurl, std::vector<std::string>());
+    names_by_url.back().second.push_back(hook_map_entry.first.second);
   }
+  return names_by_url;
 }
 
 void CookieStoreIOS::UpdateCachesFromCookieMonster() {
   DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
-  for (const auto& hook_map_entry : hook_map_) {
-    std::pair<GURL, std::string> key = hook_map_entry.first;
+  for (auto& url_and_names : GetHookedNamesByURL()) {
+    const GURL& gurl = url_and_names.first;
     GetCookieListCallback callback = base::BindOnce(
-        &CookieStoreIOS::GotCookieListFor, weak_factory_.GetWeakPtr(), key);
+        &CookieStoreIOS::GotCookieListForURL, weak_factory_.GetWeakPtr(), gurl,
+        std::move(url_and_names.second));
     cookie_monster_->GetCookieListWithOptionsAsync(
-        key.first, net::CookieOptions::MakeAllInclusive(), std::move(callback));
+        gurl, net::CookieOptions::MakeAllInclusive(), std::move(callback));
   }
 }
 
@@ -491,6 +491,81 @@ TEST_F(CookieStoreIOSTest, MultipleNotifies) {
   DeleteSystemCookie(kTestCookieURLBarBar, "abc");
 }
 
+// Tests that a burst of system cookie notifications results in a single query
+// per hooked URL.
+TEST_F(CookieStoreIOSTest, BatchesNotificationBursts) {
+  std::vector<net::CanonicalCookie> cookies;
+  std::unique_ptr<net::CookieChangeSubscription> handle =
+      store_->GetChangeDispatcher().AddCallbackForCookie(
+          kTestCookieURLFooBar, "ghi",
+          base::Bind(&RecordCookieChanges, &cookies, nullptr));
+  base::RunLoop().RunUntilIdle();
+  const size_t queries_saved = store_->cookie_queries_saved();
+
+  system_store_->SetCookieAsync(
+      [NSHTTPCookie cookieWithProperties:@{
+        NSHTTPCookiePath : @"/bar",
+        NSHTTPCookieName : @"ghi",
+        NSHTTPCookieValue : @"jkl",
+        NSHTTPCookieDomain : @"foo.google.com",
+      }],
+      base::BindOnce(&net::CookieStoreIOS::NotifySystemCookiesChanged));
+  CookieStoreIOS::NotifySystemCookiesChanged();
+  base::RunLoop().RunUntilIdle();
+
+  ASSERT_EQ(1U, cookies.size());
+  EXPECT_EQ("jkl", cookies[0].Value());
+  // Two notifications for two hooked names of the same URL only need one
+  // query instead of four.
+  EXPECT_EQ(queries_saved + 3, store_->cookie_queries_saved());
+  DeleteSystemCookie(kTestCookieURLFooBar, "ghi");
+}
+
+// Tests that the changes of a burst are dispatched name by name, removals
+// before insertions.
+TEST_F(CookieStoreIOSTest, DispatchesBatchedChangesByName) {
+  std::vector<net::CanonicalCookie> cookies;
+  std::vector<bool> removes;
+  std::unique_ptr<net::CookieChangeSubscription> handle =
+      store_->GetChangeDispatcher().AddCallbackForCookie(
+          kTestCookieURLFooBar, "ghi",
+          base::Bind(&RecordCookieChanges, &cookies, &removes));
+  std::unique_ptr<net::CookieChangeSubscription> handle2 =
+      store_->GetChangeDispatcher().AddCallbackForCookie(
+          kTestCookieURLFooBar, "mno",
+          base::Bind(&RecordCookieChanges, &cookies, &removes));
+  SetSystemCookie(kTestCookieURLFooBar, "ghi", "a");
+  SetSystemCookie(kTestCookieURLFooBar, "mno", "b");
+  cookies.clear();
+  removes.clear();
+
+  // Replace both cookies within the same burst.
+  for (NSString* name in @[ @"ghi", @"mno" ]) {
+    system_store_->SetCookieAsync(
+        [NSHTTPCookie cookieWithProperties:@{
+          NSHTTPCookiePath : @"/bar",
+          NSHTTPCookieName : name,
+          NSHTTPCookieValue : @"c",
+          NSHTTPCookieDomain : @"foo.google.com",
+        }],
+        base::BindOnce(&net::CookieStoreIOS::NotifySystemCookiesChanged));
+  }
+  base::RunLoop().RunUntilIdle();
+
+  ASSERT_EQ(4U, cookies.size());
+  ASSERT_EQ(4U, removes.size());
+  EXPECT_EQ("ghi", cookies[0].Name());
+  EXPECT_TRUE(removes[0]);
+  EXPECT_EQ("ghi", cookies[1].Name());
+  EXPECT_FALSE(removes[1]);
+  EXPECT_EQ("mno", cookies[2].Name());
+  EXPECT_TRUE(removes[2]);
+  EXPECT_EQ("mno", cookies[3].Name());
+  EXPECT_FALSE(removes[3]);
+  DeleteSystemCookie(kTestCookieURLFooBar, "ghi");
+  DeleteSystemCookie(kTestCookieURLFooBar, "mno");
+}
+
 TEST_F(CookieStoreIOSTest, LessSpecificNestedCookie) {
   std::vector<net::CanonicalCookie> cookies;
   SetSystemCookie(kTestCookieURLFooBaz, "abc", "def");
@@ -90,6 +90,8 @@ NSArray* NSHTTPSystemCookieStore::GetCookiesForURL(const GURL& url) {
 
 NSArray* NSHTTPSystemCookieStore::GetAllCookies() {
   NSArray* cookies = cookie_store_.cookies;
+  // Load the creation times of the whole jar at once before sorting.
+  creation_time_manager_->LoadCreationTimes(cookies);
   return [cookies sortedArrayUsingFunction:CompareCookies
                                    context:creation_time_manager_.get()];
 }
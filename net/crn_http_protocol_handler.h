@@ -7,13 +7,30 @@
 
 #import <Foundation/Foundation.h>
 
+#include "base/callback_forward.h"
 #include "base/macros.h"
+#include "base/time/time.h"
 #include "net/base/load_timing_info.h"
 #include "net/http/http_response_info.h"
 
+@protocol CRNNetworkClientProtocol;
+
 namespace net {
 class URLRequestContextGetter;
 
+// Controls how the data read from the network is batched before being passed
+// to the NSURLProtocol client. Buffered data is always flushed when the end of
+// the stream is reached or when the request fails.
+struct DataCoalescingPolicy {
+  // Buffered data is flushed once at least this many bytes are pending. Zero
+  // disables coalescing: every read is passed to the client right away.
+  size_t flush_threshold_bytes = 0;
+  // Buffered data is flushed once this much time elapsed since the oldest
+  // pending read. Zero flushes as soon as no more data can be read
+  // synchronously.
+  base::TimeDelta flush_delay;
+};
+
 class HTTPProtocolHandlerDelegate {
  public:
   // Sets the global instance of the HTTPProtocolHandlerDelegate.
@@ -31,6 +48,10 @@ class HTTPProtocolHandlerDelegate {
 
   // Returns the request context used. Must not return null.
   virtual URLRequestContextGetter* GetDefaultURLRequestContext() = 0;
+
+  // Returns the policy used to coalesce the data of |request| before passing
+  // it to the client. Coalescing is disabled by default.
+  virtual DataCoalescingPolicy GetDataCoalescingPolicy(NSURLRequest* request);
 };
 
 // Delegate class which supplies a metrics callback that is invoked when a net
@@ -47,6 +68,14 @@ class MetricsDelegate {
     LoadTimingInfo load_timing_info;
     HttpResponseInfo response_info;
     base::Time response_end_time;
+    // Number of reads completed by the network stack.
+    int read_count = 0;
+    // Number of -didLoadData: calls made to the client.
+    int did_load_data_count = 0;
+    // Delay between the start of the request and the first byte read from
+    // the network, and the first byte passed to the client.
+    base::TimeDelta time_to_first_byte;
+    base::TimeDelta time_to_first_data_callback;
 
    private:
     DISALLOW_COPY_AND_ASSIGN(Metrics);
@@ -66,6 +95,13 @@ class MetricsDelegate {
   virtual void OnStopNetRequest(std::unique_ptr<Metrics> metrics) = 0;
 };
 
+// Starts loading |request| on the current thread, which must be the network
+// thread, and passes the network events to |client|. The returned closure
+// cancels the load. Only for tests.
+base::OnceClosure StartHttpProtocolHandlerCoreForTesting(
+    NSURLRequest* request,
+    id<CRNNetworkClientProtocol> client);
+
 }  // namespace net
 
 // Custom NSURLProtocol handling HTTP and HTTPS requests.
@@ -21,12 +21,15 @@
 #include "base/strings/string_util.h"
 #include "base/strings/sys_string_conversions.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
 #include "ios/net/chunked_data_stream_uploader.h"
 #import "ios/net/clients/crn_network_client_protocol.h"
 #import "ios/net/crn_http_protocol_handler_proxy_with_client_thread.h"
 #import "ios/net/http_protocol_logging.h"
 #include "ios/net/nsurlrequest_util.h"
 #import "ios/net/protocol_handler_util.h"
+#include "ios/net/read_buffer_pool.h"
 #include "net/base/auth.h"
 #include "net/base/elements_upload_data_stream.h"
 #include "net/base/io_buffer.h"
@@ -91,6 +94,11 @@ void HTTPProtocolHandlerDelegate::SetInstance(
   g_protocol_handler_delegate = delegate;
 }
 
+DataCoalescingPolicy HTTPProtocolHandlerDelegate::GetDataCoalescingPolicy(
+    NSURLRequest* request) {
+  return DataCoalescingPolicy();
+}
+
 // static
 void MetricsDelegate::SetInstance(MetricsDelegate* delegate) {
   g_metrics_delegate = delegate;
@@ -193,16 +201,41 @@ class HttpProtocolHandlerCore
   void CancelAfterSSLError();
   void StartReading();
   void AllocateReadBuffer(int last_read_data_size);
+  // Appends the first |bytes_read| bytes of |read_buffer_| to the data pending
+  // delivery to the client.
+  void AppendReadData(int bytes_read);
+  // Returns true if the pending data must be passed to the client according to
+  // |coalescing_policy_|.
+  bool ShouldFlushPendingData() const;
+  // Passes the pending data to the client.
+  void FlushPendingData();
 
   base::ThreadChecker thread_checker_;
 
   // The NSURLProtocol client.
   id<CRNNetworkClientProtocol> client_ = nil;
-  std::unique_ptr<char, base::FreeDeleter> read_buffer_;
+  // Buffer obtained from ReadBufferPool, returned to the pool on destruction or
+  // once the client releases the NSData wrapping it.
+  ReadBufferPool::Buffer read_buffer_;
   int read_buffer_size_ = kIOBufferMinSize;
   scoped_refptr<WrappedIOBuffer> read_buffer_wrapper_;
   NSMutableURLRequest* request_ = nil;
   NSURLSessionTask* task_ = nil;
+  // Policy controlling the batching of the -didLoadData: calls.
+  DataCoalescingPolicy coalescing_policy_;
+  // Data read from the network and not yet passed to the client, as a
+  // scatter list of read buffers.
+  dispatch_data_t pending_data_ = nil;
+  // Time at which the oldest chunk of |pending_data_| was read.
+  base::TimeTicks pending_data_start_time_;
+  // Flushes |pending_data_| when no read completes within the flush delay.
+  base::OneShotTimer flush_timer_;
+  // Metrics reported to the MetricsDelegate.
+  base::TimeTicks start_time_;
+  int read_count_ = 0;
+  int did_load_data_count_ = 0;
+  base::TimeDelta time_to_first_byte_;
+  base::TimeDelta time_to_first_data_callback_;
   // The stream has data to upload.
   NSInputStream* http_body_stream_ = nil;
   // Stream delegate to read the HTTPBodyStream.
@@ -476,36 +509,100 @@ void HttpProtocolHandlerCore::OnReadCompleted(URLRequest* request,
   DCHECK_EQ(net_request_, request);
 
   // Read data from the socket until no bytes left to read.
-  uint64_t total_bytes_read = 0;
   while (bytes_read > 0) {
-    total_bytes_read += bytes_read;
-    // The NSData will take the ownership of |read_buffer_|.
-    NSData* data =
-        [NSData dataWithBytesNoCopy:read_buffer_.release() length:bytes_read];
-    // If the data is not encoded in UTF8, the NSString is nil.
-    DVLOG(3) << "To client:" << std::endl
-             << base::SysNSStringToUTF8([[NSString alloc]
-                    initWithData:data
-                        encoding:NSUTF8StringEncoding]);
-    // Pass the read data to the client.
-    [client_ didLoadData:data];
+    AppendReadData(bytes_read);
+    if (ShouldFlushPendingData())
+      FlushPendingData();
 
     // Allocate a new buffer and continue reading from the socket.
     AllocateReadBuffer(bytes_read);
     bytes_read = request->Read(read_buffer_wrapper_.get(), read_buffer_size_);
   }
 
+  if (bytes_read == net::ERR_IO_PENDING) {
+    if (!pending_data_)
+      return;
+    const base::TimeDelta remaining_delay =
+        coalescing_policy_.flush_delay -
+        (base::TimeTicks::Now() - pending_data_start_time_);
+    if (remaining_delay <= base::TimeDelta()) {
+      FlushPendingData();
+    } else if (!flush_timer_.IsRunning()) {
+      flush_timer_.Start(
+          FROM_HERE, remaining_delay,
+          base::BindOnce(&HttpProtocolHandlerCore::FlushPendingData,
+                         base::Unretained(this)));
+    }
+    return;
+  }
+
+  // The data read so far is passed to the client before the end of stream or
+  // the error.
+  FlushPendingData();
   if (bytes_read == net::OK) {
     // If there is nothing more to read.
     StopNetRequest();
     [client_ didFinishLoading];
-  } else if (bytes_read != net::ERR_IO_PENDING) {
+  } else {
     // If there was an error (not canceled).
     int error = bytes_read;
     StopRequestWithError(IOSErrorCode(error), error);
   }
 }
 
+void HttpProtocolHandlerCore::AppendReadData(int bytes_read) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  DCHECK_GT(bytes_read, 0);
+  if (read_count_++ == 0)
+    time_to_first_byte_ = base::TimeTicks::Now() - start_time_;
+
+  // The chunk takes the ownership of |read_buffer_| and returns it to the pool
+  // when the client releases the data.
+  const int buffer_size = read_buffer_.get_deleter().size();
+  char* buffer = read_buffer_.release();
+  dispatch_data_t chunk = dispatch_data_create(
+      buffer, bytes_read, nullptr, ^{
+        ReadBufferPool::GetInstance()->Release(buffer, buffer_size);
+      });
+  if (pending_data_) {
+    pending_data_ = dispatch_data_create_concat(pending_data_, chunk);
+  } else {
+    pending_data_ = chunk;
+    pending_data_start_time_ = base::TimeTicks::Now();
+  }
+}
+
+bool HttpProtocolHandlerCore::ShouldFlushPendingData() const {
+  DCHECK(pending_data_);
+  if (dispatch_data_get_size(pending_data_) >=
+      coalescing_policy_.flush_threshold_bytes) {
+    return true;
+  }
+  return !coalescing_policy_.flush_delay.is_zero() &&
+         base::TimeTicks::Now() - pending_data_start_time_ >=
+             coalescing_policy_.flush_delay;
+}
+
+void HttpProtocolHandlerCore::FlushPendingData() {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  flush_timer_.Stop();
+  if (!pending_data_)
+    return;
+
+  // dispatch_data_t objects are also NSData objects.
+  NSData* data = base::mac::ObjCCastStrict<NSData>(pending_data_);
+  pending_data_ = nil;
+  if (did_load_data_count_++ == 0)
+    time_to_first_data_callback_ = base::TimeTicks::Now() - start_time_;
+  // If the data is not encoded in UTF8, the NSString is nil.
+  DVLOG(3) << "To client:" << std::endl
+           << base::SysNSStringToUTF8([[NSString alloc]
+                  initWithData:data
+                      encoding:NSUTF8StringEncoding]);
+  // Pass the read data to the client.
+  [client_ didLoadData:data];
+}
+
 void HttpProtocolHandlerCore::AllocateReadBuffer(int last_read_data_size) {
   if (last_read_data_size == read_buffer_size_) {
     // If the whole buffer was filled with data then increase the buffer size
@@ -517,7 +614,7 @@ void HttpProtocolHandlerCore::AllocateReadBuffer(int last_read_data_size) {
     // |kIOBufferMinSize|.
     read_buffer_size_ = std::max(read_buffer_size_ / 2, kIOBufferMinSize);
   }
-  read_buffer_.reset(static_cast<char*>(malloc(read_buffer_size_)));
+  read_buffer_ = ReadBufferPool::GetInstance()->Acquire(read_buffer_size_);
   read_buffer_wrapper_ = base::MakeRefCounted<WrappedIOBuffer>(
       static_cast<const char*>(read_buffer_.get()));
 }
@@ -571,6 +668,9 @@ void HttpProtocolHandlerCore::Start(id<CRNNetworkClientProtocol> base_client) {
   DCHECK(!client_);
   DCHECK(base_client);
   client_ = base_client;
+  start_time_ = base::TimeTicks::Now();
+  coalescing_policy_ =
+      g_protocol_handler_delegate->GetDataCoalescingPolicy(request_);
   GURL url = GURLWithNSURL([request_ URL]);
 
   // Now that all of the network clients are set up, if there was an error with
@@ -655,6 +755,8 @@ void HttpProtocolHandlerCore::Cancel() {
     return;
 
   DVLOG(2) << "Client canceling request: " << net_request_->url().spec();
+  // The client is not interested in the data not delivered yet.
+  pending_data_ = nil;
   net_request_->Cancel();
   StopNetRequest();
 }
@@ -669,10 +771,15 @@ void HttpProtocolHandlerCore::StopNetRequest() {
     metrics->task = task_;
     metrics->response_info = net_request_->response_info();
     net_request_->GetLoadTimingInfo(&metrics->load_timing_info);
+    metrics->read_count = read_count_;
+    metrics->did_load_data_count = did_load_data_count_;
+    metrics->time_to_first_byte = time_to_first_byte_;
+    metrics->time_to_first_data_callback = time_to_first_data_callback_;
 
     g_metrics_delegate->OnStopNetRequest(std::move(metrics));
   }
 
+  flush_timer_.Stop();
   delete net_request_;
   net_request_ = nullptr;
   if (http_body_stream_)
@@ -781,6 +888,15 @@ int HttpProtocolHandlerCore::OnRead(char* buffer, int buffer_length) {
   return bytes_read;
 }
 
+base::OnceClosure StartHttpProtocolHandlerCoreForTesting(
+    NSURLRequest* request,
+    id<CRNNetworkClientProtocol> client) {
+  scoped_refptr<HttpProtocolHandlerCore> core =
+      new HttpProtocolHandlerCore(request);
+  core->Start(client);
+  return base::BindOnce(&HttpProtocolHandlerCore::Cancel, core);
+}
+
 }  // namespace net
 
 #pragma mark -
@@ -0,0 +1,475 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/net/crn_http_protocol_handler.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/location.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/test/task_environment.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/time/time.h"
+#import "ios/net/clients/crn_network_client_protocol.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_response_info.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_job.h"
+#include "net/url_request/url_request_job_factory.h"
+#include "net/url_request/url_request_job_factory_impl.h"
+#include "net/url_request/url_request_test_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/gtest_mac.h"
+#include "testing/platform_test.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+// Network client recording the calls made by the HttpProtocolHandlerCore.
+@interface CRNFakeNetworkClient : NSObject<CRNNetworkClientProtocol>
+// The calls received, in order, with the size of the data loaded or the error.
+@property(nonatomic, readonly) NSMutableArray<NSString*>* calls;
+// The data loaded.
+@property(nonatomic, readonly) NSMutableData* data;
+@end
+
+@implementation CRNFakeNetworkClient
+
+- (instancetype)init {
+  if ((self = [super init])) {
+    _calls = [NSMutableArray array];
+    _data = [NSMutableData data];
+  }
+  return self;
+}
+
+- (void)didFailWithNSErrorCode:(NSInteger)nsErrorCode
+                  netErrorCode:(int)netErrorCode {
+  [_calls addObject:[NSString stringWithFormat:@"didFailWithNetErrorCode:%d",
+                                               netErrorCode]];
+}
+
+- (void)didLoadData:(NSData*)data {
+  [_calls addObject:[NSString stringWithFormat:@"didLoadData:%lu",
+                                               static_cast<unsigned long>(
+                                                   data.length)]];
+  [_data appendData:data];
+}
+
+- (void)didReceiveResponse:(NSURLResponse*)response {
+  [_calls addObject:@"didReceiveResponse"];
+}
+
+- (void)wasRedirectedToRequest:(NSURLRequest*)request
+                 nativeRequest:(net::URLRequest*)nativeRequest
+              redirectResponse:(NSURLResponse*)redirectResponse {
+  [_calls addObject:@"wasRedirectedToRequest"];
+}
+
+- (void)didFinishLoading {
+  [_calls addObject:@"didFinishLoading"];
+}
+
+- (void)didCreateNativeRequest:(net::URLRequest*)nativeRequest {
+}
+
+@end
+
+namespace net {
+namespace {
+
+// Maximum number of bytes returned by each read of ScriptedURLRequestJob.
+const int kChunkSize = 1000;
+
+// Threshold and delay large enough to never flush the pending data.
+const size_t kLargeThreshold = 1024 * 1024;
+const base::TimeDelta kLargeDelay = base::TimeDelta::FromHours(1);
+
+// Returns the first |size| bytes of the body served by ScriptedURLRequestJob.
+std::string ExpectedBody(int size) {
+  std::string body(size, '\0');
+  for (int i = 0; i < size; ++i)
+    body[i] = 'a' + i % 26;
+  return body;
+}
+
+// Returns the call made to the client to load |size| bytes.
+NSString* DidLoadData(int size) {
+  return [NSString stringWithFormat:@"didLoadData:%d", size];
+}
+
+// URLRequestJob serving a body made available by the test. Reads return at
+// most |kChunkSize| bytes synchronously, and complete asynchronously when no
+// data is available.
+class ScriptedURLRequestJob : public URLRequestJob {
+ public:
+  explicit ScriptedURLRequestJob(URLRequest* request)
+      : URLRequestJob(request, nullptr) {}
+
+  base::WeakPtr<ScriptedURLRequestJob> GetWeakPtr() {
+    return weak_factory_.GetWeakPtr();
+  }
+
+  // Makes |size| more bytes of the body available.
+  void AddData(int size) {
+    available_bytes_ += size;
+    if (!pending_read_buffer_)
+      return;
+    scoped_refptr<IOBuffer> buffer = std::move(pending_read_buffer_);
+    ReadRawDataComplete(ReadAvailableData(buffer.get(), pending_read_size_));
+  }
+
+  // Ends the body with |net_error|, which is OK for a successful load. Once
+  // the pending read completes, |this| may be deleted.
+  void Finish(int net_error) {
+    finished_ = true;
+    net_error_ = net_error;
+    if (!pending_read_buffer_)
+      return;
+    pending_read_buffer_ = nullptr;
+    ReadRawDataComplete(net_error);
+  }
+
+  // URLRequestJob methods:
+  void Start() override {
+    base::ThreadTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, base::BindOnce(&ScriptedURLRequestJob::StartAsync,
+                                  weak_factory_.GetWeakPtr()));
+  }
+
+  int ReadRawData(IOBuffer* buf, int buf_size) override {
+    if (available_bytes_ > 0)
+      return ReadAvailableData(buf, buf_size);
+    if (finished_)
+      return net_error_;
+    pending_read_buffer_ = buf;
+    pending_read_size_ = buf_size;
+    return ERR_IO_PENDING;
+  }
+
+  bool GetMimeType(std::string* mime_type) const override {
+    *mime_type = "text/plain";
+    return true;
+  }
+
+  void GetResponseInfo(HttpResponseInfo* info) override {
+    std::string header_string("HTTP/1.1 200 OK");
+    header_string.push_back('\0');
+    header_string += "Content-Type: text/plain";
+    header_string.push_back('\0');
+    info->headers = new HttpResponseHeaders(header_string);
+  }
+
+ private:
+  void StartAsync() { NotifyHeadersComplete(); }
+
+  // Copies the next available bytes of the body to |buf|.
+  int ReadAvailableData(IOBuffer* buf, int buf_size) {
+    const int size = std::min({buf_size, available_bytes_, kChunkSize});
+    for (int i = 0; i < size; ++i)
+      buf->data()[i] = 'a' + (read_bytes_ + i) % 26;
+    read_bytes_ += size;
+    available_bytes_ -= size;
+    return size;
+  }
+
+  int available_bytes_ = 0;
+  int read_bytes_ = 0;
+  bool finished_ = false;
+  int net_error_ = OK;
+  scoped_refptr<IOBuffer> pending_read_buffer_;
+  int pending_read_size_ = 0;
+
+  base::WeakPtrFactory<ScriptedURLRequestJob> weak_factory_{this};
+
+  DISALLOW_COPY_AND_ASSIGN(ScriptedURLRequestJob);
+};
+
+// Creates ScriptedURLRequestJobs, and exposes the last one to the test.
+class ScriptedProtocolHandler : public URLRequestJobFactory::ProtocolHandler {
+ public:
+  explicit ScriptedProtocolHandler(base::WeakPtr<ScriptedURLRequestJob>* job)
+      : job_(job) {}
+
+  URLRequestJob* MaybeCreateJob(
+      URLRequest* request,
+      NetworkDelegate* network_delegate) const override {
+    ScriptedURLRequestJob* job = new ScriptedURLRequestJob(request);
+    *job_ = job->GetWeakPtr();
+    return job;
+  }
+
+ private:
+  base::WeakPtr<ScriptedURLRequestJob>* job_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScriptedProtocolHandler);
+};
+
+class FakeProtocolHandlerDelegate : public HTTPProtocolHandlerDelegate {
+ public:
+  explicit FakeProtocolHandlerDelegate(URLRequestContextGetter* context_getter)
+      : context_getter_(context_getter) {}
+
+  void set_data_coalescing_policy(const DataCoalescingPolicy& policy) {
+    policy_ = policy;
+  }
+
+  // HTTPProtocolHandlerDelegate methods:
+  bool CanHandleRequest(NSURLRequest* request) override { return true; }
+  bool IsRequestSupported(NSURLRequest* request) override { return true; }
+  URLRequestContextGetter* GetDefaultURLRequestContext() override {
+    return context_getter_;
+  }
+  DataCoalescingPolicy GetDataCoalescingPolicy(
+      NSURLRequest* request) override {
+    return policy_;
+  }
+
+ private:
+  URLRequestContextGetter* context_getter_;
+  DataCoalescingPolicy policy_;
+
+  DISALLOW_COPY_AND_ASSIGN(FakeProtocolHandlerDelegate);
+};
+
+class FakeMetricsDelegate : public MetricsDelegate {
+ public:
+  FakeMetricsDelegate() = default;
+
+  // Returns the metrics of the stopped request, or null if it is not stopped.
+  const Metrics* metrics() const { return metrics_.get(); }
+
+  // MetricsDelegate methods:
+  void OnStartNetRequest(NSURLSessionTask* task) override {}
+  void OnStopNetRequest(std::unique_ptr<Metrics> metrics) override {
+    metrics_ = std::move(metrics);
+  }
+
+ private:
+  std::unique_ptr<Metrics> metrics_;
+
+  DISALLOW_COPY_AND_ASSIGN(FakeMetricsDelegate);
+};
+
+class HttpProtocolHandlerCoreTest : public PlatformTest {
+ protected:
+  HttpProtocolHandlerCoreTest()
+      : task_environment_(base::test::TaskEnvironment::TimeSource::MOCK_TIME),
+        client_([[CRNFakeNetworkClient alloc] init]) {
+    auto context = std::make_unique<TestURLRequestContext>(true);
+    job_factory_.SetProtocolHandler(
+        "http", std::make_unique<ScriptedProtocolHandler>(&job_));
+    context->set_job_factory(&job_factory_);
+    context->Init();
+    context_getter_ = base::MakeRefCounted<TestURLRequestContextGetter>(
+        base::ThreadTaskRunnerHandle::Get(), std::move(context));
+    delegate_ = std::make_unique<FakeProtocolHandlerDelegate>(
+        context_getter_.get());
+    HTTPProtocolHandlerDelegate::SetInstance(delegate_.get());
+    MetricsDelegate::SetInstance(&metrics_delegate_);
+  }
+
+  ~HttpProtocolHandlerCoreTest() override {
+    // The core is deleted through the delegate, so the delegate is reset last.
+    if (cancel_loading_)
+      std::move(cancel_loading_).Run();
+    task_environment_.RunUntilIdle();
+    MetricsDelegate::SetInstance(nullptr);
+    HTTPProtocolHandlerDelegate::SetInstance(nullptr);
+  }
+
+  // Starts loading a page with the data coalescing |policy|, and waits for the
+  // response.
+  void StartLoading(const DataCoalescingPolicy& policy) {
+    delegate_->set_data_coalescing_policy(policy);
+    NSURLRequest* request = [NSURLRequest
+        requestWithURL:[NSURL URLWithString:@"http://www.example.com/"]];
+    cancel_loading_ = StartHttpProtocolHandlerCoreForTesting(request, client_);
+    task_environment_.RunUntilIdle();
+  }
+
+  base::test::SingleThreadTaskEnvironment task_environment_;
+  URLRequestJobFactoryImpl job_factory_;
+  scoped_refptr<TestURLRequestContextGetter> context_getter_;
+  std::unique_ptr<FakeProtocolHandlerDelegate> delegate_;
+  FakeMetricsDelegate metrics_delegate_;
+  CRNFakeNetworkClient* client_;
+  base::WeakPtr<ScriptedURLRequestJob> job_;
+  base::OnceClosure cancel_loading_;
+};
+
+}  // namespace
+
+// Tests that every read is passed to the client when coalescing is disabled.
+TEST_F(HttpProtocolHandlerCoreTest, LoadsEachReadByDefault) {
+  StartLoading(DataCoalescingPolicy());
+  ASSERT_TRUE(job_);
+
+  job_->AddData(3 * kChunkSize);
+  EXPECT_NSEQ((@[
+                @"didReceiveResponse", DidLoadData(kChunkSize),
+                DidLoadData(kChunkSize), DidLoadData(kChunkSize)
+              ]),
+              client_.calls);
+
+  job_->Finish(OK);
+  EXPECT_NSEQ(@"didFinishLoading", client_.calls.lastObject);
+  EXPECT_EQ(5u, client_.calls.count);
+  EXPECT_EQ(ExpectedBody(3 * kChunkSize),
+            std::string(static_cast<const char*>(client_.data.bytes),
+                        client_.data.length));
+
+  const MetricsDelegate::Metrics* metrics = metrics_delegate_.metrics();
+  ASSERT_TRUE(metrics);
+  EXPECT_EQ(3, metrics->read_count);
+  EXPECT_EQ(3, metrics->did_load_data_count);
+}
+
+// Tests that the reads are passed to the client at once when the byte
+// threshold is reached, and that the remaining data is passed at the end of
+// the stream.
+TEST_F(HttpProtocolHandlerCoreTest, FlushesWhenThresholdIsReached) {
+  DataCoalescingPolicy policy;
+  policy.flush_threshold_bytes = 3 * kChunkSize;
+  policy.flush_delay = kLargeDelay;
+  StartLoading(policy);
+  ASSERT_TRUE(job_);
+
+  job_->AddData(2 * kChunkSize);
+  EXPECT_NSEQ((@[ @"didReceiveResponse" ]), client_.calls);
+
+  job_->AddData(kChunkSize);
+  EXPECT_NSEQ((@[ @"didReceiveResponse", DidLoadData(3 * kChunkSize) ]),
+              client_.calls);
+
+  job_->AddData(kChunkSize);
+  EXPECT_EQ(2u, client_.calls.count);
+
+  job_->Finish(OK);
+  EXPECT_NSEQ((@[
+                @"didReceiveResponse", DidLoadData(3 * kChunkSize),
+                DidLoadData(kChunkSize), @"didFinishLoading"
+              ]),
+              client_.calls);
+  EXPECT_EQ(ExpectedBody(4 * kChunkSize),
+            std::string(static_cast<const char*>(client_.data.bytes),
+                        client_.data.length));
+
+  const MetricsDelegate::Metrics* metrics = metrics_delegate_.metrics();
+  ASSERT_TRUE(metrics);
+  EXPECT_EQ(4, metrics->read_count);
+  EXPECT_EQ(2, metrics->did_load_data_count);
+}
+
+// Tests that the reads are passed to the client once the delay elapsed since
+// the oldest pending read, and that the times to the first byte are reported.
+TEST_F(HttpProtocolHandlerCoreTest, FlushesWhenDelayExpires) {
+  DataCoalescingPolicy policy;
+  policy.flush_threshold_bytes = kLargeThreshold;
+  policy.flush_delay = base::TimeDelta::FromMilliseconds(100);
+  StartLoading(policy);
+  ASSERT_TRUE(job_);
+
+  task_environment_.FastForwardBy(base::TimeDelta::FromMilliseconds(20));
+  job_->AddData(kChunkSize);
+  task_environment_.FastForwardBy(base::TimeDelta::FromMilliseconds(99));
+  EXPECT_NSEQ((@[ @"didReceiveResponse" ]), client_.calls);
+
+  // A later read does not postpone the flush.
+  job_->AddData(kChunkSize);
+  EXPECT_EQ(1u, client_.calls.count);
+  task_environment_.FastForwardBy(base::TimeDelta::FromMilliseconds(1));
+  EXPECT_NSEQ((@[ @"didReceiveResponse", DidLoadData(2 * kChunkSize) ]),
+              client_.calls);
+
+  job_->Finish(OK);
+  EXPECT_NSEQ((@[
+                @"didReceiveResponse", DidLoadData(2 * kChunkSize),
+                @"didFinishLoading"
+              ]),
+              client_.calls);
+
+  const MetricsDelegate::Metrics* metrics = metrics_delegate_.metrics();
+  ASSERT_TRUE(metrics);
+  EXPECT_EQ(2, metrics->read_count);
+  EXPECT_EQ(1, metrics->did_load_data_count);
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(20),
+            metrics->time_to_first_byte);
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(120),
+            metrics->time_to_first_data_callback);
+}
+
+// Tests that the reads are passed to the client as soon as no more data can be
+// read synchronously when the delay is zero.
+TEST_F(HttpProtocolHandlerCoreTest, FlushesWhenNoDataIsAvailable) {
+  DataCoalescingPolicy policy;
+  policy.flush_threshold_bytes = kLargeThreshold;
+  StartLoading(policy);
+  ASSERT_TRUE(job_);
+
+  job_->AddData(3 * kChunkSize);
+  EXPECT_NSEQ((@[ @"didReceiveResponse", DidLoadData(3 * kChunkSize) ]),
+              client_.calls);
+
+  job_->Finish(OK);
+  const MetricsDelegate::Metrics* metrics = metrics_delegate_.metrics();
+  ASSERT_TRUE(metrics);
+  EXPECT_EQ(3, metrics->read_count);
+  EXPECT_EQ(1, metrics->did_load_data_count);
+}
+
+// Tests that the pending data is passed to the client before the error.
+TEST_F(HttpProtocolHandlerCoreTest, FlushesBeforeError) {
+  DataCoalescingPolicy policy;
+  policy.flush_threshold_bytes = kLargeThreshold;
+  policy.flush_delay = kLargeDelay;
+  StartLoading(policy);
+  ASSERT_TRUE(job_);
+
+  job_->AddData(kChunkSize);
+  job_->Finish(ERR_CONNECTION_RESET);
+  EXPECT_NSEQ((@[
+                @"didReceiveResponse", DidLoadData(kChunkSize),
+                [NSString stringWithFormat:@"didFailWithNetErrorCode:%d",
+                                           ERR_CONNECTION_RESET]
+              ]),
+              client_.calls);
+
+  const MetricsDelegate::Metrics* metrics = metrics_delegate_.metrics();
+  ASSERT_TRUE(metrics);
+  EXPECT_EQ(1, metrics->read_count);
+  EXPECT_EQ(1, metrics->did_load_data_count);
+}
+
+// Tests that the pending data is dropped when the load is canceled.
+TEST_F(HttpProtocolHandlerCoreTest, DropsPendingDataOnCancel) {
+  DataCoalescingPolicy policy;
+  policy.flush_threshold_bytes = kLargeThreshold;
+  policy.flush_delay = base::TimeDelta::FromMilliseconds(100);
+  StartLoading(policy);
+  ASSERT_TRUE(job_);
+
+  job_->AddData(kChunkSize);
+  std::move(cancel_loading_).Run();
+  task_environment_.FastForwardBy(base::TimeDelta::FromMilliseconds(100));
+  EXPECT_NSEQ((@[ @"didReceiveResponse" ]), client_.calls);
+
+  const MetricsDelegate::Metrics* metrics = metrics_delegate_.metrics();
+  ASSERT_TRUE(metrics);
+  EXPECT_EQ(1, metrics->read_count);
+  EXPECT_EQ(0, metrics->did_load_data_count);
+  EXPECT_TRUE(metrics->time_to_first_data_callback.is_zero());
+}
+
+}  // namespace net
@@ -0,0 +1,138 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/net/read_buffer_pool.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include "base/bits.h"
+#include "base/logging.h"
+#include "base/no_destructor.h"
+
+namespace net {
+
+namespace {
+
+// Size classes of the shared pool. They match the bounds of the read buffer
+// used by HttpProtocolHandlerCore.
+const int kSharedPoolMinSize = 64 * 1024;
+const int kSharedPoolMaxSize = 16 * kSharedPoolMinSize;  // 1MB
+
+// High-water mark of the shared pool, enough to keep a few buffers of every
+// size class around during page loads.
+const size_t kSharedPoolMaxRetainedBytes = 4 * kSharedPoolMaxSize;
+
+}  // namespace
+
+void ReadBufferPool::Deleter::operator()(char* buffer) const {
+  if (pool_) {
+    pool_->Release(buffer, size_);
+  } else {
+    free(buffer);
+  }
+}
+
+ReadBufferPool::ReadBufferPool(int min_size,
+                               int max_size,
+                               size_t max_retained_bytes)
+    : min_size_(min_size),
+      max_size_(max_size),
+      max_retained_bytes_(max_retained_bytes) {
+  DCHECK(base::bits::IsPowerOfTwo(min_size_));
+  DCHECK(base::bits::IsPowerOfTwo(max_size_));
+  DCHECK_LE(min_size_, max_size_);
+  free_buffers_.resize(BucketIndex(max_size_) + 1);
+}
+
+ReadBufferPool::~ReadBufferPool() {
+  base::AutoLock auto_lock(lock_);
+  for (std::vector<char*>& bucket : free_buffers_) {
+    for (char* buffer : bucket)
+      free(buffer);
+  }
+}
+
+// static
+ReadBufferPool* ReadBufferPool::GetInstance() {
+  static base::NoDestructor<ReadBufferPool> instance(
+      kSharedPoolMinSize, kSharedPoolMaxSize, kSharedPoolMaxRetainedBytes);
+  return instance.get();
+}
+
+ReadBufferPool::Buffer ReadBufferPool::Acquire(int size) {
+  char* buffer = nullptr;
+  {
+    base::AutoLock auto_lock(lock_);
+    std::vector<char*>& bucket = free_buffers_[BucketIndex(size)];
+    if (bucket.empty()) {
+      stats_.misses++;
+    } else {
+      buffer = bucket.back();
+      bucket.pop_back();
+      stats_.retained_bytes -= size;
+      stats_.hits++;
+    }
+  }
+  if (!buffer)
+    buffer = static_cast<char*>(malloc(size));
+  return Buffer(buffer, Deleter(this, size));
+}
+
+void ReadBufferPool::Release(char* buffer, int size) {
+  if (!buffer)
+    return;
+  const size_t buffer_size = size;
+  if (buffer_size > max_retained_bytes_) {
+    free(buffer);
+    base::AutoLock auto_lock(lock_);
+    stats_.discards++;
+    return;
+  }
+
+  std::vector<char*> evicted_buffers;
+  {
+    base::AutoLock auto_lock(lock_);
+    // Make room by evicting from the size class holding the most bytes, so
+    // that a burst of large reads does not starve the small size classes.
+    while (stats_.retained_bytes + buffer_size > max_retained_bytes_) {
+      size_t largest_bucket = 0;
+      size_t largest_bucket_bytes = 0;
+      for (size_t i = 0; i < free_buffers_.size(); ++i) {
+        const size_t bucket_bytes =
+            free_buffers_[i].size() * (static_cast<size_t>(min_size_) << i);
+        if (bucket_bytes >= largest_bucket_bytes) {
+          largest_bucket = i;
+          largest_bucket_bytes = bucket_bytes;
+        }
+      }
+      DCHECK(!free_buffers_[largest_bucket].empty());
+      evicted_buffers.push_back(free_buffers_[largest_bucket].back());
+      free_buffers_[largest_bucket].pop_back();
+      stats_.retained_bytes -= static_cast<size_t>(min_size_) << largest_bucket;
+      stats_.discards++;
+    }
+    free_buffers_[BucketIndex(size)].push_back(buffer);
+    stats_.retained_bytes += buffer_size;
+    stats_.peak_retained_bytes =
+        std::max(stats_.peak_retained_bytes, stats_.retained_bytes);
+  }
+  for (char* evicted_buffer : evicted_buffers)
+    free(evicted_buffer);
+}
+
+ReadBufferPool::Stats ReadBufferPool::GetStats() const {
+  base::AutoLock auto_lock(lock_);
+  return stats_;
+}
+
+size_t ReadBufferPool::BucketIndex(int size) const {
+  DCHECK(base::bits::IsPowerOfTwo(size));
+  DCHECK_GE(size, min_size_);
+  DCHECK_LE(size, max_size_);
+  return base::bits::Log2Floor(size) - base::bits::Log2Floor(min_size_);
+}
+
+}  // namespace net
@@ -0,0 +1,97 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_NET_READ_BUFFER_POOL_H_
+#define IOS_NET_READ_BUFFER_POOL_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+
+namespace net {
+
+// Pool of heap buffers used to read the response body of a net::URLRequest.
+// Buffers are bucketed by power-of-two size classes between |min_size| and
+// |max_size|. Buffers are acquired on the IO thread, but may be released from
+// any thread (typically when the NSData wrapping them is deallocated by the
+// NSURLProtocol client), so the pool is guarded by a lock.
+class ReadBufferPool {
+ public:
+  // Counters describing the effectiveness of the pool.
+  struct Stats {
+    // Number of Acquire() calls served from a free list.
+    size_t hits = 0;
+    // Number of Acquire() calls that had to allocate a new buffer.
+    size_t misses = 0;
+    // Number of buffers freed to keep the pool under its high-water mark.
+    size_t discards = 0;
+    // Number of bytes currently held in the free lists.
+    size_t retained_bytes = 0;
+    // Largest value |retained_bytes| ever reached.
+    size_t peak_retained_bytes = 0;
+  };
+
+  // Deleter returning a buffer to the pool it was acquired from.
+  class Deleter {
+   public:
+    Deleter() = default;
+    Deleter(ReadBufferPool* pool, int size) : pool_(pool), size_(size) {}
+
+    void operator()(char* buffer) const;
+
+    // Size of the buffer, as requested to Acquire().
+    int size() const { return size_; }
+
+   private:
+    ReadBufferPool* pool_ = nullptr;
+    int size_ = 0;
+  };
+
+  using Buffer = std::unique_ptr<char, Deleter>;
+
+  // |min_size| and |max_size| must be powers of two. At most
+  // |max_retained_bytes| are kept in the free lists; releasing a buffer beyond
+  // that high-water mark frees buffers from the fullest size class.
+  ReadBufferPool(int min_size, int max_size, size_t max_retained_bytes);
+  ~ReadBufferPool();
+
+  // Returns the process-wide pool used by the HTTP protocol handler.
+  static ReadBufferPool* GetInstance();
+
+  // Returns a buffer of |size| bytes. |size| must be one of the size classes
+  // of the pool.
+  Buffer Acquire(int size);
+
+  // Returns |buffer| of |size| bytes to the pool. |buffer| must have been
+  // obtained from Acquire() and released from its Buffer. Can be called from
+  // any thread.
+  void Release(char* buffer, int size);
+
+  // Returns a snapshot of the pool counters.
+  Stats GetStats() const;
+
+ private:
+  // Returns the index of the free list holding buffers of |size| bytes.
+  size_t BucketIndex(int size) const;
+
+  const int min_size_;
+  const int max_size_;
+  const size_t max_retained_bytes_;
+
+  mutable base::Lock lock_;
+  // Free buffers, indexed by size class.
+  std::vector<std::vector<char*>> free_buffers_ GUARDED_BY(lock_);
+  Stats stats_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(ReadBufferPool);
+};
+
+}  // namespace net
+
+#endif  // IOS_NET_READ_BUFFER_POOL_H_
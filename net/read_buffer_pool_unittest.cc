@@ -0,0 +1,112 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/net/read_buffer_pool.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/platform_test.h"
+
+namespace net {
+
+namespace {
+
+const int kMinSize = 1024;
+const int kMaxSize = 8 * kMinSize;
+const size_t kMaxRetainedBytes = 4 * kMaxSize;
+
+}  // namespace
+
+class ReadBufferPoolTest : public PlatformTest {
+ protected:
+  ReadBufferPoolTest() : pool_(kMinSize, kMaxSize, kMaxRetainedBytes) {}
+
+  ReadBufferPool pool_;
+};
+
+// Tests that a released buffer is reused for the same size class only.
+TEST_F(ReadBufferPoolTest, RecyclesBuffersPerSizeClass) {
+  ReadBufferPool::Buffer buffer = pool_.Acquire(kMinSize);
+  ASSERT_TRUE(buffer);
+  memset(buffer.get(), 0, kMinSize);
+  char* raw_buffer = buffer.get();
+  buffer.reset();
+
+  ReadBufferPool::Stats stats = pool_.GetStats();
+  EXPECT_EQ(0U, stats.hits);
+  EXPECT_EQ(1U, stats.misses);
+  EXPECT_EQ(static_cast<size_t>(kMinSize), stats.retained_bytes);
+
+  ReadBufferPool::Buffer larger_buffer = pool_.Acquire(2 * kMinSize);
+  EXPECT_EQ(2U, pool_.GetStats().misses);
+
+  ReadBufferPool::Buffer reused_buffer = pool_.Acquire(kMinSize);
+  EXPECT_EQ(raw_buffer, reused_buffer.get());
+  stats = pool_.GetStats();
+  EXPECT_EQ(1U, stats.hits);
+  EXPECT_EQ(0U, stats.retained_bytes);
+}
+
+// Tests that buffers released after being detached from their Buffer, as done
+// by the NSData deallocator, are recycled.
+TEST_F(ReadBufferPoolTest, ReleaseDetachedBuffer) {
+  ReadBufferPool::Buffer buffer = pool_.Acquire(kMaxSize);
+  const int size = buffer.get_deleter().size();
+  EXPECT_EQ(kMaxSize, size);
+  char* raw_buffer = buffer.release();
+  pool_.Release(raw_buffer, size);
+
+  EXPECT_EQ(raw_buffer, pool_.Acquire(kMaxSize).get());
+  EXPECT_EQ(1U, pool_.GetStats().hits);
+}
+
+// Tests that the pool never retains more than its high-water mark.
+TEST_F(ReadBufferPoolTest, HighWaterMark) {
+  std::vector<ReadBufferPool::Buffer> buffers;
+  for (int i = 0; i < 6; ++i)
+    buffers.push_back(pool_.Acquire(kMaxSize));
+  buffers.clear();
+
+  ReadBufferPool::Stats stats = pool_.GetStats();
+  EXPECT_EQ(kMaxRetainedBytes, stats.retained_bytes);
+  EXPECT_EQ(kMaxRetainedBytes, stats.peak_retained_bytes);
+  EXPECT_EQ(2U, stats.discards);
+
+  // Releasing a small buffer into a full pool evicts a large one.
+  pool_.Acquire(kMinSize).reset();
+  stats = pool_.GetStats();
+  EXPECT_EQ(3U * kMaxSize + kMinSize, stats.retained_bytes);
+  EXPECT_EQ(3U, stats.discards);
+  EXPECT_EQ(0U, stats.hits);
+}
+
+// Replays the read pattern of HttpProtocolHandlerCore, where the client holds
+// on to a few chunks at a time, and compares the number of allocations with
+// the malloc-per-read path, which allocates once per read.
+TEST_F(ReadBufferPoolTest, ReadLoopAllocationCount) {
+  const size_t kReadCount = 1000;
+  const size_t kChunksHeldByClient = 3;
+  std::vector<ReadBufferPool::Buffer> in_flight;
+  int size = kMinSize;
+  for (size_t i = 0; i < kReadCount; ++i) {
+    in_flight.push_back(pool_.Acquire(size));
+    if (in_flight.size() > kChunksHeldByClient)
+      in_flight.erase(in_flight.begin());
+    // Grow then shrink the buffer like AllocateReadBuffer() does.
+    size = (i / 50) % 2 ? std::max(size / 2, kMinSize)
+                        : std::min(size * 2, kMaxSize);
+  }
+  in_flight.clear();
+
+  ReadBufferPool::Stats stats = pool_.GetStats();
+  EXPECT_EQ(kReadCount, stats.hits + stats.misses);
+  // Without pooling, every read allocates.
+  EXPECT_LT(stats.misses * 10, kReadCount);
+}
+
+}  // namespace net
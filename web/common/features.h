@@ -50,6 +50,16 @@ extern const base::Feature kUseJSForErrorPage;
 // is requested by default.
 extern const base::Feature kUseDefaultUserAgentInWebClient;
 
+// When enabled, the session history injected by restore_session.html is
+// encoded in a compact binary format, and sessions longer than
+// wk_navigation_util::kMaxSessionSize are restored in chunks instead of being
+// truncated.
+extern const base::Feature kRestoreSessionCompactEncoding;
+
+// When enabled, the tasks posted to the WebThreads record the depth of the
+// queue of their thread and the time they wait to run.
+extern const base::Feature kWebThreadTaskTelemetry;
+
 // Use WKWebView.loading to update WebState::IsLoading.
 // TODO(crbug.com/1006012): Clean up this flag after experiment.
 bool UseWKWebViewLoading();
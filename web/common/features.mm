@@ -44,6 +44,12 @@ const base::Feature kUseJSForErrorPage{"UseJSForErrorPage",
 const base::Feature kUseDefaultUserAgentInWebClient{
     "UseDefaultUserAgentInWebClient", base::FEATURE_DISABLED_BY_DEFAULT};
 
+const base::Feature kRestoreSessionCompactEncoding{
+    "RestoreSessionCompactEncoding", base::FEATURE_ENABLED_BY_DEFAULT};
+
+const base::Feature kWebThreadTaskTelemetry{"WebThreadTaskTelemetry",
+                                            base::FEATURE_DISABLED_BY_DEFAULT};
+
 bool UseWKWebViewLoading() {
   return base::FeatureList::IsEnabled(web::features::kUseWKWebViewLoading);
 }
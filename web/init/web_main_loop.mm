@@ -10,6 +10,7 @@
 
 #include "base/bind.h"
 #include "base/command_line.h"
+#include "base/feature_list.h"
 #include "base/logging.h"
 #include "base/message_loop/message_pump_type.h"
 #include "base/metrics/histogram_macros.h"
@@ -22,6 +23,7 @@
 #include "base/task/thread_pool/thread_pool_instance.h"
 #include "base/threading/thread_restrictions.h"
 #include "base/threading/thread_task_runner_handle.h"
+#include "ios/web/common/features.h"
 #import "ios/web/net/cookie_notification_bridge.h"
 #include "ios/web/public/init/ios_global_state.h"
 #include "ios/web/public/init/web_main_parts.h"
@@ -119,6 +121,10 @@ int WebMainLoop::PreCreateThreads() {
 }
 
 int WebMainLoop::CreateThreads() {
+  // The FeatureList is initialized by PreCreateThreads().
+  WebThreadImpl::SetTaskTelemetryEnabled(
+      base::FeatureList::IsEnabled(features::kWebThreadTaskTelemetry));
+
   ios_global_state::StartThreadPool();
 
   base::Thread::Options io_message_loop_options;
@@ -237,6 +237,57 @@ var callGCrWebFunction_ = function(functionPath, parameters) {
   return functionReference.apply(null, parameters);
 }
 
+/**
+ * Executes the batch of |calls| sent in a single message and sends the results
+ * of the calls which expect one back to the native application at once. A call
+ * which throws replies with the error instead of a result, so that it does not
+ * prevent the next calls from running and the reply from being sent.
+ * @param {number} messageId The message ID of the batch.
+ * @param {!Array} calls The calls to execute, in order. Each call is an object
+ *                 with 'messageId', 'replyWithResult', 'functionName' and
+ *                 'parameters' keys.
+ */
+var executeBatchedCalls_ = function(messageId, calls) {
+  var replies = [];
+  for (var i = 0; i < calls.length; i++) {
+    var call = calls[i];
+    if (!Number.isInteger(call['messageId']) ||
+        call['messageId'] > messageId) {
+      continue;
+    }
+    var functionName = call['functionName'];
+    var parameters = call['parameters'];
+    var result = null;
+    var error = null;
+    if (typeof functionName === 'string' && functionName.length >= 1 &&
+        Array.isArray(parameters)) {
+      try {
+        result = callGCrWebFunction_(functionName, parameters);
+      } catch (e) {
+        error = String(e);
+      }
+    }
+    if (typeof call['replyWithResult'] === 'boolean' &&
+        call['replyWithResult']) {
+      var reply = {'messageId': call['messageId']};
+      if (error !== null) {
+        reply['error'] = error;
+      } else if (typeof result !== 'undefined') {
+        reply['result'] = result;
+      }
+      replies.push(reply);
+    }
+  }
+  if (replies.length == 0) {
+    return;
+  }
+  __gCrWeb.message.invokeOnHost({
+    'command': 'frameMessaging_' + __gCrWeb.message['getFrameId']() + '.reply',
+    'messageId': messageId,
+    'replies': replies
+  });
+};
+
 /**
  * Decrypts and executes the function specified in |functionPayload|.
  * @param {Object} encryptedMessageDetails JSON containing encrypted
@@ -321,6 +372,11 @@ var executeMessage_ = function(encryptedMessageDetails,
           new Uint8Array(decryptedFunctionPayload));
         var functionDict = JSON.parse(functionJSONPayload);
 
+        if (Array.isArray(functionDict['calls'])) {
+          executeBatchedCalls_(messageDict['messageId'], functionDict['calls']);
+          return;
+        }
+
         let functionName = functionDict['functionName'];
         let parameters = functionDict['parameters'];
 
@@ -9,6 +9,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "base/cancelable_callback.h"
 #include "base/macros.h"
@@ -66,6 +67,11 @@ class WebFrameImpl : public WebFrame, public web::WebStateObserver {
                               const std::vector<base::Value>& parameters,
                               bool reply_with_result);
 
+  // Sends the calls queued in |pending_calls_| to the frame in a single
+  // encrypted envelope. If encryption fails, the requests awaiting a reply are
+  // cancelled.
+  void SendPendingCalls();
+
   // Detaches the receiver from the associated  WebState.
   void DetachFromWebState();
   // Returns the script command name to use for this WebFrame.
@@ -125,6 +131,24 @@ class WebFrameImpl : public WebFrame, public web::WebStateObserver {
                          bool interacting,
                          WebFrame* sender_frame);
 
+  // A call to a JavaScript function which has not been sent to the frame yet.
+  struct PendingCall {
+    PendingCall(int message_id,
+                const std::string& name,
+                const std::vector<base::Value>& parameters,
+                bool reply_with_result);
+    PendingCall(PendingCall&& other);
+    ~PendingCall();
+    int message_id;
+    std::string name;
+    base::ListValue parameters;
+    bool reply_with_result;
+  };
+
+  // Calls to JavaScript functions made during the current task, which are
+  // sent together by |SendPendingCalls|. Only used when |frame_key_| is set.
+  std::vector<PendingCall> pending_calls_;
+
   // The JavaScript requests awating a reply.
   std::map<uint32_t, std::unique_ptr<struct RequestCallbacks>>
       pending_requests_;
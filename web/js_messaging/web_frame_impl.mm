@@ -9,11 +9,13 @@
 #include "base/base64.h"
 #include "base/bind.h"
 #include "base/json/json_writer.h"
+#include "base/metrics/histogram_macros.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/stringprintf.h"
 #include "base/strings/sys_string_conversions.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/task/post_task.h"
+#include "base/timer/elapsed_timer.h"
 #include "base/values.h"
 #include "crypto/aead.h"
 #include "crypto/random.h"
@@ -26,6 +28,10 @@
 
 namespace {
 const char kJavaScriptReplyCommandPrefix[] = "frameMessaging_";
+
+// Histogram names for the envelopes sent by |SendPendingCalls|.
+const char kCallsPerEnvelopeHistogram[] = "IOS.WebFrame.CallsPerEnvelope";
+const char kEnvelopeCryptoTimeHistogram[] = "IOS.WebFrame.EnvelopeCryptoTime";
 }
 
 namespace web {
@@ -132,6 +138,35 @@ bool WebFrameImpl::CallJavaScriptFunction(
                                      reply_with_result);
   }
 
+  // Calls made during the same task are encrypted and routed to the frame
+  // together, once the current task completes.
+  if (pending_calls_.empty()) {
+    base::PostTask(FROM_HERE, {web::WebThread::UI},
+                   base::BindOnce(&WebFrameImpl::SendPendingCalls,
+                                  weak_ptr_factory_.GetWeakPtr()));
+  }
+  pending_calls_.emplace_back(message_id, name, parameters, reply_with_result);
+
+  return true;
+}
+
+void WebFrameImpl::SendPendingCalls() {
+  std::vector<PendingCall> calls;
+  calls.swap(pending_calls_);
+  if (calls.empty() || !web_state_ || !frame_key_) {
+    return;
+  }
+
+  base::ElapsedTimer crypto_timer;
+
+  // The envelope is identified by the highest message ID of the batch, which
+  // is the last one, so that the frame's replay protection still applies.
+  const int message_id = calls.back().message_id;
+  bool reply_with_result = false;
+  for (const PendingCall& call : calls) {
+    reply_with_result |= call.reply_with_result;
+  }
+
   base::DictionaryValue message_payload;
   message_payload.SetKey("messageId", base::Value(message_id));
   message_payload.SetKey("replyWithResult", base::Value(reply_with_result));
@@ -139,15 +174,42 @@ bool WebFrameImpl::CallJavaScriptFunction(
       EncryptPayload(std::move(message_payload), std::string());
 
   base::DictionaryValue function_payload;
-  function_payload.SetKey("functionName", base::Value(name));
-  base::ListValue parameters_value(parameters);
-  function_payload.SetKey("parameters", std::move(parameters_value));
+  if (calls.size() == 1) {
+    function_payload.SetKey("functionName", base::Value(calls[0].name));
+    function_payload.SetKey("parameters", std::move(calls[0].parameters));
+  } else {
+    // Batched calls carry their own message ID so that the frame replies to
+    // each of them.
+    base::ListValue calls_value;
+    for (PendingCall& call : calls) {
+      base::DictionaryValue call_value;
+      call_value.SetKey("messageId", base::Value(call.message_id));
+      call_value.SetKey("replyWithResult",
+                        base::Value(call.reply_with_result));
+      call_value.SetKey("functionName", base::Value(call.name));
+      call_value.SetKey("parameters", std::move(call.parameters));
+      calls_value.GetList().push_back(std::move(call_value));
+    }
+    function_payload.SetKey("calls", std::move(calls_value));
+  }
   const std::string& encrypted_function_json = EncryptPayload(
       std::move(function_payload), base::NumberToString(message_id));
 
+  UMA_HISTOGRAM_COUNTS_100(kCallsPerEnvelopeHistogram,
+                           static_cast<int>(calls.size()));
+  UMA_HISTOGRAM_CUSTOM_MICROSECONDS_TIMES(
+      kEnvelopeCryptoTimeHistogram, crypto_timer.Elapsed(),
+      base::TimeDelta::FromMicroseconds(1), base::TimeDelta::FromSeconds(1),
+      50);
+
   if (encrypted_message_json.empty() || encrypted_function_json.empty()) {
     // Sealing the payload failed.
-    return false;
+    for (const PendingCall& call : calls) {
+      if (call.reply_with_result) {
+        CancelRequest(call.message_id);
+      }
+    }
+    return;
   }
 
   std::string script =
@@ -155,8 +217,6 @@ bool WebFrameImpl::CallJavaScriptFunction(
                          encrypted_message_json.c_str(),
                          encrypted_function_json.c_str(), frame_id_.c_str());
   GetWebState()->ExecuteJavaScript(base::UTF8ToUTF16(script));
-
-  return true;
 }
 
 bool WebFrameImpl::CallJavaScriptFunction(
@@ -274,6 +334,24 @@ void WebFrameImpl::OnJavaScriptReply(web::WebState* web_state,
     return;
   }
 
+  // Replies to a batch of calls are sent together. A call which threw has an
+  // "error" instead of a "result", and completes without a result.
+  const base::Value* replies =
+      command_json.FindKeyOfType("replies", base::Value::Type::LIST);
+  if (replies) {
+    for (const base::Value& reply : replies->GetList()) {
+      const base::Value* reply_message_id =
+          reply.is_dict() ? reply.FindKey("messageId") : nullptr;
+      if (!reply_message_id || !reply_message_id->is_double()) {
+        NOTREACHED();
+        continue;
+      }
+      CompleteRequest(static_cast<int>(reply_message_id->GetDouble()),
+                      reply.FindKey("result"));
+    }
+    return;
+  }
+
   int message_id = static_cast<int>(message_id_value->GetDouble());
 
   auto request = pending_requests_.find(message_id);
@@ -301,6 +379,7 @@ const std::string WebFrameImpl::GetScriptCommandPrefix() {
 }
 
 void WebFrameImpl::WebStateDestroyed(web::WebState* web_state) {
+  pending_calls_.clear();
   CancelPendingRequests();
   DetachFromWebState();
 }
@@ -312,4 +391,18 @@ WebFrameImpl::RequestCallbacks::RequestCallbacks(
 
 WebFrameImpl::RequestCallbacks::~RequestCallbacks() {}
 
+WebFrameImpl::PendingCall::PendingCall(
+    int message_id,
+    const std::string& name,
+    const std::vector<base::Value>& parameters,
+    bool reply_with_result)
+    : message_id(message_id),
+      name(name),
+      parameters(parameters),
+      reply_with_result(reply_with_result) {}
+
+WebFrameImpl::PendingCall::PendingCall(PendingCall&& other) = default;
+
+WebFrameImpl::PendingCall::~PendingCall() {}
+
 }  // namespace web
@@ -98,6 +98,82 @@ TEST_F(WebFrameImplIntTest, CallJavaScriptFunctionOnIframe) {
   }));
 }
 
+// Tests that calls made to an iframe during the same task are all executed and
+// that each of them receives its own result.
+TEST_F(WebFrameImplIntTest, CallJavaScriptFunctionBatchOnIframe) {
+  ASSERT_TRUE(LoadHtml("<p><iframe srcdoc='<p>'/>"));
+
+  __block WebFramesManager* manager = web_state()->GetWebFramesManager();
+  ASSERT_TRUE(WaitUntilConditionOrTimeout(
+      base::test::ios::kWaitForJSCompletionTimeout, ^bool {
+        return manager->GetAllWebFrames().size() == 2;
+      }));
+
+  NSTimeInterval js_timeout = kWaitForJSCompletionTimeout;
+  WebFrame* iframe = GetChildWebFrameForWebState(web_state());
+  ASSERT_TRUE(iframe);
+
+  __block int called_count = 0;
+  std::vector<base::Value> params;
+  for (int i = 0; i < 3; i++) {
+    iframe->CallJavaScriptFunction(
+        "message.getFrameId", params,
+        base::BindOnce(^(const base::Value* value) {
+          ASSERT_TRUE(value);
+          ASSERT_TRUE(value->is_string());
+          EXPECT_EQ(value->GetString(), iframe->GetFrameId());
+          called_count++;
+        }),
+        // Increase feature timeout in order to fail on test specific timeout.
+        base::TimeDelta::FromSeconds(2 * js_timeout));
+  }
+
+  EXPECT_TRUE(WaitUntilConditionOrTimeout(js_timeout, ^bool {
+    return called_count == 3;
+  }));
+}
+
+// Tests that a call which throws does not prevent the next calls of the same
+// batch from being executed and their results from being received.
+TEST_F(WebFrameImplIntTest, CallJavaScriptFunctionBatchWithErrorOnIframe) {
+  ASSERT_TRUE(
+      LoadHtml("<p><iframe srcdoc=\"<script>__gCrWeb.testThrow = "
+               "function() { throw new Error('test'); };</script>\"/>"));
+
+  __block WebFramesManager* manager = web_state()->GetWebFramesManager();
+  ASSERT_TRUE(WaitUntilConditionOrTimeout(
+      base::test::ios::kWaitForJSCompletionTimeout, ^bool {
+        return manager->GetAllWebFrames().size() == 2;
+      }));
+
+  NSTimeInterval js_timeout = kWaitForJSCompletionTimeout;
+  WebFrame* iframe = GetChildWebFrameForWebState(web_state());
+  ASSERT_TRUE(iframe);
+
+  __block bool throwing_call_completed = false;
+  __block bool next_call_completed = false;
+  std::vector<base::Value> params;
+  iframe->CallJavaScriptFunction(
+      "testThrow", params, base::BindOnce(^(const base::Value* value) {
+        EXPECT_FALSE(value);
+        throwing_call_completed = true;
+      }),
+      // Increase feature timeout in order to fail on test specific timeout.
+      base::TimeDelta::FromSeconds(2 * js_timeout));
+  iframe->CallJavaScriptFunction(
+      "message.getFrameId", params, base::BindOnce(^(const base::Value* value) {
+        ASSERT_TRUE(value);
+        ASSERT_TRUE(value->is_string());
+        EXPECT_EQ(value->GetString(), iframe->GetFrameId());
+        next_call_completed = true;
+      }),
+      base::TimeDelta::FromSeconds(2 * js_timeout));
+
+  EXPECT_TRUE(WaitUntilConditionOrTimeout(js_timeout, ^bool {
+    return throwing_call_completed && next_call_completed;
+  }));
+}
+
 TEST_F(WebFrameImplIntTest, CallJavaScriptFunctionTimeout) {
   ASSERT_TRUE(LoadHtml("<p>"));
 
@@ -11,6 +11,7 @@
 #include "base/strings/string_number_conversions.h"
 #import "base/strings/sys_string_conversions.h"
 #include "base/test/ios/wait_util.h"
+#include "base/test/metrics/histogram_tester.h"
 #include "base/values.h"
 #include "crypto/aead.h"
 #import "ios/web/public/test/fakes/test_web_state.h"
@@ -163,6 +164,8 @@ TEST_F(WebFrameImplTest, CallJavaScriptFunction) {
   EXPECT_TRUE(
       web_frame.CallJavaScriptFunction("functionName", function_params));
 
+  // Calls are sent to the frame once the current task completes.
+  base::RunLoop().RunUntilIdle();
   NSString* last_script =
       base::SysUTF16ToNSString(test_web_state.GetLastExecutedJavascript());
   EXPECT_TRUE([last_script hasPrefix:@"__gCrWeb.message.routeMessage"]);
@@ -219,6 +222,7 @@ TEST_F(WebFrameImplTest, CallJavaScriptFunctionUniqueInitializationVector) {
   EXPECT_TRUE(
       web_frame.CallJavaScriptFunction("functionName", function_params));
 
+  base::RunLoop().RunUntilIdle();
   NSString* last_script1 =
       base::SysUTF16ToNSString(test_web_state.GetLastExecutedJavascript());
   RouteMessageParameters params1 =
@@ -228,6 +232,7 @@ TEST_F(WebFrameImplTest, CallJavaScriptFunctionUniqueInitializationVector) {
   // vector is not reused and that the ciphertext is different.
   EXPECT_TRUE(
       web_frame.CallJavaScriptFunction("functionName", function_params));
+  base::RunLoop().RunUntilIdle();
   NSString* last_script2 =
       base::SysUTF16ToNSString(test_web_state.GetLastExecutedJavascript());
   RouteMessageParameters params2 =
@@ -260,6 +265,7 @@ TEST_F(WebFrameImplTest, CallJavaScriptFunctionMessageProperlyEncoded) {
   EXPECT_TRUE(
       web_frame.CallJavaScriptFunction("functionName", function_params));
 
+  base::RunLoop().RunUntilIdle();
   NSString* last_script =
       base::SysUTF16ToNSString(test_web_state.GetLastExecutedJavascript());
   RouteMessageParameters params = ParametersFromFunctionCallString(last_script);
@@ -352,6 +358,7 @@ TEST_F(WebFrameImplTest, CallJavaScriptFunctionRespondWithResult) {
       }),
       base::TimeDelta::FromSeconds(5)));
 
+  base::RunLoop().RunUntilIdle();
   NSString* last_script =
       base::SysUTF16ToNSString(test_web_state.GetLastExecutedJavascript());
   RouteMessageParameters params = ParametersFromFunctionCallString(last_script);
@@ -383,6 +390,97 @@ TEST_F(WebFrameImplTest, CallJavaScriptFunctionRespondWithResult) {
   EXPECT_TRUE(decrypted_respond_with_result.value());
 }
 
+// Tests that calls made during the same task are encrypted and sent to the
+// frame in a single message, each with its own message ID.
+TEST_F(WebFrameImplTest, CallJavaScriptFunctionBatchesCalls) {
+  std::unique_ptr<SymmetricKey> key = CreateKey();
+  const std::string key_string = key->key();
+  const int initial_message_id = 11;
+
+  TestWebState test_web_state;
+  GURL security_origin;
+  WebFrameImpl web_frame(kFrameId, /*is_main_frame=*/false, security_origin,
+                         &test_web_state);
+  web_frame.SetEncryptionKey(std::move(key));
+  web_frame.SetNextMessageId(initial_message_id);
+  base::HistogramTester histogram_tester;
+
+  std::vector<base::Value> function_params;
+  function_params.push_back(base::Value("plaintextParam"));
+  EXPECT_TRUE(web_frame.CallJavaScriptFunction("function1", function_params));
+  EXPECT_TRUE(web_frame.CallJavaScriptFunction(
+      "function2", function_params,
+      base::BindOnce(^(const base::Value* value){
+      }),
+      base::TimeDelta::FromSeconds(5)));
+  EXPECT_TRUE(test_web_state.GetLastExecutedJavascript().empty());
+
+  base::RunLoop().RunUntilIdle();
+  NSString* last_script =
+      base::SysUTF16ToNSString(test_web_state.GetLastExecutedJavascript());
+  RouteMessageParameters params = ParametersFromFunctionCallString(last_script);
+  histogram_tester.ExpectUniqueSample("IOS.WebFrame.CallsPerEnvelope", 2, 1);
+  histogram_tester.ExpectTotalCount("IOS.WebFrame.EnvelopeCryptoTime", 1);
+
+  std::string decoded_function_ciphertext;
+  EXPECT_TRUE(base::Base64Decode(
+      base::SysNSStringToUTF8(params.encoded_function_payload),
+      &decoded_function_ciphertext));
+  std::string decoded_function_iv;
+  EXPECT_TRUE(
+      base::Base64Decode(base::SysNSStringToUTF8(params.encoded_function_iv),
+                         &decoded_function_iv));
+  std::string decoded_message_ciphertext;
+  EXPECT_TRUE(base::Base64Decode(
+      base::SysNSStringToUTF8(params.encoded_message_payload),
+      &decoded_message_ciphertext));
+  std::string decoded_message_iv;
+  EXPECT_TRUE(base::Base64Decode(
+      base::SysNSStringToUTF8(params.encoded_message_iv), &decoded_message_iv));
+
+  // The envelope uses the message ID of the last call.
+  crypto::Aead aead(crypto::Aead::AES_256_GCM);
+  aead.Init(&key_string);
+  std::string message_plaintext;
+  EXPECT_TRUE(aead.Open(decoded_message_ciphertext, decoded_message_iv,
+                        /*additional_data=*/nullptr, &message_plaintext));
+  base::Optional<base::Value> parsed_message =
+      base::JSONReader::Read(message_plaintext, false);
+  ASSERT_TRUE(parsed_message.has_value());
+  EXPECT_EQ(initial_message_id + 1,
+            parsed_message.value().FindIntKey("messageId"));
+  EXPECT_EQ(true, parsed_message.value().FindBoolKey("replyWithResult"));
+
+  std::string function_plaintext;
+  EXPECT_TRUE(aead.Open(decoded_function_ciphertext, decoded_function_iv,
+                        base::NumberToString(initial_message_id + 1),
+                        &function_plaintext));
+  base::Optional<base::Value> parsed_function =
+      base::JSONReader::Read(function_plaintext, false);
+  ASSERT_TRUE(parsed_function.has_value());
+  const base::Value* calls =
+      parsed_function.value().FindKeyOfType("calls", base::Value::Type::LIST);
+  ASSERT_TRUE(calls);
+  ASSERT_EQ(2U, calls->GetList().size());
+
+  const base::Value& call1 = calls->GetList()[0];
+  EXPECT_EQ(initial_message_id, call1.FindIntKey("messageId"));
+  EXPECT_EQ(false, call1.FindBoolKey("replyWithResult"));
+  ASSERT_TRUE(call1.FindStringKey("functionName"));
+  EXPECT_EQ("function1", *call1.FindStringKey("functionName"));
+
+  const base::Value& call2 = calls->GetList()[1];
+  EXPECT_EQ(initial_message_id + 1, call2.FindIntKey("messageId"));
+  EXPECT_EQ(true, call2.FindBoolKey("replyWithResult"));
+  ASSERT_TRUE(call2.FindStringKey("functionName"));
+  EXPECT_EQ("function2", *call2.FindStringKey("functionName"));
+  const base::Value* parameters =
+      call2.FindKeyOfType("parameters", base::Value::Type::LIST);
+  ASSERT_TRUE(parameters);
+  ASSERT_EQ(1U, parameters->GetList().size());
+  EXPECT_EQ("plaintextParam", parameters->GetList()[0].GetString());
+}
+
 // Tests that the WebFrame properly creates JavaScript for the main frame when
 // there is no encryption key.
 TEST_F(WebFrameImplTest, CallJavaScriptFunctionMainFrameWithoutKey) {
@@ -0,0 +1,133 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/web/navigation/interned_url.h"
+
+#include <atomic>
+#include <unordered_map>
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/no_destructor.h"
+#include "base/strings/string_piece.h"
+#include "base/synchronization/lock.h"
+
+namespace web {
+
+// A pooled URL and the number of InternedURLs referencing it. The number of
+// references only drops to zero with the pool lock held, at the same time the
+// entry is removed from the pool, so that the pool never returns an entry
+// being freed.
+class InternedURL::Entry {
+ public:
+  explicit Entry(const GURL& url) : url_(url) {}
+
+  const GURL& url() const { return url_; }
+
+  std::atomic<int> ref_count{1};
+
+ private:
+  const GURL url_;
+
+  DISALLOW_COPY_AND_ASSIGN(Entry);
+};
+
+// The pool of the interned URLs, keyed by their spec. The keys point to the
+// specs of the entries, so that they are not duplicated.
+struct InternedURL::Pool {
+  base::Lock lock;
+  std::unordered_map<base::StringPiece, Entry*, base::StringPieceHash> entries;
+};
+
+// static
+InternedURL::Pool& InternedURL::GetPool() {
+  static base::NoDestructor<Pool> pool;
+  return *pool;
+}
+
+InternedURL::InternedURL() : entry_(nullptr) {}
+
+InternedURL::InternedURL(const GURL& url) : entry_(nullptr) {
+  if (url.is_empty())
+    return;
+  Pool& pool = GetPool();
+  base::AutoLock lock(pool.lock);
+  auto it = pool.entries.find(url.possibly_invalid_spec());
+  if (it != pool.entries.end()) {
+    entry_ = it->second;
+    entry_->ref_count.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  entry_ = new Entry(url);
+  pool.entries.emplace(entry_->url().possibly_invalid_spec(), entry_);
+}
+
+InternedURL::InternedURL(const InternedURL& other) : entry_(other.entry_) {
+  if (entry_)
+    entry_->ref_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+InternedURL::InternedURL(InternedURL&& other) : entry_(other.entry_) {
+  other.entry_ = nullptr;
+}
+
+InternedURL& InternedURL::operator=(const InternedURL& other) {
+  if (entry_ == other.entry_)
+    return *this;
+  if (other.entry_)
+    other.entry_->ref_count.fetch_add(1, std::memory_order_relaxed);
+  if (entry_)
+    Release(entry_);
+  entry_ = other.entry_;
+  return *this;
+}
+
+InternedURL& InternedURL::operator=(InternedURL&& other) {
+  if (this == &other)
+    return *this;
+  if (entry_)
+    Release(entry_);
+  entry_ = other.entry_;
+  other.entry_ = nullptr;
+  return *this;
+}
+
+InternedURL::~InternedURL() {
+  if (entry_)
+    Release(entry_);
+}
+
+const GURL& InternedURL::get() const {
+  static const base::NoDestructor<GURL> empty_url;
+  return entry_ ? entry_->url() : *empty_url;
+}
+
+// static
+size_t InternedURL::GetPoolSizeForTesting() {
+  Pool& pool = GetPool();
+  base::AutoLock lock(pool.lock);
+  return pool.entries.size();
+}
+
+// static
+void InternedURL::Release(Entry* entry) {
+  // Releases a reference without the lock as long as it is not the last one.
+  int ref_count = entry->ref_count.load(std::memory_order_relaxed);
+  while (ref_count > 1) {
+    if (entry->ref_count.compare_exchange_weak(ref_count, ref_count - 1,
+                                               std::memory_order_acq_rel)) {
+      return;
+    }
+  }
+
+  Pool& pool = GetPool();
+  base::AutoLock lock(pool.lock);
+  if (entry->ref_count.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    return;
+  size_t erased = pool.entries.erase(entry->url().possibly_invalid_spec());
+  DCHECK_EQ(1u, erased);
+  delete entry;
+}
+
+}  // namespace web
@@ -0,0 +1,56 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_WEB_NAVIGATION_INTERNED_URL_H_
+#define IOS_WEB_NAVIGATION_INTERNED_URL_H_
+
+#include <stddef.h>
+
+#include "url/gurl.h"
+
+namespace web {
+
+// Reference to a GURL kept in a process-wide pool, so that identical URLs
+// referenced by different InternedURLs share one parsed representation. The
+// pooled GURL is freed when the last InternedURL referencing it is destroyed.
+// InternedURLs can be created, copied and destroyed on any thread.
+class InternedURL {
+ public:
+  // Creates an InternedURL referencing the empty URL, which is not pooled.
+  InternedURL();
+  // Creates an InternedURL referencing the pooled URL equal to |url|, adding
+  // it to the pool if needed.
+  explicit InternedURL(const GURL& url);
+  InternedURL(const InternedURL& other);
+  InternedURL(InternedURL&& other);
+  InternedURL& operator=(const InternedURL& other);
+  InternedURL& operator=(InternedURL&& other);
+  ~InternedURL();
+
+  // Returns the referenced URL.
+  const GURL& get() const;
+
+  // Returns whether the referenced URL is empty.
+  bool is_empty() const { return !entry_; }
+
+  // Returns the number of URLs in the pool.
+  static size_t GetPoolSizeForTesting();
+
+ private:
+  class Entry;
+  struct Pool;
+
+  // Returns the process-wide pool.
+  static Pool& GetPool();
+
+  // Releases the reference to |entry|, freeing it if it is the last one.
+  static void Release(Entry* entry);
+
+  // The pooled URL, or null for the empty URL.
+  Entry* entry_;
+};
+
+}  // namespace web
+
+#endif  // IOS_WEB_NAVIGATION_INTERNED_URL_H_
@@ -0,0 +1,80 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/web/navigation/interned_url.h"
+
+#include <memory>
+#include <utility>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/platform_test.h"
+
+namespace web {
+
+using InternedURLTest = PlatformTest;
+
+// Tests that the empty URL is not pooled.
+TEST_F(InternedURLTest, EmptyURL) {
+  size_t pool_size = InternedURL::GetPoolSizeForTesting();
+  InternedURL default_url;
+  InternedURL empty_url((GURL()));
+  EXPECT_TRUE(default_url.is_empty());
+  EXPECT_TRUE(default_url.get().is_empty());
+  EXPECT_TRUE(empty_url.is_empty());
+  EXPECT_TRUE(empty_url.get().is_empty());
+  EXPECT_EQ(pool_size, InternedURL::GetPoolSizeForTesting());
+}
+
+// Tests that identical URLs share one pooled URL, which is freed with the
+// last InternedURL referencing it.
+TEST_F(InternedURLTest, IdenticalURLs) {
+  size_t pool_size = InternedURL::GetPoolSizeForTesting();
+  const GURL url("https://www.chromium.org/interned");
+  auto first_url = std::make_unique<InternedURL>(url);
+  InternedURL second_url(url);
+  EXPECT_EQ(url, second_url.get());
+  EXPECT_EQ(&first_url->get(), &second_url.get());
+  EXPECT_EQ(pool_size + 1, InternedURL::GetPoolSizeForTesting());
+
+  first_url.reset();
+  EXPECT_EQ(url, second_url.get());
+  EXPECT_EQ(pool_size + 1, InternedURL::GetPoolSizeForTesting());
+
+  second_url = InternedURL();
+  EXPECT_EQ(pool_size, InternedURL::GetPoolSizeForTesting());
+}
+
+// Tests that different URLs are pooled separately.
+TEST_F(InternedURLTest, DifferentURLs) {
+  size_t pool_size = InternedURL::GetPoolSizeForTesting();
+  InternedURL first_url(GURL("https://www.chromium.org/first"));
+  InternedURL second_url(GURL("https://www.chromium.org/second"));
+  EXPECT_NE(first_url.get(), second_url.get());
+  EXPECT_EQ(pool_size + 2, InternedURL::GetPoolSizeForTesting());
+}
+
+// Tests that copying and moving InternedURLs keeps the pooled URL referenced
+// as long as needed.
+TEST_F(InternedURLTest, CopyAndMove) {
+  size_t pool_size = InternedURL::GetPoolSizeForTesting();
+  const GURL url("https://www.chromium.org/copied");
+  InternedURL copied_url;
+  {
+    InternedURL interned_url(url);
+    copied_url = interned_url;
+  }
+  EXPECT_EQ(url, copied_url.get());
+
+  InternedURL moved_url(std::move(copied_url));
+  EXPECT_TRUE(copied_url.is_empty());
+  EXPECT_EQ(url, moved_url.get());
+
+  InternedURL other_url(GURL("https://www.chromium.org/other"));
+  EXPECT_EQ(pool_size + 2, InternedURL::GetPoolSizeForTesting());
+  other_url = std::move(moved_url);
+  EXPECT_EQ(url, other_url.get());
+  EXPECT_EQ(pool_size + 1, InternedURL::GetPoolSizeForTesting());
+}
+
+}  // namespace web
@@ -11,6 +11,7 @@
 
 #include "base/strings/string16.h"
 #include "ios/web/navigation/error_retry_state_machine.h"
+#include "ios/web/navigation/interned_url.h"
 #include "ios/web/public/favicon/favicon_status.h"
 #import "ios/web/public/navigation/navigation_item.h"
 #include "ios/web/public/navigation/referrer.h"
@@ -142,10 +143,12 @@ class NavigationItemImpl : public web::NavigationItem {
   friend NavigationItemStorageBuilder;
 
   int unique_id_;
-  GURL original_request_url_;
-  GURL url_;
+  // The URLs are interned, as they are usually identical to each other and to
+  // the URLs of the items of other tabs.
+  InternedURL original_request_url_;
+  InternedURL url_;
   Referrer referrer_;
-  GURL virtual_url_;
+  InternedURL virtual_url_;
   base::string16 title_;
   PageDisplayState page_display_state_;
   ui::PageTransition transition_type_;
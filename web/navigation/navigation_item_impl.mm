@@ -97,15 +97,16 @@ int NavigationItemImpl::GetUniqueID() const {
 }
 
 void NavigationItemImpl::SetOriginalRequestURL(const GURL& url) {
-  original_request_url_ = url;
+  original_request_url_ = (url == url_.get()) ? url_ : InternedURL(url);
 }
 
 const GURL& NavigationItemImpl::GetOriginalRequestURL() const {
-  return original_request_url_;
+  return original_request_url_.get();
 }
 
 void NavigationItemImpl::SetURL(const GURL& url) {
-  url_ = url;
+  url_ = (url == original_request_url_.get()) ? original_request_url_
+                                               : InternedURL(url);
   cached_display_title_.clear();
   error_retry_state_machine_.SetURL(url);
   if (!wk_navigation_util::URLNeedsUserAgentType(url)) {
@@ -121,7 +122,7 @@ void NavigationItemImpl::SetURL(const GURL& url) {
 }
 
 const GURL& NavigationItemImpl::GetURL() const {
-  return url_;
+  return url_.get();
 }
 
 void NavigationItemImpl::SetReferrer(const web::Referrer& referrer) {
@@ -133,12 +134,12 @@ const web::Referrer& NavigationItemImpl::GetReferrer() const {
 }
 
 void NavigationItemImpl::SetVirtualURL(const GURL& url) {
-  virtual_url_ = (url == url_) ? GURL() : url;
+  virtual_url_ = (url == url_.get()) ? InternedURL() : InternedURL(url);
   cached_display_title_.clear();
 }
 
 const GURL& NavigationItemImpl::GetVirtualURL() const {
-  return virtual_url_.is_empty() ? url_ : virtual_url_;
+  return virtual_url_.is_empty() ? url_.get() : virtual_url_.get();
 }
 
 void NavigationItemImpl::SetTitle(const base::string16& title) {
@@ -372,10 +373,10 @@ NSString* NavigationItemImpl::GetDescription() const {
            "is_create_from_push_state: %@ "
            "has_state_been_replaced: %@ is_created_from_hash_change: %@ "
            "navigation_initiation_type: %d",
-          url_.spec().c_str(), virtual_url_.spec().c_str(),
-          original_request_url_.spec().c_str(), referrer_.url.spec().c_str(),
-          base::UTF16ToUTF8(title_).c_str(), transition_type_,
-          page_display_state_.GetDescription(),
+          url_.get().spec().c_str(), virtual_url_.get().spec().c_str(),
+          original_request_url_.get().spec().c_str(),
+          referrer_.url.spec().c_str(), base::UTF16ToUTF8(title_).c_str(),
+          transition_type_, page_display_state_.GetDescription(),
           GetUserAgentTypeDescription(user_agent_type_).c_str(),
           GetUserAgentTypeDescription(user_agent_type_inheritance_).c_str(),
           is_created_from_push_state_ ? @"true" : @"false",
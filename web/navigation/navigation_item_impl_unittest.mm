@@ -8,7 +8,9 @@
 
 #include "base/logging.h"
 #include "base/strings/utf_string_conversions.h"
+#import "ios/web/navigation/navigation_item_storage_builder.h"
 #include "ios/web/navigation/wk_navigation_util.h"
+#import "ios/web/public/session/crw_navigation_item_storage.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #import "testing/gtest_mac.h"
 #include "testing/platform_test.h"
@@ -161,6 +163,35 @@ TEST_F(NavigationItemTest, VirtualURLTest) {
   EXPECT_EQ(original_url, item_->GetURL());
 }
 
+// Tests that identical URLs of the same and of different items share their
+// storage.
+TEST_F(NavigationItemTest, SharedURLs) {
+  EXPECT_EQ(&item_->GetOriginalRequestURL(), &item_->GetURL());
+  EXPECT_EQ(&item_->GetURL(), &item_->GetVirtualURL());
+
+  web::NavigationItemImpl other_item;
+  other_item.SetURL(GURL(kItemURLString));
+  other_item.SetVirtualURL(GURL("http://virtual.test"));
+  item_->SetVirtualURL(GURL("http://virtual.test"));
+  EXPECT_EQ(&item_->GetURL(), &other_item.GetURL());
+  EXPECT_EQ(&item_->GetVirtualURL(), &other_item.GetVirtualURL());
+}
+
+// Tests that the items restored from storage share their URLs with each other
+// and with the existing items.
+TEST_F(NavigationItemTest, SharedURLsOfRestoredItems) {
+  CRWNavigationItemStorage* storage = [[CRWNavigationItemStorage alloc] init];
+  storage.virtualURL = GURL(kItemURLString);
+  NavigationItemStorageBuilder builder;
+  std::unique_ptr<NavigationItemImpl> first_item =
+      builder.BuildNavigationItemImpl(storage);
+  std::unique_ptr<NavigationItemImpl> second_item =
+      builder.BuildNavigationItemImpl(storage);
+  EXPECT_EQ(&first_item->GetOriginalRequestURL(), &first_item->GetURL());
+  EXPECT_EQ(&first_item->GetURL(), &second_item->GetURL());
+  EXPECT_EQ(&item_->GetURL(), &first_item->GetURL());
+}
+
 // Tests NavigationItemImpl::GetDisplayTitleForURL method.
 TEST_F(NavigationItemTest, GetDisplayTitleForURL) {
   base::string16 title;
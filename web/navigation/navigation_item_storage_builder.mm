@@ -37,9 +37,10 @@ NavigationItemStorageBuilder::BuildNavigationItemImpl(
   // While the virtual URL is persisted, we still need the original request URL
   // and the non-virtual URL to be set upon NavigationItem creation.  Since
   // GetVirtualURL() returns |url_| for the non-overridden case, this will also
-  // update the virtual URL reported by this object.
-  item->original_request_url_ = navigation_item_storage.virtualURL;
+  // update the virtual URL reported by this object. The URLs are interned, so
+  // that the items restored for the same URL share it.
   item->SetURL(navigation_item_storage.virtualURL);
+  item->original_request_url_ = item->url_;
   item->referrer_ = navigation_item_storage.referrer;
   item->timestamp_ = navigation_item_storage.timestamp;
   item->title_ = navigation_item_storage.title;
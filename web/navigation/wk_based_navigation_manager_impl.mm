@@ -96,7 +96,10 @@ void WKBasedNavigationManagerImpl::OnNavigationStarted(const GURL& url) {
   GURL target_url;
   if (wk_navigation_util::IsRestoreSessionUrl(url) &&
       !web::wk_navigation_util::ExtractTargetURL(url, &target_url)) {
-    restoration_timer_ = std::make_unique<base::ElapsedTimer>();
+    // Long sessions are restored in chunks by several loads of the restore
+    // session URL, so only time the restoration from the first one.
+    if (!restoration_timer_)
+      restoration_timer_ = std::make_unique<base::ElapsedTimer>();
   } else if (!wk_navigation_util::IsRestoreSessionUrl(url)) {
     // It's possible for there to be pending navigations for a session that is
     // going to be restored (such as for the -ForwardHistoryClobber workaround).
@@ -750,6 +753,7 @@ void WKBasedNavigationManagerImpl::UnsafeRestore(
   // committed item, because a restored session has no pending or transient
   // item.
   is_restore_session_in_progress_ = true;
+  restoration_timer_.reset();
   if (last_committed_item_index > -1)
     restored_visible_item_ = std::move(items[last_committed_item_index]);
 
@@ -20,6 +20,7 @@
 
 #import <Foundation/Foundation.h>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "url/gurl.h"
@@ -30,13 +31,19 @@ class NavigationItem;
 
 namespace wk_navigation_util {
 
-// Session restoration algorithm has this limitation on maximum session size.
+// Session restoration algorithm has this limitation on the number of entries
+// restored by a single load of restore_session.html. Longer sessions are
+// truncated, or restored in chunks with the compact encoding.
 extern const int kMaxSessionSize;
 
 // URL fragment prefix used to encode the session history to inject in a
 // restore_session.html URL.
 extern const char kRestoreSessionSessionHashPrefix[];
 
+// URL fragment prefix used to encode the session history to inject in a
+// restore_session.html URL with the compact encoding.
+extern const char kRestoreSessionCompactSessionHashPrefix[];
+
 // URL fragment prefix used to encode target URL in a restore_session.html URL.
 extern const char kRestoreSessionTargetUrlHashPrefix[];
 
@@ -59,13 +66,35 @@ GURL GetRestoreSessionBaseUrl();
 // history encoded in the URL fragment, such that when this URL is loaded in the
 // web view, recreates all the history entries in |items| and the current loaded
 // item is the entry at |last_committed_item_index|.  Sets |first_index| to the
-// new beginning of items.
+// new beginning of items, which is only past the beginning of |items| if the
+// session is truncated.
 void CreateRestoreSessionUrl(
     int last_committed_item_index,
     const std::vector<std::unique_ptr<NavigationItem>>& items,
     GURL* url,
     int* first_index);
 
+// Encodes the session history of |items|, whose last visible entry is at
+// |offset| relative to the end of |items|, in the compact format decoded by
+// restore_session.html. The encoding is a base64url string without padding of:
+// - a version byte,
+// - -|offset| as a varint,
+// - the table of the URL prefixes shared by the entries: the number of
+//   prefixes as a varint, then each prefix as a varint length and its bytes,
+// - the entries: their number as a varint, then for each entry its prefix as a
+//   varint (1-based index in the table, 0 for no prefix), the rest of its URL
+//   and its UTF-8 title, each as a varint length and its bytes.
+std::string EncodeCompactSession(
+    int offset,
+    const std::vector<std::unique_ptr<NavigationItem>>& items);
+
+// Decodes a session history encoded by EncodeCompactSession(), as
+// restore_session.html does. Returns false if |encoded_session| is invalid.
+bool DecodeCompactSession(const std::string& encoded_session,
+                          int* offset,
+                          std::vector<std::string>* url_specs,
+                          std::vector<std::string>* titles);
+
 // Returns true if the base URL of |url| is restore_session.html.
 bool IsRestoreSessionUrl(const GURL& url);
 bool IsRestoreSessionUrl(NSURL* url);
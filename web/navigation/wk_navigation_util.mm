@@ -4,10 +4,16 @@
 
 #import "ios/web/navigation/wk_navigation_util.h"
 
+#include <limits>
+#include <map>
+
+#include "base/base64url.h"
 #include "base/json/json_writer.h"
 #include "base/mac/bundle_locations.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
 #include "base/strings/sys_string_conversions.h"
+#include "base/strings/utf_string_conversions.h"
 #include "base/values.h"
 #include "ios/web/common/features.h"
 #import "ios/web/public/navigation/navigation_item.h"
@@ -26,10 +32,13 @@ namespace wk_navigation_util {
 // Session restoration algorithms uses pushState calls to restore back forward
 // navigation list. WKWebView does not allow pushing more than 100 items per
 // 30 seconds. Limiting max session size to 75 will allow web pages to use push
-// state calls.
+// state calls. restore_session.html uses the same limit for the size of the
+// chunks of the sessions it restores with the compact encoding, each chunk
+// being restored by a new document.
 const int kMaxSessionSize = 75;
 
 const char kRestoreSessionSessionHashPrefix[] = "session=";
+const char kRestoreSessionCompactSessionHashPrefix[] = "compactSession=";
 const char kRestoreSessionTargetUrlHashPrefix[] = "targetUrl=";
 const char kOriginalUrlKey[] = "for";
 NSString* const kReferrerHeaderName = @"Referer";
@@ -76,8 +85,63 @@ int GetSafeItemIterators(
   // item index by whatever was trimmed from the left.
   return last_committed_item_index - (*begin - items.begin());
 }
+
+// Version of the compact encoding of the session history. Must match the
+// version expected by restore_session.html.
+const char kCompactSessionVersion = 1;
+
+// Appends |value| to |output| as a little-endian base 128 varint.
+void AppendVarint(uint64_t value, std::string* output) {
+  while (value >= 0x80) {
+    output->push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  output->push_back(static_cast<char>(value));
+}
+
+// Appends the length of |string| as a varint, then |string|, to |output|.
+void AppendLengthPrefixedString(base::StringPiece string, std::string* output) {
+  AppendVarint(string.size(), output);
+  string.AppendToString(output);
 }
 
+// Reads a varint written by AppendVarint() from the beginning of |input|.
+bool ReadVarint(base::StringPiece* input, uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; shift < 64 && !input->empty(); shift += 7) {
+    const uint8_t byte = static_cast<uint8_t>(input->front());
+    input->remove_prefix(1);
+    *value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+// Reads a string written by AppendLengthPrefixedString() from the beginning of
+// |input|.
+bool ReadLengthPrefixedString(base::StringPiece* input, std::string* string) {
+  uint64_t length = 0;
+  if (!ReadVarint(input, &length) || length > input->size())
+    return false;
+  *string = input->substr(0, length).as_string();
+  input->remove_prefix(length);
+  return true;
+}
+
+// Returns the prefix of the spec of |url| shared by the URLs of its origin, or
+// an empty string if |url| has no such prefix.
+std::string GetSharedURLPrefix(const GURL& url) {
+  const GURL origin = url.GetOrigin();
+  if (!origin.is_valid() ||
+      !base::StartsWith(url.spec(), origin.spec(),
+                        base::CompareCase::SENSITIVE)) {
+    return std::string();
+  }
+  return origin.spec();
+}
+}  // namespace
+
 bool IsWKInternalUrl(const GURL& url) {
   return (!base::FeatureList::IsEnabled(web::features::kUseJSForErrorPage) &&
           IsPlaceholderUrl(url)) ||
@@ -122,6 +186,101 @@ GURL GetRestoreSessionBaseUrl() {
   return GURL(url::kAboutBlankURL).ReplaceComponents(replacements);
 }
 
+std::string EncodeCompactSession(
+    int offset,
+    const std::vector<std::unique_ptr<NavigationItem>>& items) {
+  DCHECK_LE(offset, 0);
+  // The prefixes are numbered from 1 in the order they are first used.
+  std::map<std::string, size_t> prefix_numbers;
+  std::vector<base::StringPiece> prefixes;
+  std::string entries;
+  for (const auto& item : items) {
+    const std::string& spec = item->GetURL().spec();
+    const std::string prefix = GetSharedURLPrefix(item->GetURL());
+    size_t prefix_number = 0;
+    if (!prefix.empty()) {
+      auto inserted = prefix_numbers.emplace(prefix, prefixes.size() + 1);
+      if (inserted.second)
+        prefixes.push_back(inserted.first->first);
+      prefix_number = inserted.first->second;
+    }
+    AppendVarint(prefix_number, &entries);
+    AppendLengthPrefixedString(base::StringPiece(spec).substr(prefix.size()),
+                               &entries);
+    AppendLengthPrefixedString(base::UTF16ToUTF8(item->GetTitle()), &entries);
+  }
+
+  std::string session(1, kCompactSessionVersion);
+  AppendVarint(-offset, &session);
+  AppendVarint(prefixes.size(), &session);
+  for (base::StringPiece prefix : prefixes)
+    AppendLengthPrefixedString(prefix, &session);
+  AppendVarint(items.size(), &session);
+  session.append(entries);
+
+  std::string encoded_session;
+  base::Base64UrlEncode(session, base::Base64UrlEncodePolicy::OMIT_PADDING,
+                        &encoded_session);
+  return encoded_session;
+}
+
+bool DecodeCompactSession(const std::string& encoded_session,
+                          int* offset,
+                          std::vector<std::string>* url_specs,
+                          std::vector<std::string>* titles) {
+  std::string session;
+  if (!base::Base64UrlDecode(encoded_session,
+                             base::Base64UrlDecodePolicy::DISALLOW_PADDING,
+                             &session)) {
+    return false;
+  }
+
+  base::StringPiece input(session);
+  if (input.empty() || input.front() != kCompactSessionVersion)
+    return false;
+  input.remove_prefix(1);
+
+  uint64_t negated_offset = 0;
+  if (!ReadVarint(&input, &negated_offset) ||
+      negated_offset > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+    return false;
+  }
+
+  uint64_t prefix_count = 0;
+  if (!ReadVarint(&input, &prefix_count))
+    return false;
+  std::vector<std::string> prefixes;
+  for (uint64_t i = 0; i < prefix_count; ++i) {
+    std::string prefix;
+    if (!ReadLengthPrefixedString(&input, &prefix))
+      return false;
+    prefixes.push_back(std::move(prefix));
+  }
+
+  uint64_t item_count = 0;
+  if (!ReadVarint(&input, &item_count))
+    return false;
+  url_specs->clear();
+  titles->clear();
+  for (uint64_t i = 0; i < item_count; ++i) {
+    uint64_t prefix_number = 0;
+    std::string url_suffix;
+    std::string title;
+    if (!ReadVarint(&input, &prefix_number) ||
+        prefix_number > prefixes.size() ||
+        !ReadLengthPrefixedString(&input, &url_suffix) ||
+        !ReadLengthPrefixedString(&input, &title)) {
+      return false;
+    }
+    url_specs->push_back(
+        prefix_number ? prefixes[prefix_number - 1] + url_suffix : url_suffix);
+    titles->push_back(std::move(title));
+  }
+
+  *offset = -static_cast<int>(negated_offset);
+  return input.empty();
+}
+
 void CreateRestoreSessionUrl(
     int last_committed_item_index,
     const std::vector<std::unique_ptr<NavigationItem>>& items,
@@ -130,6 +289,20 @@ void CreateRestoreSessionUrl(
   DCHECK(last_committed_item_index >= 0 &&
          last_committed_item_index < static_cast<int>(items.size()));
 
+  if (base::FeatureList::IsEnabled(features::kRestoreSessionCompactEncoding)) {
+    // restore_session.html restores the sessions longer than kMaxSessionSize
+    // in chunks, so the session is not truncated.
+    const int offset =
+        last_committed_item_index + 1 - static_cast<int>(items.size());
+    GURL::Replacements replacements;
+    std::string ref = kRestoreSessionCompactSessionHashPrefix +
+                      EncodeCompactSession(offset, items);
+    replacements.SetRefStr(ref);
+    *first_index = 0;
+    *url = GetRestoreSessionBaseUrl().ReplaceComponents(replacements);
+    return;
+  }
+
   std::vector<std::unique_ptr<NavigationItem>>::const_iterator begin;
   std::vector<std::unique_ptr<NavigationItem>>::const_iterator end;
   int new_last_committed_item_index =
@@ -11,6 +11,7 @@
 #include "base/strings/stringprintf.h"
 #include "base/strings/sys_string_conversions.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/values.h"
 #include "ios/web/common/features.h"
 #import "ios/web/navigation/navigation_item_impl.h"
@@ -56,7 +57,42 @@ base::JSONReader::ValueWithError ExtractSessionDict(GURL restore_session_url) {
 
 }  // namespace
 
-typedef PlatformTest WKNavigationUtilTest;
+// Test fixture for the restore session URLs encoding the session history in
+// JSON.
+class WKNavigationUtilTest : public PlatformTest {
+ protected:
+  WKNavigationUtilTest() {
+    feature_list_.InitAndDisableFeature(
+        features::kRestoreSessionCompactEncoding);
+  }
+
+  base::test::ScopedFeatureList feature_list_;
+};
+
+// Test fixture for the restore session URLs encoding the session history with
+// the compact encoding.
+class WKNavigationUtilCompactSessionTest : public PlatformTest {
+ protected:
+  WKNavigationUtilCompactSessionTest() {
+    feature_list_.InitAndEnableFeature(
+        features::kRestoreSessionCompactEncoding);
+  }
+
+  // Decodes the session history encoded in |restore_session_url|.
+  void DecodeSession(const GURL& restore_session_url,
+                     int* offset,
+                     std::vector<std::string>* url_specs,
+                     std::vector<std::string>* titles) {
+    ASSERT_TRUE(IsRestoreSessionUrl(restore_session_url));
+    const std::string ref = restore_session_url.ref();
+    ASSERT_EQ(0U, ref.find(kRestoreSessionCompactSessionHashPrefix));
+    ASSERT_TRUE(DecodeCompactSession(
+        ref.substr(strlen(kRestoreSessionCompactSessionHashPrefix)), offset,
+        url_specs, titles));
+  }
+
+  base::test::ScopedFeatureList feature_list_;
+};
 
 TEST_F(WKNavigationUtilTest, CreateRestoreSessionUrl) {
   auto item0 = std::make_unique<NavigationItemImpl>();
@@ -400,5 +436,106 @@ TEST_F(WKNavigationUtilTest, URLNeedsUserAgentType) {
         URLNeedsUserAgentType(CreatePlaceholderUrlForUrl(app_specific)));
 }
 
+// Tests that the compact encoding restores the URLs and titles of the session.
+TEST_F(WKNavigationUtilCompactSessionTest, CreateRestoreSessionUrl) {
+  std::vector<std::unique_ptr<NavigationItem>> items;
+  for (const char* spec :
+       {"https://www.example.com/a", "https://www.example.com/b?q=1",
+        "https://other.example.com:8443/", "about:blank",
+        "data:text/html,Hello"}) {
+    auto item = std::make_unique<NavigationItemImpl>();
+    item->SetURL(GURL(spec));
+    items.push_back(std::move(item));
+  }
+  items[0]->SetTitle(base::UTF8ToUTF16("Caf\xC3\xA9 \xE2\x98\x95"));
+  items[2]->SetTitle(base::ASCIIToUTF16("Test Website 2"));
+
+  int first_index = -1;
+  GURL restore_session_url;
+  CreateRestoreSessionUrl(1 /* last_committed_item_index */, items,
+                          &restore_session_url, &first_index);
+  EXPECT_EQ(0, first_index);
+  ASSERT_TRUE(IsRestoreSessionUrl(net::NSURLWithGURL(restore_session_url)));
+
+  int offset = 0;
+  std::vector<std::string> url_specs;
+  std::vector<std::string> titles;
+  DecodeSession(restore_session_url, &offset, &url_specs, &titles);
+  EXPECT_EQ(-3, offset);
+  ASSERT_EQ(items.size(), url_specs.size());
+  ASSERT_EQ(items.size(), titles.size());
+  for (size_t i = 0; i < items.size(); ++i) {
+    EXPECT_EQ(items[i]->GetURL().spec(), url_specs[i]);
+    EXPECT_EQ(base::UTF16ToUTF8(items[i]->GetTitle()), titles[i]);
+  }
+}
+
+// Tests that sessions longer than kMaxSessionSize are not truncated with the
+// compact encoding, and that the URL prefixes shared by the entries are only
+// encoded once.
+TEST_F(WKNavigationUtilCompactSessionTest,
+       CreateRestoreSessionUrlForLongSession) {
+  const int kItemCount = kMaxSessionSize * 4;
+  std::vector<std::unique_ptr<NavigationItem>> items;
+  for (int i = 0; i < kItemCount; i++) {
+    auto item = std::make_unique<NavigationItemImpl>();
+    item->SetURL(
+        GURL(base::StringPrintf("https://www.example.com/article/%d", i)));
+    item->SetTitle(base::ASCIIToUTF16(base::StringPrintf("Test%d", i)));
+    items.push_back(std::move(item));
+  }
+
+  int first_index = -1;
+  GURL restore_session_url;
+  CreateRestoreSessionUrl(kMaxSessionSize /* last_committed_item_index */,
+                          items, &restore_session_url, &first_index);
+  EXPECT_EQ(0, first_index);
+  ASSERT_TRUE(IsRestoreSessionUrl(net::NSURLWithGURL(restore_session_url)));
+
+  // The prefix shared by the URLs is encoded once, so the encoded session is
+  // shorter than the URLs alone.
+  size_t url_specs_length = 0;
+  for (const auto& item : items)
+    url_specs_length += item->GetURL().spec().size();
+  EXPECT_LT(restore_session_url.ref().size(), url_specs_length);
+
+  int offset = 0;
+  std::vector<std::string> url_specs;
+  std::vector<std::string> titles;
+  DecodeSession(restore_session_url, &offset, &url_specs, &titles);
+  EXPECT_EQ(kMaxSessionSize + 1 - kItemCount, offset);
+  ASSERT_EQ(static_cast<size_t>(kItemCount), url_specs.size());
+  EXPECT_EQ("https://www.example.com/article/0", url_specs.front());
+  EXPECT_EQ("https://www.example.com/article/299", url_specs.back());
+  EXPECT_EQ("Test299", titles.back());
+}
+
+// Tests that invalid compact encodings are rejected.
+TEST_F(WKNavigationUtilCompactSessionTest, DecodeRejectsInvalidSessions) {
+  std::vector<std::unique_ptr<NavigationItem>> items;
+  CreateTestNavigationItems(3, items);
+  const std::string encoded_session = EncodeCompactSession(-1, items);
+
+  int offset = 0;
+  std::vector<std::string> url_specs;
+  std::vector<std::string> titles;
+  ASSERT_TRUE(
+      DecodeCompactSession(encoded_session, &offset, &url_specs, &titles));
+  EXPECT_EQ(-1, offset);
+  EXPECT_EQ(3U, url_specs.size());
+
+  // Truncated session.
+  EXPECT_FALSE(DecodeCompactSession(
+      encoded_session.substr(0, encoded_session.size() - 4), &offset,
+      &url_specs, &titles));
+  // Not base64url.
+  EXPECT_FALSE(DecodeCompactSession("not base64url!", &offset, &url_specs,
+                                    &titles));
+  // Unsupported version.
+  EXPECT_FALSE(DecodeCompactSession("AgAAAA", &offset, &url_specs, &titles));
+  // Empty session.
+  EXPECT_FALSE(DecodeCompactSession("", &offset, &url_specs, &titles));
+}
+
 }  // namespace wk_navigation_util
 }  // namespace web
@@ -9,8 +9,10 @@
 #import <WebKit/WebKit.h>
 
 // A WKHTTPCookieStore wrapper which caches the output of getAllCookies call to
-// use on subsequent calls, while observing the core WKHTTPCookieStore to
-// invalidate the cached copy once the store is updated.
+// use on subsequent calls. The cached cookies are indexed by registrable domain
+// and kept up to date in place by |setCookie:| and |deleteCookie:|, while
+// changes made by others to the core WKHTTPCookieStore are merged in by a
+// background refresh.
 // This class implements a fix for when WKHTTPCookieStore's getAllCookies method
 // callback is not called bug, see crbug.com/885218 for details.
 // All the methods of CRWWKHTTPCookieStore follow the same rules of the
@@ -28,6 +30,12 @@
 // is fixed.
 - (void)getAllCookies:(void (^)(NSArray<NSHTTPCookie*>*))completionHandler;
 
+// Fetches the stored cookies whose registrable domain is the one of |URL| and
+// whose path is a prefix of the path of |URL|. Callers still need to apply the
+// other cookie matching rules (exact domain match, secure, same site).
+- (void)getCookiesForURL:(NSURL*)URL
+       completionHandler:(void (^)(NSArray<NSHTTPCookie*>*))completionHandler;
+
 // Sets |cookie| to the store, and invokes |completionHandler| after cookie is
 // set.
 - (void)setCookie:(NSHTTPCookie*)cookie
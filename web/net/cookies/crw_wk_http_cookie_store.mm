@@ -4,8 +4,11 @@
 
 #import "ios/web/net/cookies/crw_wk_http_cookie_store.h"
 
+#import "base/ios/block_types.h"
 #include "base/logging.h"
+#include "base/strings/sys_string_conversions.h"
 #include "ios/web/public/thread/web_thread.h"
+#include "net/base/registry_controlled_domains/registry_controlled_domain.h"
 
 #if !defined(__has_feature) || !__has_feature(objc_arc)
 #error "This file requires ARC support."
@@ -26,64 +29,283 @@ void PrioritizeWKHTTPCookieStoreCallbacks() {
             completionHandler:^(NSArray<WKWebsiteDataRecord*>* records){
             }];
 }
+
+// Returns the key under which the cookies of |host| are indexed: the
+// registrable domain of |host|, or |host| itself if it has none (e.g. IP
+// addresses and intranet hosts).
+NSString* IndexKeyForHost(NSString* host) {
+  std::string host_string = base::SysNSStringToUTF8(host.lowercaseString);
+  if (!host_string.empty() && host_string[0] == '.')
+    host_string.erase(0, 1);
+  std::string domain = net::registry_controlled_domains::GetDomainAndRegistry(
+      host_string,
+      net::registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES);
+  return base::SysUTF8ToNSString(domain.empty() ? host_string : domain);
+}
+
+// Returns whether setting |rhs| replaces |lhs| in the store.
+BOOL IsSameCookie(NSHTTPCookie* lhs, NSHTTPCookie* rhs) {
+  return [lhs.name isEqualToString:rhs.name] &&
+         [lhs.domain caseInsensitiveCompare:rhs.domain] == NSOrderedSame &&
+         [lhs.path isEqualToString:rhs.path];
+}
+
+// Returns whether |cookie| may be sent for a URL with |path|. This is a
+// permissive version of the path-match rules: the trailing slash of the cookie
+// path is ignored.
+BOOL IsCookiePathPrefix(NSHTTPCookie* cookie, NSString* path) {
+  NSString* cookie_path = cookie.path;
+  if ([cookie_path hasSuffix:@"/"])
+    cookie_path = [cookie_path substringToIndex:cookie_path.length - 1];
+  return cookie_path.length == 0 || [path hasPrefix:cookie_path];
+}
+
 }  // namespace
 
 @interface CRWWKHTTPCookieStore () <WKHTTPCookieStoreObserver>
 
-// The last getAllCookies output. Will always be set from the UI
+// The cookies of the store, indexed by registrable domain. nil until the first
+// getAllCookies output is received. Will always be accessed from the UI
 // thread.
+@property(nonatomic)
+    NSMutableDictionary<NSString*, NSMutableArray<NSHTTPCookie*>*>*
+        cookiesByDomain;
+
+// All the cookies of |cookiesByDomain|, reset when the index changes. Will
+// always be set from the UI thread.
 @property(nonatomic) NSArray<NSHTTPCookie*>* cachedCookies;
 
 @end
 
-@implementation CRWWKHTTPCookieStore
+@implementation CRWWKHTTPCookieStore {
+  // Blocks waiting for |cookiesByDomain| to be loaded.
+  NSMutableArray<ProceduralBlock>* _pendingIndexHandlers;
+  // Number of change notifications expected from |_HTTPCookieStore| for the
+  // |setCookie:| and |deleteCookie:| calls made through this object. These
+  // changes are already applied to the index, so they are not fetched.
+  NSUInteger _expectedChangeCount;
+  // Whether a getAllCookies call to |_HTTPCookieStore| is in flight.
+  BOOL _fetching;
+  // Whether the store changed while a getAllCookies call was in flight.
+  BOOL _refreshNeeded;
+  // Incremented when |_HTTPCookieStore| changes, to ignore the outputs of
+  // getAllCookies calls made to the previous store.
+  NSUInteger _storeGeneration;
+}
+
+- (instancetype)init {
+  if ((self = [super init])) {
+    _pendingIndexHandlers = [NSMutableArray array];
+  }
+  return self;
+}
 
 - (void)getAllCookies:(void (^)(NSArray<NSHTTPCookie*>*))completionHandler {
   DCHECK_CURRENTLY_ON(web::WebThread::UI);
-  NSArray<NSHTTPCookie*>* result = _HTTPCookieStore ? _cachedCookies : @[];
-  if (result) {
-    dispatch_async(dispatch_get_main_queue(), ^{
-      completionHandler(result);
-    });
-  } else {
-    __weak __typeof(self) weakSelf = self;
-    [_HTTPCookieStore getAllCookies:^(NSArray<NSHTTPCookie*>* cookies) {
-      weakSelf.cachedCookies = cookies;
-      completionHandler(cookies);
-    }];
-    PrioritizeWKHTTPCookieStoreCallbacks();
-  }
+  __weak __typeof(self) weakSelf = self;
+  [self runWhenIndexIsLoaded:^{
+    completionHandler([weakSelf allCookies]);
+  }];
+}
+
+- (void)getCookiesForURL:(NSURL*)URL
+       completionHandler:(void (^)(NSArray<NSHTTPCookie*>*))completionHandler {
+  DCHECK_CURRENTLY_ON(web::WebThread::UI);
+  __weak __typeof(self) weakSelf = self;
+  [self runWhenIndexIsLoaded:^{
+    completionHandler([weakSelf cookiesForURL:URL]);
+  }];
 }
 
 - (void)setCookie:(NSHTTPCookie*)cookie
     completionHandler:(nullable void (^)(void))completionHandler {
   DCHECK_CURRENTLY_ON(web::WebThread::UI);
-  _cachedCookies = nil;
+  NSHTTPCookie* replacedCookie = [self removeCookieFromIndex:cookie];
+  // Setting an expired cookie deletes it.
+  BOOL expired =
+      cookie.expiresDate && cookie.expiresDate.timeIntervalSinceNow <= 0;
+  if (!expired)
+    [self addCookieToIndex:cookie];
+  [self willWriteChangingStore:expired ? replacedCookie != nil
+                                       : ![replacedCookie isEqual:cookie]];
   [_HTTPCookieStore setCookie:cookie completionHandler:completionHandler];
 }
 
 - (void)deleteCookie:(NSHTTPCookie*)cookie
     completionHandler:(nullable void (^)(void))completionHandler {
   DCHECK_CURRENTLY_ON(web::WebThread::UI);
-  _cachedCookies = nil;
+  NSHTTPCookie* deletedCookie = [self removeCookieFromIndex:cookie];
+  [self willWriteChangingStore:deletedCookie != nil];
   [_HTTPCookieStore deleteCookie:cookie completionHandler:completionHandler];
 }
 
 - (void)setHTTPCookieStore:(WKHTTPCookieStore*)newCookieStore {
   DCHECK_CURRENTLY_ON(web::WebThread::UI);
   _cachedCookies = nil;
-  if (newCookieStore == _HTTPCookieStore)
+  _cookiesByDomain = nil;
+  _fetching = NO;
+  _refreshNeeded = NO;
+  _expectedChangeCount = 0;
+  _storeGeneration++;
+  if (newCookieStore != _HTTPCookieStore) {
+    [_HTTPCookieStore removeObserver:self];
+    _HTTPCookieStore = newCookieStore;
+    [_HTTPCookieStore addObserver:self];
+  }
+
+  // Blocks waiting for the previous store are served by the new one.
+  if (!_pendingIndexHandlers.count)
     return;
-  [_HTTPCookieStore removeObserver:self];
-  _HTTPCookieStore = newCookieStore;
-  [_HTTPCookieStore addObserver:self];
+  if (_HTTPCookieStore) {
+    [self fetchAllCookies];
+  } else {
+    [self runPendingIndexHandlers];
+  }
 }
 
 #pragma mark WKHTTPCookieStoreObserver method
 
 - (void)cookiesDidChangeInCookieStore:(WKHTTPCookieStore*)cookieStore {
   DCHECK(_HTTPCookieStore == cookieStore);
+  if (!_cookiesByDomain)
+    return;
+  // Changes made through this object are already applied to the index.
+  if (_expectedChangeCount) {
+    _expectedChangeCount--;
+    return;
+  }
+  // The index keeps serving requests while the changes made by others are
+  // fetched.
+  [self fetchAllCookies];
+}
+
+#pragma mark Private methods
+
+// Runs |block| asynchronously once |cookiesByDomain| is loaded.
+- (void)runWhenIndexIsLoaded:(ProceduralBlock)block {
+  if (!_HTTPCookieStore || _cookiesByDomain) {
+    dispatch_async(dispatch_get_main_queue(), block);
+    return;
+  }
+  [_pendingIndexHandlers addObject:block];
+  [self fetchAllCookies];
+}
+
+// Runs and clears |_pendingIndexHandlers|.
+- (void)runPendingIndexHandlers {
+  NSArray<ProceduralBlock>* handlers = _pendingIndexHandlers;
+  _pendingIndexHandlers = [NSMutableArray array];
+  for (ProceduralBlock handler in handlers)
+    handler();
+}
+
+// Fetches all the cookies of |_HTTPCookieStore| to rebuild the index.
+- (void)fetchAllCookies {
+  DCHECK(_HTTPCookieStore);
+  if (_fetching) {
+    _refreshNeeded = YES;
+    return;
+  }
+  _fetching = YES;
+  _refreshNeeded = NO;
+  NSUInteger generation = _storeGeneration;
+  __weak __typeof(self) weakSelf = self;
+  [_HTTPCookieStore getAllCookies:^(NSArray<NSHTTPCookie*>* cookies) {
+    [weakSelf didFetchCookies:cookies generation:generation];
+  }];
+  PrioritizeWKHTTPCookieStoreCallbacks();
+}
+
+- (void)didFetchCookies:(NSArray<NSHTTPCookie*>*)cookies
+             generation:(NSUInteger)generation {
+  if (generation != _storeGeneration)
+    return;
+  _fetching = NO;
+  _cookiesByDomain = [NSMutableDictionary dictionary];
+  for (NSHTTPCookie* cookie in cookies)
+    [self addCookieToIndex:cookie];
+  _cachedCookies = cookies;
+  [self runPendingIndexHandlers];
+  // Fetch again if the output may miss changes made during the fetch.
+  if (_refreshNeeded)
+    [self fetchAllCookies];
+}
+
+// Returns all the indexed cookies.
+- (NSArray<NSHTTPCookie*>*)allCookies {
+  if (!_cookiesByDomain)
+    return @[];
+  if (!_cachedCookies) {
+    NSMutableArray<NSHTTPCookie*>* cookies = [NSMutableArray array];
+    for (NSMutableArray<NSHTTPCookie*>* bucket in _cookiesByDomain
+             .objectEnumerator) {
+      [cookies addObjectsFromArray:bucket];
+    }
+    _cachedCookies = [cookies copy];
+  }
+  return _cachedCookies;
+}
+
+// Returns the indexed cookies that may be sent for |URL|.
+- (NSArray<NSHTTPCookie*>*)cookiesForURL:(NSURL*)URL {
+  NSArray<NSHTTPCookie*>* bucket =
+      URL.host ? _cookiesByDomain[IndexKeyForHost(URL.host)] : nil;
+  NSString* path = URL.path.length ? URL.path : @"/";
+  NSMutableArray<NSHTTPCookie*>* cookies = [NSMutableArray array];
+  for (NSHTTPCookie* cookie in bucket) {
+    if (IsCookiePathPrefix(cookie, path))
+      [cookies addObject:cookie];
+  }
+  return cookies;
+}
+
+- (void)addCookieToIndex:(NSHTTPCookie*)cookie {
+  if (!_cookiesByDomain)
+    return;
+  NSString* key = IndexKeyForHost(cookie.domain);
+  NSMutableArray<NSHTTPCookie*>* bucket = _cookiesByDomain[key];
+  if (!bucket) {
+    bucket = [NSMutableArray array];
+    _cookiesByDomain[key] = bucket;
+  }
+  [bucket addObject:cookie];
+  _cachedCookies = nil;
+}
+
+// Removes the indexed cookie that |cookie| replaces, and returns it.
+- (NSHTTPCookie*)removeCookieFromIndex:(NSHTTPCookie*)cookie {
+  if (!_cookiesByDomain)
+    return nil;
+  NSString* key = IndexKeyForHost(cookie.domain);
+  NSMutableArray<NSHTTPCookie*>* bucket = _cookiesByDomain[key];
+  NSUInteger index = [bucket indexOfObjectPassingTest:^BOOL(
+                                 NSHTTPCookie* indexedCookie, NSUInteger idx,
+                                 BOOL* stop) {
+    return IsSameCookie(indexedCookie, cookie);
+  }];
+  if (index == NSNotFound)
+    return nil;
+  NSHTTPCookie* removedCookie = bucket[index];
+  [bucket removeObjectAtIndex:index];
+  if (!bucket.count)
+    [_cookiesByDomain removeObjectForKey:key];
   _cachedCookies = nil;
+  return removedCookie;
+}
+
+// Called before writing to |_HTTPCookieStore|. |changesStore| is whether the
+// write changes the indexed cookies, in which case the store notifies of the
+// change.
+- (void)willWriteChangingStore:(BOOL)changesStore {
+  // Writes to a nil store never complete.
+  if (!_HTTPCookieStore)
+    return;
+  // A fetch in flight may miss the write.
+  if (_fetching)
+    _refreshNeeded = YES;
+  // Without index, no notification is handled.
+  if (_cookiesByDomain && changesStore)
+    _expectedChangeCount++;
 }
 
 @end
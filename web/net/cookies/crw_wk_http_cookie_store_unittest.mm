@@ -24,6 +24,17 @@
 using base::test::ios::WaitUntilConditionOrTimeout;
 using base::test::ios::kWaitForCookiesTimeout;
 
+// Counts the change notifications of a WKHTTPCookieStore.
+@interface CookieChangeCounter : NSObject <WKHTTPCookieStoreObserver>
+@property(nonatomic, readonly) NSUInteger changeCount;
+@end
+
+@implementation CookieChangeCounter
+- (void)cookiesDidChangeInCookieStore:(WKHTTPCookieStore*)cookieStore {
+  _changeCount++;
+}
+@end
+
 class CRWWKHTTPCookieStoreTest : public PlatformTest {
  public:
   CRWWKHTTPCookieStoreTest()
@@ -126,7 +137,7 @@ TEST_F(CRWWKHTTPCookieStoreTest, GetCookiesCachedCorrectly) {
   EXPECT_OCMOCK_VERIFY(mock_http_cookie_store_);
 }
 
-// Tests that |setCookie:| works correctly and invalidates the cache.
+// Tests that |setCookie:| works correctly and updates the cache in place.
 TEST_F(CRWWKHTTPCookieStoreTest, SetCookie) {
   // Verify that internal cookie store setCookie method was called.
   OCMExpect([mock_http_cookie_store_ setCookie:test_cookie_1_
@@ -147,18 +158,34 @@ TEST_F(CRWWKHTTPCookieStoreTest, SetCookie) {
                              completionHandler:[OCMArg any]])
       .andForwardToRealObject();
   EXPECT_TRUE(SetCookie(test_cookie_2_));
-
-  // Verify that cache was invalidated and internal getAllCookies is called.
-  OCMExpect([mock_http_cookie_store_ getAllCookies:[OCMArg any]])
-      .andForwardToRealObject();
   NSArray<NSHTTPCookie*>* result_2 = GetCookies();
 
-  // Check that the cookies returned was changed and cache was invalidated.
+  // Check that the cookies returned include the new cookie.
   EXPECT_NSNE(result_1, result_2);
+  EXPECT_EQ(2U, result_2.count);
+  EXPECT_TRUE([result_2 containsObject:test_cookie_2_]);
   EXPECT_OCMOCK_VERIFY(mock_http_cookie_store_);
 }
 
-// Tests that |deleteCookie:| works correctly and invalidates the cache.
+// Tests that setting a cookie with the same name, domain and path replaces the
+// cached cookie.
+TEST_F(CRWWKHTTPCookieStoreTest, SetCookieReplacesCachedCookie) {
+  EXPECT_TRUE(SetCookie(test_cookie_1_));
+  EXPECT_EQ(1U, GetCookies().count);
+
+  NSHTTPCookie* updated_cookie = [NSHTTPCookie cookieWithProperties:@{
+    NSHTTPCookiePath : test_cookie_1_.path,
+    NSHTTPCookieName : test_cookie_1_.name,
+    NSHTTPCookieValue : @"updated",
+    NSHTTPCookieDomain : test_cookie_1_.domain,
+  }];
+  EXPECT_TRUE(SetCookie(updated_cookie));
+  NSArray<NSHTTPCookie*>* result = GetCookies();
+  ASSERT_EQ(1U, result.count);
+  EXPECT_NSEQ(@"updated", result[0].value);
+}
+
+// Tests that |deleteCookie:| works correctly and updates the cache in place.
 TEST_F(CRWWKHTTPCookieStoreTest, DeleteCookie) {
   EXPECT_TRUE(SetCookie(test_cookie_1_));
   EXPECT_TRUE(SetCookie(test_cookie_2_));
@@ -172,12 +199,9 @@ TEST_F(CRWWKHTTPCookieStoreTest, DeleteCookie) {
 
   EXPECT_TRUE(DeleteCookie(test_cookie_2_));
 
-  // Verify that cache was invalidated and internal getAllCookies is called.
-  OCMExpect([mock_http_cookie_store_ getAllCookies:[OCMArg any]])
-      .andForwardToRealObject();
-
   NSArray<NSHTTPCookie*>* result_2 = GetCookies();
   EXPECT_EQ(1U, result_2.count);
+  EXPECT_FALSE([result_2 containsObject:test_cookie_2_]);
 
   EXPECT_OCMOCK_VERIFY(mock_http_cookie_store_);
 }
@@ -205,15 +229,56 @@ TEST_F(CRWWKHTTPCookieStoreTest, ChangeCookieStore) {
   EXPECT_EQ(0U, result_3.count);
 
   EXPECT_TRUE(SetCookie(test_cookie_2_));
-
-  // Verify that cache was invalidated and internal getAllCookies is called.
-  OCMExpect([mock_http_cookie_store_ getAllCookies:[OCMArg any]])
-      .andForwardToRealObject();
   NSArray<NSHTTPCookie*>* result_4 = GetCookies();
   EXPECT_EQ(1U, result_4.count);
   EXPECT_OCMOCK_VERIFY(mock_http_cookie_store_);
 }
 
+// Tests that the changes made through the CRWWKHTTPCookieStore are not fetched
+// from the internal cookie store.
+TEST_F(CRWWKHTTPCookieStoreTest, LocalWriteDoesNotFetch) {
+  EXPECT_EQ(0U, GetCookies().count);
+  CookieChangeCounter* counter = [[CookieChangeCounter alloc] init];
+  [mock_http_cookie_store_ addObserver:counter];
+
+  // Internal getAllCookies shouldn't be called again.
+  [[mock_http_cookie_store_ reject] getAllCookies:[OCMArg any]];
+  EXPECT_TRUE(SetCookie(test_cookie_1_));
+  ASSERT_TRUE(WaitUntilConditionOrTimeout(kWaitForCookiesTimeout, ^bool {
+    return counter.changeCount == 1U;
+  }));
+  EXPECT_EQ(1U, GetCookies().count);
+
+  EXPECT_TRUE(DeleteCookie(test_cookie_1_));
+  ASSERT_TRUE(WaitUntilConditionOrTimeout(kWaitForCookiesTimeout, ^bool {
+    return counter.changeCount == 2U;
+  }));
+  EXPECT_EQ(0U, GetCookies().count);
+
+  [mock_http_cookie_store_ removeObserver:counter];
+  EXPECT_OCMOCK_VERIFY(mock_http_cookie_store_);
+}
+
+// Tests that cookies set by other clients of the internal cookie store while a
+// write is pending are fetched.
+TEST_F(CRWWKHTTPCookieStoreTest, ExternalChangeDuringWrite) {
+  EXPECT_EQ(0U, GetCookies().count);
+
+  __block bool external_cookie_set = false;
+  [crw_cookie_store_ setCookie:test_cookie_1_ completionHandler:nil];
+  [mock_http_cookie_store_ setCookie:test_cookie_2_
+                   completionHandler:^{
+                     external_cookie_set = true;
+                   }];
+  ASSERT_TRUE(WaitUntilConditionOrTimeout(kWaitForCookiesTimeout, ^bool {
+    return external_cookie_set;
+  }));
+
+  EXPECT_TRUE(WaitUntilConditionOrTimeout(kWaitForCookiesTimeout, ^bool {
+    return GetCookies().count == 2U;
+  }));
+}
+
 // Tests that if the internal cookie store is nil, getAllCookie will still run
 // its callback.
 TEST_F(CRWWKHTTPCookieStoreTest, NilCookieStore) {
@@ -223,3 +288,48 @@ TEST_F(CRWWKHTTPCookieStoreTest, NilCookieStore) {
   NSArray<NSHTTPCookie*>* result = GetCookies();
   EXPECT_EQ(0U, result.count);
 }
+
+// Tests that |getCookiesForURL:| only returns the cookies of the registrable
+// domain of the URL whose path matches.
+TEST_F(CRWWKHTTPCookieStoreTest, GetCookiesForURL) {
+  NSHTTPCookie* domain_cookie = [NSHTTPCookie cookieWithProperties:@{
+    NSHTTPCookiePath : @"/",
+    NSHTTPCookieName : @"domain",
+    NSHTTPCookieValue : @"value",
+    NSHTTPCookieDomain : @".google.com",
+  }];
+  NSHTTPCookie* other_domain_cookie = [NSHTTPCookie cookieWithProperties:@{
+    NSHTTPCookiePath : @"/",
+    NSHTTPCookieName : @"other",
+    NSHTTPCookieValue : @"value",
+    NSHTTPCookieDomain : @"example.com",
+  }];
+  EXPECT_TRUE(SetCookie(test_cookie_1_));
+  EXPECT_TRUE(SetCookie(domain_cookie));
+  EXPECT_TRUE(SetCookie(other_domain_cookie));
+
+  __block NSArray<NSHTTPCookie*>* result = nil;
+  [crw_cookie_store_
+       getCookiesForURL:[NSURL URLWithString:@"http://foo.google.com/bar/baz"]
+      completionHandler:^(NSArray<NSHTTPCookie*>* cookies) {
+        result = cookies;
+      }];
+  ASSERT_TRUE(WaitUntilConditionOrTimeout(kWaitForCookiesTimeout, ^bool {
+    return result != nil;
+  }));
+  EXPECT_EQ(2U, result.count);
+  EXPECT_TRUE([result containsObject:test_cookie_1_]);
+  EXPECT_TRUE([result containsObject:domain_cookie]);
+
+  result = nil;
+  [crw_cookie_store_
+       getCookiesForURL:[NSURL URLWithString:@"http://www.google.com/"]
+      completionHandler:^(NSArray<NSHTTPCookie*>* cookies) {
+        result = cookies;
+      }];
+  ASSERT_TRUE(WaitUntilConditionOrTimeout(kWaitForCookiesTimeout, ^bool {
+    return result != nil;
+  }));
+  ASSERT_EQ(1U, result.count);
+  EXPECT_NSEQ(domain_cookie, result[0]);
+}
@@ -208,13 +208,19 @@ void WKHTTPSystemCookieStore::GetCookiesAsyncInternal(
   base::PostTask(
       FROM_HERE, {web::WebThread::UI}, base::BindOnce(^{
         __typeof(weak_cookie_store) strong_cookie_store = weak_cookie_store;
-        if (strong_cookie_store) {
-          [strong_cookie_store
-              getAllCookies:^(NSArray<NSHTTPCookie*>* cookies) {
-                ProcessGetCookiesResultInIOThread(std::move(shared_callback),
-                                                  weak_time_manager, block_url,
-                                                  cookies);
-              }];
+        void (^completion_handler)(NSArray<NSHTTPCookie*>*) =
+            ^(NSArray<NSHTTPCookie*>* cookies) {
+              ProcessGetCookiesResultInIOThread(std::move(shared_callback),
+                                                weak_time_manager, block_url,
+                                                cookies);
+            };
+        if (strong_cookie_store && block_url.is_empty()) {
+          [strong_cookie_store getAllCookies:completion_handler];
+        } else if (strong_cookie_store) {
+          // Only the cookies indexed under the domain of |block_url| need to
+          // be filtered.
+          [strong_cookie_store getCookiesForURL:net::NSURLWithGURL(block_url)
+                              completionHandler:completion_handler];
         } else {
           ProcessGetCookiesResultInIOThread(std::move(shared_callback),
                                             weak_time_manager, block_url, @[]);
@@ -250,6 +256,7 @@ void WKHTTPSystemCookieStore::ProcessGetCookiesResultInIOThread(
     }
 
     if (weak_time_manager) {
+      weak_time_manager->LoadCreationTimes(block_cookies);
       NSArray* sorted_results = [block_cookies
           sortedArrayUsingFunction:net::SystemCookieStore::CompareCookies
                            context:weak_time_manager.get()];
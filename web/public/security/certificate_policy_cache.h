@@ -5,10 +5,16 @@
 #ifndef IOS_WEB_PUBLIC_SECURITY_CERTIFICATE_POLICY_CACHE_H_
 #define IOS_WEB_PUBLIC_SECURITY_CERTIFICATE_POLICY_CACHE_H_
 
-#include <map>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
 #include "ios/web/public/security/cert_policy.h"
 #include "net/cert/x509_certificate.h"
 
@@ -16,15 +22,34 @@ namespace web {
 
 // A manager for certificate policy decisions for hosts, used to remember
 // decisions about how to handle problematic certs.
-// This class is thread-safe only in that in can be created and passed around
-// on any thread; the policy-related methods can only be called from the IO
-// thread.
+// The policies are kept in an immutable snapshot, replaced by a modified copy
+// on each write. The policies can be queried from any thread without locking,
+// but can only be modified from the IO thread.
 class CertificatePolicyCache
     : public base::RefCountedThreadSafe<CertificatePolicyCache> {
  public:
+  // A certificate allowed for a host.
+  struct AllowedCert {
+    AllowedCert(scoped_refptr<net::X509Certificate> cert,
+                const std::string& host,
+                net::CertStatus error);
+    AllowedCert(const AllowedCert& other);
+    ~AllowedCert();
+
+    scoped_refptr<net::X509Certificate> cert;
+    std::string host;
+    net::CertStatus error;
+  };
+
   // Can be called from any thread:
   CertificatePolicyCache();
 
+  // Queries whether |cert| is allowed or denied for |host|. Can be called from
+  // any thread, and does not allocate if |host| has no policy.
+  virtual CertPolicy::Judgment QueryPolicy(net::X509Certificate* cert,
+                                           const std::string& host,
+                                           net::CertStatus error) const;
+
   // Everything from here on can only be called from the IO thread.
 
   // Records that |cert| is permitted to be used for |host| in the future.
@@ -32,10 +57,11 @@ class CertificatePolicyCache
                                 const std::string& host,
                                 net::CertStatus error);
 
-  // Queries whether |cert| is allowed or denied for |host|.
-  virtual CertPolicy::Judgment QueryPolicy(net::X509Certificate* cert,
-                                           const std::string& host,
-                                           net::CertStatus error);
+  // Records that each cert of |allowed_certs| is permitted to be used for its
+  // host in the future. Copies the policies once for all the certs, so should
+  // be preferred to AllowCertForHost() when allowing several certs.
+  virtual void AllowCertsForHosts(
+      const std::vector<AllowedCert>& allowed_certs);
 
   // Removes all policies stored in this instance.
   virtual void ClearCertificatePolicies();
@@ -47,7 +73,19 @@ class CertificatePolicyCache
   friend class base::RefCountedThreadSafe<CertificatePolicyCache>;
 
   // Certificate policies for each host.
-  std::map<std::string, CertPolicy> cert_policy_for_host_;
+  using Snapshot = std::unordered_map<std::string, CertPolicy>;
+
+  // Makes |snapshot| the policies returned by the queries, and deletes the
+  // replaced snapshot once the queries that may read it complete.
+  void PublishSnapshot(std::unique_ptr<const Snapshot> snapshot);
+
+  // The current policies. Never null.
+  std::atomic<const Snapshot*> snapshot_;
+  // Incremented each time |snapshot_| is replaced. Only the queries that
+  // started in the epoch of a replacement may read the replaced snapshot.
+  std::atomic<uint64_t> epoch_;
+  // The number of running queries that started in an even or odd epoch.
+  mutable std::atomic<int> query_counts_[2];
 
   DISALLOW_COPY_AND_ASSIGN(CertificatePolicyCache);
 };
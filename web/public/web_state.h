@@ -20,6 +20,7 @@
 #include "base/supports_user_data.h"
 #include "ios/web/public/deprecated/url_verification_constants.h"
 #include "ios/web/public/navigation/referrer.h"
+#include "ios/web/public/web_state_user_data_slots.h"
 #include "mojo/public/cpp/bindings/generic_pending_receiver.h"
 #include "mojo/public/cpp/system/message_pipe.h"
 #include "ui/base/page_transition_types.h"
@@ -59,7 +60,9 @@ class WebStateObserver;
 class WebStatePolicyDecider;
 
 // Core interface for interaction with the web.
-class WebState : public base::SupportsUserData {
+// WebStateUserDataSlots is the first base class so that its slots are still
+// valid, and empty, while base::SupportsUserData destroys the user data.
+class WebState : public WebStateUserDataSlots, public base::SupportsUserData {
  public:
   // Parameters for the Create() method.
   struct CreateParams {
@@ -157,7 +160,12 @@ class WebState : public base::SupportsUserData {
       const CreateParams& params,
       CRWSessionStorage* session_storage);
 
-  ~WebState() override {}
+  ~WebState() override;
+
+  // Hide the base::SupportsUserData methods to keep the slots of the user data
+  // in sync with the user data map.
+  void SetUserData(const void* key, std::unique_ptr<Data> data);
+  void RemoveUserData(const void* key);
 
   // Gets/Sets the delegate.
   virtual WebStateDelegate* GetDelegate() = 0;
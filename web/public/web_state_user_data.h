@@ -5,10 +5,13 @@
 #ifndef IOS_WEB_PUBLIC_WEB_STATE_USER_DATA_H_
 #define IOS_WEB_PUBLIC_WEB_STATE_USER_DATA_H_
 
+#include "base/bind.h"
+#include "base/callback.h"
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
 #include "base/supports_user_data.h"
 #import "ios/web/public/web_state.h"
+#include "ios/web/public/web_state_user_data_slots.h"
 
 // This macro declares a static variable inside the class that inherits from
 // WebStateUserData. The address of this static variable is used as the key to
@@ -22,6 +25,30 @@
 
 namespace web {
 
+// Creates the user data attached to a WebState.
+using WebStateUserDataFactory = base::OnceCallback<void(WebState*)>;
+
+// Registers |factory| to create the user data of |key| attached to |web_state|
+// once it is first needed. Use WebStateUserData::CreateLazilyForWebState()
+// instead of calling this function directly.
+void RegisterLazyWebStateUserData(WebState* web_state,
+                                  const void* key,
+                                  WebStateUserDataFactory factory);
+
+// Runs the factory registered for |key| and |web_state| with
+// RegisterLazyWebStateUserData(), if any, and returns the user data of |key|.
+// Returns nullptr if no factory is registered or if |web_state| is being
+// destroyed.
+base::SupportsUserData::Data* CreateLazyWebStateUserData(WebState* web_state,
+                                                         const void* key);
+
+// Registers |callback| to run right after the factory registered for |key| and
+// |web_state| with RegisterLazyWebStateUserData(), and after the callbacks
+// registered before it. Does nothing if no factory is registered.
+void AppendToLazyWebStateUserData(WebState* web_state,
+                                  const void* key,
+                                  WebStateUserDataFactory callback);
+
 // A base class for classes attached to, and scoped to, the lifetime of a
 // WebState. For example:
 //
@@ -49,14 +76,71 @@ class WebStateUserData : public base::SupportsUserData::Data {
       web_state->SetUserData(UserDataKey(), base::WrapUnique(new T(web_state)));
   }
 
+  // Defers the creation of the instance of type T attached to the specified
+  // WebState until it is first retrieved with FromWebState(), or until the
+  // WebState is first shown or starts its first navigation, whichever comes
+  // first. |factory| must attach the instance, usually by calling
+  // CreateForWebState(). If an instance is already attached, does nothing.
+  static void CreateLazilyForWebState(WebState* web_state,
+                                      WebStateUserDataFactory factory) {
+    if (!web_state->GetUserData(UserDataKey())) {
+      RegisterLazyWebStateUserData(web_state, UserDataKey(),
+                                   std::move(factory));
+    }
+  }
+  static void CreateLazilyForWebState(WebState* web_state) {
+    CreateLazilyForWebState(
+        web_state, base::BindOnce(&WebStateUserData<T>::CreateForWebState));
+  }
+
   // Retrieves the instance of type T that was attached to the specified
-  // WebState (via CreateForWebState above) and returns it. If no instance
-  // of the type was attached, returns nullptr.
+  // WebState (via CreateForWebState above) and returns it. If the creation of
+  // the instance was deferred with CreateLazilyForWebState, creates it. If no
+  // instance of the type was attached, returns nullptr.
+  // The instance is looked up in the slot of type T first, and only in the
+  // user data map if the slot is empty.
   static T* FromWebState(WebState* web_state) {
-    return static_cast<T*>(web_state->GetUserData(UserDataKey()));
+    const size_t slot = UserDataSlot();
+    base::SupportsUserData::Data* data = web_state->GetUserDataInSlot(slot);
+    if (data)
+      return static_cast<T*>(data);
+    data = web_state->GetUserData(UserDataKey());
+    if (!data)
+      data = CreateLazyWebStateUserData(web_state, UserDataKey());
+    if (data)
+      web_state->SetUserDataInSlot(slot, data);
+    return static_cast<T*>(data);
   }
+  // The const version does not create an instance whose creation was deferred.
   static const T* FromWebState(const WebState* web_state) {
-    return static_cast<const T*>(web_state->GetUserData(UserDataKey()));
+    const base::SupportsUserData::Data* data =
+        web_state->GetUserDataInSlot(UserDataSlot());
+    if (!data)
+      data = web_state->GetUserData(UserDataKey());
+    return static_cast<const T*>(data);
+  }
+
+  // Runs |callback| with the instance of type T attached to the specified
+  // WebState. If the creation of the instance was deferred with
+  // CreateLazilyForWebState, runs |callback| once it is created instead of
+  // creating it, so that observers of all the WebStates, such as the ones
+  // installing delegates, do not create it. If no instance of the type was
+  // attached, does nothing.
+  static void RunWhenCreatedForWebState(
+      WebState* web_state,
+      base::OnceCallback<void(T*)> callback) {
+    base::SupportsUserData::Data* data =
+        web_state->GetUserDataInSlot(UserDataSlot());
+    if (!data)
+      data = web_state->GetUserData(UserDataKey());
+    if (data) {
+      std::move(callback).Run(static_cast<T*>(data));
+      return;
+    }
+    AppendToLazyWebStateUserData(
+        web_state, UserDataKey(),
+        base::BindOnce(&WebStateUserData<T>::RunWithInstance,
+                       std::move(callback)));
   }
 
   // Removes the instance attached to the specified WebState.
@@ -65,6 +149,24 @@ class WebStateUserData : public base::SupportsUserData::Data {
   }
 
   static const void* UserDataKey() { return &T::kUserDataKey; }
+
+  // Returns the index of the slot of type T in the WebStateUserDataSlots of
+  // WebStates. The slot is registered the first time it is needed, as
+  // assigning it when the key is defined would require a static initializer.
+  static size_t UserDataSlot() {
+    static const size_t slot =
+        WebStateUserDataSlots::RegisterSlot(UserDataKey());
+    return slot;
+  }
+
+ private:
+  // Runs |callback| with the instance of type T attached to |web_state|, if
+  // any.
+  static void RunWithInstance(base::OnceCallback<void(T*)> callback,
+                              WebState* web_state) {
+    if (T* instance = FromWebState(web_state))
+      std::move(callback).Run(instance);
+  }
 };
 
 }  // namespace web
@@ -0,0 +1,60 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_WEB_PUBLIC_WEB_STATE_USER_DATA_SLOTS_H_
+#define IOS_WEB_PUBLIC_WEB_STATE_USER_DATA_SLOTS_H_
+
+#include <stddef.h>
+
+#include <limits>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/supports_user_data.h"
+
+namespace web {
+
+// Dense table of the WebStateUserData attached to a WebState, indexed by a
+// small integer assigned to each WebStateUserData type. Lets
+// WebStateUserData<T>::FromWebState() find the user data with an indexed load
+// instead of a map lookup. The table does not own the user data, which stays
+// owned by the base::SupportsUserData map; data whose key has no slot is only
+// stored in the map.
+class WebStateUserDataSlots {
+ public:
+  // Value returned by FindSlot() for keys without a slot.
+  static constexpr size_t kInvalidSlot = std::numeric_limits<size_t>::max();
+
+  // Returns the slot of the user data of |key|, assigning the next free slot
+  // the first time |key| is registered. Slots are shared by all WebStates.
+  static size_t RegisterSlot(const void* key);
+
+  // Returns the slot registered for |key|, or kInvalidSlot if there is none.
+  static size_t FindSlot(const void* key);
+
+  // Returns the user data stored in |slot|, or nullptr if there is none.
+  base::SupportsUserData::Data* GetUserDataInSlot(size_t slot) const {
+    return slot < slots_.size() ? slots_[slot] : nullptr;
+  }
+
+  // Stores |data| in |slot|. |data| must be owned by the WebState under the
+  // key of |slot|.
+  void SetUserDataInSlot(size_t slot, base::SupportsUserData::Data* data);
+
+ protected:
+  WebStateUserDataSlots();
+  ~WebStateUserDataSlots();
+
+  // Empties all the slots.
+  void ClearUserDataSlots();
+
+ private:
+  std::vector<base::SupportsUserData::Data*> slots_;
+
+  DISALLOW_COPY_AND_ASSIGN(WebStateUserDataSlots);
+};
+
+}  // namespace web
+
+#endif  // IOS_WEB_PUBLIC_WEB_STATE_USER_DATA_SLOTS_H_
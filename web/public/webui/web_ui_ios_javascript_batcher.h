@@ -0,0 +1,94 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IOS_WEB_PUBLIC_WEBUI_WEB_UI_IOS_JAVASCRIPT_BATCHER_H_
+#define IOS_WEB_PUBLIC_WEBUI_WEB_UI_IOS_JAVASCRIPT_BATCHER_H_
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "base/containers/circular_deque.h"
+#include "base/macros.h"
+#include "base/strings/string16.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+
+namespace base {
+class Value;
+}
+
+namespace web {
+
+class WebUIIOS;
+
+// Buffers the JavaScript function calls of a WebUIIOSMessageHandler and
+// executes them in order as a single script once per interval, instead of
+// executing a script per call. Meant for the handlers forwarding events to the
+// page at a high rate.
+class WebUIIOSJavascriptBatcher {
+ public:
+  // What to do with a call made when |max_pending_calls| calls are pending.
+  enum class OverflowPolicy {
+    // Executes the pending calls right away, then buffers the call.
+    kFlush,
+    // Drops the oldest pending call, then buffers the call.
+    kDropOldest,
+    // Drops the call.
+    kDropNewest,
+  };
+
+  struct Options {
+    // Maximum time a call is buffered before being executed, about a frame.
+    base::TimeDelta interval = base::TimeDelta::FromMilliseconds(16);
+    // Maximum number of buffered calls.
+    size_t max_pending_calls = 500;
+    OverflowPolicy overflow_policy = OverflowPolicy::kFlush;
+  };
+
+  // Executes the calls in the page of |web_ui|, which must outlive the
+  // batcher.
+  WebUIIOSJavascriptBatcher(WebUIIOS* web_ui, const Options& options);
+  explicit WebUIIOSJavascriptBatcher(WebUIIOS* web_ui);
+  // Drops the pending calls.
+  ~WebUIIOSJavascriptBatcher();
+
+  // Buffers a call to the JavaScript function |function_name| with |args|, as
+  // WebUIIOS::CallJavascriptFunction() would make it. |args| are serialized
+  // right away.
+  void CallJavascriptFunction(const std::string& function_name,
+                              const std::vector<const base::Value*>& args);
+
+  // Executes the pending calls right away.
+  void Flush();
+
+  // Returns the number of calls buffered, executed as part of a batch.
+  size_t batched_call_count() const { return batched_call_count_; }
+  // Returns the number of calls dropped by the overflow policy.
+  size_t dropped_call_count() const { return dropped_call_count_; }
+  // Returns the number of scripts executed.
+  size_t batch_count() const { return batch_count_; }
+  // Returns the number of calls waiting to be executed.
+  size_t pending_call_count() const { return pending_calls_.size(); }
+
+ private:
+  WebUIIOS* web_ui_;
+  const Options options_;
+
+  // The JavaScript of the pending calls, in order.
+  base::circular_deque<base::string16> pending_calls_;
+  // Executes the pending calls at the end of the interval.
+  base::OneShotTimer flush_timer_;
+
+  size_t batched_call_count_ = 0;
+  size_t dropped_call_count_ = 0;
+  size_t batch_count_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(WebUIIOSJavascriptBatcher);
+};
+
+}  // namespace web
+
+#endif  // IOS_WEB_PUBLIC_WEBUI_WEB_UI_IOS_JAVASCRIPT_BATCHER_H_
@@ -4,33 +4,97 @@
 
 #include "ios/web/public/security/certificate_policy_cache.h"
 
+#include <utility>
+
 #include "base/logging.h"
+#include "base/threading/platform_thread.h"
 #include "ios/web/public/thread/web_thread.h"
 
 namespace web {
 
-CertificatePolicyCache::CertificatePolicyCache() {}
+CertificatePolicyCache::AllowedCert::AllowedCert(
+    scoped_refptr<net::X509Certificate> cert,
+    const std::string& host,
+    net::CertStatus error)
+    : cert(std::move(cert)), host(host), error(error) {}
+
+CertificatePolicyCache::AllowedCert::AllowedCert(const AllowedCert& other) =
+    default;
 
-CertificatePolicyCache::~CertificatePolicyCache() {}
+CertificatePolicyCache::AllowedCert::~AllowedCert() = default;
+
+CertificatePolicyCache::CertificatePolicyCache()
+    : snapshot_(new Snapshot()), epoch_(0), query_counts_{{0}, {0}} {}
+
+CertificatePolicyCache::~CertificatePolicyCache() {
+  delete snapshot_.load();
+}
+
+CertPolicy::Judgment CertificatePolicyCache::QueryPolicy(
+    net::X509Certificate* cert,
+    const std::string& host,
+    net::CertStatus error) const {
+  // The query must be counted in its epoch before loading the snapshot, so
+  // that PublishSnapshot() either waits for it or has already replaced the
+  // snapshot. If the epoch changed while counting the query, the writer may
+  // not wait for it, so count it in the new epoch instead.
+  std::atomic<int>* query_count = nullptr;
+  while (true) {
+    const uint64_t epoch = epoch_.load(std::memory_order_seq_cst);
+    query_count = &query_counts_[epoch & 1];
+    query_count->fetch_add(1, std::memory_order_seq_cst);
+    if (epoch_.load(std::memory_order_seq_cst) == epoch)
+      break;
+    query_count->fetch_sub(1, std::memory_order_release);
+  }
+
+  const Snapshot* snapshot = snapshot_.load(std::memory_order_seq_cst);
+  auto it = snapshot->find(host);
+  CertPolicy::Judgment judgment =
+      it == snapshot->end() ? CertPolicy::UNKNOWN
+                            : it->second.Check(cert, error);
+  query_count->fetch_sub(1, std::memory_order_release);
+  return judgment;
+}
 
 void CertificatePolicyCache::AllowCertForHost(net::X509Certificate* cert,
                                               const std::string& host,
                                               net::CertStatus error) {
   DCHECK_CURRENTLY_ON(WebThread::IO);
-  cert_policy_for_host_[host].Allow(cert, error);
+  auto snapshot = std::make_unique<Snapshot>(*snapshot_.load());
+  (*snapshot)[host].Allow(cert, error);
+  PublishSnapshot(std::move(snapshot));
 }
 
-CertPolicy::Judgment CertificatePolicyCache::QueryPolicy(
-    net::X509Certificate* cert,
-    const std::string& host,
-    net::CertStatus error) {
+void CertificatePolicyCache::AllowCertsForHosts(
+    const std::vector<AllowedCert>& allowed_certs) {
   DCHECK_CURRENTLY_ON(WebThread::IO);
-  return cert_policy_for_host_[host].Check(cert, error);
+  if (allowed_certs.empty())
+    return;
+  auto snapshot = std::make_unique<Snapshot>(*snapshot_.load());
+  for (const AllowedCert& allowed_cert : allowed_certs) {
+    (*snapshot)[allowed_cert.host].Allow(allowed_cert.cert.get(),
+                                         allowed_cert.error);
+  }
+  PublishSnapshot(std::move(snapshot));
 }
 
 void CertificatePolicyCache::ClearCertificatePolicies() {
   DCHECK_CURRENTLY_ON(WebThread::IO);
-  cert_policy_for_host_.clear();
+  PublishSnapshot(std::make_unique<Snapshot>());
+}
+
+void CertificatePolicyCache::PublishSnapshot(
+    std::unique_ptr<const Snapshot> snapshot) {
+  std::unique_ptr<const Snapshot> replaced_snapshot(
+      snapshot_.exchange(snapshot.release(), std::memory_order_seq_cst));
+  // Queries starting from now count in the next epoch and read the new
+  // snapshot. Only the queries of the current epoch may read the replaced one.
+  // No query can start in the current epoch anymore, and the running ones are
+  // short and never block, so this only waits for a few lookups.
+  const uint64_t epoch = epoch_.fetch_add(1, std::memory_order_seq_cst);
+  while (query_counts_[epoch & 1].load(std::memory_order_acquire) != 0)
+    base::PlatformThread::YieldCurrentThread();
 }
 
 }  // namespace web
@@ -0,0 +1,206 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/web/public/security/certificate_policy_cache.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/strings/stringprintf.h"
+#include "base/synchronization/atomic_flag.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
+#include "ios/web/public/test/web_task_environment.h"
+#include "net/cert/x509_certificate.h"
+#include "net/test/test_certificate_data.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/platform_test.h"
+
+namespace web {
+
+namespace {
+
+// Queries the policy of a cert in a loop until stopped.
+class QueryDelegate : public base::DelegateSimpleThread::Delegate {
+ public:
+  QueryDelegate(CertificatePolicyCache* cache,
+                net::X509Certificate* cert,
+                const base::AtomicFlag* stop)
+      : cache_(cache), cert_(cert), stop_(stop) {}
+
+  void Run() override {
+    while (!stop_->IsSet()) {
+      CertPolicy::Judgment judgment = cache_->QueryPolicy(
+          cert_, "google.com", net::CERT_STATUS_DATE_INVALID);
+      EXPECT_NE(CertPolicy::DENIED, judgment);
+    }
+  }
+
+ private:
+  CertificatePolicyCache* cache_;
+  net::X509Certificate* cert_;
+  const base::AtomicFlag* stop_;
+
+  DISALLOW_COPY_AND_ASSIGN(QueryDelegate);
+};
+
+// Checks in a loop until stopped that a cert is allowed, and counts the
+// queries.
+class AllowedQueryDelegate : public base::DelegateSimpleThread::Delegate {
+ public:
+  AllowedQueryDelegate(CertificatePolicyCache* cache,
+                       net::X509Certificate* cert,
+                       const base::AtomicFlag* stop)
+      : cache_(cache), cert_(cert), stop_(stop), query_count_(0) {}
+
+  void Run() override {
+    while (!stop_->IsSet()) {
+      EXPECT_EQ(CertPolicy::ALLOWED,
+                cache_->QueryPolicy(cert_, "google.com",
+                                    net::CERT_STATUS_DATE_INVALID));
+      query_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  int query_count() const {
+    return query_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  CertificatePolicyCache* cache_;
+  net::X509Certificate* cert_;
+  const base::AtomicFlag* stop_;
+  std::atomic<int> query_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(AllowedQueryDelegate);
+};
+
+}  // namespace
+
+class CertificatePolicyCacheTest : public PlatformTest {
+ protected:
+  CertificatePolicyCacheTest()
+      : cache_(base::MakeRefCounted<CertificatePolicyCache>()),
+        google_cert_(net::X509Certificate::CreateFromBytes(
+            reinterpret_cast<const char*>(google_der),
+            sizeof(google_der))),
+        webkit_cert_(net::X509Certificate::CreateFromBytes(
+            reinterpret_cast<const char*>(webkit_der),
+            sizeof(webkit_der))) {}
+
+  WebTaskEnvironment task_environment_;
+  scoped_refptr<CertificatePolicyCache> cache_;
+  scoped_refptr<net::X509Certificate> google_cert_;
+  scoped_refptr<net::X509Certificate> webkit_cert_;
+};
+
+// Tests that the allowed certs are only allowed for their host.
+TEST_F(CertificatePolicyCacheTest, AllowCertForHost) {
+  ASSERT_TRUE(google_cert_);
+  EXPECT_EQ(CertPolicy::UNKNOWN,
+            cache_->QueryPolicy(google_cert_.get(), "google.com",
+                                net::CERT_STATUS_DATE_INVALID));
+
+  cache_->AllowCertForHost(google_cert_.get(), "google.com",
+                           net::CERT_STATUS_DATE_INVALID);
+  EXPECT_EQ(CertPolicy::ALLOWED,
+            cache_->QueryPolicy(google_cert_.get(), "google.com",
+                                net::CERT_STATUS_DATE_INVALID));
+  EXPECT_EQ(CertPolicy::UNKNOWN,
+            cache_->QueryPolicy(google_cert_.get(), "webkit.org",
+                                net::CERT_STATUS_DATE_INVALID));
+  EXPECT_EQ(CertPolicy::UNKNOWN,
+            cache_->QueryPolicy(google_cert_.get(), "google.com",
+                                net::CERT_STATUS_COMMON_NAME_INVALID));
+}
+
+// Tests allowing several certs at once.
+TEST_F(CertificatePolicyCacheTest, AllowCertsForHosts) {
+  ASSERT_TRUE(google_cert_);
+  ASSERT_TRUE(webkit_cert_);
+  std::vector<CertificatePolicyCache::AllowedCert> allowed_certs;
+  allowed_certs.emplace_back(google_cert_, "google.com",
+                             net::CERT_STATUS_DATE_INVALID);
+  allowed_certs.emplace_back(webkit_cert_, "webkit.org",
+                             net::CERT_STATUS_COMMON_NAME_INVALID);
+  cache_->AllowCertsForHosts(allowed_certs);
+
+  EXPECT_EQ(CertPolicy::ALLOWED,
+            cache_->QueryPolicy(google_cert_.get(), "google.com",
+                                net::CERT_STATUS_DATE_INVALID));
+  EXPECT_EQ(CertPolicy::ALLOWED,
+            cache_->QueryPolicy(webkit_cert_.get(), "webkit.org",
+                                net::CERT_STATUS_COMMON_NAME_INVALID));
+  EXPECT_EQ(CertPolicy::UNKNOWN,
+            cache_->QueryPolicy(webkit_cert_.get(), "google.com",
+                                net::CERT_STATUS_COMMON_NAME_INVALID));
+}
+
+// Tests that clearing the policies forgets the allowed certs.
+TEST_F(CertificatePolicyCacheTest, ClearCertificatePolicies) {
+  ASSERT_TRUE(google_cert_);
+  cache_->AllowCertForHost(google_cert_.get(), "google.com",
+                           net::CERT_STATUS_DATE_INVALID);
+  cache_->ClearCertificatePolicies();
+  EXPECT_EQ(CertPolicy::UNKNOWN,
+            cache_->QueryPolicy(google_cert_.get(), "google.com",
+                                net::CERT_STATUS_DATE_INVALID));
+}
+
+// Tests querying the policies from other threads while they are modified.
+TEST_F(CertificatePolicyCacheTest, QueryFromOtherThreads) {
+  ASSERT_TRUE(google_cert_);
+  ASSERT_TRUE(webkit_cert_);
+  base::AtomicFlag stop;
+  QueryDelegate delegate(cache_.get(), google_cert_.get(), &stop);
+  base::DelegateSimpleThreadPool pool("CertificatePolicyCacheTest", 4);
+  pool.AddWork(&delegate, 4);
+  pool.Start();
+
+  for (int i = 0; i < 1000; ++i) {
+    cache_->AllowCertForHost(google_cert_.get(), "google.com",
+                             net::CERT_STATUS_DATE_INVALID);
+    cache_->AllowCertForHost(webkit_cert_.get(), "webkit.org",
+                             net::CERT_STATUS_DATE_INVALID);
+    cache_->ClearCertificatePolicies();
+  }
+  stop.Set();
+  pool.JoinAll();
+}
+
+// Tests that writes complete while other threads query the policies
+// continuously, and that the queries always see the policies that no write
+// removed.
+TEST_F(CertificatePolicyCacheTest, WriteWhileQueriedContinuously) {
+  ASSERT_TRUE(google_cert_);
+  ASSERT_TRUE(webkit_cert_);
+  cache_->AllowCertForHost(google_cert_.get(), "google.com",
+                           net::CERT_STATUS_DATE_INVALID);
+  base::AtomicFlag stop;
+  AllowedQueryDelegate delegate(cache_.get(), google_cert_.get(), &stop);
+  base::DelegateSimpleThreadPool pool("CertificatePolicyCacheTest", 4);
+  pool.AddWork(&delegate, 4);
+  pool.Start();
+  while (delegate.query_count() == 0)
+    base::PlatformThread::YieldCurrentThread();
+
+  const int queries_before_writes = delegate.query_count();
+  for (int i = 0; i < 1000; ++i) {
+    std::string host = base::StringPrintf("host%d.example.com", i);
+    cache_->AllowCertForHost(webkit_cert_.get(), host,
+                             net::CERT_STATUS_DATE_INVALID);
+    EXPECT_EQ(CertPolicy::ALLOWED,
+              cache_->QueryPolicy(webkit_cert_.get(), host,
+                                  net::CERT_STATUS_DATE_INVALID));
+  }
+  // The readers kept querying during the writes.
+  EXPECT_LT(queries_before_writes, delegate.query_count());
+  stop.Set();
+  pool.JoinAll();
+}
+
+}  // namespace web
@@ -4,6 +4,9 @@
 
 #import "ios/web/session/session_certificate_policy_cache_impl.h"
 
+#include <utility>
+#include <vector>
+
 #include "base/bind.h"
 #include "base/task/post_task.h"
 #include "ios/web/public/security/certificate_policy_cache.h"
@@ -55,14 +58,15 @@ void SessionCertificatePolicyCacheImpl::UpdateCertificatePolicyCache(
     const scoped_refptr<web::CertificatePolicyCache>& cache) const {
   DCHECK_CURRENTLY_ON(WebThread::UI);
   DCHECK(cache.get());
-  NSSet* allowed_certs = [NSSet setWithSet:allowed_certs_];
-  const scoped_refptr<web::CertificatePolicyCache> cache_copy = cache;
-  base::PostTask(FROM_HERE, {web::WebThread::IO}, base::BindOnce(^{
-                   for (CRWSessionCertificateStorage* cert in allowed_certs) {
-                     cache_copy->AllowCertForHost(cert.certificate, cert.host,
-                                                  cert.status);
-                   }
-                 }));
+  std::vector<CertificatePolicyCache::AllowedCert> allowed_certs;
+  allowed_certs.reserve(allowed_certs_.count);
+  for (CRWSessionCertificateStorage* cert in allowed_certs_) {
+    allowed_certs.emplace_back(cert.certificate, cert.host, cert.status);
+  }
+  base::PostTask(
+      FROM_HERE, {web::WebThread::IO},
+      base::BindOnce(&CertificatePolicyCache::AllowCertsForHosts, cache,
+                     std::move(allowed_certs)));
 }
 
 void SessionCertificatePolicyCacheImpl::RegisterAllowedCertificate(
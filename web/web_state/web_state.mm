@@ -52,6 +52,28 @@ WebState::OpenURLParams::OpenURLParams(const OpenURLParams& params)
 
 WebState::OpenURLParams::~OpenURLParams() {}
 
+WebState::~WebState() {
+  // The user data may look up other user data while they are destroyed, at
+  // which point the user data map is already empty.
+  ClearUserDataSlots();
+}
+
+void WebState::SetUserData(const void* key, std::unique_ptr<Data> data) {
+  // Update the slot first, as |data| may replace user data that looks up the
+  // user data of |key| when destroyed.
+  const size_t slot = FindSlot(key);
+  if (slot != kInvalidSlot)
+    SetUserDataInSlot(slot, data.get());
+  base::SupportsUserData::SetUserData(key, std::move(data));
+}
+
+void WebState::RemoveUserData(const void* key) {
+  const size_t slot = FindSlot(key);
+  if (slot != kInvalidSlot)
+    SetUserDataInSlot(slot, nullptr);
+  base::SupportsUserData::RemoveUserData(key);
+}
+
 WebState::InterfaceBinder::InterfaceBinder(WebState* web_state)
     : web_state_(web_state) {}
 
@@ -284,11 +284,12 @@ TEST_F(WebStateTest, SetHasOpener) {
   EXPECT_TRUE(web_state()->HasOpener());
 }
 
-// Verifies that large session can be restored with max session size limit
-// equals to |wk_navigation_util::kMaxSessionSize|.
+// Verifies that large session can be restored entirely, in chunks of
+// |wk_navigation_util::kMaxSessionSize| items.
 TEST_F(WebStateTest, RestoreLargeSession) {
   // Create session storage with large number of items.
   const int kItemCount = 150;
+  ASSERT_GT(kItemCount, wk_navigation_util::kMaxSessionSize);
   NSMutableArray<CRWNavigationItemStorage*>* item_storages =
       [NSMutableArray arrayWithCapacity:kItemCount];
   for (unsigned int i = 0; i < kItemCount; i++) {
@@ -312,8 +313,7 @@ TEST_F(WebStateTest, RestoreLargeSession) {
 
   // Verify that session was fully restored.
   EXPECT_TRUE(WaitUntilConditionOrTimeout(kWaitForPageLoadTimeout, ^{
-    bool restored = navigation_manager->GetItemCount() ==
-                        wk_navigation_util::kMaxSessionSize &&
+    bool restored = navigation_manager->GetItemCount() == kItemCount &&
                     navigation_manager->CanGoForward();
     EXPECT_EQ(restored, !navigation_manager->IsRestoreSessionInProgress());
     if (!restored) {
@@ -365,8 +365,7 @@ TEST_F(WebStateTest, RestoreLargeSession) {
 
     return restored;
   }));
-  EXPECT_EQ(wk_navigation_util::kMaxSessionSize,
-            navigation_manager->GetItemCount());
+  EXPECT_EQ(kItemCount, navigation_manager->GetItemCount());
   EXPECT_TRUE(navigation_manager->CanGoForward());
 
   histogram_tester_.ExpectTotalCount(kRestoreNavigationItemCount, 1);
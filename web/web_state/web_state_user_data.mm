@@ -0,0 +1,162 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/web/public/web_state_user_data.h"
+
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/macros.h"
+#include "ios/web/public/web_state_observer.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace web {
+namespace {
+
+// Key of the LazyWebStateUserDataFactories attached to a WebState.
+const char kLazyWebStateUserDataFactoriesKey = 0;
+
+// The factories of the user data of a WebState whose creation is deferred.
+// Runs all the remaining factories once the WebState is realized, that is once
+// it is first shown or starts its first navigation.
+class LazyWebStateUserDataFactories : public base::SupportsUserData::Data,
+                                      public WebStateObserver {
+ public:
+  explicit LazyWebStateUserDataFactories(WebState* web_state)
+      : web_state_(web_state) {
+    web_state_->AddObserver(this);
+  }
+
+  ~LazyWebStateUserDataFactories() override { StopObserving(); }
+
+  // Returns the factories attached to |web_state|, or nullptr if there are
+  // none.
+  static LazyWebStateUserDataFactories* FromWebState(WebState* web_state) {
+    return static_cast<LazyWebStateUserDataFactories*>(
+        web_state->GetUserData(&kLazyWebStateUserDataFactoriesKey));
+  }
+
+  // Adds the factory of the user data of |key|. Runs |factory| immediately if
+  // the WebState is already realized.
+  void AddFactory(const void* key, WebStateUserDataFactory factory) {
+    if (!observing_ || web_state_->IsVisible() || web_state_->IsLoading()) {
+      std::move(factory).Run(web_state_);
+      return;
+    }
+    factories_.emplace(key, std::move(factory));
+  }
+
+  // Runs the factory of the user data of |key|, if there is one. Returns
+  // whether a factory was run.
+  bool RunFactory(const void* key) {
+    auto it = factories_.find(key);
+    if (it == factories_.end())
+      return false;
+    // Remove the factory before running it, as it is expected to look up the
+    // user data of |key|.
+    WebStateUserDataFactory factory = std::move(it->second);
+    factories_.erase(it);
+    std::move(factory).Run(web_state_);
+    return true;
+  }
+
+  // Makes the factory of the user data of |key| run |callback| after it, if
+  // there is one.
+  void AppendToFactory(const void* key, WebStateUserDataFactory callback) {
+    auto it = factories_.find(key);
+    if (it == factories_.end())
+      return;
+    it->second = base::BindOnce(
+        [](WebStateUserDataFactory factory, WebStateUserDataFactory callback,
+           WebState* web_state) {
+          std::move(factory).Run(web_state);
+          std::move(callback).Run(web_state);
+        },
+        std::move(it->second), std::move(callback));
+  }
+
+  // WebStateObserver implementation.
+  void WasShown(WebState* web_state) override { Realize(); }
+  void DidStartNavigation(WebState* web_state,
+                          NavigationContext* navigation_context) override {
+    Realize();
+  }
+  void WebStateDestroyed(WebState* web_state) override {
+    factories_.clear();
+    StopObserving();
+  }
+
+ private:
+  // Runs all the remaining factories and stops deferring the creation of user
+  // data. The user data created are notified of the event which realized the
+  // WebState if they observe it.
+  void Realize() {
+    StopObserving();
+    std::map<const void*, WebStateUserDataFactory> factories;
+    std::swap(factories, factories_);
+    for (auto& key_and_factory : factories)
+      std::move(key_and_factory.second).Run(web_state_);
+  }
+
+  void StopObserving() {
+    if (!observing_)
+      return;
+    web_state_->RemoveObserver(this);
+    observing_ = false;
+  }
+
+  WebState* web_state_;
+  // Whether the WebState is observed, that is, whether it is not realized nor
+  // destroyed yet.
+  bool observing_ = true;
+  // The factories, by key of the user data they create.
+  std::map<const void*, WebStateUserDataFactory> factories_;
+
+  DISALLOW_COPY_AND_ASSIGN(LazyWebStateUserDataFactories);
+};
+
+}  // namespace
+
+void RegisterLazyWebStateUserData(WebState* web_state,
+                                  const void* key,
+                                  WebStateUserDataFactory factory) {
+  DCHECK(!web_state->IsBeingDestroyed());
+  LazyWebStateUserDataFactories* factories =
+      LazyWebStateUserDataFactories::FromWebState(web_state);
+  if (!factories) {
+    auto new_factories =
+        std::make_unique<LazyWebStateUserDataFactories>(web_state);
+    factories = new_factories.get();
+    web_state->SetUserData(&kLazyWebStateUserDataFactoriesKey,
+                           std::move(new_factories));
+  }
+  factories->AddFactory(key, std::move(factory));
+}
+
+base::SupportsUserData::Data* CreateLazyWebStateUserData(WebState* web_state,
+                                                         const void* key) {
+  if (web_state->IsBeingDestroyed())
+    return nullptr;
+  LazyWebStateUserDataFactories* factories =
+      LazyWebStateUserDataFactories::FromWebState(web_state);
+  if (!factories || !factories->RunFactory(key))
+    return nullptr;
+  return web_state->GetUserData(key);
+}
+
+void AppendToLazyWebStateUserData(WebState* web_state,
+                                  const void* key,
+                                  WebStateUserDataFactory callback) {
+  LazyWebStateUserDataFactories* factories =
+      LazyWebStateUserDataFactories::FromWebState(web_state);
+  if (factories)
+    factories->AppendToFactory(key, std::move(callback));
+}
+
+}  // namespace web
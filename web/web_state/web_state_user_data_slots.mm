@@ -0,0 +1,72 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/web/public/web_state_user_data_slots.h"
+
+#include <map>
+
+#include "base/logging.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace web {
+namespace {
+
+// The slots assigned to the user data keys.
+struct SlotRegistry {
+  base::Lock lock;
+  std::map<const void*, size_t> slots;
+};
+
+SlotRegistry& GetSlotRegistry() {
+  static base::NoDestructor<SlotRegistry> registry;
+  return *registry;
+}
+
+}  // namespace
+
+constexpr size_t WebStateUserDataSlots::kInvalidSlot;
+
+// static
+size_t WebStateUserDataSlots::RegisterSlot(const void* key) {
+  SlotRegistry& registry = GetSlotRegistry();
+  base::AutoLock auto_lock(registry.lock);
+  // The slot of a key may be registered several times, for example by
+  // different instantiations of WebStateUserData<T> in a component build.
+  return registry.slots.emplace(key, registry.slots.size()).first->second;
+}
+
+// static
+size_t WebStateUserDataSlots::FindSlot(const void* key) {
+  SlotRegistry& registry = GetSlotRegistry();
+  base::AutoLock auto_lock(registry.lock);
+  auto it = registry.slots.find(key);
+  return it == registry.slots.end() ? kInvalidSlot : it->second;
+}
+
+WebStateUserDataSlots::WebStateUserDataSlots() = default;
+
+WebStateUserDataSlots::~WebStateUserDataSlots() = default;
+
+void WebStateUserDataSlots::SetUserDataInSlot(
+    size_t slot,
+    base::SupportsUserData::Data* data) {
+  DCHECK_NE(kInvalidSlot, slot);
+  if (slot >= slots_.size()) {
+    if (!data)
+      return;
+    slots_.resize(slot + 1);
+  }
+  slots_[slot] = data;
+}
+
+void WebStateUserDataSlots::ClearUserDataSlots() {
+  slots_.clear();
+}
+
+}  // namespace web
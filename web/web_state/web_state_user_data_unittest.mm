@@ -0,0 +1,164 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#import "ios/web/public/web_state_user_data.h"
+
+#include <string>
+
+#include "base/bind.h"
+#import "ios/web/public/test/fakes/fake_navigation_context.h"
+#import "ios/web/public/test/fakes/test_web_state.h"
+#include "testing/platform_test.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace web {
+namespace {
+
+// Counts the instances of TestUserData created.
+int g_created_count = 0;
+
+// WebStateUserData counting its instances.
+class TestUserData : public WebStateUserData<TestUserData> {
+ public:
+  ~TestUserData() override = default;
+
+ private:
+  explicit TestUserData(WebState* web_state) { ++g_created_count; }
+  friend class WebStateUserData<TestUserData>;
+  WEB_STATE_USER_DATA_KEY_DECL();
+};
+
+WEB_STATE_USER_DATA_KEY_IMPL(TestUserData)
+
+}  // namespace
+
+class WebStateUserDataTest : public PlatformTest {
+ protected:
+  WebStateUserDataTest() { g_created_count = 0; }
+
+  TestWebState web_state_;
+};
+
+// Tests that user data created lazily is created when it is retrieved.
+TEST_F(WebStateUserDataTest, CreatedLazilyOnRetrieval) {
+  TestUserData::CreateLazilyForWebState(&web_state_);
+  EXPECT_EQ(0, g_created_count);
+
+  // The const getter does not create the user data.
+  const WebState* const_web_state = &web_state_;
+  EXPECT_FALSE(TestUserData::FromWebState(const_web_state));
+  EXPECT_EQ(0, g_created_count);
+
+  TestUserData* user_data = TestUserData::FromWebState(&web_state_);
+  EXPECT_TRUE(user_data);
+  EXPECT_EQ(1, g_created_count);
+  EXPECT_EQ(user_data, TestUserData::FromWebState(&web_state_));
+  EXPECT_EQ(1, g_created_count);
+
+  // Showing the WebState does not create the user data again.
+  web_state_.WasShown();
+  EXPECT_EQ(1, g_created_count);
+}
+
+// Tests that user data created lazily is created when the WebState is shown.
+TEST_F(WebStateUserDataTest, CreatedLazilyWhenShown) {
+  TestUserData::CreateLazilyForWebState(&web_state_);
+  EXPECT_EQ(0, g_created_count);
+  web_state_.WasShown();
+  EXPECT_EQ(1, g_created_count);
+  EXPECT_TRUE(TestUserData::FromWebState(&web_state_));
+  EXPECT_EQ(1, g_created_count);
+
+  // Once the WebState is realized, the user data is created immediately.
+  TestUserData::RemoveFromWebState(&web_state_);
+  TestUserData::CreateLazilyForWebState(&web_state_);
+  EXPECT_EQ(2, g_created_count);
+}
+
+// Tests that user data created lazily is created when the WebState starts its
+// first navigation.
+TEST_F(WebStateUserDataTest, CreatedLazilyOnNavigation) {
+  TestUserData::CreateLazilyForWebState(&web_state_);
+  EXPECT_EQ(0, g_created_count);
+  FakeNavigationContext context;
+  web_state_.OnNavigationStarted(&context);
+  EXPECT_EQ(1, g_created_count);
+}
+
+// Tests that user data created lazily is not created if it is never used.
+TEST_F(WebStateUserDataTest, NotCreatedIfUnused) {
+  {
+    TestWebState web_state;
+    TestUserData::CreateLazilyForWebState(&web_state);
+  }
+  EXPECT_EQ(0, g_created_count);
+}
+
+// Tests that callbacks waiting for user data created lazily run in order once
+// it is created, without creating it.
+TEST_F(WebStateUserDataTest, RunWhenCreatedLazily) {
+  TestUserData::CreateLazilyForWebState(&web_state_);
+  __block std::string log;
+  __block TestUserData* run_with = nullptr;
+  TestUserData::RunWhenCreatedForWebState(
+      &web_state_, base::BindOnce(^(TestUserData* user_data) {
+        log += "a";
+        run_with = user_data;
+      }));
+  TestUserData::RunWhenCreatedForWebState(
+      &web_state_, base::BindOnce(^(TestUserData* user_data) {
+        log += "b";
+      }));
+  EXPECT_EQ(0, g_created_count);
+  EXPECT_EQ("", log);
+
+  web_state_.WasShown();
+  EXPECT_EQ(1, g_created_count);
+  EXPECT_EQ("ab", log);
+  EXPECT_EQ(TestUserData::FromWebState(&web_state_), run_with);
+
+  // Once the user data is created, the callbacks run immediately.
+  TestUserData::RunWhenCreatedForWebState(
+      &web_state_, base::BindOnce(^(TestUserData* user_data) {
+        log += "c";
+      }));
+  EXPECT_EQ("abc", log);
+}
+
+// Tests that callbacks waiting for user data which is not attached never run.
+TEST_F(WebStateUserDataTest, RunWhenCreatedWithoutUserData) {
+  __block bool run = false;
+  TestUserData::RunWhenCreatedForWebState(
+      &web_state_, base::BindOnce(^(TestUserData* user_data) {
+        run = true;
+      }));
+  web_state_.WasShown();
+  EXPECT_FALSE(run);
+  EXPECT_EQ(0, g_created_count);
+}
+
+// Tests that the user data looked up in its slot is kept in sync with the user
+// data map.
+TEST_F(WebStateUserDataTest, SlotMatchesUserDataMap) {
+  TestUserData::CreateForWebState(&web_state_);
+  TestUserData* user_data = TestUserData::FromWebState(&web_state_);
+  ASSERT_TRUE(user_data);
+  EXPECT_EQ(user_data, web_state_.GetUserData(TestUserData::UserDataKey()));
+
+  TestUserData::RemoveFromWebState(&web_state_);
+  EXPECT_FALSE(TestUserData::FromWebState(&web_state_));
+
+  // Replacing the user data in the map updates its slot.
+  TestUserData::CreateForWebState(&web_state_);
+  EXPECT_TRUE(TestUserData::FromWebState(&web_state_));
+  web_state_.SetUserData(TestUserData::UserDataKey(), nullptr);
+  EXPECT_FALSE(TestUserData::FromWebState(&web_state_));
+  const WebState* const_web_state = &web_state_;
+  EXPECT_FALSE(TestUserData::FromWebState(const_web_state));
+}
+
+}  // namespace web
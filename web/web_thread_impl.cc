@@ -4,15 +4,18 @@
 
 #include "ios/web/web_thread_impl.h"
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <utility>
 
-#include "base/atomicops.h"
 #include "base/bind.h"
 #include "base/callback.h"
 #include "base/compiler_specific.h"
 #include "base/lazy_instance.h"
+#include "base/logging.h"
 #include "base/macros.h"
+#include "base/metrics/histogram_macros.h"
 #include "base/no_destructor.h"
 #include "base/run_loop.h"
 #include "base/single_thread_task_runner.h"
@@ -87,50 +90,156 @@ struct WebThreadGlobals {
   WebThreadGlobals() {
   }
 
-  // This lock protects |threads| and |states|. Do not read or modify those
-  // arrays without holding this lock. Do not block while holding this lock.
+  // This lock serializes the writes to |owned_task_runners|, |task_runners|
+  // and |states|. The reads of |task_runners| and |states| do not need it.
+  // Do not block while holding this lock.
   base::Lock lock;
 
-  // This array is protected by |lock|. This array is filled as WebThreadImpls
-  // are constructed and depopulated when they are destructed.
+  // This array is protected by |lock|. It owns the task runners of
+  // |task_runners|.
   scoped_refptr<base::SingleThreadTaskRunner>
-      task_runners[WebThread::ID_COUNT] GUARDED_BY(lock);
+      owned_task_runners[WebThread::ID_COUNT] GUARDED_BY(lock);
 
-  // This array is protected by |lock|. Holds the state of each WebThread::ID.
-  WebThreadState states[WebThread::ID_COUNT] GUARDED_BY(lock) = {};
+  // This array is filled as WebThreadImpls are constructed and is not
+  // depopulated when they are destructed, so it can be read without |lock|.
+  // A task runner is published before its thread enters the RUNNING state.
+  std::atomic<base::SingleThreadTaskRunner*>
+      task_runners[WebThread::ID_COUNT] = {};
+
+  // Holds the state of each WebThread::ID. Can be read without |lock|.
+  std::atomic<WebThreadState> states[WebThread::ID_COUNT] = {};
+
+#if DCHECK_IS_ON()
+  // Number of threads reading each entry of |task_runners| without |lock|.
+  std::atomic<int> lock_free_readers[WebThread::ID_COUNT] = {};
+#endif
 };
 
 base::LazyInstance<WebThreadGlobals>::Leaky g_globals =
     LAZY_INSTANCE_INITIALIZER;
 
+// Counts, in DCHECK builds, the threads that may use the task runner of a
+// WebThread::ID read without |lock|, as ResetGlobalsForTesting() releases it.
+class ScopedLockFreeRead {
+ public:
+  explicit ScopedLockFreeRead(WebThread::ID identifier) {
+#if DCHECK_IS_ON()
+    identifier_ = identifier;
+    g_globals.Get().lock_free_readers[identifier_].fetch_add(1);
+#endif
+  }
+
+  ~ScopedLockFreeRead() {
+#if DCHECK_IS_ON()
+    g_globals.Get().lock_free_readers[identifier_].fetch_sub(1);
+#endif
+  }
+
+ private:
+#if DCHECK_IS_ON()
+  WebThread::ID identifier_;
+#endif
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedLockFreeRead);
+};
+
+// Whether the tasks posted to the WebThreads record telemetry.
+std::atomic<bool> g_task_telemetry_enabled{false};
+
+// The number of tasks posted to each WebThread::ID that did not run yet, if
+// task telemetry is enabled.
+std::atomic<int> g_queued_task_counts[WebThread::ID_COUNT] = {};
+
+// Records the depth of the queue of |identifier| when a task is posted.
+void RecordQueueDepth(WebThread::ID identifier, int queue_depth) {
+  static_assert(WebThread::ID_COUNT == 2, "Unhandled WebThread");
+  switch (identifier) {
+    case WebThread::UI:
+      UMA_HISTOGRAM_COUNTS_1000("IOS.WebThread.QueueDepth.UI", queue_depth);
+      break;
+    case WebThread::IO:
+      UMA_HISTOGRAM_COUNTS_1000("IOS.WebThread.QueueDepth.IO", queue_depth);
+      break;
+    case WebThread::ID_COUNT:
+      NOTREACHED();
+      break;
+  }
+}
+
+// Records the time a task of |identifier| waited to run once ready.
+void RecordQueueingLatency(WebThread::ID identifier, base::TimeDelta latency) {
+  static_assert(WebThread::ID_COUNT == 2, "Unhandled WebThread");
+  switch (identifier) {
+    case WebThread::UI:
+      UMA_HISTOGRAM_TIMES("IOS.WebThread.QueueingLatency.UI", latency);
+      break;
+    case WebThread::IO:
+      UMA_HISTOGRAM_TIMES("IOS.WebThread.QueueingLatency.IO", latency);
+      break;
+    case WebThread::ID_COUNT:
+      NOTREACHED();
+      break;
+  }
+}
+
+// Telemetry of a task posted to a WebThread, counted in the queue of the
+// thread until it is destroyed, whether the task ran or not.
+class TaskTelemetry {
+ public:
+  TaskTelemetry(WebThread::ID identifier, base::TimeDelta delay)
+      : identifier_(identifier), ready_time_(base::TimeTicks::Now() + delay) {
+    int queue_depth = g_queued_task_counts[identifier_].fetch_add(
+        1, std::memory_order_relaxed);
+    RecordQueueDepth(identifier_, queue_depth);
+  }
+
+  ~TaskTelemetry() {
+    g_queued_task_counts[identifier_].fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  // Records the queueing latency of the task, which is about to run.
+  void WillRunTask() {
+    RecordQueueingLatency(identifier_, base::TimeTicks::Now() - ready_time_);
+  }
+
+ private:
+  const WebThread::ID identifier_;
+  // The time the task was ready to run.
+  const base::TimeTicks ready_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(TaskTelemetry);
+};
+
+void RunTaskWithTelemetry(std::unique_ptr<TaskTelemetry> telemetry,
+                          base::OnceClosure task) {
+  telemetry->WillRunTask();
+  std::move(task).Run();
+}
+
 bool PostTaskHelper(WebThread::ID identifier,
                     const base::Location& from_here,
                     base::OnceClosure task,
                     base::TimeDelta delay,
-                    bool nestable) NO_THREAD_SAFETY_ANALYSIS {
+                    bool nestable) {
   DCHECK_GE(identifier, 0);
   DCHECK_LT(identifier, WebThread::ID_COUNT);
-  // Optimization: to avoid unnecessary locks, we listed the ID enumeration in
-  // order of lifetime.  So no need to lock if we know that the target thread
-  // outlives current thread.
-  // Note: since the array is so small, ok to loop instead of creating a map,
-  // which would require a lock because std::map isn't thread safe, defeating
-  // the whole purpose of this optimization.
-  WebThread::ID current_thread = WebThread::ID_COUNT;
-  bool target_thread_outlives_current =
-      WebThread::GetCurrentThreadIdentifier(&current_thread) &&
-      current_thread >= identifier;
-
+  // No lock is needed: the task runner of |identifier| is published before
+  // the RUNNING state, and is not released when the thread shuts down. A task
+  // posted while the thread shuts down is dropped by its task runner.
   WebThreadGlobals& globals = g_globals.Get();
-  if (!target_thread_outlives_current)
-    globals.lock.Acquire();
-
+  ScopedLockFreeRead lock_free_read(identifier);
   const bool accepting_tasks =
-      globals.states[identifier] == WebThreadState::RUNNING;
+      globals.states[identifier].load(std::memory_order_acquire) ==
+      WebThreadState::RUNNING;
   if (accepting_tasks) {
     base::SingleThreadTaskRunner* task_runner =
-        globals.task_runners[identifier].get();
+        globals.task_runners[identifier].load(std::memory_order_acquire);
     DCHECK(task_runner);
+    if (g_task_telemetry_enabled.load(std::memory_order_relaxed)) {
+      task = base::BindOnce(&RunTaskWithTelemetry,
+                            std::make_unique<TaskTelemetry>(identifier, delay),
+                            std::move(task));
+    }
     if (nestable) {
       task_runner->PostDelayedTask(from_here, std::move(task), delay);
     } else {
@@ -139,9 +248,6 @@ bool PostTaskHelper(WebThread::ID identifier,
     }
   }
 
-  if (!target_thread_outlives_current)
-    globals.lock.Release();
-
   return accepting_tasks;
 }
 
@@ -248,19 +354,22 @@ WebThreadImpl::WebThreadImpl(
   DCHECK_GE(identifier_, 0);
   DCHECK_LT(identifier_, ID_COUNT);
 
-  DCHECK_EQ(globals.states[identifier_], WebThreadState::UNINITIALIZED);
-  globals.states[identifier_] = WebThreadState::RUNNING;
-
-  DCHECK(!globals.task_runners[identifier_]);
-  globals.task_runners[identifier_] = std::move(task_runner);
+  DCHECK_EQ(globals.states[identifier_].load(), WebThreadState::UNINITIALIZED);
+  DCHECK(!globals.owned_task_runners[identifier_]);
+  globals.task_runners[identifier_].store(task_runner.get(),
+                                          std::memory_order_release);
+  globals.owned_task_runners[identifier_] = std::move(task_runner);
+  globals.states[identifier_].store(WebThreadState::RUNNING,
+                                    std::memory_order_release);
 }
 
 WebThreadImpl::~WebThreadImpl() {
   WebThreadGlobals& globals = g_globals.Get();
   base::AutoLock lock(globals.lock);
 
-  DCHECK_EQ(globals.states[identifier_], WebThreadState::RUNNING);
-  globals.states[identifier_] = WebThreadState::SHUTDOWN;
+  DCHECK_EQ(globals.states[identifier_].load(), WebThreadState::RUNNING);
+  globals.states[identifier_].store(WebThreadState::SHUTDOWN,
+                                    std::memory_order_release);
 }
 
 // static
@@ -268,9 +377,21 @@ void WebThreadImpl::ResetGlobalsForTesting(WebThread::ID identifier) {
   WebThreadGlobals& globals = g_globals.Get();
 
   base::AutoLock lock(globals.lock);
-  DCHECK_EQ(globals.states[identifier], WebThreadState::SHUTDOWN);
-  globals.states[identifier] = WebThreadState::UNINITIALIZED;
-  globals.task_runners[identifier] = nullptr;
+  DCHECK_EQ(globals.states[identifier].load(), WebThreadState::SHUTDOWN);
+  globals.states[identifier].store(WebThreadState::UNINITIALIZED,
+                                   std::memory_order_release);
+  globals.task_runners[identifier].store(nullptr, std::memory_order_release);
+#if DCHECK_IS_ON()
+  // The task runner is released without waiting for the threads that read it
+  // without |lock|, so they must all be done with it.
+  DCHECK_EQ(0, globals.lock_free_readers[identifier].load());
+#endif
+  globals.owned_task_runners[identifier] = nullptr;
+}
+
+// static
+void WebThreadImpl::SetTaskTelemetryEnabled(bool enabled) {
+  g_task_telemetry_enabled.store(enabled, std::memory_order_relaxed);
 }
 
 // Friendly names for the well-known threads.
@@ -293,20 +414,21 @@ bool WebThread::IsThreadInitialized(ID identifier) {
     return false;
 
   WebThreadGlobals& globals = g_globals.Get();
-  base::AutoLock lock(globals.lock);
   DCHECK_GE(identifier, 0);
   DCHECK_LT(identifier, ID_COUNT);
-  return globals.states[identifier] == WebThreadState::RUNNING;
+  return globals.states[identifier].load(std::memory_order_acquire) ==
+         WebThreadState::RUNNING;
 }
 
 // static
 bool WebThread::CurrentlyOn(ID identifier) {
   WebThreadGlobals& globals = g_globals.Get();
-  base::AutoLock lock(globals.lock);
   DCHECK_GE(identifier, 0);
   DCHECK_LT(identifier, ID_COUNT);
-  return globals.task_runners[identifier] &&
-         globals.task_runners[identifier]->BelongsToCurrentThread();
+  ScopedLockFreeRead lock_free_read(identifier);
+  base::SingleThreadTaskRunner* task_runner =
+      globals.task_runners[identifier].load(std::memory_order_acquire);
+  return task_runner && task_runner->BelongsToCurrentThread();
 }
 
 // static
@@ -329,10 +451,11 @@ bool WebThread::GetCurrentThreadIdentifier(ID* identifier) {
     return false;
 
   WebThreadGlobals& globals = g_globals.Get();
-  base::AutoLock lock(globals.lock);
   for (int i = 0; i < ID_COUNT; ++i) {
-    if (globals.task_runners[i] &&
-        globals.task_runners[i]->BelongsToCurrentThread()) {
+    ScopedLockFreeRead lock_free_read(static_cast<ID>(i));
+    base::SingleThreadTaskRunner* task_runner =
+        globals.task_runners[i].load(std::memory_order_acquire);
+    if (task_runner && task_runner->BelongsToCurrentThread()) {
       *identifier = static_cast<ID>(i);
       return true;
     }
@@ -44,11 +44,18 @@ class WebThreadImpl : public WebThread {
   // cleaned up in ~WebThreadImpl() as there are subtle differences between
   // UNINITIALIZED and SHUTDOWN state (e.g. globals.task_runners are kept around
   // on shutdown). Must be called after ~WebThreadImpl() for the given
-  // |identifier|.
+  // |identifier|, once the threads that may post to |identifier| or check
+  // whether they run on it are joined: the task runner of |identifier| is
+  // released without waiting for them, which is DCHECKed.
   //
   // Also unregisters and deletes the TaskExecutor.
   static void ResetGlobalsForTesting(WebThread::ID identifier);
 
+  // Sets whether the tasks posted to the WebThreads record the depth of the
+  // queue of their thread and the time they wait to run once ready, as
+  // histograms. Disabled by default.
+  static void SetTaskTelemetryEnabled(bool enabled);
+
  private:
   // Restrict instantiation to WebSubThread as it performs important
   // initialization that shouldn't be bypassed (except by WebMainLoop for
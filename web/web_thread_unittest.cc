@@ -5,8 +5,11 @@
 #include "ios/web/public/thread/web_thread.h"
 
 #include "base/bind.h"
+#include "base/macros.h"
 #include "base/task/post_task.h"
 #include "base/test/bind_test_util.h"
+#include "base/test/metrics/histogram_tester.h"
+#include "base/threading/simple_thread.h"
 #include "ios/web/public/test/web_task_environment.h"
 #include "ios/web/public/thread/web_task_traits.h"
 #include "ios/web/web_thread_impl.h"
@@ -101,4 +104,59 @@ TEST_F(WebThreadTest, GetContinuationTaskRunnerWithNoTaskRunning) {
   EXPECT_THAT(base::GetContinuationTaskRunner().get(), NotNull());
 }
 
+// Posts tasks to the IO thread.
+class PostTaskDelegate : public base::DelegateSimpleThread::Delegate {
+ public:
+  PostTaskDelegate(int task_count, const base::RepeatingClosure& task)
+      : task_count_(task_count), task_(task) {}
+
+  void Run() override {
+    for (int i = 0; i < task_count_; ++i)
+      EXPECT_TRUE(base::PostTask(FROM_HERE, {WebThread::IO}, task_));
+  }
+
+ private:
+  const int task_count_;
+  const base::RepeatingClosure task_;
+
+  DISALLOW_COPY_AND_ASSIGN(PostTaskDelegate);
+};
+
+// Tests posting tasks to the IO thread from threads that are not WebThreads.
+TEST_F(WebThreadTest, PostTaskFromOtherThreads) {
+  const int kThreadCount = 4;
+  const int kTaskCount = 100;
+  int run_count = 0;
+  base::RunLoop run_loop;
+  base::RepeatingClosure task = base::BindLambdaForTesting([&]() {
+    EXPECT_TRUE(WebThread::CurrentlyOn(WebThread::IO));
+    if (++run_count == kThreadCount * kTaskCount)
+      run_loop.Quit();
+  });
+  PostTaskDelegate delegate(kTaskCount, task);
+  base::DelegateSimpleThreadPool pool("WebThreadTest", kThreadCount);
+  pool.AddWork(&delegate, kThreadCount);
+  pool.Start();
+  run_loop.Run();
+  pool.JoinAll();
+  EXPECT_EQ(kThreadCount * kTaskCount, run_count);
+}
+
+// Tests that the tasks record their queueing latency and the depth of the
+// queue of their thread when the task telemetry is enabled.
+TEST_F(WebThreadTest, TaskTelemetry) {
+  base::HistogramTester histogram_tester;
+  WebThreadImpl::SetTaskTelemetryEnabled(true);
+  base::RunLoop run_loop;
+  base::PostTask(FROM_HERE, {WebThread::IO}, base::DoNothing());
+  base::PostTask(FROM_HERE, {WebThread::IO}, run_loop.QuitWhenIdleClosure());
+  run_loop.Run();
+  WebThreadImpl::SetTaskTelemetryEnabled(false);
+
+  histogram_tester.ExpectBucketCount("IOS.WebThread.QueueDepth.IO", 0, 1);
+  histogram_tester.ExpectBucketCount("IOS.WebThread.QueueDepth.IO", 1, 1);
+  histogram_tester.ExpectTotalCount("IOS.WebThread.QueueingLatency.IO", 2);
+  histogram_tester.ExpectTotalCount("IOS.WebThread.QueueDepth.UI", 0);
+}
+
 }  // namespace web
@@ -77,7 +77,10 @@ class MojoFacade {
   // Writes a message to the message pipe endpoint given by handle. |args| is a
   // dictionary which must contain the following keys:
   //   - "handle" (a number representing MojoHandle, the endpoint to write to);
-  //   - "buffer" (a dictionary representing the message data; may be empty);
+  //   - "buffer" (the message data; may be empty). Either a base64 encoded
+  //     string, which is decoded directly into the message, or a dictionary
+  //     keyed by byte index, which is what JSON.stringify produces for typed
+  //     arrays;
   //   - "handles" (an array representing any handles to attach; handles are
   //     transferred and will no longer be valid; may be empty);
   // Returns MojoResult as a number.
@@ -85,10 +88,12 @@ class MojoFacade {
 
   // Reads a message from the message pipe endpoint given by handle. |args| is
   // a dictionary which must contain the keys "handle" (a number representing
-  // MojoHandle, the endpoint to read from).
+  // MojoHandle, the endpoint to read from) and may contain the key "binary" (a
+  // boolean, false by default, selecting the encoding of "buffer").
   // Returns a dictionary with the following keys:
   //   - "result" (a number representing MojoResult);
-  //   - "buffer" (an array representing message data; non-empty only on
+  //   - "buffer" (message data, as a base64 encoded string if "binary" was
+  //     requested or as an array of numbers otherwise; non-empty only on
   //     success);
   //   - "handles" (an array representing MojoHandles received, if any);
   base::Value HandleMojoHandleReadMessage(base::Value args);
@@ -5,6 +5,7 @@
 #import "ios/web/webui/mojo_facade.h"
 
 #include <stdint.h>
+#include <string.h>
 
 #include <limits>
 #include <utility>
@@ -12,17 +13,21 @@
 
 #import <Foundation/Foundation.h>
 
+#include "base/base64.h"
 #include "base/bind.h"
 #import "base/ios/block_types.h"
 #include "base/json/json_reader.h"
 #include "base/json/json_writer.h"
+#include "base/numerics/safe_conversions.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/sys_string_conversions.h"
 #include "base/values.h"
 #include "ios/web/public/thread/web_thread.h"
 #import "ios/web/public/web_state.h"
 #include "mojo/public/cpp/bindings/generic_pending_receiver.h"
 #include "mojo/public/cpp/system/core.h"
+#include "third_party/modp_b64/modp_b64.h"
 
 #if !defined(__has_feature) || !__has_feature(objc_arc)
 #error "This file requires ARC support."
@@ -30,6 +35,73 @@
 
 namespace web {
 
+namespace {
+
+// Returns the number of bytes encoded by |base64|, or -1 if |base64| is not
+// a valid padded base64 string.
+int GetBase64DecodedSize(base::StringPiece base64) {
+  if (base64.size() % 4 != 0)
+    return -1;
+  size_t padding = 0;
+  if (!base64.empty() && base64.back() == '=') {
+    padding = base64.size() > 1 && base64[base64.size() - 2] == '=' ? 2 : 1;
+  }
+  return base::checked_cast<int>(base64.size() / 4 * 3 - padding);
+}
+
+// Writes a message made of the base64 encoded |base64_bytes| and |handles| to
+// |message_pipe|. Unlike mojo::WriteMessageRaw, the payload is decoded
+// directly into the message buffer, without an intermediate copy. Returns
+// MOJO_RESULT_INVALID_ARGUMENT if |base64_bytes| is not valid base64, in which
+// case |handles| are not attached to any message.
+MojoResult WriteBase64Message(mojo::MessagePipeHandle message_pipe,
+                              base::StringPiece base64_bytes,
+                              const std::vector<MojoHandle>& handles) {
+  const int num_bytes = GetBase64DecodedSize(base64_bytes);
+  if (num_bytes < 0)
+    return MOJO_RESULT_INVALID_ARGUMENT;
+
+  mojo::ScopedMessageHandle message;
+  MojoResult rv = mojo::CreateMessage(&message, MOJO_CREATE_MESSAGE_FLAG_NONE);
+  DCHECK_EQ(MOJO_RESULT_OK, rv);
+
+  // The payload is decoded before the handles are attached, so that they are
+  // not closed with the message if the payload is malformed.
+  void* buffer = nullptr;
+  uint32_t buffer_size = 0;
+  rv = MojoAppendMessageData(message->value(),
+                             static_cast<uint32_t>(num_bytes), nullptr, 0,
+                             nullptr, &buffer, &buffer_size);
+  if (rv != MOJO_RESULT_OK)
+    return MOJO_RESULT_ABORTED;
+  DCHECK_GE(buffer_size, static_cast<uint32_t>(num_bytes));
+
+  if (num_bytes > 0) {
+    size_t decoded_size =
+        modp_b64_decode(static_cast<char*>(buffer), base64_bytes.data(),
+                        base64_bytes.size());
+    if (decoded_size != static_cast<size_t>(num_bytes))
+      return MOJO_RESULT_INVALID_ARGUMENT;
+  }
+
+  MojoAppendMessageDataOptions append_options;
+  append_options.struct_size = sizeof(append_options);
+  append_options.flags = MOJO_APPEND_MESSAGE_DATA_FLAG_COMMIT_SIZE;
+  rv = MojoAppendMessageData(message->value(), 0, handles.data(),
+                             base::checked_cast<uint32_t>(handles.size()),
+                             &append_options, &buffer, &buffer_size);
+  if (rv != MOJO_RESULT_OK)
+    return MOJO_RESULT_ABORTED;
+
+  MojoWriteMessageOptions write_options;
+  write_options.struct_size = sizeof(write_options);
+  write_options.flags = MOJO_WRITE_MESSAGE_FLAG_NONE;
+  return MojoWriteMessage(message_pipe.value(), message.release().value(),
+                          &write_options);
+}
+
+}  // namespace
+
 MojoFacade::MojoFacade(WebState* web_state) : web_state_(web_state) {
   DCHECK_CURRENTLY_ON(WebThread::UI);
   DCHECK(web_state_);
@@ -135,9 +207,9 @@ base::Value MojoFacade::HandleMojoHandleWriteMessage(base::Value args) {
       args.FindKeyOfType("handles", base::Value::Type::LIST);
   CHECK(handles_list);
 
-  const base::Value* buffer =
-      args.FindKeyOfType("buffer", base::Value::Type::DICTIONARY);
+  const base::Value* buffer = args.FindKey("buffer");
   CHECK(buffer);
+  CHECK(buffer->is_string() || buffer->is_dict());
 
   int flags = MOJO_WRITE_MESSAGE_FLAG_NONE;
 
@@ -148,6 +220,13 @@ base::Value MojoFacade::HandleMojoHandleWriteMessage(base::Value args) {
     handles[i] = one_handle;
   }
 
+  mojo::MessagePipeHandle message_pipe(static_cast<MojoHandle>(*handle));
+  if (buffer->is_string()) {
+    MojoResult result =
+        WriteBase64Message(message_pipe, buffer->GetString(), handles);
+    return base::Value(static_cast<int>(result));
+  }
+
   std::vector<uint8_t> bytes(buffer->DictSize());
   for (const auto& item : buffer->DictItems()) {
     size_t index = std::numeric_limits<size_t>::max();
@@ -157,7 +236,6 @@ base::Value MojoFacade::HandleMojoHandleWriteMessage(base::Value args) {
     bytes[index] = one_byte;
   }
 
-  mojo::MessagePipeHandle message_pipe(static_cast<MojoHandle>(*handle));
   MojoResult result =
       mojo::WriteMessageRaw(message_pipe, bytes.data(), bytes.size(),
                             handles.data(), handles.size(), flags);
@@ -173,6 +251,8 @@ base::Value MojoFacade::HandleMojoHandleReadMessage(base::Value args) {
     handle_as_int = handle_as_value->GetInt();
   }
 
+  const bool binary = args.FindBoolKey("binary").value_or(false);
+
   int flags = MOJO_READ_MESSAGE_FLAG_NONE;
 
   std::vector<uint8_t> bytes;
@@ -191,12 +271,22 @@ base::Value MojoFacade::HandleMojoHandleReadMessage(base::Value args) {
     }
     result.SetKey("handles", std::move(handles_list));
 
-    base::Value buffer(base::Value::Type::LIST);
-    base::Value::ListStorage& buffer_storage = buffer.GetList();
-    for (uint32_t i = 0; i < bytes.size(); i++) {
-      buffer_storage.emplace_back(bytes[i]);
+    if (binary) {
+      std::string encoded_bytes;
+      base::Base64Encode(
+          base::StringPiece(reinterpret_cast<const char*>(bytes.data()),
+                            bytes.size()),
+          &encoded_bytes);
+      result.SetKey("buffer", base::Value(std::move(encoded_bytes)));
+    } else {
+      base::Value buffer(base::Value::Type::LIST);
+      base::Value::ListStorage& buffer_storage = buffer.GetList();
+      buffer_storage.reserve(bytes.size());
+      for (uint32_t i = 0; i < bytes.size(); i++) {
+        buffer_storage.emplace_back(bytes[i]);
+      }
+      result.SetKey("buffer", std::move(buffer));
     }
-    result.SetKey("buffer", std::move(buffer));
   }
   result.SetKey("result", base::Value(static_cast<int>(mojo_result)));
 
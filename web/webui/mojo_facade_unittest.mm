@@ -5,6 +5,7 @@
 #import "ios/web/webui/mojo_facade.h"
 
 #include <memory>
+#include <string>
 
 #include "base/bind.h"
 #include "base/run_loop.h"
@@ -244,4 +245,91 @@ TEST_F(MojoFacadeTest, ReadWrite) {
   CloseHandle(handle1);
 }
 
+// Tests writing and reading a message using the base64 binary transport.
+TEST_F(MojoFacadeTest, ReadWriteBinary) {
+  uint32_t handle0, handle1;
+  CreateMessagePipe(&handle0, &handle1);
+
+  // Write to the other end of the pipe.
+  NSDictionary* write = @{
+    @"name" : @"MojoHandle.writeMessage",
+    @"args" : @{
+      @"handle" : @(handle1),
+      @"handles" : @[],
+      @"buffer" : @"CQLY",  // base64 encoding of {9, 2, 216}.
+    },
+  };
+  std::string result_as_string = facade()->HandleMojoMessage(GetJson(write));
+  int result = 0;
+  EXPECT_TRUE(base::StringToInt(result_as_string, &result));
+  EXPECT_EQ(MOJO_RESULT_OK, static_cast<MojoResult>(result));
+
+  // Read the message back using the binary transport.
+  NSDictionary* read = @{
+    @"name" : @"MojoHandle.readMessage",
+    @"args" : @{
+      @"handle" : @(handle0),
+      @"binary" : @YES,
+    },
+  };
+  NSDictionary* message = GetObject(facade()->HandleMojoMessage(GetJson(read)));
+  ASSERT_TRUE([message isKindOfClass:[NSDictionary class]]);
+  EXPECT_NSEQ(@"CQLY", message[@"buffer"]);
+  EXPECT_FALSE([message[@"handles"] count]);
+  EXPECT_EQ(MOJO_RESULT_OK, [message[@"result"] unsignedIntValue]);
+
+  // Messages written using the binary transport can be read as JSON arrays.
+  facade()->HandleMojoMessage(GetJson(write));
+  read = @{
+    @"name" : @"MojoHandle.readMessage",
+    @"args" : @{
+      @"handle" : @(handle0),
+    },
+  };
+  message = GetObject(facade()->HandleMojoMessage(GetJson(read)));
+  NSArray* expected_message = @[ @9, @2, @216 ];
+  EXPECT_NSEQ(expected_message, message[@"buffer"]);
+
+  CloseHandle(handle0);
+  CloseHandle(handle1);
+}
+
+// Tests that writing a message with a malformed base64 payload fails without
+// writing anything to the pipe.
+TEST_F(MojoFacadeTest, WriteMalformedBinary) {
+  uint32_t handle0, handle1;
+  CreateMessagePipe(&handle0, &handle1);
+
+  // A payload whose size is not a multiple of 4, and one with characters which
+  // are not base64.
+  for (NSString* buffer in @[ @"CQL", @"CQ!Y" ]) {
+    NSDictionary* write = @{
+      @"name" : @"MojoHandle.writeMessage",
+      @"args" : @{
+        @"handle" : @(handle1),
+        @"handles" : @[],
+        @"buffer" : buffer,
+      },
+    };
+    std::string result_as_string = facade()->HandleMojoMessage(GetJson(write));
+    int result = 0;
+    EXPECT_TRUE(base::StringToInt(result_as_string, &result));
+    EXPECT_EQ(MOJO_RESULT_INVALID_ARGUMENT, static_cast<MojoResult>(result));
+  }
+
+  // Nothing was written to the pipe.
+  NSDictionary* read = @{
+    @"name" : @"MojoHandle.readMessage",
+    @"args" : @{
+      @"handle" : @(handle0),
+    },
+  };
+  NSDictionary* message = GetObject(facade()->HandleMojoMessage(GetJson(read)));
+  ASSERT_TRUE([message isKindOfClass:[NSDictionary class]]);
+  EXPECT_EQ(MOJO_RESULT_SHOULD_WAIT, [message[@"result"] unsignedIntValue]);
+
+  CloseHandle(handle0);
+  CloseHandle(handle1);
+}
+
 }  // namespace web
@@ -8,10 +8,13 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "base/compiler_specific.h"
+#include "base/containers/mru_cache.h"
 #include "base/macros.h"
+#include "base/memory/scoped_refptr.h"
 #include "base/supports_user_data.h"
 #include "ios/web/public/webui/url_data_source_ios.h"
 #include "ios/web/webui/url_data_manager_ios.h"
@@ -59,6 +62,21 @@ class URLDataManagerIOSBackend : public base::SupportsUserData::Data {
       DataSourceMap;
   typedef std::map<RequestID, URLRequestChromeJob*> PendingRequestMap;
 
+  // The name of the source, the path and the fingerprint of the responses of
+  // the source of a cached response.
+  typedef std::tuple<std::string, std::string, std::string> ResponseCacheKey;
+
+  // A response with the replacements of its source applied.
+  struct CachedResponse {
+    CachedResponse(const std::string& mime_type,
+                   scoped_refptr<base::RefCountedMemory> bytes);
+    CachedResponse(const CachedResponse& other);
+    ~CachedResponse();
+
+    std::string mime_type;
+    scoped_refptr<base::RefCountedMemory> bytes;
+  };
+
   // Called by the job when it's starting up.
   // Returns false if |url| is not a URL managed by this object.
   bool StartRequest(const net::URLRequest* request, URLRequestChromeJob* job);
@@ -82,6 +100,9 @@ class URLDataManagerIOSBackend : public base::SupportsUserData::Data {
   // else NULL.
   URLDataSourceIOSImpl* GetDataSourceFromURL(const GURL& url);
 
+  // Removes the cached responses of the source named |source_name|.
+  void RemoveCachedResponses(const std::string& source_name);
+
   // Custom sources of data, keyed by source path (e.g. "favicon").
   DataSourceMap data_sources_;
 
@@ -93,6 +114,10 @@ class URLDataManagerIOSBackend : public base::SupportsUserData::Data {
   // The ID we'll use for the next request we receive.
   RequestID next_request_id_;
 
+  // The most recently used responses of the sources that allow it, served
+  // without asking the source again nor applying its replacements.
+  base::MRUCache<ResponseCacheKey, CachedResponse> response_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(URLDataManagerIOSBackend);
 };
 
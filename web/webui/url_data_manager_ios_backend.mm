@@ -5,6 +5,7 @@
 #include "ios/web/webui/url_data_manager_ios_backend.h"
 
 #include <set>
+#include <utility>
 
 #include "base/bind.h"
 #include "base/command_line.h"
@@ -13,8 +14,10 @@
 #include "base/memory/ref_counted.h"
 #include "base/memory/ref_counted_memory.h"
 #include "base/memory/weak_ptr.h"
+#include "base/optional.h"
 #include "base/single_thread_task_runner.h"
 #include "base/stl_util.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/task/post_task.h"
@@ -54,6 +57,9 @@ const char kChromeURLContentSecurityPolicyHeaderBase[] =
 
 const char kChromeURLXFrameOptionsHeader[] = "X-Frame-Options: DENY";
 
+// Maximum number of responses cached by each URLDataManagerIOSBackend.
+const size_t kMaxCachedResponses = 32;
+
 // Returns whether |url| passes some sanity checks and is a valid GURL.
 bool CheckURLIsValid(const GURL& url) {
   std::vector<std::string> additional_schemes;
@@ -111,6 +117,10 @@ class URLRequestChromeJob : public net::URLRequestJob {
   // for us.
   void DataAvailable(base::RefCountedMemory* bytes);
 
+  // Used to notify that the response was found in the cache of the backend.
+  void CachedResponseAvailable(const std::string& mime_type,
+                               scoped_refptr<base::RefCountedMemory> bytes);
+
   void set_mime_type(const std::string& mime_type) { mime_type_ = mime_type; }
 
   void set_allow_caching(bool allow_caching) { allow_caching_ = allow_caching; }
@@ -187,6 +197,14 @@ class URLRequestChromeJob : public net::URLRequestJob {
   // True when job is generated from an incognito profile.
   const bool is_incognito_;
 
+  // If set, the response is cached with this key by the backend, which applies
+  // the replacements of the source to the data instead of a SourceStream.
+  base::Optional<URLDataManagerIOSBackend::ResponseCacheKey>
+      response_cache_key_;
+
+  // True when the response was served from the cache of the backend.
+  bool response_cache_hit_;
+
   // The BrowserState with which this job is associated.
   BrowserState* browser_state_;
 
@@ -213,6 +231,7 @@ URLRequestChromeJob::URLRequestChromeJob(net::URLRequest* request,
       deny_xframe_options_(true),
       send_content_type_header_(false),
       is_incognito_(is_incognito),
+      response_cache_hit_(false),
       browser_state_(browser_state),
       backend_(NULL),
       weak_factory_(this) {
@@ -295,7 +314,8 @@ std::unique_ptr<net::SourceStream> URLRequestChromeJob::SetUpSourceStream() {
   // same parent URLRequest, thus it is safe to pass the replacements via a raw
   // pointer.
   const ui::TemplateReplacements* replacements = nullptr;
-  if (source_)
+  // The replacements of a cached response are applied by the backend instead.
+  if (source_ && !response_cache_key_)
     replacements = source_->GetReplacements();
   if (replacements) {
     // It is safe to pass the raw replacements directly to the source stream, as
@@ -321,7 +341,9 @@ void URLRequestChromeJob::MimeTypeAvailable(URLDataSourceIOSImpl* source,
 }
 
 void URLRequestChromeJob::DataAvailable(base::RefCountedMemory* bytes) {
-  TRACE_EVENT_ASYNC_END0("browser", "DataManager:Request", this);
+  TRACE_EVENT_ASYNC_END2("browser", "DataManager:Request", this, "cache_hit",
+                         response_cache_hit_, "bytes_saved",
+                         response_cache_hit_ && bytes ? bytes->size() : 0);
   if (bytes) {
     data_ = bytes;
     if (pending_buf_.get()) {
@@ -335,6 +357,18 @@ void URLRequestChromeJob::DataAvailable(base::RefCountedMemory* bytes) {
   }
 }
 
+void URLRequestChromeJob::CachedResponseAvailable(
+    const std::string& mime_type,
+    scoped_refptr<base::RefCountedMemory> bytes) {
+  response_cache_hit_ = true;
+  set_mime_type(mime_type);
+  // The request may be cancelled when its headers are complete.
+  base::WeakPtr<URLRequestChromeJob> weak_this = weak_factory_.GetWeakPtr();
+  NotifyHeadersComplete();
+  if (weak_this)
+    DataAvailable(bytes.get());
+}
+
 int URLRequestChromeJob::ReadRawData(net::IOBuffer* buf, int buf_size) {
   if (!data_.get()) {
     DCHECK(!pending_buf_.get());
@@ -417,7 +451,18 @@ class ChromeProtocolHandler
 
 }  // namespace
 
-URLDataManagerIOSBackend::URLDataManagerIOSBackend() : next_request_id_(0) {
+URLDataManagerIOSBackend::CachedResponse::CachedResponse(
+    const std::string& mime_type,
+    scoped_refptr<base::RefCountedMemory> bytes)
+    : mime_type(mime_type), bytes(std::move(bytes)) {}
+
+URLDataManagerIOSBackend::CachedResponse::CachedResponse(
+    const CachedResponse& other) = default;
+
+URLDataManagerIOSBackend::CachedResponse::~CachedResponse() = default;
+
+URLDataManagerIOSBackend::URLDataManagerIOSBackend()
+    : next_request_id_(0), response_cache_(kMaxCachedResponses) {
   URLDataSourceIOS* shared_source = new SharedResourcesDataSourceIOS();
   URLDataSourceIOSImpl* source_impl =
       new URLDataSourceIOSImpl(shared_source->GetSource(), shared_source);
@@ -447,6 +492,12 @@ void URLDataManagerIOSBackend::AddDataSource(URLDataSourceIOSImpl* source) {
     if (!source->source()->ShouldReplaceExistingSource())
       return;
     i->second->backend_ = NULL;
+    // The sources are replaced whenever a WebUI is created, usually by sources
+    // serving the same responses, which can still be served from the cache.
+    if (i->second->GetResponsesFingerprint() !=
+        source->GetResponsesFingerprint()) {
+      RemoveCachedResponses(source->source_name());
+    }
   }
   data_sources_[source->source_name()] = source;
   source->backend_ = this;
@@ -476,10 +527,6 @@ bool URLDataManagerIOSBackend::StartRequest(const net::URLRequest* request,
   std::string path;
   URLToRequestPath(request->url(), &path);
 
-  // Save this request so we know where to send the data.
-  RequestID request_id = next_request_id_++;
-  pending_requests_.insert(std::make_pair(request_id, job));
-
   job->set_allow_caching(source->source()->AllowCaching());
   job->set_add_content_security_policy(true);
   job->set_content_security_policy_object_source(
@@ -488,6 +535,27 @@ bool URLDataManagerIOSBackend::StartRequest(const net::URLRequest* request,
   job->set_deny_xframe_options(source->source()->ShouldDenyXFrameOptions());
   job->set_send_content_type_header(false);
 
+  if (source->ShouldCacheResponses()) {
+    ResponseCacheKey cache_key(source->source_name(), path,
+                               source->GetResponsesFingerprint());
+    auto cached_response = response_cache_.Get(cache_key);
+    if (cached_response != response_cache_.end()) {
+      // The job must not be notified synchronously from its Start().
+      base::PostTask(
+          FROM_HERE, {WebThread::IO},
+          base::BindOnce(&URLRequestChromeJob::CachedResponseAvailable,
+                         job->weak_factory_.GetWeakPtr(),
+                         cached_response->second.mime_type,
+                         cached_response->second.bytes));
+      return true;
+    }
+    job->response_cache_key_ = std::move(cache_key);
+  }
+
+  // Save this request so we know where to send the data.
+  RequestID request_id = next_request_id_++;
+  pending_requests_.insert(std::make_pair(request_id, job));
+
   // Forward along the request to the data source.
   // URLRequestChromeJob should receive mime type before data. This
   // is guaranteed because request for mime type is placed in the
@@ -524,6 +592,18 @@ URLDataSourceIOSImpl* URLDataManagerIOSBackend::GetDataSourceFromURL(
   return NULL;
 }
 
+void URLDataManagerIOSBackend::RemoveCachedResponses(
+    const std::string& source_name) {
+  auto it = response_cache_.begin();
+  while (it != response_cache_.end()) {
+    if (std::get<0>(it->first) == source_name) {
+      it = response_cache_.Erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 void URLDataManagerIOSBackend::CallStartRequest(
     scoped_refptr<URLDataSourceIOSImpl> source,
     const std::string& path,
@@ -553,7 +633,26 @@ void URLDataManagerIOSBackend::DataAvailable(RequestID request_id,
   if (i != pending_requests_.end()) {
     URLRequestChromeJob* job(i->second);
     pending_requests_.erase(i);
-    job->DataAvailable(bytes);
+    if (!bytes || !job->response_cache_key_) {
+      job->DataAvailable(bytes);
+      return;
+    }
+
+    // Apply the replacements once for all the requests served from the cache.
+    // Only the HTML responses have their source set, as in
+    // URLRequestChromeJob::SetUpSourceStream().
+    scoped_refptr<base::RefCountedMemory> response(bytes);
+    const ui::TemplateReplacements* replacements =
+        job->source_ ? job->source_->GetReplacements() : nullptr;
+    if (replacements) {
+      std::string data = ui::ReplaceTemplateExpressions(
+          base::StringPiece(response->front_as<char>(), response->size()),
+          *replacements);
+      response = base::RefCountedString::TakeString(&data);
+    }
+    response_cache_.Put(*job->response_cache_key_,
+                        CachedResponse(job->mime_type_, response));
+    job->DataAvailable(response.get());
   }
 }
 
@@ -0,0 +1,171 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/web/webui/url_data_manager_ios_backend.h"
+
+#include <memory>
+#include <string>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/run_loop.h"
+#include "base/test/trace_event_analyzer.h"
+#include "base/values.h"
+#include "ios/web/public/browser_state.h"
+#include "ios/web/public/test/fakes/test_web_client.h"
+#include "ios/web/public/test/web_test.h"
+#include "ios/web/public/webui/web_ui_ios_data_source.h"
+#include "ios/web/test/test_url_constants.h"
+#include "net/base/request_priority.h"
+#include "net/traffic_annotation/network_traffic_annotation_test_helper.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_context.h"
+#include "net/url_request/url_request_context_getter.h"
+#include "net/url_request/url_request_test_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace web {
+
+namespace {
+
+const char kTestHost[] = "testpage";
+const char kTestPath[] = "page.html";
+const int kTestResourceId = 1;
+const char kTestResource[] = "<p>$i18n{title}</p>";
+
+// A WebClient serving |kTestResource| and counting how many times it does so.
+class ResourceCountingWebClient : public TestWebClient {
+ public:
+  ResourceCountingWebClient() = default;
+
+  base::RefCountedMemory* GetDataResourceBytes(int id) const override {
+    EXPECT_EQ(kTestResourceId, id);
+    ++resource_requests_;
+    return new base::RefCountedStaticMemory(kTestResource,
+                                            sizeof(kTestResource) - 1);
+  }
+
+  int resource_requests() const { return resource_requests_; }
+
+ private:
+  mutable int resource_requests_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(ResourceCountingWebClient);
+};
+
+}  // namespace
+
+// Test fixture for testing the responses cached by URLDataManagerIOSBackend.
+class URLDataManagerIOSBackendTest : public WebTest {
+ protected:
+  URLDataManagerIOSBackendTest()
+      : WebTest(std::make_unique<ResourceCountingWebClient>(),
+                WebTaskEnvironment::Options::IO_MAINLOOP) {}
+
+  // Adds a source serving |kTestResource| with |title| as replacement.
+  WebUIIOSDataSource* AddSource(const std::string& title) {
+    WebUIIOSDataSource* source = WebUIIOSDataSource::Create(kTestHost);
+    source->AddString("title", title);
+    source->AddResourcePath(kTestPath, kTestResourceId);
+    WebUIIOSDataSource::Add(GetBrowserState(), source);
+    base::RunLoop().RunUntilIdle();
+    return source;
+  }
+
+  // Requests |kTestPath| and returns the data received.
+  std::string Fetch() {
+    GURL url(std::string(kTestWebUIScheme) + "://" + kTestHost + "/" +
+             kTestPath);
+    net::TestDelegate delegate;
+    std::unique_ptr<net::URLRequest> request =
+        GetBrowserState()
+            ->GetRequestContext()
+            ->GetURLRequestContext()
+            ->CreateRequest(url, net::DEFAULT_PRIORITY, &delegate,
+                            TRAFFIC_ANNOTATION_FOR_TESTS);
+    request->Start();
+    delegate.RunUntilComplete();
+    return delegate.data_received();
+  }
+
+  int resource_requests() const {
+    return static_cast<ResourceCountingWebClient*>(GetWebClient())
+        ->resource_requests();
+  }
+};
+
+// Tests that a response is served from the cache the second time.
+TEST_F(URLDataManagerIOSBackendTest, ServesSecondRequestFromCache) {
+  AddSource("A");
+
+  EXPECT_EQ("<p>A</p>", Fetch());
+  EXPECT_EQ("<p>A</p>", Fetch());
+  EXPECT_EQ(1, resource_requests());
+}
+
+// Tests that the cached responses are still served after the source is
+// replaced by a source with the same content, as when a WebUI is created.
+TEST_F(URLDataManagerIOSBackendTest, KeepsCacheWhenReplacedByEqualSource) {
+  AddSource("A");
+  EXPECT_EQ("<p>A</p>", Fetch());
+
+  AddSource("A");
+  EXPECT_EQ("<p>A</p>", Fetch());
+  EXPECT_EQ(1, resource_requests());
+}
+
+// Tests that the cached responses are not served after the source is replaced
+// by a source with other content.
+TEST_F(URLDataManagerIOSBackendTest, InvalidatesCacheWhenReplaced) {
+  AddSource("A");
+  EXPECT_EQ("<p>A</p>", Fetch());
+
+  AddSource("B");
+  EXPECT_EQ("<p>B</p>", Fetch());
+  EXPECT_EQ(2, resource_requests());
+}
+
+// Tests that the cached responses are not served after the strings of the
+// source change.
+TEST_F(URLDataManagerIOSBackendTest, InvalidatesCacheOnAddLocalizedStrings) {
+  WebUIIOSDataSource* source = AddSource("A");
+  EXPECT_EQ("<p>A</p>", Fetch());
+
+  base::DictionaryValue localized_strings;
+  localized_strings.SetString("title", "B");
+  source->AddLocalizedStrings(localized_strings);
+  EXPECT_EQ("<p>B</p>", Fetch());
+  EXPECT_EQ(2, resource_requests());
+}
+
+// Tests that the end of each request is traced with whether it was served from
+// the cache and how many bytes that saved.
+TEST_F(URLDataManagerIOSBackendTest, TracesCacheHits) {
+  AddSource("A");
+
+  trace_analyzer::Start("browser");
+  std::string response = Fetch();
+  Fetch();
+  std::unique_ptr<trace_analyzer::TraceAnalyzer> analyzer =
+      trace_analyzer::Stop();
+
+  trace_analyzer::TraceEventVector events;
+  analyzer->FindEvents(
+      trace_analyzer::Query::EventNameIs("DataManager:Request") &&
+          trace_analyzer::Query::EventPhaseIs(TRACE_EVENT_PHASE_ASYNC_END),
+      &events);
+  ASSERT_EQ(2U, events.size());
+  EXPECT_FALSE(events[0]->GetKnownArgAsBool("cache_hit"));
+  EXPECT_EQ(0, events[0]->GetKnownArgAsInt("bytes_saved"));
+  EXPECT_TRUE(events[1]->GetKnownArgAsBool("cache_hit"));
+  EXPECT_EQ(static_cast<int>(response.size()),
+            events[1]->GetKnownArgAsInt("bytes_saved"));
+}
+
+}  // namespace web
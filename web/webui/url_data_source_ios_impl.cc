@@ -59,4 +59,12 @@ const ui::TemplateReplacements* URLDataSourceIOSImpl::GetReplacements() const {
   return nullptr;
 }
 
+bool URLDataSourceIOSImpl::ShouldCacheResponses() const {
+  return false;
+}
+
+std::string URLDataSourceIOSImpl::GetResponsesFingerprint() const {
+  return std::string();
+}
+
 }  // namespace web
@@ -6,6 +6,7 @@
 #define IOS_WEB_WEBUI_URL_DATA_SOURCE_IOS_IMPL_H_
 
 #include <memory>
+#include <string>
 
 #include "base/memory/ref_counted.h"
 #include "base/sequenced_task_runner_helpers.h"
@@ -68,6 +69,16 @@ class URLDataSourceIOSImpl
   // Replacements for i18n or null if no replacements are desired.
   virtual const ui::TemplateReplacements* GetReplacements() const;
 
+  // Returns whether the responses of this source, with the replacements
+  // applied, can be cached by the backend as long as GetResponsesFingerprint()
+  // does not change. Called on the IO thread.
+  virtual bool ShouldCacheResponses() const;
+
+  // Returns a digest of the content served by this source, which changes
+  // whenever its responses may change and is equal for sources serving the
+  // same responses. Called on the IO thread.
+  virtual std::string GetResponsesFingerprint() const;
+
  protected:
   virtual ~URLDataSourceIOSImpl();
 
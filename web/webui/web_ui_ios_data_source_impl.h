@@ -11,6 +11,7 @@
 #include "base/callback.h"
 #include "base/compiler_specific.h"
 #include "base/macros.h"
+#include "base/synchronization/lock.h"
 #include "base/values.h"
 #include "ios/web/public/webui/url_data_source_ios.h"
 #include "ios/web/public/webui/web_ui_ios_data_source.h"
@@ -35,6 +36,8 @@ class WebUIIOSDataSourceImpl : public URLDataSourceIOSImpl,
   void SetDefaultResource(int resource_id) override;
   void DisableDenyXFrameOptions() override;
   const ui::TemplateReplacements* GetReplacements() const override;
+  bool ShouldCacheResponses() const override;
+  std::string GetResponsesFingerprint() const override;
 
  protected:
   ~WebUIIOSDataSourceImpl() override;
@@ -63,6 +66,10 @@ class WebUIIOSDataSourceImpl : public URLDataSourceIOSImpl,
 
   int PathToIdrOrDefault(const std::string& path) const;
 
+  // Returns a digest of the strings and resources served by this source.
+  // |content_lock_| must be held.
+  std::string ComputeResponsesFingerprint() const;
+
   // The name of this source.
   // E.g., for favicons, this could be "favicon", which results in paths for
   // specific resources like "favicon/34" getting sent to this source.
@@ -79,6 +86,13 @@ class WebUIIOSDataSourceImpl : public URLDataSourceIOSImpl,
   bool deny_xframe_options_;
   bool load_time_data_defaults_added_;
   bool replace_existing_source_;
+  // Guards the strings and resources served, which are changed on the main
+  // thread and fingerprinted on the IO thread.
+  mutable base::Lock content_lock_;
+  // The digest of the strings and resources served, computed lazily on the IO
+  // thread and cleared whenever they change. Sources with equal content have
+  // equal fingerprints, so their cached responses survive replacing them.
+  mutable std::string responses_fingerprint_;
 
   DISALLOW_COPY_AND_ASSIGN(WebUIIOSDataSourceImpl);
 };
@@ -7,7 +7,11 @@
 #include <string>
 
 #include "base/bind.h"
+#include "base/hash/md5.h"
+#include "base/json/json_writer.h"
 #include "base/memory/ref_counted_memory.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
 #import "ios/web/public/web_client.h"
@@ -20,6 +24,17 @@
 
 namespace web {
 
+namespace {
+
+// Adds |data| to |context|, prefixed by its size so that consecutive parts
+// cannot be confused with each other.
+void UpdateFingerprint(base::MD5Context* context, base::StringPiece data) {
+  base::MD5Update(context, base::NumberToString(data.size()) + ":");
+  base::MD5Update(context, data);
+}
+
+}  // namespace
+
 // static
 WebUIIOSDataSource* WebUIIOSDataSource::Create(const std::string& source_name) {
   return new WebUIIOSDataSourceImpl(source_name);
@@ -72,45 +87,61 @@ WebUIIOSDataSourceImpl::~WebUIIOSDataSourceImpl() {}
 
 void WebUIIOSDataSourceImpl::AddString(const std::string& name,
                                        const base::string16& value) {
+  base::AutoLock lock(content_lock_);
   localized_strings_.SetString(name, value);
   replacements_[name] = base::UTF16ToUTF8(value);
+  responses_fingerprint_.clear();
 }
 
 void WebUIIOSDataSourceImpl::AddString(const std::string& name,
                                        const std::string& value) {
+  base::AutoLock lock(content_lock_);
   localized_strings_.SetString(name, value);
   replacements_[name] = value;
+  responses_fingerprint_.clear();
 }
 
 void WebUIIOSDataSourceImpl::AddLocalizedString(const std::string& name,
                                                 int ids) {
+  base::AutoLock lock(content_lock_);
   localized_strings_.SetString(name, GetWebClient()->GetLocalizedString(ids));
   replacements_[name] =
       base::UTF16ToUTF8(GetWebClient()->GetLocalizedString(ids));
+  responses_fingerprint_.clear();
 }
 
 void WebUIIOSDataSourceImpl::AddLocalizedStrings(
     const base::DictionaryValue& localized_strings) {
+  base::AutoLock lock(content_lock_);
   localized_strings_.MergeDictionary(&localized_strings);
   ui::TemplateReplacementsFromDictionaryValue(localized_strings,
                                               &replacements_);
+  responses_fingerprint_.clear();
 }
 
 void WebUIIOSDataSourceImpl::AddBoolean(const std::string& name, bool value) {
+  base::AutoLock lock(content_lock_);
   localized_strings_.SetBoolean(name, value);
+  responses_fingerprint_.clear();
 }
 
 void WebUIIOSDataSourceImpl::UseStringsJs() {
+  base::AutoLock lock(content_lock_);
   use_strings_js_ = true;
+  responses_fingerprint_.clear();
 }
 
 void WebUIIOSDataSourceImpl::AddResourcePath(const std::string& path,
                                              int resource_id) {
+  base::AutoLock lock(content_lock_);
   path_to_idr_map_[path] = resource_id;
+  responses_fingerprint_.clear();
 }
 
 void WebUIIOSDataSourceImpl::SetDefaultResource(int resource_id) {
+  base::AutoLock lock(content_lock_);
   default_resource_ = resource_id;
+  responses_fingerprint_.clear();
 }
 
 void WebUIIOSDataSourceImpl::DisableDenyXFrameOptions() {
@@ -122,6 +153,17 @@ const ui::TemplateReplacements* WebUIIOSDataSourceImpl::GetReplacements()
   return &replacements_;
 }
 
+bool WebUIIOSDataSourceImpl::ShouldCacheResponses() const {
+  return true;
+}
+
+std::string WebUIIOSDataSourceImpl::GetResponsesFingerprint() const {
+  base::AutoLock lock(content_lock_);
+  if (responses_fingerprint_.empty())
+    responses_fingerprint_ = ComputeResponsesFingerprint();
+  return responses_fingerprint_;
+}
+
 std::string WebUIIOSDataSourceImpl::GetSource() const {
   return source_name_;
 }
@@ -153,7 +195,11 @@ void WebUIIOSDataSourceImpl::EnsureLoadTimeDataDefaultsAdded() {
   base::DictionaryValue defaults;
   webui::SetLoadTimeDataDefaults(web::GetWebClient()->GetApplicationLocale(),
                                  &defaults);
-  AddLocalizedStrings(defaults);
+  // The defaults only depend on the locale, which the localized strings
+  // already depend on, so they do not change the fingerprint of the responses.
+  base::AutoLock lock(content_lock_);
+  localized_strings_.MergeDictionary(&defaults);
+  ui::TemplateReplacementsFromDictionaryValue(defaults, &replacements_);
 }
 
 void WebUIIOSDataSourceImpl::StartDataRequest(
@@ -184,6 +230,28 @@ void WebUIIOSDataSourceImpl::SendLocalizedStringsAsJSON(
   std::move(callback).Run(base::RefCountedString::TakeString(&template_data));
 }
 
+std::string WebUIIOSDataSourceImpl::ComputeResponsesFingerprint() const {
+  content_lock_.AssertAcquired();
+  base::MD5Context context;
+  base::MD5Init(&context);
+  std::string localized_strings_json;
+  base::JSONWriter::Write(localized_strings_, &localized_strings_json);
+  UpdateFingerprint(&context, localized_strings_json);
+  for (const auto& replacement : replacements_) {
+    UpdateFingerprint(&context, replacement.first);
+    UpdateFingerprint(&context, replacement.second);
+  }
+  for (const auto& path_and_idr : path_to_idr_map_) {
+    UpdateFingerprint(&context, path_and_idr.first);
+    UpdateFingerprint(&context, base::NumberToString(path_and_idr.second));
+  }
+  UpdateFingerprint(&context, base::NumberToString(default_resource_));
+  UpdateFingerprint(&context, use_strings_js_ ? "strings_js" : "");
+  base::MD5Digest digest;
+  base::MD5Final(&digest, &context);
+  return base::MD5DigestToBase16(digest);
+}
+
 int WebUIIOSDataSourceImpl::PathToIdrOrDefault(const std::string& path) const {
   auto it = path_to_idr_map_.find(path);
   return it == path_to_idr_map_.end() ? default_resource_ : it->second;
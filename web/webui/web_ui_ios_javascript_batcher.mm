@@ -0,0 +1,92 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/web/public/webui/web_ui_ios_javascript_batcher.h"
+
+#include "base/logging.h"
+#include "base/strings/string_util.h"
+#include "base/strings/utf_string_conversions.h"
+#import "ios/web/public/web_state.h"
+#include "ios/web/public/webui/web_ui_ios.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace web {
+
+namespace {
+
+// Wraps each call so that a call throwing an exception does not prevent the
+// next calls of the batch from running, as when they ran as separate scripts.
+const char kCallPrefix[] = "try{";
+const char kCallSuffix[] = "}catch(e){console.error(e);}";
+
+}  // namespace
+
+WebUIIOSJavascriptBatcher::WebUIIOSJavascriptBatcher(WebUIIOS* web_ui,
+                                                     const Options& options)
+    : web_ui_(web_ui), options_(options) {
+  DCHECK(web_ui_);
+  DCHECK_GT(options_.max_pending_calls, 0u);
+}
+
+WebUIIOSJavascriptBatcher::WebUIIOSJavascriptBatcher(WebUIIOS* web_ui)
+    : WebUIIOSJavascriptBatcher(web_ui, Options()) {}
+
+WebUIIOSJavascriptBatcher::~WebUIIOSJavascriptBatcher() = default;
+
+void WebUIIOSJavascriptBatcher::CallJavascriptFunction(
+    const std::string& function_name,
+    const std::vector<const base::Value*>& args) {
+  DCHECK(base::IsStringASCII(function_name));
+  if (pending_calls_.size() >= options_.max_pending_calls) {
+    switch (options_.overflow_policy) {
+      case OverflowPolicy::kFlush:
+        Flush();
+        break;
+      case OverflowPolicy::kDropOldest:
+        // The evicted call will not be executed as part of a batch.
+        pending_calls_.pop_front();
+        --batched_call_count_;
+        ++dropped_call_count_;
+        break;
+      case OverflowPolicy::kDropNewest:
+        ++dropped_call_count_;
+        return;
+    }
+  }
+
+  pending_calls_.push_back(WebUIIOS::GetJavascriptCall(function_name, args));
+  ++batched_call_count_;
+  if (!flush_timer_.IsRunning()) {
+    flush_timer_.Start(FROM_HERE, options_.interval, this,
+                       &WebUIIOSJavascriptBatcher::Flush);
+  }
+}
+
+void WebUIIOSJavascriptBatcher::Flush() {
+  flush_timer_.Stop();
+  if (pending_calls_.empty())
+    return;
+
+  const base::string16 call_prefix = base::ASCIIToUTF16(kCallPrefix);
+  const base::string16 call_suffix = base::ASCIIToUTF16(kCallSuffix);
+  size_t script_size = 0;
+  for (const base::string16& call : pending_calls_)
+    script_size += call_prefix.size() + call.size() + call_suffix.size();
+
+  base::string16 script;
+  script.reserve(script_size);
+  for (const base::string16& call : pending_calls_) {
+    script += call_prefix;
+    script += call;
+    script += call_suffix;
+  }
+  pending_calls_.clear();
+  ++batch_count_;
+  web_ui_->GetWebState()->ExecuteJavaScript(script);
+}
+
+}  // namespace web
@@ -0,0 +1,157 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ios/web/public/webui/web_ui_ios_javascript_batcher.h"
+
+#include "base/strings/utf_string_conversions.h"
+#include "base/values.h"
+#import "ios/web/public/test/fakes/test_web_state.h"
+#include "ios/web/public/test/web_task_environment.h"
+#include "ios/web/webui/web_ui_ios_impl.h"
+#include "testing/platform_test.h"
+
+#if !defined(__has_feature) || !__has_feature(objc_arc)
+#error "This file requires ARC support."
+#endif
+
+namespace web {
+
+namespace {
+
+// Interval of the batchers under test.
+const base::TimeDelta kInterval = base::TimeDelta::FromMilliseconds(16);
+
+}  // namespace
+
+class WebUIIOSJavascriptBatcherTest : public PlatformTest {
+ protected:
+  WebUIIOSJavascriptBatcherTest()
+      : task_environment_(
+            WebTaskEnvironment::Options::DEFAULT,
+            base::test::TaskEnvironment::TimeSource::MOCK_TIME),
+        web_ui_(&web_state_) {}
+
+  // Returns a batcher buffering up to |max_pending_calls| with
+  // |overflow_policy|.
+  std::unique_ptr<WebUIIOSJavascriptBatcher> CreateBatcher(
+      size_t max_pending_calls,
+      WebUIIOSJavascriptBatcher::OverflowPolicy overflow_policy) {
+    WebUIIOSJavascriptBatcher::Options options;
+    options.interval = kInterval;
+    options.max_pending_calls = max_pending_calls;
+    options.overflow_policy = overflow_policy;
+    return std::make_unique<WebUIIOSJavascriptBatcher>(&web_ui_, options);
+  }
+
+  // Calls the function |name| with an integer argument.
+  void Call(WebUIIOSJavascriptBatcher* batcher, const std::string& name) {
+    base::Value arg(1);
+    batcher->CallJavascriptFunction(name, {&arg});
+  }
+
+  // Returns the last executed script.
+  std::string GetLastExecutedJavascript() {
+    return base::UTF16ToUTF8(web_state_.GetLastExecutedJavascript());
+  }
+
+  WebTaskEnvironment task_environment_;
+  TestWebState web_state_;
+  WebUIIOSImpl web_ui_;
+};
+
+// Tests that the calls are executed in order as a single script at the end of
+// the interval.
+TEST_F(WebUIIOSJavascriptBatcherTest, BatchCalls) {
+  auto batcher =
+      CreateBatcher(10, WebUIIOSJavascriptBatcher::OverflowPolicy::kFlush);
+  Call(batcher.get(), "a");
+  Call(batcher.get(), "b");
+  task_environment_.FastForwardBy(kInterval / 2);
+  EXPECT_EQ("", GetLastExecutedJavascript());
+  Call(batcher.get(), "c");
+
+  task_environment_.FastForwardBy(kInterval / 2);
+  EXPECT_EQ(
+      "try{a(1);}catch(e){console.error(e);}"
+      "try{b(1);}catch(e){console.error(e);}"
+      "try{c(1);}catch(e){console.error(e);}",
+      GetLastExecutedJavascript());
+  EXPECT_EQ(3u, batcher->batched_call_count());
+  EXPECT_EQ(1u, batcher->batch_count());
+  EXPECT_EQ(0u, batcher->pending_call_count());
+}
+
+// Tests that the pending calls are executed right away when the batcher is
+// full with the kFlush policy.
+TEST_F(WebUIIOSJavascriptBatcherTest, FlushOnOverflow) {
+  auto batcher =
+      CreateBatcher(2, WebUIIOSJavascriptBatcher::OverflowPolicy::kFlush);
+  Call(batcher.get(), "a");
+  Call(batcher.get(), "b");
+  Call(batcher.get(), "c");
+  EXPECT_EQ(
+      "try{a(1);}catch(e){console.error(e);}"
+      "try{b(1);}catch(e){console.error(e);}",
+      GetLastExecutedJavascript());
+
+  task_environment_.FastForwardBy(kInterval);
+  EXPECT_EQ("try{c(1);}catch(e){console.error(e);}",
+            GetLastExecutedJavascript());
+  EXPECT_EQ(0u, batcher->dropped_call_count());
+  EXPECT_EQ(2u, batcher->batch_count());
+}
+
+// Tests that the oldest pending call is dropped when the batcher is full with
+// the kDropOldest policy.
+TEST_F(WebUIIOSJavascriptBatcherTest, DropOldestOnOverflow) {
+  auto batcher =
+      CreateBatcher(2, WebUIIOSJavascriptBatcher::OverflowPolicy::kDropOldest);
+  Call(batcher.get(), "a");
+  Call(batcher.get(), "b");
+  Call(batcher.get(), "c");
+  task_environment_.FastForwardBy(kInterval);
+  EXPECT_EQ(
+      "try{b(1);}catch(e){console.error(e);}"
+      "try{c(1);}catch(e){console.error(e);}",
+      GetLastExecutedJavascript());
+  EXPECT_EQ(1u, batcher->dropped_call_count());
+  EXPECT_EQ(2u, batcher->batched_call_count());
+}
+
+// Tests that the new call is dropped when the batcher is full with the
+// kDropNewest policy.
+TEST_F(WebUIIOSJavascriptBatcherTest, DropNewestOnOverflow) {
+  auto batcher =
+      CreateBatcher(2, WebUIIOSJavascriptBatcher::OverflowPolicy::kDropNewest);
+  Call(batcher.get(), "a");
+  Call(batcher.get(), "b");
+  Call(batcher.get(), "c");
+  task_environment_.FastForwardBy(kInterval);
+  EXPECT_EQ(
+      "try{a(1);}catch(e){console.error(e);}"
+      "try{b(1);}catch(e){console.error(e);}",
+      GetLastExecutedJavascript());
+  EXPECT_EQ(1u, batcher->dropped_call_count());
+  EXPECT_EQ(2u, batcher->batched_call_count());
+}
+
+// Tests that Flush() executes the pending calls right away.
+TEST_F(WebUIIOSJavascriptBatcherTest, Flush) {
+  auto batcher =
+      CreateBatcher(10, WebUIIOSJavascriptBatcher::OverflowPolicy::kFlush);
+  batcher->Flush();
+  EXPECT_EQ(0u, batcher->batch_count());
+
+  Call(batcher.get(), "a");
+  batcher->Flush();
+  EXPECT_EQ("try{a(1);}catch(e){console.error(e);}",
+            GetLastExecutedJavascript());
+  EXPECT_EQ(1u, batcher->batch_count());
+
+  web_state_.ClearLastExecutedJavascript();
+  task_environment_.FastForwardBy(kInterval);
+  EXPECT_EQ("", GetLastExecutedJavascript());
+}
+
+}  // namespace web